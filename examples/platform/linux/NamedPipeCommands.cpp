@@ -48,6 +48,22 @@ CHIP_ERROR NamedPipeCommands::Start(std::string & path, NamedPipeCommandDelegate
     return CHIP_NO_ERROR;
 }
 
+CHIP_ERROR NamedPipeCommands::Start(std::string & path, std::string & path_out, NamedPipeCommandDelegate * delegate)
+{
+    VerifyOrReturnError(!mStarted, CHIP_NO_ERROR);
+    VerifyOrReturnError((mkfifo(path_out.c_str(), 0666) == 0) || (errno == EEXIST), CHIP_ERROR_OPEN_FAILED);
+    mChipEventFifoPathOut = path_out;
+
+    CHIP_ERROR err = Start(path, delegate);
+    if (err != CHIP_NO_ERROR)
+    {
+        // The out FIFO was created above; do not leave it behind when the channel does not start.
+        unlink(mChipEventFifoPathOut.c_str());
+        mChipEventFifoPathOut.clear();
+    }
+    return err;
+}
+
 CHIP_ERROR NamedPipeCommands::Stop()
 {
     VerifyOrReturnError(mStarted, CHIP_NO_ERROR);
@@ -63,9 +79,31 @@ CHIP_ERROR NamedPipeCommands::Stop()
     VerifyOrReturnError(unlink(mChipEventFifoPath.c_str()) == 0, CHIP_ERROR_WRITE_FAILED);
     mChipEventFifoPath.clear();
 
+    if (!mChipEventFifoPathOut.empty())
+    {
+        VerifyOrReturnError(unlink(mChipEventFifoPathOut.c_str()) == 0, CHIP_ERROR_WRITE_FAILED);
+        mChipEventFifoPathOut.clear();
+    }
+
     return CHIP_NO_ERROR;
 }
 
+void NamedPipeCommands::WriteToOutPipe(const std::string & json)
+{
+    VerifyOrReturn(mStarted && !mChipEventFifoPathOut.empty(), ChipLogError(NotSpecified, "Out FIFO is not started"));
+
+    // Opening a FIFO for writing without O_NONBLOCK would wait for a reader.
+    int fd = open(mChipEventFifoPathOut.c_str(), O_WRONLY | O_NONBLOCK);
+    VerifyOrReturn(fd != -1, ChipLogError(NotSpecified, "No reader on the out FIFO, dropping reply"));
+
+    std::string line = json + "\n";
+    if (write(fd, line.c_str(), line.size()) != static_cast<ssize_t>(line.size()))
+    {
+        ChipLogError(NotSpecified, "Failed to write to the out FIFO");
+    }
+    close(fd);
+}
+
 void * NamedPipeCommands::EventCommandListenerTask(void * arg)
 {
     char readbuf[kChipEventCmdBufSize];
@@ -33,12 +33,18 @@ class NamedPipeCommands
 {
 public:
     CHIP_ERROR Start(std::string & path, NamedPipeCommandDelegate * delegate);
+    // Also creates a second FIFO at path_out that replies are written to with WriteToOutPipe().
+    CHIP_ERROR Start(std::string & path, std::string & path_out, NamedPipeCommandDelegate * delegate);
     CHIP_ERROR Stop();
 
+    // Writes one line to the out FIFO. Never blocks: the line is dropped if nobody is reading.
+    void WriteToOutPipe(const std::string & json);
+
 private:
     bool mStarted = false;
     pthread_t mChipEventCommandListener;
     std::string mChipEventFifoPath;
+    std::string mChipEventFifoPathOut;
     NamedPipeCommandDelegate * mDelegate = nullptr;
 
     static void * EventCommandListenerTask(void * arg);
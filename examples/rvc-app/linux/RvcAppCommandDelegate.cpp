@@ -17,17 +17,66 @@
  */
 
 #include "RvcAppCommandDelegate.h"
+#include "RvcAIProfiler.h"
 #include <app/data-model/Nullable.h>
 #include <platform/PlatformManager.h>
 
 #include "rvc-device.h"
 #include <string>
 #include <utility>
+#include <vector>
 
 using namespace chip;
 using namespace chip::app;
 using namespace chip::app::Clusters;
 
+namespace {
+
+// Builds an area from the keys of the AddArea message. AreaId must be present.
+ServiceArea::AreaStructureWrapper AreaFromJson(const Json::Value & jsonValue)
+{
+    ServiceArea::AreaStructureWrapper area;
+    area.SetAreaId(jsonValue["AreaId"].asUInt());
+    if (jsonValue.isMember("MapId"))
+    {
+        area.SetMapId(jsonValue["MapId"].asUInt());
+    }
+
+    // Set the location info
+    if (jsonValue.isMember("LocationName") || jsonValue.isMember("FloorNumber") || jsonValue.isMember("AreaType"))
+    {
+        DataModel::Nullable<int16_t> floorNumber = DataModel::NullNullable;
+        if (jsonValue.isMember("FloorNumber"))
+        {
+            floorNumber = jsonValue["FloorNumber"].asInt();
+        }
+        DataModel::Nullable<Globals::AreaTypeTag> areaType = DataModel::NullNullable;
+        if (jsonValue.isMember("AreaType"))
+        {
+            areaType = Globals::AreaTypeTag(jsonValue["AreaType"].asUInt());
+        }
+        auto locationName = jsonValue["LocationName"].asString();
+
+        area.SetLocationInfo(CharSpan(locationName.data(), locationName.size()), floorNumber, areaType);
+    }
+
+    // Set landmark info
+    if (jsonValue.isMember("LandmarkTag"))
+    {
+        DataModel::Nullable<Globals::RelativePositionTag> relativePositionTag = DataModel::NullNullable;
+        if (jsonValue.isMember("RelativePositionTag"))
+        {
+            relativePositionTag = Globals::RelativePositionTag(jsonValue["RelativePositionTag"].asUInt());
+        }
+
+        area.SetLandmarkInfo(Globals::LandmarkTag(jsonValue["LandmarkTag"].asUInt()), relativePositionTag);
+    }
+
+    return area;
+}
+
+} // namespace
+
 RvcAppCommandHandler * RvcAppCommandHandler::FromJSON(const char * json)
 {
     Json::Reader reader;
@@ -114,6 +163,13 @@ void RvcAppCommandHandler::HandleCommand(intptr_t context)
         VerifyOrExit(self->mJsonValue.isMember("AreaId"), ChipLogError(NotSpecified, "RVC App: AreaId key is missing"));
         self->OnAddServiceAreaArea(self->mJsonValue);
     }
+    else if (name == "ImportMaps")
+    {
+        VerifyOrExit(self->mJsonValue.isMember("Maps") && self->mJsonValue["Maps"].isArray() &&
+                         self->mJsonValue.isMember("Areas") && self->mJsonValue["Areas"].isArray(),
+                     ChipLogError(NotSpecified, "RVC App: Maps and Areas arrays are missing"));
+        self->OnImportServiceAreaMaps(self->mJsonValue);
+    }
     else if (name == "RemoveMap")
     {
         VerifyOrExit(self->mJsonValue.isMember("MapId"), ChipLogError(NotSpecified, "RVC App: MapId key is missing"));
@@ -137,6 +193,16 @@ void RvcAppCommandHandler::HandleCommand(intptr_t context)
     {
         self->OnResetHandler();
     }
+    else if (name == "ReloadModel")
+    {
+        VerifyOrExit(self->mJsonValue.isMember("Path") && self->mJsonValue["Path"].isString(),
+                     ChipLogError(NotSpecified, "RVC App: Path key is missing"));
+        self->OnReloadModelHandler(self->mJsonValue["Path"].asString());
+    }
+    else if (name == "GetInferenceStats")
+    {
+        self->OnGetInferenceStatsHandler();
+    }
     else
     {
         ChipLogError(NotSpecified, "Unhandled command: Should never happens");
@@ -151,6 +217,16 @@ void RvcAppCommandHandler::SetRvcDevice(chip::app::Clusters::RvcDevice * aRvcDev
     mRvcDevice = aRvcDevice;
 }
 
+void RvcAppCommandHandler::SetAIInterface(RvcAIInterface * aAIInterface)
+{
+    mAIInterface = aAIInterface;
+}
+
+void RvcAppCommandHandler::SetPipes(NamedPipeCommands * aPipes)
+{
+    mPipes = aPipes;
+}
+
 void RvcAppCommandHandler::OnChargedHandler()
 {
     mRvcDevice->HandleChargedMessage();
@@ -223,44 +299,34 @@ void RvcAppCommandHandler::OnAddServiceAreaMap(Json::Value jsonValue)
 
 void RvcAppCommandHandler::OnAddServiceAreaArea(Json::Value jsonValue)
 {
-    ServiceArea::AreaStructureWrapper area;
-    area.SetAreaId(jsonValue["AreaId"].asUInt());
-    if (jsonValue.isMember("MapId"))
-    {
-        area.SetMapId(jsonValue["MapId"].asUInt());
-    }
+    ServiceArea::AreaStructureWrapper area = AreaFromJson(jsonValue);
+    mRvcDevice->HandleAddServiceAreaArea(area);
+}
 
-    // Set the location info
-    if (jsonValue.isMember("LocationName") || jsonValue.isMember("FloorNumber") || jsonValue.isMember("AreaType"))
-    {
-        DataModel::Nullable<int16_t> floorNumber = DataModel::NullNullable;
-        if (jsonValue.isMember("FloorNumber"))
-        {
-            floorNumber = jsonValue["FloorNumber"].asInt();
-        }
-        DataModel::Nullable<Globals::AreaTypeTag> areaType = DataModel::NullNullable;
-        if (jsonValue.isMember("AreaType"))
-        {
-            areaType = Globals::AreaTypeTag(jsonValue["AreaType"].asUInt());
-        }
-        auto locationName = jsonValue["LocationName"].asString();
+void RvcAppCommandHandler::OnImportServiceAreaMaps(const Json::Value & jsonValue)
+{
+    std::vector<ServiceArea::MapStructureWrapper> maps;
+    std::vector<ServiceArea::AreaStructureWrapper> areas;
 
-        area.SetLocationInfo(CharSpan(locationName.data(), locationName.size()), floorNumber, areaType);
+    const Json::Value & jsonMaps = jsonValue["Maps"];
+    maps.reserve(jsonMaps.size());
+    for (const Json::Value & jsonMap : jsonMaps)
+    {
+        VerifyOrReturn(jsonMap.isMember("MapId") && jsonMap.isMember("MapName"),
+                       ChipLogError(NotSpecified, "RVC App: ImportMaps: MapId and MapName keys are missing"));
+        std::string mapName = jsonMap["MapName"].asString();
+        maps.emplace_back(jsonMap["MapId"].asUInt(), CharSpan(mapName.data(), mapName.size()));
     }
 
-    // Set landmark info
-    if (jsonValue.isMember("LandmarkTag"))
+    const Json::Value & jsonAreas = jsonValue["Areas"];
+    areas.reserve(jsonAreas.size());
+    for (const Json::Value & jsonArea : jsonAreas)
     {
-        DataModel::Nullable<Globals::RelativePositionTag> relativePositionTag = DataModel::NullNullable;
-        if (jsonValue.isMember("RelativePositionTag"))
-        {
-            relativePositionTag = Globals::RelativePositionTag(jsonValue["RelativePositionTag"].asUInt());
-        }
-
-        area.SetLandmarkInfo(Globals::LandmarkTag(jsonValue["LandmarkTag"].asUInt()), relativePositionTag);
+        VerifyOrReturn(jsonArea.isMember("AreaId"), ChipLogError(NotSpecified, "RVC App: ImportMaps: AreaId key is missing"));
+        areas.push_back(AreaFromJson(jsonArea));
     }
 
-    mRvcDevice->HandleAddServiceAreaArea(area);
+    mRvcDevice->HandleImportServiceAreaMaps(maps, areas);
 }
 
 void RvcAppCommandHandler::OnRemoveServiceAreaMap(uint32_t mapId)
@@ -288,11 +354,76 @@ void RvcAppCommandHandler::OnResetHandler()
     mRvcDevice->HandleResetMessage();
 }
 
+void RvcAppCommandHandler::OnReloadModelHandler(const std::string & aPath)
+{
+    VerifyOrReturn(mAIInterface != nullptr, ChipLogError(NotSpecified, "RVC App: No AI interface to reload"));
+
+    // Mapping, verifying and planning the new model happen on the inference worker, not on the CHIP thread.
+    ChipLogProgress(NotSpecified, "RVC App: Reloading the model from %s", aPath.c_str());
+    mAIInterface->RequestModelReload(aPath);
+}
+
+void RvcAppCommandHandler::OnGetInferenceStatsHandler()
+{
+    VerifyOrReturn(mPipes != nullptr, ChipLogError(NotSpecified, "RVC App: No out pipe to reply on"));
+    RvcAIProfiler * profiler = (mAIInterface != nullptr) ? mAIInterface->GetProfiler() : nullptr;
+    VerifyOrReturn(profiler != nullptr, ChipLogError(NotSpecified, "RVC App: Inference profiling is not enabled"));
+
+    RvcAIProfiler::Snapshot snapshot = profiler->GetSnapshot();
+
+    Json::Value reply;
+    reply["Name"]            = "InferenceStats";
+    reply["Inferences"]      = snapshot.inferences;
+    reply["GraphInferences"] = snapshot.graphInferences;
+    reply["Window"]          = snapshot.windowSize;
+    reply["LastUs"]          = snapshot.lastUs;
+    reply["P50Us"]           = snapshot.p50Us;
+    reply["P99Us"]           = snapshot.p99Us;
+    reply["MaxUs"]           = snapshot.maxUs;
+    reply["ArenaUsedBytes"]  = static_cast<Json::UInt64>(snapshot.arenaUsedBytes);
+
+    reply["Ops"] = Json::Value(Json::arrayValue);
+    for (const RvcAIProfiler::OpStats & op : snapshot.ops)
+    {
+        Json::Value entry;
+        entry["Op"]        = op.tag;
+        entry["Count"]     = op.count;
+        entry["AverageUs"] = op.averageUs;
+        entry["Share"]     = op.share;
+        reply["Ops"].append(entry);
+    }
+
+    reply["SlowestLayers"] = Json::Value(Json::arrayValue);
+    for (const RvcAIProfiler::LayerStats & layer : snapshot.layers)
+    {
+        Json::Value entry;
+        entry["Index"]     = layer.index;
+        entry["Op"]        = layer.tag;
+        entry["AverageUs"] = layer.averageUs;
+        entry["MaxUs"]     = layer.maxUs;
+        reply["SlowestLayers"].append(entry);
+    }
+
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+    mPipes->WriteToOutPipe(Json::writeString(builder, reply));
+}
+
 void RvcAppCommandDelegate::SetRvcDevice(chip::app::Clusters::RvcDevice * aRvcDevice)
 {
     mRvcDevice = aRvcDevice;
 }
 
+void RvcAppCommandDelegate::SetAIInterface(RvcAIInterface * aAIInterface)
+{
+    mAIInterface = aAIInterface;
+}
+
+void RvcAppCommandDelegate::SetPipes(NamedPipeCommands * aPipes)
+{
+    mPipes = aPipes;
+}
+
 void RvcAppCommandDelegate::OnEventCommandReceived(const char * json)
 {
     auto handler = RvcAppCommandHandler::FromJSON(json);
@@ -303,5 +434,7 @@ void RvcAppCommandDelegate::OnEventCommandReceived(const char * json)
     }
 
     handler->SetRvcDevice(mRvcDevice);
+    handler->SetAIInterface(mAIInterface);
+    handler->SetPipes(mPipes);
     chip::DeviceLayer::PlatformMgr().ScheduleWork(RvcAppCommandHandler::HandleCommand, reinterpret_cast<intptr_t>(handler));
 }
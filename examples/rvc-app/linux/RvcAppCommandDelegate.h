@@ -19,6 +19,7 @@
 #pragma once
 
 #include "NamedPipeCommands.h"
+#include "RvcAIInterface.h"
 #include "rvc-device.h"
 #include <json/json.h>
 #include <platform/DiagnosticDataProvider.h>
@@ -36,9 +37,15 @@ public:
 
     void SetRvcDevice(chip::app::Clusters::RvcDevice * aRvcDevice);
 
+    void SetAIInterface(RvcAIInterface * aAIInterface);
+
+    void SetPipes(NamedPipeCommands * aPipes);
+
 private:
     Json::Value mJsonValue;
     chip::app::Clusters::RvcDevice * mRvcDevice;
+    RvcAIInterface * mAIInterface = nullptr;
+    NamedPipeCommands * mPipes    = nullptr;
 
     /**
      * Should be called to notify that the device has finished charging.
@@ -69,6 +76,12 @@ private:
 
     void OnAddServiceAreaArea(Json::Value jsonValue);
 
+    /**
+     * Replaces the supported maps and areas. jsonValue holds a Maps array (MapId, MapName) and an Areas array, whose entries
+     * take the keys of the AddArea message.
+     */
+    void OnImportServiceAreaMaps(const Json::Value & jsonValue);
+
     void OnRemoveServiceAreaMap(uint32_t mapId);
 
     void OnRemoveServiceAreaArea(uint32_t areaId);
@@ -78,14 +91,28 @@ private:
     void OnClearErrorHandler();
 
     void OnResetHandler();
+
+    /**
+     * Swaps the detection model to the .tflite file at aPath without restarting the app.
+     */
+    void OnReloadModelHandler(const std::string & aPath);
+
+    /**
+     * Writes the inference latency percentiles and per-operator timings to the out pipe.
+     */
+    void OnGetInferenceStatsHandler();
 };
 
 class RvcAppCommandDelegate : public NamedPipeCommandDelegate
 {
 private:
     chip::app::Clusters::RvcDevice * mRvcDevice;
+    RvcAIInterface * mAIInterface = nullptr;
+    NamedPipeCommands * mPipes    = nullptr;
 
 public:
     void SetRvcDevice(chip::app::Clusters::RvcDevice * aRvcDevice);
+    void SetAIInterface(RvcAIInterface * aAIInterface);
+    void SetPipes(NamedPipeCommands * aPipes);
     void OnEventCommandReceived(const char * json) override;
 };
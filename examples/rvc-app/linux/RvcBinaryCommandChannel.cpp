@@ -0,0 +1,358 @@
+/*
+ *
+ *    Copyright (c) 2025 Project CHIP Authors
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "RvcBinaryCommandChannel.h"
+
+#include <lib/core/CHIPEncoding.h>
+#include <lib/core/TLV.h>
+#include <lib/support/CodeUtils.h>
+#include <lib/support/TypeTraits.h>
+#include <lib/support/logging/CHIPLogging.h>
+#include <platform/CHIPDeviceLayer.h>
+
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+using namespace chip;
+using namespace chip::app;
+using namespace chip::app::Clusters;
+
+namespace {
+
+constexpr uint8_t kTagCommandId = 0;
+constexpr uint8_t kTagAreaId    = 1;
+constexpr uint8_t kTagValue     = 2;
+constexpr uint8_t kTagText      = 3;
+
+constexpr size_t kFrameHeaderSize = sizeof(uint32_t);
+// Large enough for several frames per read() when the client sends faster than we handle them.
+constexpr size_t kReadBufferSize = 4 * (kFrameHeaderSize + RvcBinaryCommandChannel::kMaxFrameSize);
+
+using CommandHandler = void (*)(RvcDevice & device, const RvcBinaryCommand & command);
+
+struct DispatchEntry
+{
+    RvcBinaryCommandId id;
+    CommandHandler handler;
+};
+
+// Indexed by RvcBinaryCommandId; the static_assert below keeps the order in step with the enum.
+constexpr DispatchEntry kDispatchTable[] = {
+    { RvcBinaryCommandId::kCharged, [](RvcDevice & d, const RvcBinaryCommand &) { d.HandleChargedMessage(); } },
+    { RvcBinaryCommandId::kCharging, [](RvcDevice & d, const RvcBinaryCommand &) { d.HandleChargingMessage(); } },
+    { RvcBinaryCommandId::kDocked, [](RvcDevice & d, const RvcBinaryCommand &) { d.HandleDockedMessage(); } },
+    { RvcBinaryCommandId::kEmptyingDustBin, [](RvcDevice & d, const RvcBinaryCommand &) { d.HandleEmptyingDustBinMessage(); } },
+    { RvcBinaryCommandId::kCleaningMop, [](RvcDevice & d, const RvcBinaryCommand &) { d.HandleCleaningMopMessage(); } },
+    { RvcBinaryCommandId::kFillingWaterTank,
+      [](RvcDevice & d, const RvcBinaryCommand &) { d.HandleFillingWaterTankMessage(); } },
+    { RvcBinaryCommandId::kUpdatingMaps, [](RvcDevice & d, const RvcBinaryCommand &) { d.HandleUpdatingMapsMessage(); } },
+    { RvcBinaryCommandId::kChargerFound, [](RvcDevice & d, const RvcBinaryCommand &) { d.HandleChargerFoundMessage(); } },
+    { RvcBinaryCommandId::kLowCharge, [](RvcDevice & d, const RvcBinaryCommand &) { d.HandleLowChargeMessage(); } },
+    { RvcBinaryCommandId::kActivityComplete, [](RvcDevice & d, const RvcBinaryCommand &) { d.HandleActivityCompleteEvent(); } },
+    { RvcBinaryCommandId::kAreaComplete, [](RvcDevice & d, const RvcBinaryCommand &) { d.HandleAreaCompletedEvent(); } },
+    { RvcBinaryCommandId::kErrorEvent, [](RvcDevice & d, const RvcBinaryCommand & c) { d.HandleErrorEvent(c.text); } },
+    { RvcBinaryCommandId::kClearError, [](RvcDevice & d, const RvcBinaryCommand &) { d.HandleClearErrorMessage(); } },
+    { RvcBinaryCommandId::kReset, [](RvcDevice & d, const RvcBinaryCommand &) { d.HandleResetMessage(); } },
+    { RvcBinaryCommandId::kProgressStatus,
+      [](RvcDevice & d, const RvcBinaryCommand & c) {
+          d.HandleProgressStatusMessage(c.areaId, static_cast<ServiceArea::OperationalStatusEnum>(c.value));
+      } },
+    { RvcBinaryCommandId::kProgressEstimate,
+      [](RvcDevice & d, const RvcBinaryCommand & c) {
+          d.HandleProgressEstimateMessage(c.areaId,
+                                          c.hasValue ? DataModel::MakeNullable(c.value) : DataModel::Nullable<uint32_t>());
+      } },
+};
+
+constexpr bool IsDispatchTableOrdered()
+{
+    for (size_t i = 0; i < MATTER_ARRAY_SIZE(kDispatchTable); i++)
+    {
+        if (static_cast<size_t>(kDispatchTable[i].id) != i)
+        {
+            return false;
+        }
+    }
+    return MATTER_ARRAY_SIZE(kDispatchTable) == static_cast<size_t>(RvcBinaryCommandId::kCount);
+}
+static_assert(IsDispatchTableOrdered(), "kDispatchTable must list every RvcBinaryCommandId, in order");
+
+CHIP_ERROR DecodeCommand(TLV::TLVReader & reader, RvcBinaryCommand & command)
+{
+    VerifyOrReturnError(reader.GetType() == TLV::kTLVType_Structure, CHIP_ERROR_WRONG_TLV_TYPE);
+
+    bool hasId = false;
+    command    = RvcBinaryCommand();
+
+    TLV::TLVType structType;
+    ReturnErrorOnFailure(reader.EnterContainer(structType));
+
+    CHIP_ERROR err;
+    while ((err = reader.Next()) == CHIP_NO_ERROR)
+    {
+        if (!TLV::IsContextTag(reader.GetTag()))
+        {
+            continue;
+        }
+
+        switch (TLV::TagNumFromTag(reader.GetTag()))
+        {
+        case kTagCommandId: {
+            uint8_t id;
+            ReturnErrorOnFailure(reader.Get(id));
+            VerifyOrReturnError(id < to_underlying(RvcBinaryCommandId::kCount), CHIP_ERROR_INVALID_ARGUMENT);
+            command.id = static_cast<RvcBinaryCommandId>(id);
+            hasId      = true;
+            break;
+        }
+        case kTagAreaId:
+            ReturnErrorOnFailure(reader.Get(command.areaId));
+            break;
+        case kTagValue:
+            ReturnErrorOnFailure(reader.Get(command.value));
+            command.hasValue = true;
+            break;
+        case kTagText: {
+            CharSpan text;
+            ReturnErrorOnFailure(reader.Get(text));
+            size_t size = std::min(text.size(), RvcBinaryCommand::kMaxTextSize);
+            memcpy(command.text, text.data(), size);
+            command.text[size] = '\0';
+            break;
+        }
+        default:
+            break; // unknown fields are skipped, for forward compatibility
+        }
+    }
+    VerifyOrReturnError(err == CHIP_END_OF_TLV, err);
+    ReturnErrorOnFailure(reader.ExitContainer(structType));
+
+    VerifyOrReturnError(hasId, CHIP_ERROR_INVALID_ARGUMENT);
+
+    // The dispatch table casts the value straight to the enum.
+    if (command.id == RvcBinaryCommandId::kProgressStatus)
+    {
+        VerifyOrReturnError(command.hasValue &&
+                                command.value < to_underlying(ServiceArea::OperationalStatusEnum::kUnknownEnumValue),
+                            CHIP_ERROR_INVALID_ARGUMENT);
+    }
+    return CHIP_NO_ERROR;
+}
+
+void CloseClient(void * fd)
+{
+    close(static_cast<int>(reinterpret_cast<intptr_t>(fd)));
+}
+
+} // namespace
+
+CHIP_ERROR RvcBinaryCommandChannel::Start(const std::string & path, RvcDevice * device)
+{
+    VerifyOrReturnError(!mStarted, CHIP_NO_ERROR);
+    VerifyOrReturnError(device != nullptr, CHIP_ERROR_INVALID_ARGUMENT);
+
+    sockaddr_un addr = {};
+    addr.sun_family  = AF_UNIX;
+    VerifyOrReturnError(path.size() < sizeof(addr.sun_path), CHIP_ERROR_INVALID_ARGUMENT);
+    memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    VerifyOrReturnError(fd != -1, CHIP_ERROR_POSIX(errno));
+
+    // A socket file left behind by a previous run would make bind() fail.
+    unlink(path.c_str());
+    if (bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 || listen(fd, 1) != 0)
+    {
+        CHIP_ERROR err = CHIP_ERROR_POSIX(errno);
+        close(fd);
+        return err;
+    }
+
+    mListenFd = fd;
+    mPath     = path;
+    mDevice   = device;
+    mStarted  = true;
+
+    if (pthread_create(&mListener, nullptr, ListenerTask, reinterpret_cast<void *>(this)) != 0)
+    {
+        // There is no listener thread for Stop() to cancel and join; undo the rest here.
+        close(mListenFd);
+        mListenFd = -1;
+        unlink(mPath.c_str());
+        mPath.clear();
+        mDevice  = nullptr;
+        mStarted = false;
+        return CHIP_ERROR_UNEXPECTED_EVENT;
+    }
+
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR RvcBinaryCommandChannel::Stop()
+{
+    VerifyOrReturnError(mStarted, CHIP_NO_ERROR);
+
+    mStarted = false;
+
+    // accept() and read() are cancellation points.
+    if (pthread_cancel(mListener) == 0)
+    {
+        pthread_join(mListener, nullptr);
+    }
+
+    close(mListenFd);
+    mListenFd = -1;
+    unlink(mPath.c_str());
+    mPath.clear();
+    mDevice = nullptr;
+
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR RvcBinaryCommandChannel::DecodeBatch(const uint8_t * payload, size_t length, RvcBinaryCommandBatch & aBatch)
+{
+    TLV::TLVReader reader;
+    reader.Init(payload, length);
+
+    ReturnErrorOnFailure(reader.Next(TLV::kTLVType_Array, TLV::AnonymousTag()));
+
+    TLV::TLVType arrayType;
+    ReturnErrorOnFailure(reader.EnterContainer(arrayType));
+
+    aBatch.count = 0;
+    CHIP_ERROR err;
+    while ((err = reader.Next()) == CHIP_NO_ERROR)
+    {
+        VerifyOrReturnError(aBatch.count < RvcBinaryCommandBatch::kMaxCommands, CHIP_ERROR_BUFFER_TOO_SMALL);
+        ReturnErrorOnFailure(DecodeCommand(reader, aBatch.commands[aBatch.count]));
+        aBatch.count++;
+    }
+    VerifyOrReturnError(err == CHIP_END_OF_TLV, err);
+
+    return reader.ExitContainer(arrayType);
+}
+
+void RvcBinaryCommandChannel::DispatchBatch(const RvcBinaryCommandBatch & aBatch)
+{
+    VerifyOrReturn(aBatch.device != nullptr);
+
+    aBatch.device->BeginMessageBatch();
+    for (size_t i = 0; i < aBatch.count; i++)
+    {
+        const RvcBinaryCommand & command = aBatch.commands[i];
+        kDispatchTable[to_underlying(command.id)].handler(*aBatch.device, command);
+    }
+    aBatch.device->EndMessageBatch();
+}
+
+void RvcBinaryCommandChannel::HandleBatch(intptr_t context)
+{
+    auto * batch = reinterpret_cast<RvcBinaryCommandBatch *>(context);
+    DispatchBatch(*batch);
+    Platform::Delete(batch);
+}
+
+void RvcBinaryCommandChannel::HandleFrame(const uint8_t * payload, size_t length)
+{
+    auto * batch = Platform::New<RvcBinaryCommandBatch>();
+    VerifyOrReturn(batch != nullptr, ChipLogError(NotSpecified, "RVC App: No memory for a binary command batch"));
+
+    CHIP_ERROR err = DecodeBatch(payload, length, *batch);
+    if (err != CHIP_NO_ERROR)
+    {
+        ChipLogError(NotSpecified, "RVC App: Dropping a malformed binary command frame: %" CHIP_ERROR_FORMAT, err.Format());
+        Platform::Delete(batch);
+        return;
+    }
+
+    batch->device = mDevice;
+    if (DeviceLayer::PlatformMgr().ScheduleWork(HandleBatch, reinterpret_cast<intptr_t>(batch)) != CHIP_NO_ERROR)
+    {
+        Platform::Delete(batch);
+    }
+}
+
+void RvcBinaryCommandChannel::ServeClient(int fd)
+{
+    uint8_t buffer[kReadBufferSize];
+    size_t used = 0;
+
+    for (;;)
+    {
+        ssize_t readBytes = read(fd, buffer + used, sizeof(buffer) - used);
+        if (readBytes <= 0)
+        {
+            return; // client closed the connection, or error
+        }
+        used += static_cast<size_t>(readBytes);
+
+        // Handle every complete frame in the buffer.
+        size_t offset = 0;
+        while (used - offset >= kFrameHeaderSize)
+        {
+            uint32_t length = Encoding::LittleEndian::Get32(buffer + offset);
+            if (length > kMaxFrameSize)
+            {
+                ChipLogError(NotSpecified, "RVC App: Binary command frame of %u bytes is too large, closing the connection",
+                             static_cast<unsigned>(length));
+                return;
+            }
+            if (used - offset - kFrameHeaderSize < length)
+            {
+                break; // incomplete frame, wait for more data
+            }
+
+            HandleFrame(buffer + offset + kFrameHeaderSize, length);
+            offset += kFrameHeaderSize + length;
+        }
+
+        memmove(buffer, buffer + offset, used - offset);
+        used -= offset;
+    }
+}
+
+void * RvcBinaryCommandChannel::ListenerTask(void * arg)
+{
+    auto * self = reinterpret_cast<RvcBinaryCommandChannel *>(arg);
+
+    for (;;)
+    {
+        int fd = accept(self->mListenFd, nullptr, nullptr);
+        if (fd == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            ChipLogError(NotSpecified, "RVC App: Failed to accept a binary command client");
+            break;
+        }
+
+        // Close the connection even if the thread is cancelled while serving it.
+        pthread_cleanup_push(CloseClient, reinterpret_cast<void *>(static_cast<intptr_t>(fd)));
+        self->ServeClient(fd);
+        pthread_cleanup_pop(1);
+    }
+
+    return nullptr;
+}
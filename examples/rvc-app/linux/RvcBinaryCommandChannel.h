@@ -0,0 +1,113 @@
+/*
+ *
+ *    Copyright (c) 2025 Project CHIP Authors
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include "rvc-device.h"
+
+#include <lib/core/CHIPError.h>
+#include <pthread.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * Message IDs of the binary command channel. The state messages match the JSON messages of the same name.
+ */
+enum class RvcBinaryCommandId : uint8_t
+{
+    kCharged          = 0,
+    kCharging         = 1,
+    kDocked           = 2,
+    kEmptyingDustBin  = 3,
+    kCleaningMop      = 4,
+    kFillingWaterTank = 5,
+    kUpdatingMaps     = 6,
+    kChargerFound     = 7,
+    kLowCharge        = 8,
+    kActivityComplete = 9,
+    kAreaComplete     = 10,
+    kErrorEvent       = 11, // Text: the error name
+    kClearError       = 12,
+    kReset            = 13,
+    kProgressStatus   = 14, // AreaId, Value: an OperationalStatusEnum
+    kProgressEstimate = 15, // AreaId, Value: the estimated time in seconds, absent for null
+
+    kCount,
+};
+
+/**
+ * One decoded message. Plain data, so that a whole batch is a single allocation handed to the CHIP thread.
+ */
+struct RvcBinaryCommand
+{
+    static constexpr size_t kMaxTextSize = 32;
+
+    RvcBinaryCommandId id       = RvcBinaryCommandId::kCount;
+    uint32_t areaId             = 0;
+    uint32_t value              = 0;
+    bool hasValue               = false;
+    char text[kMaxTextSize + 1] = {};
+};
+
+struct RvcBinaryCommandBatch
+{
+    static constexpr size_t kMaxCommands = 64;
+
+    chip::app::Clusters::RvcDevice * device = nullptr;
+    size_t count                            = 0;
+    RvcBinaryCommand commands[kMaxCommands];
+};
+
+/**
+ * A framed binary alternative to the JSON app pipe, for a navigation process that sends many messages per second.
+ *
+ * The channel listens on a Unix domain stream socket and serves one client at a time. Each frame is a 32-bit little-endian
+ * payload length followed by a TLV payload: an anonymous array of structures, one per message, with the context tags
+ *   0: message ID (RvcBinaryCommandId), 1: area ID, 2: value, 3: text.
+ *
+ * Frames are decoded on the channel's thread. Each frame is dispatched as a batch, with a single ScheduleWork, and is handled
+ * on the CHIP thread as one Service Area transaction.
+ */
+class RvcBinaryCommandChannel
+{
+public:
+    static constexpr size_t kMaxFrameSize = 4096;
+
+    CHIP_ERROR Start(const std::string & path, chip::app::Clusters::RvcDevice * device);
+    CHIP_ERROR Stop();
+
+private:
+    bool mStarted = false;
+    int mListenFd = -1;
+    pthread_t mListener;
+    std::string mPath;
+    chip::app::Clusters::RvcDevice * mDevice = nullptr;
+
+    static void * ListenerTask(void * arg);
+    void ServeClient(int fd);
+    void HandleFrame(const uint8_t * payload, size_t length);
+
+    // Decodes the TLV payload of one frame.
+    static CHIP_ERROR DecodeBatch(const uint8_t * payload, size_t length, RvcBinaryCommandBatch & aBatch);
+
+    // Runs on the CHIP thread: handles every message of the batch, then frees it.
+    static void HandleBatch(intptr_t context);
+    static void DispatchBatch(const RvcBinaryCommandBatch & aBatch);
+};
@@ -0,0 +1,312 @@
+/*
+ * Per-op benchmark for the optimized int8 kernels
+ *
+ * Runs every distinct Conv2D and MaxPool2D shape of YOLOv8n (640x640 input)
+ * through the TFLM reference kernel and through RvcInt8Kernels on random
+ * data, checks that the outputs are bit-identical and prints the speedup of
+ * each op. With a model path, also runs the whole model with both kernel
+ * backends on the same input and compares the outputs.
+ *
+ * Usage:
+ *   ./bench-int8-kernels [iterations] [threads] [model.tflite]
+ */
+
+#include "../../rvc-common/include/RvcAIInterface.h"
+#include "../../rvc-common/include/RvcInt8Kernels.h"
+
+#include "tensorflow/lite/kernels/internal/reference/integer_ops/conv.h"
+#include "tensorflow/lite/kernels/internal/reference/integer_ops/pooling.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct ConvShape {
+    const char* name;
+    int size;       // Input height and width
+    int inChannels;
+    int outChannels;
+    int kernel;
+    int stride;
+};
+
+// One entry per distinct Conv2D shape, with how often it occurs in the model.
+struct ConvCase {
+    ConvShape shape;
+    int count;
+};
+
+const ConvCase kConvCases[] = {
+    { { "stem 3x3/2", 640, 3, 16, 3, 2 }, 1 },
+    { { "down 3x3/2", 320, 16, 32, 3, 2 }, 1 },
+    { { "c2f 1x1", 160, 32, 32, 1, 1 }, 1 },
+    { { "c2f 3x3", 160, 16, 16, 3, 1 }, 2 },
+    { { "c2f 1x1 out", 160, 48, 32, 1, 1 }, 1 },
+    { { "down 3x3/2", 160, 32, 64, 3, 2 }, 1 },
+    { { "c2f 1x1", 80, 64, 64, 1, 1 }, 1 },
+    { { "c2f 3x3", 80, 32, 32, 3, 1 }, 4 },
+    { { "c2f 1x1 out", 80, 128, 64, 1, 1 }, 1 },
+    { { "down 3x3/2", 80, 64, 128, 3, 2 }, 1 },
+    { { "c2f 3x3", 40, 64, 64, 3, 1 }, 4 },
+    { { "down 3x3/2", 40, 128, 256, 3, 2 }, 1 },
+    { { "c2f 3x3", 20, 128, 128, 3, 1 }, 2 },
+    { { "c2f 1x1", 20, 256, 256, 1, 1 }, 1 },
+    { { "head box 3x3", 80, 64, 64, 3, 1 }, 2 },
+    { { "head cls 3x3", 80, 64, 80, 3, 1 }, 1 },
+    { { "head cls 3x3", 80, 80, 80, 3, 1 }, 1 },
+    { { "head cls 1x1", 80, 80, 80, 1, 1 }, 1 },
+};
+
+template <typename Fn>
+double MeasureMicros(int iterations, Fn&& fn)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        fn();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::micro>(elapsed).count() / iterations;
+}
+
+void FillRandom(std::vector<int8_t>& data, std::mt19937& rng)
+{
+    std::uniform_int_distribution<int> dist(-128, 127);
+    for (int8_t& value : data) {
+        value = static_cast<int8_t>(dist(rng));
+    }
+}
+
+// Returns false if the outputs differ. Adds the measured times to the totals.
+bool BenchConv(const ConvShape& shape, int iterations, int threads, std::mt19937& rng, double& referenceUs, double& optimizedUs)
+{
+    const int pad = shape.kernel / 2;
+    const int out_size = (shape.size + 2 * pad - shape.kernel) / shape.stride + 1;
+
+    RvcConvInt8Params params;
+    params.inputHeight = params.inputWidth = shape.size;
+    params.inputChannels = shape.inChannels;
+    params.filterHeight = params.filterWidth = shape.kernel;
+    params.outputHeight = params.outputWidth = out_size;
+    params.outputChannels = shape.outChannels;
+    params.strideHeight = params.strideWidth = shape.stride;
+    params.padHeight = params.padWidth = pad;
+    params.inputZeroPoint = -3;
+    params.outputZeroPoint = 5;
+
+    std::vector<int8_t> input(static_cast<size_t>(shape.size) * shape.size * shape.inChannels);
+    std::vector<int8_t> filter(static_cast<size_t>(shape.outChannels) * shape.kernel * shape.kernel * shape.inChannels);
+    std::vector<int32_t> bias(shape.outChannels);
+    std::vector<int32_t> multiplier(shape.outChannels);
+    std::vector<int32_t> shift(shape.outChannels);
+    FillRandom(input, rng);
+    FillRandom(filter, rng);
+    std::uniform_int_distribution<int32_t> bias_dist(-20000, 20000);
+    std::uniform_int_distribution<int32_t> multiplier_dist(1 << 30, (1u << 31) - 1);
+    std::uniform_int_distribution<int32_t> shift_dist(-12, -8);
+    for (int o = 0; o < shape.outChannels; ++o) {
+        bias[o] = bias_dist(rng);
+        multiplier[o] = multiplier_dist(rng);
+        shift[o] = shift_dist(rng);
+    }
+    params.outputMultiplier = multiplier.data();
+    params.outputShift = shift.data();
+
+    tflite::ConvParams reference_params = {};
+    reference_params.padding_values.height = static_cast<int16_t>(pad);
+    reference_params.padding_values.width = static_cast<int16_t>(pad);
+    reference_params.stride_height = static_cast<int16_t>(shape.stride);
+    reference_params.stride_width = static_cast<int16_t>(shape.stride);
+    reference_params.dilation_height_factor = 1;
+    reference_params.dilation_width_factor = 1;
+    reference_params.input_offset = -params.inputZeroPoint;
+    reference_params.output_offset = params.outputZeroPoint;
+    reference_params.quantized_activation_min = params.activationMin;
+    reference_params.quantized_activation_max = params.activationMax;
+    const tflite::RuntimeShape input_shape({ 1, shape.size, shape.size, shape.inChannels });
+    const tflite::RuntimeShape filter_shape({ shape.outChannels, shape.kernel, shape.kernel, shape.inChannels });
+    const tflite::RuntimeShape bias_shape({ shape.outChannels });
+    const tflite::RuntimeShape output_shape({ 1, out_size, out_size, shape.outChannels });
+
+    std::vector<int8_t> expected(static_cast<size_t>(out_size) * out_size * shape.outChannels);
+    std::vector<int8_t> actual(expected.size());
+    std::vector<int8_t> scratch(RvcInt8Kernels::ConvScratchBytes(params, threads));
+
+    auto run_reference = [&] {
+        tflite::reference_integer_ops::ConvPerChannel(reference_params, multiplier.data(), shift.data(), input_shape, input.data(),
+                                                      filter_shape, filter.data(), bias_shape, bias.data(), output_shape,
+                                                      expected.data());
+    };
+    auto run_optimized = [&] {
+        RvcInt8Kernels::ConvInt8(params, input.data(), filter.data(), bias.data(), actual.data(), scratch.data(), threads);
+    };
+
+    run_reference();
+    run_optimized();
+    if (std::memcmp(expected.data(), actual.data(), expected.size()) != 0) {
+        std::cerr << "ERROR: " << shape.name << " output differs from the reference kernel" << std::endl;
+        return false;
+    }
+
+    referenceUs = MeasureMicros(iterations, run_reference);
+    optimizedUs = MeasureMicros(iterations, run_optimized);
+    return true;
+}
+
+bool BenchMaxPool(int iterations, std::mt19937& rng, double& referenceUs, double& optimizedUs)
+{
+    // SPPF: three 5x5 stride 1 max pools on the 20x20x128 feature map.
+    RvcPoolInt8Params params;
+    params.inputHeight = params.inputWidth = 20;
+    params.outputHeight = params.outputWidth = 20;
+    params.channels = 128;
+    params.filterHeight = params.filterWidth = 5;
+    params.padHeight = params.padWidth = 2;
+
+    std::vector<int8_t> input(20 * 20 * 128);
+    std::vector<int8_t> expected(input.size());
+    std::vector<int8_t> actual(input.size());
+    FillRandom(input, rng);
+
+    tflite::PoolParams reference_params = {};
+    reference_params.padding_values.height = 2;
+    reference_params.padding_values.width = 2;
+    reference_params.stride_height = 1;
+    reference_params.stride_width = 1;
+    reference_params.filter_height = 5;
+    reference_params.filter_width = 5;
+    reference_params.quantized_activation_min = params.activationMin;
+    reference_params.quantized_activation_max = params.activationMax;
+    const tflite::RuntimeShape shape({ 1, 20, 20, 128 });
+
+    auto run_reference = [&] { tflite::reference_integer_ops::MaxPool(reference_params, shape, input.data(), shape, expected.data()); };
+    auto run_optimized = [&] { RvcInt8Kernels::MaxPoolInt8(params, input.data(), actual.data()); };
+
+    run_reference();
+    run_optimized();
+    if (std::memcmp(expected.data(), actual.data(), expected.size()) != 0) {
+        std::cerr << "ERROR: MaxPool2D output differs from the reference kernel" << std::endl;
+        return false;
+    }
+
+    referenceUs = MeasureMicros(iterations, run_reference);
+    optimizedUs = MeasureMicros(iterations, run_optimized);
+    return true;
+}
+
+// Runs the whole model once per backend on the same random input and compares the outputs.
+bool BenchModel(const std::string& modelPath, std::mt19937& rng)
+{
+    std::vector<int8_t> input;
+    std::vector<int8_t> outputs[2];
+    double times_ms[2] = { 0.0, 0.0 };
+    const RvcKernelBackend backends[2] = { RvcKernelBackend::kReference, RvcKernelBackend::kOptimized };
+
+    for (int i = 0; i < 2; ++i) {
+        RvcAIInterface ai;
+        ai.SetKernelBackend(backends[i]);
+        if (!ai.InitAI(modelPath, RvcAIMode::kInferenceOnly)) {
+            std::cerr << "ERROR: Failed to load " << modelPath << std::endl;
+            return false;
+        }
+        if (input.empty()) {
+            input.resize(ai.GetInputTensorBytes());
+            FillRandom(input, rng);
+        }
+
+        auto lock = ai.LockInterpreter();
+        auto start = std::chrono::steady_clock::now();
+        if (!ai.RunForward(input.data())) {
+            return false;
+        }
+        times_ms[i] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        TfLiteTensor* output = ai.GetOutputTensor();
+        outputs[i].assign(output->data.int8, output->data.int8 + output->bytes);
+    }
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "\nWhole model (" << modelPath << "):" << std::endl;
+    std::cout << "  Reference kernels: " << times_ms[0] << " ms" << std::endl;
+    std::cout << "  Optimized kernels: " << times_ms[1] << " ms" << std::endl;
+    std::cout << "  Speedup:           " << std::setprecision(2) << times_ms[0] / times_ms[1] << "x" << std::endl;
+
+    if (outputs[0] != outputs[1]) {
+        std::cerr << "ERROR: Model outputs differ between the kernel backends" << std::endl;
+        return false;
+    }
+    std::cout << "  Outputs:           bit-identical" << std::endl;
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int iterations = (argc > 1) ? std::atoi(argv[1]) : 3;
+    int threads = (argc > 2) ? std::atoi(argv[2]) : RvcInt8Kernels::ThreadCount();
+    if (iterations <= 0 || threads <= 0) {
+        std::cerr << "Usage: " << argv[0] << " [iterations] [threads] [model.tflite]" << std::endl;
+        return -1;
+    }
+    RvcInt8Kernels::SetThreadCount(threads);
+    threads = RvcInt8Kernels::ThreadCount();
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "   INT8 Kernel Benchmark" << std::endl;
+    std::cout << "========================================\n" << std::endl;
+    std::cout << "SIMD: " << RvcInt8Kernels::SimdName() << ", threads: " << threads << "\n" << std::endl;
+
+    std::mt19937 rng(1234);
+    double reference_total_us = 0.0;
+    double optimized_total_us = 0.0;
+
+    std::cout << std::left << std::setw(16) << "Op" << std::right << std::setw(9) << "Input" << std::setw(11) << "Channels"
+              << std::setw(6) << "x" << std::setw(14) << "Reference us" << std::setw(14) << "Optimized us" << std::setw(10)
+              << "Speedup" << std::endl;
+
+    for (const ConvCase& conv : kConvCases) {
+        double reference_us = 0.0;
+        double optimized_us = 0.0;
+        if (!BenchConv(conv.shape, iterations, threads, rng, reference_us, optimized_us)) {
+            return -1;
+        }
+        reference_total_us += reference_us * conv.count;
+        optimized_total_us += optimized_us * conv.count;
+
+        std::string channels = std::to_string(conv.shape.inChannels) + "->" + std::to_string(conv.shape.outChannels);
+        std::cout << std::fixed << std::setprecision(0) << std::left << std::setw(16) << conv.shape.name << std::right
+                  << std::setw(9) << conv.shape.size << std::setw(11) << channels << std::setw(6) << conv.count << std::setw(14)
+                  << reference_us << std::setw(14) << optimized_us << std::setw(9) << std::setprecision(2)
+                  << reference_us / optimized_us << "x" << std::endl;
+    }
+
+    double reference_us = 0.0;
+    double optimized_us = 0.0;
+    if (!BenchMaxPool(iterations, rng, reference_us, optimized_us)) {
+        return -1;
+    }
+    reference_total_us += reference_us * 3;
+    optimized_total_us += optimized_us * 3;
+    std::cout << std::fixed << std::setprecision(0) << std::left << std::setw(16) << "sppf maxpool 5x5" << std::right
+              << std::setw(9) << 20 << std::setw(11) << "128" << std::setw(6) << 3 << std::setw(14) << reference_us
+              << std::setw(14) << optimized_us << std::setw(9) << std::setprecision(2) << reference_us / optimized_us << "x"
+              << std::endl;
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "\nAll outputs bit-identical to the reference kernels." << std::endl;
+    std::cout << "Listed ops, reference: " << reference_total_us / 1000.0 << " ms" << std::endl;
+    std::cout << "Listed ops, optimized: " << optimized_total_us / 1000.0 << " ms" << std::endl;
+    std::cout << "Speedup:               " << std::setprecision(2) << reference_total_us / optimized_total_us << "x" << std::endl;
+
+    if (argc > 3 && !BenchModel(argv[3], rng)) {
+        return -1;
+    }
+    return 0;
+}
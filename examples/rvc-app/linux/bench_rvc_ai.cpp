@@ -0,0 +1,640 @@
+/*
+ * Benchmark harness for the RVC AI pipeline
+ *
+ * Runs a fixed set of scenarios against one interpreter and reports latency
+ * percentiles, peak RSS and arena usage, as a table and optionally as JSON
+ * for release gating. The RSS high-water mark is reset before each scenario
+ * (/proc/self/clear_refs), so each one reports its own peak and how far it
+ * grew over the RSS it started with:
+ *
+ *   cold_init          RvcAIInterface construction + InitAI(), torn down each time
+ *   warm_inference     RunForward() + DecodeOutput() on the preprocessed test image
+ *   preprocess         RvcPreprocessor only, test image into the model input
+ *   postprocess        RvcDetectionDecoder only, on the last real model output
+ *   weights_roundtrip  Trainer int8 weight export and import, checked bit-exact
+ *   fit_round          RvcFlowerClient::fit() on a temporary replay store, with
+ *                      this program standing in for the Flower server
+ *                      (only with rvc_federated_learning)
+ *
+ * Exits non-zero if a scenario fails its correctness check.
+ *
+ * Usage:
+ *   ./bench-rvc-ai [--iterations N] [--scenario name]... [--model model.tflite]
+ *                  [--image image.jpg] [--backend reference|optimized] [--json out.json]
+ */
+
+#include "../../rvc-common/include/RvcAIInterface.h"
+#include "../../rvc-common/include/RvcAITrainer.h"
+#include "../../rvc-common/include/RvcDetectionDecoder.h"
+#include "../../rvc-common/include/RvcInt8Kernels.h"
+#include "../../rvc-common/include/RvcPreprocessor.h"
+#if defined(RVC_FEDERATED_LEARNING) && RVC_FEDERATED_LEARNING
+#include "../../rvc-common/include/RvcFlowerClient.h"
+#include "../../rvc-common/include/RvcReplayStore.h"
+#endif
+
+#include "stb/stb_image.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr const char* kDefaultImagePath = "examples/rvc-app/linux/test_data/000000000009.jpg";
+constexpr int kDefaultIterations = 50;
+constexpr int kMaxColdInits = 5;   // Each one maps and plans an 80 MB probe arena
+constexpr int kMaxFitRounds = 3;
+constexpr size_t kFitSamples = 16;
+constexpr float kScoreThreshold = 0.5f;
+constexpr float kIouThreshold = 0.45f;
+
+struct Options {
+    int iterations = kDefaultIterations;
+    std::vector<std::string> scenarios; // Empty: all
+    std::string modelPath;              // Empty: the compiled-in model
+    std::string imagePath = kDefaultImagePath;
+    std::string jsonPath;
+    RvcKernelBackend backend = RvcKernelBackend::kOptimized;
+};
+
+struct ScenarioResult {
+    std::string name;
+    bool skipped = false;
+    std::string note;
+    std::vector<double> samplesUs;
+    long peakRssKb = -1;   // High-water mark while the scenario ran; -1 if it could not be reset
+    long rssGrowthKb = -1; // peakRssKb minus the RSS the scenario started with
+    size_t arenaBytes = 0;
+    size_t arenaUsedBytes = 0;
+};
+
+// State shared by the scenarios. The warm interface is created once, after cold_init.
+struct BenchContext {
+    Options options;
+    std::unique_ptr<RvcAIInterface> ai;
+    std::unique_ptr<RvcAITrainer> trainer;
+    RvcCameraFrame frame;      // Decoded test image
+    std::vector<int8_t> input; // Test image as a model input
+};
+
+using Clock = std::chrono::steady_clock;
+
+double MicrosSince(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+long PeakRssKb()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss; // Kilobytes on Linux, over the whole process lifetime
+}
+
+// Reads a "Field:   1234 kB" line from /proc/self/status; -1 if it is missing.
+long ProcStatusKb(const char* field)
+{
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    size_t length = std::strlen(field);
+    while (std::getline(status, line)) {
+        if (line.compare(0, length, field) == 0 && line.size() > length && line[length] == ':') {
+            return std::strtol(line.c_str() + length + 1, nullptr, 10);
+        }
+    }
+    return -1;
+}
+
+// Resets VmHWM to the current RSS, so it covers only what runs from here on.
+bool ResetPeakRss()
+{
+    std::ofstream clear_refs("/proc/self/clear_refs");
+    clear_refs << "5";
+    clear_refs.flush();
+    return static_cast<bool>(clear_refs);
+}
+
+// Nearest-rank percentile of sorted samples.
+double Percentile(const std::vector<double>& sorted, double fraction)
+{
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    size_t rank = static_cast<size_t>(fraction * sorted.size() + 0.999999);
+    return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+}
+
+bool InitInterface(const Options& options, RvcAIInterface& ai)
+{
+    ai.SetKernelBackend(options.backend);
+    return options.modelPath.empty() ? ai.InitAI() : ai.InitAI(options.modelPath);
+}
+
+bool LoadImage(const std::string& path, RvcCameraFrame& frame)
+{
+    int channels = 0;
+    unsigned char* pixels = stbi_load(path.c_str(), &frame.width, &frame.height, &channels, 3);
+    if (pixels == nullptr) {
+        std::cerr << "ERROR: Failed to load image " << path << " (run from the repository root or pass --image)"
+                  << std::endl;
+        return false;
+    }
+    frame.format = RvcCameraFrame::PixelFormat::kRgb888;
+    frame.pixels.assign(pixels, pixels + static_cast<size_t>(frame.width) * frame.height * 3);
+    stbi_image_free(pixels);
+    return true;
+}
+
+bool ConfigurePreprocessor(BenchContext& ctx, RvcPreprocessor& preprocessor)
+{
+    TfLiteTensor* input = ctx.ai->GetInterpreter()->input(0);
+    RvcPreprocessor::Config config;
+    config.srcWidth = ctx.frame.width;
+    config.srcHeight = ctx.frame.height;
+    config.srcFormat = ctx.frame.format;
+    config.dstHeight = input->dims->data[1];
+    config.dstWidth = input->dims->data[2];
+    config.inputScale = input->params.scale;
+    config.inputZeroPoint = input->params.zero_point;
+    return input->dims->data[3] == 3 && preprocessor.Configure(config);
+}
+
+// ============================================================================
+// Scenarios
+// ============================================================================
+
+bool RunColdInit(BenchContext& ctx, int repetitions, ScenarioResult& result)
+{
+    for (int i = 0; i < repetitions; ++i) {
+        auto start = Clock::now();
+        std::unique_ptr<RvcAIInterface> ai(new RvcAIInterface());
+        if (!InitInterface(ctx.options, *ai)) {
+            std::cerr << "ERROR: InitAI() failed" << std::endl;
+            return false;
+        }
+        result.samplesUs.push_back(MicrosSince(start));
+        result.arenaBytes = ai->GetArenaSize();
+        result.arenaUsedBytes = ai->GetArenaUsedBytes();
+    }
+    return true;
+}
+
+bool RunWarmInference(BenchContext& ctx, int repetitions, ScenarioResult& result)
+{
+    RvcDetectionResult detections;
+    for (int i = -1; i < repetitions; ++i) { // The first run only warms up caches
+        auto start = Clock::now();
+        auto lock = ctx.ai->LockInterpreter();
+        if (!ctx.ai->RunForward(ctx.input.data())) {
+            return false;
+        }
+        ctx.ai->DecodeOutput(detections);
+        if (i >= 0) {
+            result.samplesUs.push_back(MicrosSince(start));
+        }
+    }
+    std::ostringstream note;
+    note << detections.detectionCount << " detections";
+    result.note = note.str();
+    return true;
+}
+
+bool RunPreprocess(BenchContext& ctx, int repetitions, ScenarioResult& result)
+{
+    RvcPreprocessor preprocessor;
+    if (!ConfigurePreprocessor(ctx, preprocessor)) {
+        std::cerr << "ERROR: Cannot preprocess the test image for this model" << std::endl;
+        return false;
+    }
+    std::vector<int8_t> output(ctx.input.size());
+    for (int i = 0; i < repetitions; ++i) {
+        auto start = Clock::now();
+        preprocessor.Run(ctx.frame.pixels.data(), output.data());
+        result.samplesUs.push_back(MicrosSince(start));
+    }
+    if (output != ctx.input) {
+        std::cerr << "ERROR: Preprocessing is not deterministic" << std::endl;
+        return false;
+    }
+    std::ostringstream note;
+    note << ctx.frame.width << "x" << ctx.frame.height << " RGB";
+    result.note = note.str();
+    return true;
+}
+
+bool RunPostprocess(BenchContext& ctx, int repetitions, ScenarioResult& result)
+{
+    // The output of the last warm inference is still in the output tensor.
+    TfLiteTensor* output = ctx.ai->GetOutputTensor();
+    RvcDetectionDecoder decoder;
+    RvcDetectionDecoder::Config config;
+    config.scoreThreshold = kScoreThreshold;
+    config.iouThreshold = kIouThreshold;
+    config.outputScale = output->params.scale;
+    config.outputZeroPoint = output->params.zero_point;
+    config.numAnchors = output->dims->data[1];
+    config.numClasses = output->dims->data[2] - 4;
+    if (!decoder.Configure(config)) {
+        return false;
+    }
+
+    RvcDetectionResult detections;
+    for (int i = 0; i < repetitions; ++i) {
+        auto start = Clock::now();
+        decoder.Decode(output->data.int8, ctx.frame.width, ctx.frame.height, detections);
+        result.samplesUs.push_back(MicrosSince(start));
+    }
+    std::ostringstream note;
+    note << decoder.LastCandidateCount() << " candidates, " << detections.detectionCount << " detections";
+    result.note = note.str();
+    return true;
+}
+
+bool RunWeightsRoundTrip(BenchContext& ctx, int repetitions, ScenarioResult& result)
+{
+    size_t count = ctx.trainer->GetLastLayerWeightsCount();
+    if (count == 0) {
+        std::cerr << "ERROR: The model has no trainable layers" << std::endl;
+        return false;
+    }
+    std::vector<int8_t> original(count);
+    std::vector<int8_t> weights(count);
+    size_t size = 0;
+    if (!ctx.trainer->GetLastLayerWeightsInt8(original.data(), &size)) {
+        return false;
+    }
+
+    for (int i = 0; i < repetitions; ++i) {
+        auto start = Clock::now();
+        if (!ctx.trainer->GetLastLayerWeightsInt8(weights.data(), &size) ||
+            !ctx.trainer->SetLastLayerWeightsInt8(weights.data(), count)) {
+            std::cerr << "ERROR: Weight round-trip failed" << std::endl;
+            return false;
+        }
+        result.samplesUs.push_back(MicrosSince(start));
+    }
+
+    if (!ctx.trainer->GetLastLayerWeightsInt8(weights.data(), &size) || weights != original) {
+        std::cerr << "ERROR: Weights changed across the round-trip" << std::endl;
+        return false;
+    }
+    std::ostringstream note;
+    note << count << " weights in " << ctx.trainer->GetTrainableLayerCount() << " layers";
+    result.note = note.str();
+    return true;
+}
+
+#if defined(RVC_FEDERATED_LEARNING) && RVC_FEDERATED_LEARNING
+// Labels for the fit samples: the model's own detections on the test image, or one
+// centred box if there are none, so the training steps always have something to fit.
+size_t MakeFitLabels(BenchContext& ctx, RvcTrainingBox* boxes)
+{
+    RvcDetectionResult detections;
+    {
+        auto lock = ctx.ai->LockInterpreter();
+        if (ctx.ai->RunForward(ctx.input.data())) {
+            ctx.ai->DecodeOutput(detections);
+        }
+    }
+    size_t count = std::min(detections.detectionCount, RvcReplayStore::kMaxBoxes);
+    for (size_t i = 0; i < count; ++i) {
+        const RvcDetection& det = detections.detections[i];
+        boxes[i] = { (det.x1 + det.x2) * 0.5f, (det.y1 + det.y2) * 0.5f, det.x2 - det.x1, det.y2 - det.y1, det.class_id };
+    }
+    if (count == 0) {
+        boxes[0] = { 0.5f, 0.5f, 0.25f, 0.25f, 0 };
+        count = 1;
+    }
+    return count;
+}
+
+bool RunFitRound(BenchContext& ctx, int repetitions, ScenarioResult& result)
+{
+    std::string store_path = "/tmp/bench-rvc-ai-replay-" + std::to_string(getpid()) + ".bin";
+    size_t input_bytes = ctx.ai->GetInputTensorBytes();
+    size_t budget = kFitSamples * (input_bytes + 4096); // Slot headers and boxes fit in the margin
+
+    RvcReplayStore store;
+    if (!store.Open(store_path, input_bytes, budget)) {
+        std::cerr << "ERROR: Failed to create " << store_path << std::endl;
+        return false;
+    }
+    RvcTrainingBox boxes[RvcReplayStore::kMaxBoxes];
+    size_t num_boxes = MakeFitLabels(ctx, boxes);
+    for (size_t i = 0; i < kFitSamples; ++i) {
+        store.Add(ctx.input.data(), ctx.input.size(), boxes, num_boxes, false);
+    }
+
+    RvcFlowerClient client(ctx.ai.get(), ctx.trainer.get(), 0);
+    client.SetReplayStore(&store);
+
+    // The server side of a round: send the global weights, take the client's result as
+    // the next global weights (FedAvg over a single client).
+    std::map<std::string, flwr_local::Scalar> config;
+    config["lr"].setDouble(0.01);
+    config["local_epochs"].setInt(1);
+    config["batch_size"].setInt(8);
+    flwr_local::Parameters global = client.get_parameters().getParameters();
+    size_t weight_count = ctx.trainer->GetLastLayerWeightsCount();
+
+    bool ok = true;
+    int examples = 0;
+    for (int i = 0; i < repetitions && ok; ++i) {
+        auto start = Clock::now();
+        flwr_local::FitRes fit = client.fit(flwr_local::FitIns(global, config));
+        result.samplesUs.push_back(MicrosSince(start));
+
+        const std::list<std::string>& tensors = fit.getParameters().getTensors();
+        examples = fit.getNum_example();
+        ok = !tensors.empty() && tensors.front().size() == weight_count && examples > 0;
+        global = fit.getParameters();
+    }
+
+    store.Close();
+    unlink(store_path.c_str());
+    if (!ok) {
+        std::cerr << "ERROR: fit() did not return a trained dense update" << std::endl;
+        return false;
+    }
+    std::ostringstream note;
+    note << examples << " training samples per round";
+    result.note = note.str();
+    return true;
+}
+#endif
+
+struct Scenario {
+    const char* name;
+    int maxRepetitions;
+    bool (*run)(BenchContext& ctx, int repetitions, ScenarioResult& result);
+};
+
+const Scenario kScenarios[] = {
+    { "cold_init", kMaxColdInits, RunColdInit },
+    { "warm_inference", INT_MAX, RunWarmInference },
+    { "preprocess", INT_MAX, RunPreprocess },
+    { "postprocess", INT_MAX, RunPostprocess },
+    { "weights_roundtrip", INT_MAX, RunWeightsRoundTrip },
+#if defined(RVC_FEDERATED_LEARNING) && RVC_FEDERATED_LEARNING
+    { "fit_round", kMaxFitRounds, RunFitRound },
+#else
+    { "fit_round", kMaxFitRounds, nullptr },
+#endif
+};
+
+// ============================================================================
+// Reporting
+// ============================================================================
+
+void PrintTable(const std::vector<ScenarioResult>& results)
+{
+    std::cout << "\n" << std::left << std::setw(20) << "Scenario" << std::right << std::setw(6) << "n" << std::setw(12)
+              << "p50 us" << std::setw(12) << "p90 us" << std::setw(12) << "p99 us" << std::setw(12) << "max us"
+              << std::setw(12) << "RSS MB" << std::setw(12) << "+RSS MB" << "  Notes" << std::endl;
+    std::cout << std::fixed << std::setprecision(0);
+    for (const ScenarioResult& r : results) {
+        std::cout << std::left << std::setw(20) << r.name << std::right;
+        if (r.skipped) {
+            std::cout << std::setw(90) << "skipped" << "  " << r.note << std::endl;
+            continue;
+        }
+        std::vector<double> sorted(r.samplesUs);
+        std::sort(sorted.begin(), sorted.end());
+        std::cout << std::setw(6) << sorted.size() << std::setw(12) << Percentile(sorted, 0.50) << std::setw(12)
+                  << Percentile(sorted, 0.90) << std::setw(12) << Percentile(sorted, 0.99) << std::setw(12) << sorted.back()
+                  << std::setw(12);
+        if (r.peakRssKb < 0) {
+            std::cout << "-" << std::setw(12) << "-";
+        }
+        else {
+            std::cout << r.peakRssKb / 1024 << std::setw(12) << r.rssGrowthKb / 1024;
+        }
+        std::cout << "  " << r.note << std::endl;
+    }
+}
+
+std::string JsonString(const std::string& value)
+{
+    std::string out = "\"";
+    for (char c : value) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+        }
+        out += c;
+    }
+    return out + "\"";
+}
+
+bool WriteJson(const std::string& path, const BenchContext& ctx, const std::vector<ScenarioResult>& results)
+{
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "ERROR: Cannot write " << path << std::endl;
+        return false;
+    }
+
+    out << std::fixed << std::setprecision(1);
+    out << "{\n";
+    out << "  \"benchmark\": \"rvc-ai\",\n";
+    out << "  \"timestamp\": " << static_cast<long long>(std::time(nullptr)) << ",\n";
+    out << "  \"model\": " << JsonString(ctx.options.modelPath.empty() ? "embedded" : ctx.options.modelPath) << ",\n";
+    out << "  \"kernel_backend\": \""
+        << (ctx.options.backend == RvcKernelBackend::kOptimized ? "optimized" : "reference") << "\",\n";
+    out << "  \"simd\": " << JsonString(RvcInt8Kernels::SimdName()) << ",\n";
+    out << "  \"kernel_threads\": " << RvcInt8Kernels::ThreadCount() << ",\n";
+    out << "  \"arena_bytes\": " << (ctx.ai ? ctx.ai->GetArenaSize() : 0) << ",\n";
+    out << "  \"arena_used_bytes\": " << (ctx.ai ? ctx.ai->GetArenaUsedBytes() : 0) << ",\n";
+    out << "  \"peak_rss_kb\": " << PeakRssKb() << ",\n";
+    out << "  \"scenarios\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const ScenarioResult& r = results[i];
+        out << (i ? "," : "") << "\n    {\n      \"name\": " << JsonString(r.name) << ",\n";
+        if (r.skipped) {
+            out << "      \"skipped\": true,\n      \"note\": " << JsonString(r.note) << "\n    }";
+            continue;
+        }
+        std::vector<double> sorted(r.samplesUs);
+        std::sort(sorted.begin(), sorted.end());
+        double total = 0.0;
+        for (double us : sorted) {
+            total += us;
+        }
+        out << "      \"iterations\": " << sorted.size() << ",\n";
+        out << "      \"mean_us\": " << total / sorted.size() << ",\n";
+        out << "      \"min_us\": " << sorted.front() << ",\n";
+        out << "      \"p50_us\": " << Percentile(sorted, 0.50) << ",\n";
+        out << "      \"p90_us\": " << Percentile(sorted, 0.90) << ",\n";
+        out << "      \"p99_us\": " << Percentile(sorted, 0.99) << ",\n";
+        out << "      \"max_us\": " << sorted.back() << ",\n";
+        if (r.peakRssKb >= 0) {
+            out << "      \"peak_rss_kb\": " << r.peakRssKb << ",\n";
+            out << "      \"rss_growth_kb\": " << r.rssGrowthKb << ",\n";
+        }
+        if (r.arenaBytes) {
+            out << "      \"arena_bytes\": " << r.arenaBytes << ",\n";
+            out << "      \"arena_used_bytes\": " << r.arenaUsedBytes << ",\n";
+        }
+        out << "      \"note\": " << JsonString(r.note) << "\n    }";
+    }
+    out << "\n  ]\n}\n";
+    return static_cast<bool>(out);
+}
+
+bool ParseOptions(int argc, char* argv[], Options& options)
+{
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--iterations") {
+            options.iterations = std::atoi(value.c_str());
+        }
+        else if (arg == "--scenario") {
+            options.scenarios.push_back(value);
+        }
+        else if (arg == "--model") {
+            options.modelPath = value;
+        }
+        else if (arg == "--image") {
+            options.imagePath = value;
+        }
+        else if (arg == "--json") {
+            options.jsonPath = value;
+        }
+        else if (arg == "--backend" && (value == "reference" || value == "optimized")) {
+            options.backend = value == "reference" ? RvcKernelBackend::kReference : RvcKernelBackend::kOptimized;
+        }
+        else {
+            return false;
+        }
+    }
+    for (const std::string& name : options.scenarios) {
+        auto known = [&](const Scenario& s) { return name == s.name; };
+        if (std::none_of(std::begin(kScenarios), std::end(kScenarios), known)) {
+            std::cerr << "Unknown scenario: " << name << std::endl;
+            return false;
+        }
+    }
+    return options.iterations > 0;
+}
+
+bool Selected(const Options& options, const char* name)
+{
+    return options.scenarios.empty() ||
+        std::find(options.scenarios.begin(), options.scenarios.end(), name) != options.scenarios.end();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    BenchContext ctx;
+    if (!ParseOptions(argc, argv, ctx.options)) {
+        std::cerr << "Usage: " << argv[0] << " [--iterations N] [--scenario name]... [--model model.tflite]"
+                  << " [--image image.jpg] [--backend reference|optimized] [--json out.json]" << std::endl;
+        std::cerr << "Scenarios:";
+        for (const Scenario& scenario : kScenarios) {
+            std::cerr << " " << scenario.name;
+        }
+        std::cerr << std::endl;
+        return -1;
+    }
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "   RVC AI Benchmark" << std::endl;
+    std::cout << "========================================\n" << std::endl;
+
+    if (!LoadImage(ctx.options.imagePath, ctx.frame)) {
+        return -1;
+    }
+
+    std::vector<ScenarioResult> results;
+    bool ok = true;
+    for (const Scenario& scenario : kScenarios) {
+        if (!Selected(ctx.options, scenario.name)) {
+            continue;
+        }
+        ScenarioResult result;
+        result.name = scenario.name;
+        if (scenario.run == nullptr) {
+            result.skipped = true;
+            result.note = "built without rvc_federated_learning";
+            results.push_back(result);
+            continue;
+        }
+
+        // Everything after cold_init shares one warm interface and trainer.
+        if (!ctx.ai && std::strcmp(scenario.name, "cold_init") != 0) {
+            ctx.ai.reset(new RvcAIInterface());
+            ctx.trainer.reset(new RvcAITrainer());
+            RvcPreprocessor preprocessor;
+            if (!InitInterface(ctx.options, *ctx.ai) || !ctx.trainer->AttachInferenceEngine(ctx.ai.get()) ||
+                !ConfigurePreprocessor(ctx, preprocessor)) {
+                std::cerr << "ERROR: Failed to set up the warm interpreter" << std::endl;
+                return -1;
+            }
+            ctx.input.resize(ctx.ai->GetInputTensorBytes());
+            preprocessor.Run(ctx.frame.pixels.data(), ctx.input.data());
+            // Leaves a real output in the output tensor for postprocess.
+            auto lock = ctx.ai->LockInterpreter();
+            if (!ctx.ai->RunForward(ctx.input.data())) {
+                return -1;
+            }
+        }
+
+        std::cout << "Running " << scenario.name << "..." << std::endl;
+        int repetitions = std::min(ctx.options.iterations, scenario.maxRepetitions);
+        // getrusage() only has the process-lifetime peak, which cold_init's
+        // probe arena would dominate for every scenario after it.
+        bool peak_reset = ResetPeakRss();
+        long start_rss_kb = ProcStatusKb("VmRSS");
+        if (!scenario.run(ctx, repetitions, result)) {
+            std::cerr << "FAILED: " << scenario.name << std::endl;
+            ok = false;
+            continue;
+        }
+        long peak_rss_kb = ProcStatusKb("VmHWM");
+        if (peak_reset && start_rss_kb >= 0 && peak_rss_kb >= 0) {
+            result.peakRssKb = peak_rss_kb;
+            result.rssGrowthKb = std::max(0L, peak_rss_kb - start_rss_kb);
+        }
+        if (!result.arenaBytes && ctx.ai) {
+            result.arenaBytes = ctx.ai->GetArenaSize();
+            result.arenaUsedBytes = ctx.ai->GetArenaUsedBytes();
+        }
+        results.push_back(result);
+    }
+
+    PrintTable(results);
+    if (ctx.ai) {
+        std::cout << std::endl;
+        ctx.ai->LogArenaReport();
+    }
+    std::cout << "Peak RSS: " << PeakRssKb() / 1024 << " MB (whole run)" << std::endl;
+
+    if (!ctx.options.jsonPath.empty()) {
+        if (!WriteJson(ctx.options.jsonPath, ctx, results)) {
+            return -1;
+        }
+        std::cout << "Results written to " << ctx.options.jsonPath << std::endl;
+    }
+    return ok ? 0 : -1;
+}
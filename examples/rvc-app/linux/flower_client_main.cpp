@@ -5,10 +5,10 @@
  * and participates in federated learning for YOLO object detection.
  *
  * Usage:
- *   ./flower-rvc-client <node_id> <server_address>
+ *   ./flower-rvc-client <node_id> <server_address> [replay_store]
  *
  * Example:
- *   ./flower-rvc-client 0 127.0.0.1:9092
+ *   ./flower-rvc-client 0 127.0.0.1:9092 /tmp/chip_rvc_replay.bin
  */
 
 #include "../../rvc-common/include/RvcAIInterface.h"
@@ -19,14 +19,17 @@
 #include <iostream>
 #include <string>
 
+// Must match the budget the store was created with, or it is reset.
+static constexpr size_t kReplayStoreBudget = 256 * 1024 * 1024;
+
 int main(int argc, char* argv[]) {
     std::cout << "\n========================================" << std::endl;
     std::cout << "   Flower C++ Client for RVC" << std::endl;
     std::cout << "========================================\n" << std::endl;
 
     // Parse command line arguments
-    if (argc != 3) {
-        std::cerr << "Usage: " << argv[0] << " <node_id> <server_address>" << std::endl;
+    if (argc != 3 && argc != 4) {
+        std::cerr << "Usage: " << argv[0] << " <node_id> <server_address> [replay_store]" << std::endl;
         std::cerr << "Example: " << argv[0] << " 0 127.0.0.1:9092" << std::endl;
         return -1;
     }
@@ -60,6 +63,16 @@ int main(int argc, char* argv[]) {
     std::cout << "[3/3] Starting Flower Client..." << std::endl;
     RvcFlowerClient flowerClient(&aiInterface, &aiTrainer, node_id);
 
+    // Samples captured by chip-rvc-app; without a store the client trains on nothing.
+    RvcReplayStore replayStore;
+    if (argc == 4) {
+        if (!replayStore.Open(argv[3], aiInterface.GetInputTensorBytes(), kReplayStoreBudget)) {
+            std::cerr << "ERROR: Failed to open replay store " << argv[3] << std::endl;
+            return -1;
+        }
+        flowerClient.SetReplayStore(&replayStore);
+    }
+
     std::cout << "✓ Flower Client created." << std::endl;
     std::cout << "Connecting to server at " << server_address << "..." << std::endl;
     std::cout << std::endl;
@@ -6,6 +6,7 @@
  */
 
 #include "../../rvc-common/include/RvcAIInterface.h"
+#include "../../rvc-common/include/RvcLayerDiscovery.h"
 #include <tensorflow/lite/micro/micro_interpreter.h>
 
 #include <iostream>
@@ -19,7 +20,8 @@ int main(int argc, char* argv[]) {
     // Initialize AI Interface
     std::cout << "Initializing AI Interface..." << std::endl;
     RvcAIInterface aiInterface;
-    if (!aiInterface.InitAI()) {
+    // GetTensor() on arbitrary indices needs every tensor to be preserved
+    if (!aiInterface.InitAI(RvcAIMode::kPreserveAllTensors)) {
         std::cerr << "ERROR: Failed to initialize AI Interface!" << std::endl;
         return -1;
     }
@@ -85,10 +87,13 @@ int main(int argc, char* argv[]) {
     std::cout << "Total tensors found: " << tensor_count << std::endl;
     std::cout << "========================================\n" << std::endl;
 
-    std::cout << "Next steps:" << std::endl;
-    std::cout << "1. Identify weight tensor indices from the output above" << std::endl;
-    std::cout << "2. Use GetTensor(index) to access weight tensors" << std::endl;
-    std::cout << "3. Modify weight values for training" << std::endl;
+    // The trainer resolves its layers the same way, so this is what it will train.
+    std::vector<RvcTrainableLayer> layers;
+    RvcLayerQuery query;
+    query.selector = RvcLayerSelector::kDetectionHeads;
+    if (!RvcLayerDiscovery::Discover(aiInterface.GetModel(), aiInterface.GetModelHash(), query, layers)) {
+        std::cerr << "WARNING: No detection head found in this model." << std::endl;
+    }
 
     return 0;
 }
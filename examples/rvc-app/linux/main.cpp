@@ -16,51 +16,177 @@
  *    limitations under the License.
  */
 #include "RvcAppCommandDelegate.h"
+#include "RvcBinaryCommandChannel.h"
 #include "rvc-device.h"
 #include <AppMain.h>
 #include <iostream>
 #include "../../rvc-common/include/RvcAIInterface.h"
+#include "../../rvc-common/include/RvcAIProfiler.h"
 #include "../../rvc-common/include/RvcAITrainer.h"
+#include "../../rvc-common/include/RvcCameraSource.h"
+#include <platform/PlatformManager.h>
+
+#if RVC_FEDERATED_LEARNING
+#include "../../rvc-common/include/RvcFLScheduler.h"
+#include "../../rvc-common/include/RvcFlowerClient.h"
+#endif
 
 #include <string>
 
 #define RVC_ENDPOINT 1
+#define RVC_CAMERA_FPS 10
+#define RVC_CAMERA_TEST_IMAGE "examples/rvc-app/linux/test_data/000000000009.jpg"
+#define RVC_MODEL_PATH "examples/rvc-app/linux/test_data/yolov8n_full_integer_quant.tflite"
+#define RVC_FL_NODE_ID 0
+#define RVC_FL_SERVER_ADDRESS "127.0.0.1:9092"
+#define RVC_REPLAY_STORE_PATH "/tmp/chip_rvc_replay.bin"
+#define RVC_REPLAY_STORE_BUDGET (256 * 1024 * 1024)
+#define RVC_REPLAY_CAPTURE_INTERVAL 50
+#define RVC_COMMAND_SOCKET_PATH "/tmp/chip_rvc_app.sock"
+// Optional floor-type classifier, run every RVC_FLOOR_MODEL_PERIOD frames while cleaning.
+#define RVC_FLOOR_MODEL_PATH "examples/rvc-app/linux/test_data/floor_type_int8.tflite"
+#define RVC_FLOOR_MODEL_PERIOD 10
 
 using namespace chip;
 using namespace chip::app;
 using namespace chip::app::Clusters;
 
+RvcDevice * gRvcDevice = nullptr;
+RvcAIInterface * gAiInterface = nullptr;
+RvcAITrainer * gAiTrainer = nullptr;
+
 namespace {
 NamedPipeCommands sChipNamedPipeCommands;
 RvcAppCommandDelegate sRvcAppCommandDelegate;
-} // namespace
+RvcBinaryCommandChannel sBinaryCommandChannel;
+RvcCameraSource sCameraSource;
+RvcAIProfiler sAIProfiler;
 
-RvcDevice * gRvcDevice = nullptr;
-RvcAIInterface * gAiInterface = nullptr;
-RvcAITrainer * gAiTrainer = nullptr;
+// Runs on the CHIP thread; owns and frees the result handed over by the inference worker.
+void HandleDetectionResult(intptr_t context)
+{
+    auto * result = reinterpret_cast<RvcDetectionResult *>(context);
+
+    ChipLogDetail(NotSpecified, "RVC App: frame %u: %u detections, %u classifications (%.1f ms)",
+                  static_cast<unsigned>(result->frameSequence), static_cast<unsigned>(result->detectionCount),
+                  static_cast<unsigned>(result->classificationCount), static_cast<double>(result->inferenceMs));
+    for (size_t i = 0; i < result->classificationCount; i++)
+    {
+        const RvcClassification & classification = result->classifications[i];
+        ChipLogDetail(NotSpecified, "RVC App: classifier %u: class %d (%.2f)", static_cast<unsigned>(classification.model),
+                      classification.class_id, static_cast<double>(classification.score));
+    }
+
+    // Frames the scheduler ran only the classifiers on say nothing about obstacles.
+    if (gRvcDevice != nullptr && result->detectorRan)
+    {
+        gRvcDevice->HandleDetectionResult(*result);
+    }
+
+    Platform::Delete(result);
+}
+
+// Runs on the inference worker thread.
+void OnDetectionResult(const RvcDetectionResult & result, void * context)
+{
+    auto * copy = Platform::New<RvcDetectionResult>(result);
+    if (copy == nullptr)
+    {
+        return;
+    }
+
+    if (DeviceLayer::PlatformMgr().ScheduleWork(HandleDetectionResult, reinterpret_cast<intptr_t>(copy)) != CHIP_NO_ERROR)
+    {
+        Platform::Delete(copy);
+    }
+}
+
+#if RVC_FEDERATED_LEARNING
+RvcReplayStore sReplayStore;
+RvcFlowerClient * sFlowerClient = nullptr;
+RvcFLScheduler sFLScheduler;
+#endif
+
+RvcAIActivity ActivityFromOperationalState(uint8_t operationalState)
+{
+    switch (operationalState)
+    {
+    case to_underlying(OperationalState::OperationalStateEnum::kRunning):
+    case to_underlying(RvcOperationalState::OperationalStateEnum::kSeekingCharger):
+        return RvcAIActivity::kCleaning;
+    case to_underlying(RvcOperationalState::OperationalStateEnum::kCharging):
+    case to_underlying(RvcOperationalState::OperationalStateEnum::kDocked):
+    case to_underlying(RvcOperationalState::OperationalStateEnum::kEmptyingDustBin):
+    case to_underlying(RvcOperationalState::OperationalStateEnum::kCleaningMop):
+    case to_underlying(RvcOperationalState::OperationalStateEnum::kFillingWaterTank):
+        return RvcAIActivity::kDocked;
+    default:
+        return RvcAIActivity::kIdle;
+    }
+}
+
+// Runs on the CHIP thread. The camera models only run while they are useful, and training only runs while the robot sits on
+// its dock, and stops as soon as it leaves it.
+void OnOperationalStateChanged(uint8_t operationalState, void * context)
+{
+    RvcAIActivity activity = ActivityFromOperationalState(operationalState);
+    if (gAiInterface != nullptr)
+    {
+        gAiInterface->SetActivity(activity);
+    }
+    // Where the detector does not run (by default on the dock), nothing would age its tracks out and the Obstacles list
+    // would stay frozen at whatever was last seen.
+    if (gRvcDevice != nullptr && (gAiInterface == nullptr || !gAiInterface->DetectorRunsIn(activity)))
+    {
+        gRvcDevice->ClearObstacles();
+    }
+#if RVC_FEDERATED_LEARNING
+    bool docked = operationalState == to_underlying(RvcOperationalState::OperationalStateEnum::kDocked) ||
+        operationalState == to_underlying(RvcOperationalState::OperationalStateEnum::kCharging);
+    sFLScheduler.SetTrainingAllowed(docked);
+#endif
+}
+} // namespace
 
 void ApplicationInit()
 {
-    std::string path = std::string(LinuxDeviceOptions::GetInstance().app_pipe);
+    std::string path     = std::string(LinuxDeviceOptions::GetInstance().app_pipe);
+    std::string path_out = path + "_out";
 
-    if ((!path.empty()) and (sChipNamedPipeCommands.Start(path, &sRvcAppCommandDelegate) != CHIP_NO_ERROR))
+    if ((!path.empty()) and (sChipNamedPipeCommands.Start(path, path_out, &sRvcAppCommandDelegate) != CHIP_NO_ERROR))
     {
         ChipLogError(NotSpecified, "Failed to start CHIP NamedPipeCommands");
         sChipNamedPipeCommands.Stop();
     }
+    sRvcAppCommandDelegate.SetPipes(&sChipNamedPipeCommands);
 
     gRvcDevice = new RvcDevice(RVC_ENDPOINT);
     gRvcDevice->Init();
 
     sRvcAppCommandDelegate.SetRvcDevice(gRvcDevice);
 
+    if (sBinaryCommandChannel.Start(RVC_COMMAND_SOCKET_PATH, gRvcDevice) != CHIP_NO_ERROR)
+    {
+        ChipLogError(NotSpecified, "RVC App: Failed to start the binary command channel");
+    }
+
     // Initialize the On-Device AI interface
     gAiInterface = new RvcAIInterface();
-    if (!gAiInterface->InitAI())
+    gAiInterface->SetProfiler(&sAIProfiler);
+
+    RvcModelSchedule floorSchedule;
+    floorSchedule.period[to_underlying(RvcAIActivity::kCleaning)] = RVC_FLOOR_MODEL_PERIOD;
+    if (gAiInterface->AddClassifier(RVC_FLOOR_MODEL_PATH, floorSchedule) < 0)
+    {
+        ChipLogProgress(NotSpecified, "RVC App: No floor-type classifier, running the obstacle detector only");
+    }
+
+    if (!gAiInterface->InitAI(RVC_MODEL_PATH))
     {
         std::cerr << "FATAL ERROR: Failed to initialize AI Interface." << std::endl;
         return;
     }
+    sRvcAppCommandDelegate.SetAIInterface(gAiInterface);
 
     // Initialize the AI Trainer for on-device learning
     gAiTrainer = new RvcAITrainer();
@@ -70,24 +196,68 @@ void ApplicationInit()
     }
     else
     {
-        std::cout << "\n=== Testing Transfer Learning Capabilities ===" << std::endl;
-
-        // Test: Get current weights
         size_t weight_count;
         gAiTrainer->GetLastLayerWeights(nullptr, &weight_count);
         std::cout << "Last layer has " << weight_count << " weights." << std::endl;
 
-        // TODO: In future, this is where we'll integrate with Flower
-        // For now, we just verify the infrastructure works
-        std::cout << "=== Trainer ready for Federated Learning ===" << std::endl << std::endl;
+#if RVC_FEDERATED_LEARNING
+        // The Flower client trains the same model the inference worker runs, on a background thread.
+        sFlowerClient = new RvcFlowerClient(gAiInterface, gAiTrainer, RVC_FL_NODE_ID);
+        if (sReplayStore.Open(RVC_REPLAY_STORE_PATH, gAiInterface->GetInputTensorBytes(), RVC_REPLAY_STORE_BUDGET))
+        {
+            sFlowerClient->SetReplayStore(&sReplayStore);
+            gAiInterface->SetReplayCapture(&sReplayStore, RVC_REPLAY_CAPTURE_INTERVAL);
+        }
+        if (!sFLScheduler.Start(sFlowerClient, RVC_FL_SERVER_ADDRESS))
+        {
+            ChipLogError(NotSpecified, "RVC App: Failed to start the FL scheduler");
+        }
+#endif
     }
 
-    // Run inference loop (this will run continuously)
-    gAiInterface->RunInferenceLoop();
+    gRvcDevice->SetOperationalStateChangedCallback(OnOperationalStateChanged, nullptr);
+    OnOperationalStateChanged(gRvcDevice->GetCurrentOperationalState(), nullptr);
+
+    // Run inference on a worker thread so that ApplicationInit returns and the Matter event loop can start.
+    gAiInterface->SetDetectionCallback(OnDetectionResult, nullptr);
+    if (!gAiInterface->StartInferenceWorker() || !sCameraSource.Start(gAiInterface, RVC_CAMERA_TEST_IMAGE, RVC_CAMERA_FPS))
+    {
+        ChipLogError(NotSpecified, "RVC App: Failed to start the AI inference pipeline");
+    }
 }
 
 void ApplicationShutdown()
 {
+    sRvcAppCommandDelegate.SetAIInterface(nullptr);
+    sRvcAppCommandDelegate.SetPipes(nullptr);
+
+    // Stop producing frames first, then drain the worker before the interpreter goes away.
+    sCameraSource.Stop();
+    if (gAiInterface != nullptr)
+    {
+        gAiInterface->StopInferenceWorker();
+        sAIProfiler.LogReport();
+    }
+
+    if (gRvcDevice != nullptr)
+    {
+        // No more frames are coming, so the tracked obstacles would otherwise stay listed.
+        gRvcDevice->ClearObstacles();
+        gRvcDevice->SetOperationalStateChangedCallback(nullptr, nullptr);
+    }
+
+#if RVC_FEDERATED_LEARNING
+    sFLScheduler.Stop();
+    delete sFlowerClient;
+    sFlowerClient = nullptr;
+    if (gAiInterface != nullptr)
+    {
+        gAiInterface->SetReplayCapture(nullptr, 0);
+    }
+    sReplayStore.Close();
+#endif
+
+    sBinaryCommandChannel.Stop();
     delete gRvcDevice;
     gRvcDevice = nullptr;
 
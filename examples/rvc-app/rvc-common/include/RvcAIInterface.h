@@ -1,44 +1,268 @@
 #pragma once
 
+#include "RvcDetection.h"
+#include "RvcDetectionDecoder.h"
+#include "RvcFrameQueue.h"
+#include "RvcInt8Kernels.h"
+#include "RvcModelFile.h"
+#include "RvcModelScheduler.h"
+#include "RvcPreprocessor.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
 #include <cstdint>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 
 // Forward declarations to avoid including heavy TFLM headers here
 namespace tflite {
+    class MicroAllocator;
     class MicroInterpreter;
     struct Model;
     template <unsigned int tOpCount> class MicroMutableOpResolver;
 }
 struct TfLiteTensor;
+struct TfLiteEvalTensor;
+struct TfLiteContext;
+struct TfLiteNode;
+class RvcReplayStore;
+class RvcAIProfiler;
+
+/**
+ * How much of the model the interpreter keeps around, which decides the arena size.
+ */
+enum class RvcAIMode : uint8_t {
+    kInferenceOnly,      // Arena sized by the TFLM memory planner; weights are read-only
+    kTraining,           // Same arena, plus writable views of the trainable weight tensors
+    kPreserveAllTensors, // Every intermediate tensor stays addressable (inspection tools only, ~70MB)
+};
+
+#if defined(RVC_AI_INFERENCE_ONLY) && RVC_AI_INFERENCE_ONLY
+static constexpr RvcAIMode kRvcAIDefaultMode = RvcAIMode::kInferenceOnly;
+#else
+static constexpr RvcAIMode kRvcAIDefaultMode = RvcAIMode::kTraining;
+#endif
+
+/**
+ * Copy of the input and output activations of one Conv2D, taken while it runs.
+ * TFLM reuses activation memory as soon as an operator is done with it, so this
+ * is the only way to get at them without preserve_all_tensors.
+ */
+struct RvcActivationTap {
+    int filterTensorIndex = -1; // Identifies the Conv2D by its weight tensor
+    std::vector<int8_t> input;
+    std::vector<int8_t> output;
+    bool captured = false;
+};
 
 class RvcAIInterface {
 public:
+    // Invoked on the inference worker thread once a frame has been fully processed.
+    // The callee must not block; hand the result over to another thread instead.
+    using DetectionCallback = void (*)(const RvcDetectionResult & result, void * context);
+
     RvcAIInterface();
     ~RvcAIInterface(); // Important for managing unique_ptr resources
 
-    // Returns true on success
-    bool InitAI();
-    void RunInferenceLoop();
+    // Kernels used for Conv2D and MaxPool2D. Takes effect at the next InitAI(); the
+    // default is kOptimized. Both backends produce identical outputs.
+    void SetKernelBackend(RvcKernelBackend backend) { mKernelBackend = backend; }
+    RvcKernelBackend GetKernelBackend() const { return mKernelBackend; }
+
+    // Times every operator and inference (see RvcAIProfiler). Set before InitAI(): the
+    // interpreter is created with it. The profiler must outlive the interface.
+    void SetProfiler(RvcAIProfiler * profiler) { mProfiler = profiler; }
+    RvcAIProfiler * GetProfiler() const { return mProfiler; }
+
+    // Adds a secondary image classifier (int8 NHWC RGB input, one score per class) that
+    // runs on camera frames next to the detector, in the same arena. Call before InitAI();
+    // returns the classifier index used in RvcClassification, or -1 if the file cannot be
+    // mapped. A classifier the interpreter cannot run is skipped with a warning at InitAI().
+    int AddClassifier(const std::string & modelPath, const RvcModelSchedule & schedule);
+    // Replaces the default detector schedule (every frame while cleaning, every 5th frame
+    // while idle, never while docked).
+    void SetDetectorSchedule(const RvcModelSchedule & schedule) { mScheduler.SetSchedule(kDetectorSlot, schedule); }
+    // Whether the detector runs at all in the activity. While it does not, nothing updates obstacle tracks. Safe to call
+    // from any thread, also while the worker swaps models.
+    bool DetectorRunsIn(RvcAIActivity activity) const { return mScheduler.RunsIn(kDetectorSlot, activity); }
+    // Selects which models the inference worker runs. Safe to call from any thread.
+    void SetActivity(RvcAIActivity activity) { mScheduler.SetActivity(activity); }
+
+    // Returns true on success. Uses the compiled-in model.
+    bool InitAI(RvcAIMode mode = kRvcAIDefaultMode);
+    // Maps the model from a .tflite file; falls back to the compiled-in model if the file
+    // cannot be used and RVC_AI_EMBEDDED_MODEL is enabled.
+    bool InitAI(const std::string & modelPath, RvcAIMode mode = kRvcAIDefaultMode);
+
+    // Swaps to the model in modelPath without stopping the inference worker. The new file
+    // is mapped and verified before the interpreter is touched; on any failure the current
+    // model stays in use. Trainers re-locate their layers on their next call. The arena is
+    // shared, so the classifiers are re-created as well.
+    bool ReloadModel(const std::string & modelPath);
+    // Same, but performed by the inference worker between two frames, so the caller
+    // never waits for it. Runs synchronously if the worker is not running.
+    void RequestModelReload(const std::string & modelPath);
+    // Incremented by every successful ReloadModel().
+    uint32_t GetModelGeneration() const { return mModelGeneration.load(); }
+
+    // Runs the whole pipeline synchronously on the bundled test image, with every model.
     void RunSingleInference();
 
+    // Asynchronous pipeline: frames pushed with SubmitFrame() are processed on a
+    // dedicated worker thread and results are delivered through the callback.
+    void SetDetectionCallback(DetectionCallback callback, void * context);
+    bool StartInferenceWorker();
+    void StopInferenceWorker();
+
+    // Copies a raw camera frame (RGB888 or NV12) into the next free queue slot. Never
+    // blocks; returns false (and drops the frame) if the worker has not caught up yet.
+    bool SubmitFrame(const uint8_t * pixels, int width, int height, RvcCameraFrame::PixelFormat format,
+                     int64_t timestampMs);
+
     // Expose internals for RvcAITrainer
     tflite::MicroInterpreter* GetInterpreter() { return mInterpreter.get(); }
     TfLiteTensor* GetOutputTensor() { return mOutputTensor; }
+    const tflite::Model* GetModel() const { return mModel; }
+    uint64_t GetModelHash() const { return mModelHash; }
+    RvcAIMode GetMode() const { return mMode; }
+
+    // Writable view of a constant (weight/bias) tensor, read straight from the model
+    // flatbuffer so it does not need preserve_all_tensors. Only available in kTraining
+    // and kPreserveAllTensors modes; returns nullptr otherwise.
+    TfLiteEvalTensor* GetWeightTensor(int tensorIndex);
+
+    // Training support. Taps are filled by RunForward() only, never by the inference
+    // worker, so the captured activations stay stable until the next RunForward().
+    bool AddActivationTap(RvcActivationTap * tap);
+    void RemoveActivationTap(RvcActivationTap * tap);
+
+    // Serialises access to the interpreter and the weight tensors between the
+    // inference worker and training. Hold it across RunForward(), reading the
+    // outputs and writing weights.
+    std::unique_lock<std::mutex> LockInterpreter() { return std::unique_lock<std::mutex>(mInterpreterMutex); }
+
+    // Runs the model on an already preprocessed int8 input tensor (e.g. a stored
+    // training sample). The caller must hold LockInterpreter().
+    bool RunForward(const int8_t * inputTensorData);
+    size_t GetInputTensorBytes() const;
+
+    // Decodes the output of the last RunForward() with boxes normalised to the model
+    // input, like RvcTrainingBox. The caller must hold LockInterpreter().
+    void DecodeOutput(RvcDetectionResult & result);
+
+    // Stores every captureInterval-th frame that has detections into store, as its
+    // preprocessed input with the detections as pseudo-labels. Frames are dropped
+    // rather than waiting if the store is busy. Pass nullptr to stop.
+    void SetReplayCapture(RvcReplayStore * store, uint32_t captureInterval);
+
+    // Arena accounting. The arena holds the detector and every classifier.
+    size_t GetArenaSize() const { return mTensorArenaSize; }
+    size_t GetArenaUsedBytes() const;
+    void LogArenaReport() const;
 
 private:
+    // A secondary model. It has its own interpreter, but its activations live in the
+    // non-persistent part of the shared arena, which TFLM reuses between interpreters.
+    struct Classifier {
+        std::string path;
+        std::unique_ptr<RvcModelFile> file;
+        const tflite::Model * model = nullptr; // nullptr if the interpreter cannot run it
+        std::unique_ptr<tflite::MicroInterpreter> interpreter;
+        TfLiteTensor * input = nullptr;
+        TfLiteTensor * output = nullptr;
+        RvcPreprocessor preprocessor;
+    };
+
+    // Scheduler slots: the detector, then the classifiers in the order they were added.
+    static constexpr size_t kDetectorSlot = 0;
+    static constexpr uint32_t kAllModels = (1u << RvcModelScheduler::kMaxModels) - 1;
+    static_assert(RvcModelScheduler::kMaxModels == 1 + kRvcMaxClassifiers, "One scheduler slot per model");
+
+    // Pipeline stages
+    bool PreprocessFrame(const RvcCameraFrame & frame);
+    bool Invoke();
+    void PostprocessOutput(const RvcCameraFrame & frame, RvcDetectionResult & result);
+    bool RunClassifier(Classifier & classifier, const RvcCameraFrame & frame, RvcClassification & classification);
+    // Runs the models in the models mask; returns false on error or if none of them ran.
+    bool ProcessFrame(const RvcCameraFrame & frame, RvcDetectionResult & result, uint32_t models);
+    void CaptureSample(const RvcDetectionResult & result);
+
+    void InferenceWorkerMain();
+
+    bool CreateInterpreters(size_t arenaSize, bool preserveAllTensors);
+    bool LoadModel();
+
+    // Called by the Conv2D invoke hook (see RvcAIInterface.cpp) after each Conv2D during RunForward().
+    friend struct RvcConv2DTapHook;
+    void CaptureActivations(TfLiteContext * context, TfLiteNode * node);
+
     const tflite::Model* mModel;
+    std::unique_ptr<RvcModelFile> mModelFile;
+    uint64_t mModelHash = 0;
+    std::atomic<uint32_t> mModelGeneration{ 0 };
     std::unique_ptr<tflite::MicroInterpreter> mInterpreter;
     TfLiteTensor* mInputTensor;
     TfLiteTensor* mOutputTensor;
 
-    // Using a unique_ptr for the resolver to manage its lifecycle
-    std::unique_ptr<tflite::MicroMutableOpResolver<14> > mResolver;
+    // Using a unique_ptr for the resolver to manage its lifecycle. The detector and the
+    // classifiers share it.
+    static constexpr unsigned int kOpCount = 18;
+    std::unique_ptr<tflite::MicroMutableOpResolver<kOpCount> > mResolver;
 
-    // A memory buffer for TFLM to use for input, output, and intermediate arrays.
+    // A memory buffer for TFLM to use for input, output, and intermediate arrays, shared by
+    // all interpreters through one allocator (which itself lives in the arena).
     std::unique_ptr<uint8_t[]> mTensorArena;
-    
-    // NOTE: This size will need to be tuned for the specific model.
-    // YOLOv8n requires approximately 5MB arena for inference only.
-    // With preserve_all_tensors enabled, it requires ~70MB for training.
-    static constexpr int kTensorArenaSize = 80 * 1024 * 1024;  // 80MB for training
+    size_t mTensorArenaSize = 0;
+    tflite::MicroAllocator * mAllocator = nullptr;
+    RvcAIMode mMode = kRvcAIDefaultMode;
+    RvcKernelBackend mKernelBackend = RvcKernelBackend::kOptimized;
+    RvcAIProfiler * mProfiler = nullptr;
+
+    // Views handed out by GetWeightTensor(), keyed by tensor index.
+    std::map<int, TfLiteEvalTensor> mWeightViews;
+
+    std::mutex mInterpreterMutex;
+    std::vector<RvcActivationTap *> mActivationTaps;
+
+    // Upper bound used for the planning pass. The probe arena is never written beyond
+    // what the planner needs, so its untouched pages do not count towards RSS.
+    // YOLOv8n needs ~5MB for inference; preserve_all_tensors needs ~70MB.
+    static constexpr size_t kMaxTensorArenaSize = 80 * 1024 * 1024;
+    // Slack kept on top of the planned size for allocations made after AllocateTensors().
+    static constexpr size_t kArenaHeadroom = 16 * 1024;
+
+    // Three slots: one being filled by the camera, one queued, one being inferred.
+    static constexpr size_t kFrameQueueDepth = 3;
+    static constexpr int kMaxFrameWidth = 1280;
+    static constexpr int kMaxFrameHeight = 720;
+
+    RvcFrameQueue<kFrameQueueDepth> mFrameQueue;
+    uint32_t mNextFrameSequence = 0;
+
+    std::thread mWorker;
+    std::atomic<bool> mWorkerRunning{ false };
+    std::mutex mWakeMutex; // Only used to sleep while the queue is empty
+    std::string mPendingModelPath; // Guarded by mWakeMutex
+    std::condition_variable mWakeCondition;
+
+    RvcPreprocessor mPreprocessor;
+    RvcDetectionDecoder mDecoder;
+
+    std::vector<Classifier> mClassifiers;
+    RvcModelScheduler mScheduler;
+
+    DetectionCallback mDetectionCallback = nullptr;
+    void * mDetectionCallbackContext = nullptr;
+    RvcDetectionResult mResult; // Reused across frames by the worker
+
+    // Replay capture. The input is copied before Invoke(), which may reuse its memory.
+    std::atomic<RvcReplayStore *> mReplayStore{ nullptr };
+    std::atomic<uint32_t> mCaptureInterval{ 0 };
+    std::vector<int8_t> mCaptureInput;
+    std::vector<RvcTrainingBox> mCaptureBoxes;
 };
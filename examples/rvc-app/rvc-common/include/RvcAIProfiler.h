@@ -0,0 +1,111 @@
+#pragma once
+
+#include "tensorflow/lite/micro/micro_profiler_interface.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Per-operator profiler for the TFLM interpreter.
+ *
+ * The interpreter calls BeginEvent()/EndEvent() around every operator;
+ * RvcAIInterface brackets each Invoke() with BeginInference()/EndInference().
+ * Operator timings are kept per layer (position in the graph) and per operator
+ * type, and whole-inference latencies in a rolling window for percentiles.
+ *
+ * When built with RVC_AI_MATTER_TRACING, every inference is also emitted as a
+ * Matter trace scope "Inference" (group "RvcAI") and every operator as a scope
+ * "RvcAIOp" whose group is the operator tag, and each inference's latency and
+ * arena usage as Matter metrics, so they show up in the perfetto and JSON
+ * tracing backends selected with --trace-to. Scope labels are literals because
+ * the perfetto backend only accepts static event names.
+ *
+ * Begin/End calls come from the thread running the interpreter; GetSnapshot()
+ * may be called from any thread.
+ */
+class RvcAIProfiler : public tflite::MicroProfilerInterface {
+public:
+    static constexpr size_t kMaxEvents = 512;     // Operators per inference; YOLOv8n has ~230
+    static constexpr size_t kLatencyWindow = 256; // Inferences kept for the percentiles
+    static constexpr size_t kReportedLayers = 10;
+
+    struct OpStats {
+        const char * tag = nullptr; // Operator name, e.g. "CONV_2D"
+        uint32_t count = 0;         // Occurrences per inference
+        double averageUs = 0.0;     // Time per inference, all occurrences together
+        double share = 0.0;         // Fraction of the operator time
+    };
+
+    struct LayerStats {
+        uint32_t index = 0; // Position in the execution order
+        const char * tag = nullptr;
+        double averageUs = 0.0;
+        uint32_t maxUs = 0;
+    };
+
+    struct Snapshot {
+        uint32_t inferences = 0;      // Since the last Reset()
+        uint32_t graphInferences = 0; // Since the graph last changed; ops and layers average over these
+        uint32_t windowSize = 0; // Latencies the percentiles are taken over
+        uint32_t lastUs = 0;
+        uint32_t p50Us = 0;
+        uint32_t p99Us = 0;
+        uint32_t maxUs = 0;
+        size_t arenaUsedBytes = 0;
+        std::vector<OpStats> ops;       // Most expensive first
+        std::vector<LayerStats> layers; // Slowest kReportedLayers, slowest first
+    };
+
+    RvcAIProfiler();
+
+    // tflite::MicroProfilerInterface
+    uint32_t BeginEvent(const char * tag) override;
+    void EndEvent(uint32_t eventHandle) override;
+
+    void BeginInference();
+    void EndInference(size_t arenaUsedBytes);
+
+    Snapshot GetSnapshot() const;
+    void LogReport() const;
+    void Reset();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Event {
+        const char * tag;
+        Clock::time_point start;
+        uint32_t durationUs;
+    };
+
+    struct LayerTotals {
+        const char * tag;
+        uint64_t totalUs;
+        uint32_t maxUs;
+    };
+
+    struct OpTotals {
+        const char * tag;
+        uint64_t totalUs;
+        uint32_t count;
+    };
+
+    // Written by the interpreter thread only
+    Event mEvents[kMaxEvents];
+    size_t mEventCount;
+    Clock::time_point mInferenceStart;
+
+    // Guarded by mMutex
+    mutable std::mutex mMutex;
+    std::vector<LayerTotals> mLayers;
+    std::vector<OpTotals> mOps;
+    uint32_t mLatencies[kLatencyWindow];
+    uint32_t mInferences;
+    uint32_t mGraphInferences; // Inferences folded into mLayers/mOps
+    uint32_t mLastUs;
+    uint32_t mMaxUs;
+    size_t mArenaUsedBytes;
+};
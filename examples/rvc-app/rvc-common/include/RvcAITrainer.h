@@ -1,10 +1,17 @@
 #pragma once
 
+#include "RvcAIInterface.h"
+#include "RvcConvHeadTrainer.h"
+#include "RvcDetection.h"
+#include "RvcLayerDiscovery.h"
+#include "RvcQuantizedWeights.h"
+
+#include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 // Forward declaration
-class RvcAIInterface;
 namespace tflite {
     class MicroInterpreter;
 }
@@ -12,21 +19,31 @@ struct TfLiteTensor;
 struct TfLiteEvalTensor;
 
 /**
- * @brief Transfer Learning trainer for YOLO last layer
+ * @brief Transfer Learning trainer for the YOLO detection heads
  *
  * This class implements on-device training by:
  * 1. Freezing all backbone layers (feature extraction)
- * 2. Training only the last detection head
- * 3. Using simple SGD optimizer
- * 4. Computing gradients manually (TFLM doesn't support backprop)
+ * 2. Training only the detection head convolutions, found by RvcLayerDiscovery
+ * 3. Running a real backward pass for each head (RvcConvHeadTrainer), using
+ *    the head's activations captured during the forward pass. Class heads are
+ *    trained with the class loss and DFL box heads with the box loss; heads
+ *    that are neither are rejected.
+ * 4. SGD with momentum on an fp32 master copy, requantized per channel, using
+ *    the vector kernels of RvcTrainerKernels
+ *
+ * The "last layer" weight API below covers the filters of all trainable heads,
+ * concatenated in discovery order.
  */
 class RvcAITrainer {
 public:
     RvcAITrainer();
     ~RvcAITrainer();
 
-    // Link this trainer to an inference engine
-    bool AttachInferenceEngine(RvcAIInterface* inference_engine);
+    // Link this trainer to an inference engine and resolve the layers to train
+    bool AttachInferenceEngine(RvcAIInterface* inference_engine, const RvcLayerQuery& query = RvcLayerQuery());
+
+    size_t GetTrainableLayerCount() const { return mHeads.size(); }
+    const RvcTrainableLayer* GetTrainableLayer(size_t index) const;
 
     // Weight management for Federated Learning (int8 version)
     bool GetLastLayerWeightsInt8(int8_t* weights_buffer, size_t* buffer_size);
@@ -34,30 +51,63 @@ public:
     bool UpdateWeightsInt8(const int8_t* gradients, size_t size);
     size_t GetLastLayerWeightsCount();
 
-    // Legacy float version (for compatibility, but lossy)
+    // Float version: the fp32 master copy, dequantized with the tensor's own per-channel
+    // scales. SetLastLayerWeights() only updates the master copy; call CommitWeights()
+    // to requantize it into the model.
     bool GetLastLayerWeights(float* weights_buffer, size_t* buffer_size);
     bool SetLastLayerWeights(const float* weights, size_t size);
+    void CommitWeights();
+
+    // Training functions. input_tensor is a preprocessed int8 model input; boxes are
+    // normalised to the model input. Writes the classification loss to loss if given.
+    bool TrainSingleStep(const int8_t* input_tensor, const RvcTrainingBox* boxes,
+                         size_t num_boxes, float learning_rate, float* loss = nullptr);
 
-    // Training functions
-    bool TrainSingleStep(const float* input_image, const float* ground_truth_boxes,
-                         size_t num_boxes, float learning_rate);
+    // Micro-batches: AccumulateStep() runs the forward and backward pass of one sample and
+    // adds its gradients to the batch; ApplyAccumulatedUpdate() takes one SGD step with the
+    // mean gradient. TrainSingleStep() is a batch of one.
+    bool AccumulateStep(const int8_t* input_tensor, const RvcTrainingBox* boxes, size_t num_boxes,
+                        float* loss = nullptr);
+    bool ApplyAccumulatedUpdate(float learning_rate);
+    void DiscardAccumulatedGradients();
+
+    // Forward pass only: the classification loss against boxes, and the decoded detections
+    // (normalised to the model input) if detections is given. Weights are not changed.
+    bool EvaluateSample(const int8_t* input_tensor, const RvcTrainingBox* boxes, size_t num_boxes,
+                        float* loss, RvcDetectionResult* detections = nullptr);
 
     // Loss computation
     float ComputeLoss(const float* predictions, const float* ground_truth, size_t num_elements);
 
 private:
+    // One trainable Conv2D head and everything needed to train it.
+    struct TrainableHead {
+        RvcTrainableLayer layer;
+        RvcQuantizedWeights weights;       // Filter with its fp32 master copy
+        RvcConvHeadTrainer trainer;
+        RvcActivationTap tap;
+        size_t anchorOffset = SIZE_MAX;    // First row of the model output that belongs to this head
+        std::vector<float> predictedBoxes; // (cx, cy, w, h) per head anchor, refreshed every step
+    };
+
     RvcAIInterface* mInferenceEngine;
     tflite::MicroInterpreter* mInterpreter; // Borrowed from RvcAIInterface
-    TfLiteEvalTensor* mLastLayerEvalTensor; // Pointer to the last layer's weights (using EvalTensor)
 
     // Gradient storage for last layer (int8 for quantized training)
     std::vector<int8_t> mGradientsInt8;
-    std::vector<float> mGradients; // Legacy float gradients
 
-    // Helper functions for backpropagation
-    void ComputeGradients(const float* predictions, const float* ground_truth, size_t num_elements);
-    void UpdateWeightsWithSGD(float learning_rate);
+    // Heads are heap-allocated so the activation taps registered with the engine stay put.
+    std::vector<std::unique_ptr<TrainableHead>> mHeads;
+    RvcLayerQuery mLayerQuery;
+
+    uint32_t mModelGeneration = 0; // Engine model the heads were located in
 
-    // Extract last layer info from the model
-    bool LocateLastLayer();
+    // Extract trainable layer info from the model
+    bool LocateTrainableLayers();
+    bool FollowModelSwap();
+    // Only meaningful with the interpreter lock held; the heads must not be touched if true.
+    bool ModelSwapped() const { return mModelGeneration != mInferenceEngine->GetModelGeneration(); }
+    bool ConfigureHead(TrainableHead& head);
+    const float* GatherPredictedBoxes(TrainableHead& head);
+    void ReleaseHeads();
 };
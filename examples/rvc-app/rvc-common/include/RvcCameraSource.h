@@ -0,0 +1,37 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+class RvcAIInterface;
+
+/**
+ * @brief Feeds camera frames into an RvcAIInterface at a fixed frame rate.
+ *
+ * There is no camera on the Linux host, so this source decodes a still image
+ * once and replays it. A real device replaces this class with its camera
+ * driver callback calling RvcAIInterface::SubmitFrame() directly.
+ */
+class RvcCameraSource {
+public:
+    RvcCameraSource();
+    ~RvcCameraSource();
+
+    bool Start(RvcAIInterface * sink, const std::string & imagePath, int framesPerSecond);
+    void Stop();
+
+private:
+    void CaptureThreadMain();
+
+    RvcAIInterface * mSink;
+    std::vector<uint8_t> mFrame;
+    int mWidth;
+    int mHeight;
+    int mFramesPerSecond;
+
+    std::thread mThread;
+    std::atomic<bool> mRunning{ false };
+};
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "RvcDetection.h"
+#include "RvcQuantizedWeights.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Backpropagation for a single int8 Conv2D detection head.
+ *
+ * The backbone stays frozen, so only the head's own weights and bias are
+ * trained. A training step is:
+ * 1. ComputeLoss(): the YOLOv8 loss of the head's logits. Anchors whose cell
+ *    centre lies inside a ground-truth box are positives.
+ *    - Class heads: BCE, where the target score of a positive is the IoU
+ *      between the box the model predicted at that anchor and the ground
+ *      truth (task-aligned BCE), and everything else is a negative.
+ *    - Box heads (4 sides x kRegMax distance bins, decoded by the DFL): for
+ *      positives, (1 - IoU) of the expected distances, backpropagated through
+ *      the softmax of each side, plus the distribution focal loss towards the
+ *      two bins around the true distance. Negatives have no box loss.
+ *    The mean (1 - IoU) over positives is reported as box loss for both.
+ * 2. Backward(): dL/dW = dL/dZ^T * im2col(A), computed as a cache-blocked GEMM
+ *    split across output channels on a few worker threads, plus dL/db. The
+ *    gradients are added to a running sum, so several samples can be
+ *    accumulated into one micro-batch update.
+ * 3. ApplyUpdate(): SGD with momentum and weight decay on the fp32 master copy
+ *    held by RvcQuantizedWeights, using the mean gradient of the accumulated
+ *    samples.
+ * 4. Commit(): requantization of every output channel with its own scale, so
+ *    the interpreter sees the new weights.
+ *
+ * Tensors are NHWC (activations) and OHWI (weights), as in TFLM. Every buffer,
+ * including the per-thread GEMM tiles, is sized once by Configure().
+ */
+class RvcConvHeadTrainer {
+public:
+    struct Geometry {
+        int inHeight = 0, inWidth = 0, inChannels = 0;
+        int outHeight = 0, outWidth = 0, outChannels = 0;
+        int kernelHeight = 1, kernelWidth = 1;
+        int strideHeight = 1, strideWidth = 1;
+        int padTop = 0, padLeft = 0;
+    };
+
+    struct Quantization {
+        float inputScale = 1.0f;
+        int inputZeroPoint = 0;
+        float outputScale = 1.0f;
+        int outputZeroPoint = 0;
+    };
+
+    enum class HeadType : uint8_t {
+        kClassification,  // One logit per class
+        kBoxDistribution, // 4 * kRegMax channels: per side (l, t, r, b), logits over distances of 0..kRegMax-1 cells
+    };
+
+    // Distance bins per box side in the YOLOv8 DFL.
+    static constexpr int kRegMax = 16;
+
+    struct Hyperparameters {
+        float momentum = 0.9f;
+        float weightDecay = 5e-4f;
+    };
+
+    static constexpr int kMaxThreads = 4;
+
+    RvcConvHeadTrainer();
+
+    // weights is the head filter with its fp32 master copy; bias is the live int32 tensor and may be null.
+    // Both are only written back to the model by Commit().
+    // A box distribution head must have 4 * kRegMax output channels.
+    bool Configure(HeadType type, const Geometry & geometry, const Quantization & quantization, RvcQuantizedWeights * weights,
+                   int32_t * bias, const Hyperparameters & hyperparameters);
+    bool IsConfigured() const { return mWeights != nullptr; }
+    HeadType GetHeadType() const { return mType; }
+
+    // predictedBoxes is optional and only used by class heads: (cx, cy, w, h) per head anchor, normalised, in
+    // row-major grid order. Returns the loss the gradient is taken of (class BCE, or IoU + DFL loss); the mean
+    // (1 - IoU) over positives is written to boxLoss if given.
+    float ComputeLoss(const int8_t * headOutput, const RvcTrainingBox * boxes, size_t numBoxes, const float * predictedBoxes,
+                      float * boxLoss);
+
+    // Uses the output gradient from the last ComputeLoss(), and adds the result to the accumulated gradients.
+    void Backward(const int8_t * headInput);
+    size_t AccumulatedSamples() const { return mAccumulatedSamples; }
+
+    // Updates the fp32 master weights and bias with the mean accumulated gradient, then starts a new micro-batch.
+    void ApplyUpdate(float learningRate);
+    // Drops the accumulated gradients without an update.
+    void DiscardGradients();
+
+    // Requantizes the master weights and bias into the model, if they changed.
+    void Commit();
+    bool IsDirty() const { return mWeights && (mWeights->IsDirty() || mBiasDirty); }
+
+    // Gradients of the last Backward() only.
+    size_t WeightCount() const { return mWeightGrad.size(); }
+    const float * WeightGradients() const { return mWeightGrad.data(); }
+    const float * BiasGradients() const { return mBiasGrad.data(); }
+
+private:
+    float WeightScale(int outChannel) const;
+    const RvcTrainingBox * AssignBox(size_t position, const RvcTrainingBox * boxes, size_t numBoxes) const;
+    float ComputeClassLoss(const int8_t * headOutput, const RvcTrainingBox * boxes, size_t numBoxes,
+                           const float * predictedBoxes, float * boxLoss);
+    float ComputeBoxLoss(const int8_t * headOutput, const RvcTrainingBox * boxes, size_t numBoxes, float * boxLoss);
+    void Im2Col(const int8_t * headInput);
+    void GemmOutputChannels(int firstChannel, int lastChannel, float * tile);
+    void RunGemmThreads(int threads);
+
+    HeadType mType;
+    Geometry mGeometry;
+    Quantization mQuantization;
+    Hyperparameters mHyperparameters;
+    RvcQuantizedWeights * mWeights;
+    int32_t * mBias;
+    bool mBiasDirty;
+
+    size_t mPatchSize;      // kernelHeight * kernelWidth * inChannels
+    size_t mNumPositions;   // outHeight * outWidth
+
+    std::vector<int8_t> mColumns;     // im2col of the head input, [positions x patch], raw int8
+    std::vector<float> mOutputGrad;   // dL/dZ, [positions x outChannels]
+    std::vector<float> mWeightGrad;   // dL/dW, [outChannels x patch]
+    std::vector<float> mBiasGrad;     // dL/db, [outChannels]
+    std::vector<float> mTiles;        // One widened im2col block per thread
+
+    std::vector<float> mWeightGradSum; // Accumulated over the current micro-batch
+    std::vector<float> mBiasGradSum;
+    size_t mAccumulatedSamples;
+
+    std::vector<float> mMasterBias;
+    std::vector<float> mWeightVelocity;
+    std::vector<float> mBiasVelocity;
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Upper bound on the detections reported for a single frame (after NMS).
+static constexpr size_t kRvcMaxDetections = 32;
+
+// Upper bound on the secondary (classification) models that run next to the detector.
+static constexpr size_t kRvcMaxClassifiers = 3;
+
+// A single detected object, in pixel coordinates of the source frame.
+struct RvcDetection {
+    float x1, y1, x2, y2; // Top-left and bottom-right coordinates
+    float score;
+    int class_id;
+};
+
+// The top class of a secondary model, e.g. the floor type under the robot.
+struct RvcClassification {
+    uint8_t model; // Index returned by RvcAIInterface::AddClassifier()
+    int class_id;
+    float score;
+};
+
+// The detections produced for one camera frame. Fixed capacity so it can be
+// filled on the inference worker and copied across threads without allocating.
+struct RvcDetectionResult {
+    uint32_t frameSequence = 0;
+    int64_t frameTimestampMs = 0;
+    int imageWidth = 0;
+    int imageHeight = 0;
+    float inferenceMs = 0.0f;
+    bool detectorRan = false; // False if the model scheduler skipped the detector on this frame
+    size_t detectionCount = 0;
+    std::array<RvcDetection, kRvcMaxDetections> detections;
+    size_t classificationCount = 0;
+    std::array<RvcClassification, kRvcMaxClassifiers> classifications;
+};
+
+// A labelled object used for on-device training, normalised to [0, 1] in model input coordinates.
+struct RvcTrainingBox {
+    float cx, cy, w, h;
+    int class_id;
+};
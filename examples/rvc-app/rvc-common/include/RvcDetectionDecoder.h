@@ -0,0 +1,70 @@
+#pragma once
+
+#include "RvcDetection.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * @brief Turns the raw int8 YOLO output tensor into final detections.
+ *
+ * The decoder works on the quantized tensor directly:
+ * 1. The confidence threshold is quantized once in Configure(), so rejecting
+ *    an anchor is a single int8 compare against the SIMD max of its class row.
+ * 2. Surviving anchors are dequantized into a fixed-capacity candidate buffer
+ *    that is allocated once, never per frame.
+ * 3. If there are more candidates than kMaxNmsCandidates, the best ones are
+ *    picked with a partial selection rather than a full sort.
+ * 4. Class-aware NMS repeatedly takes the best remaining candidate and
+ *    suppresses same-class boxes overlapping it.
+ *
+ * Expected tensor layout is [1, num_anchors, 4 + num_classes] with
+ * (cx, cy, w, h) normalised to [0, 1], as produced by the YOLOv8 export.
+ */
+class RvcDetectionDecoder {
+public:
+    struct Config {
+        float scoreThreshold = 0.5f;
+        float iouThreshold = 0.45f;
+        float outputScale = 1.0f;
+        int outputZeroPoint = 0;
+        int numAnchors = 0;
+        int numClasses = 0;
+    };
+
+    // Candidate anchors kept for NMS; anything beyond this is the lowest scoring.
+    static constexpr size_t kMaxCandidates = 1024;
+    static constexpr size_t kMaxNmsCandidates = 128;
+
+    RvcDetectionDecoder();
+    ~RvcDetectionDecoder();
+
+    // Returns false if the configuration cannot be decoded.
+    bool Configure(const Config & config);
+
+    // Decodes one output tensor into result.detections/result.detectionCount. Boxes are the normalised
+    // model coordinates times imageWidth/imageHeight; undoing a letterbox is up to the caller.
+    void Decode(const int8_t * output, int imageWidth, int imageHeight, RvcDetectionResult & result);
+
+    // Number of anchors that passed the score threshold in the last Decode() (before NMS).
+    size_t LastCandidateCount() const { return mLastCandidateCount; }
+
+    // Exposed for the microbenchmark: best class of one anchor row in the int8 domain.
+    static int ArgMaxInt8(const int8_t * scores, int count, int8_t * maxValue);
+
+private:
+    struct Candidate {
+        RvcDetection box;
+        int8_t rawScore;
+        bool suppressed;
+    };
+
+    size_t SelectTopCandidates(size_t count);
+    void RunNms(size_t count, RvcDetectionResult & result);
+
+    Config mConfig;
+    int mScoreThresholdQ; // Smallest int8 score whose dequantized value is > scoreThreshold (128: none)
+    std::unique_ptr<Candidate[]> mCandidates;
+    size_t mLastCandidateCount;
+};
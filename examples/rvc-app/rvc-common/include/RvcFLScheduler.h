@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+class RvcFlowerClient;
+
+/**
+ * @brief Runs federated learning rounds inside the app, in the background.
+ *
+ * The Flower client shares the app's RvcAIInterface, so there is one copy of
+ * the model. Rounds run on a low-priority thread and only while training is
+ * allowed (the robot is docked or charging). When training is disallowed, a
+ * running fit() stops after its current step, and the scheduler leaves the
+ * federation until training is allowed again.
+ *
+ * SetTrainingAllowed() only flips a flag, so it is safe to call from the
+ * CHIP thread.
+ */
+class RvcFLScheduler {
+public:
+    RvcFLScheduler();
+    ~RvcFLScheduler();
+
+    bool Start(RvcFlowerClient * client, const std::string & serverAddress);
+    void Stop();
+
+    void SetTrainingAllowed(bool allowed);
+    bool IsTrainingAllowed() const { return mTrainingAllowed.load(); }
+
+private:
+    void SchedulerThreadMain();
+    bool KeepFederating() const { return mRunning.load() && mTrainingAllowed.load(); }
+
+    RvcFlowerClient * mClient;
+    std::string mServerAddress;
+
+    std::thread mThread;
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::atomic<bool> mRunning{ false };
+    std::atomic<bool> mTrainingAllowed{ false };
+};
@@ -3,6 +3,11 @@
 #include "client.h"  // Flower C++ SDK
 #include "RvcAIInterface.h"
 #include "RvcAITrainer.h"
+#include "RvcDetection.h"
+#include "RvcReplayStore.h"
+
+#include <atomic>
+#include <vector>
 
 /**
  * @brief Flower Client for RVC (Robot Vacuum Cleaner)
@@ -10,6 +15,10 @@
  * This client implements Federated Learning for the RVC app using Flower.
  * It connects to a Flower server and participates in collaborative training
  * of the YOLO object detection model.
+ *
+ * Weights go straight between the tensor arena and the message buffers. The
+ * server can ask for sparse uploads (RvcWeightCodec) through the fit config:
+ * "weight_encoding" = "int8-sparse" and, optionally, "sparse_top_k".
  */
 class RvcFlowerClient : public flwr_local::Client {
 public:
@@ -22,12 +31,35 @@ public:
     flwr_local::FitRes fit(flwr_local::FitIns ins) override;
     flwr_local::EvaluateRes evaluate(flwr_local::EvaluateIns ins) override;
 
+    // Local data. fit() trains on the store's training split, evaluate() scores its
+    // held-out split. The store is shared with the inference worker's capture.
+    void SetReplayStore(RvcReplayStore* store) { mStore = store; }
+
+    // Adds a user-labelled sample (a preprocessed int8 model input) to the store.
+    bool AddTrainingSample(const int8_t* input_tensor, size_t size, const RvcTrainingBox* boxes, size_t num_boxes);
+
+    // Aborts a running fit() after its current step and makes later rounds return without
+    // training until cleared. Safe to call from any thread.
+    void SetPreempted(bool preempted) { mPreempted.store(preempted); }
+    bool IsPreempted() const { return mPreempted.load(); }
+
 private:
     RvcAIInterface* mAIInterface;
     RvcAITrainer* mTrainer;
     int mNodeId;
+    RvcReplayStore* mStore = nullptr;
+    std::vector<uint32_t> mOrder; // Sample indices of the current pass, reused between rounds
+    // Copy of the held-out sample being evaluated, so inference runs without the store lock.
+    std::vector<int8_t> mEvalInput;
+    std::vector<RvcTrainingBox> mEvalBoxes;
+    std::atomic<bool> mPreempted{false};
+
+    // Global weights of the current round, the reference for sparse encodings in both directions.
+    std::vector<int8_t> mBaseline;
+    bool mHasBaseline = false;
+    std::vector<uint32_t> mCodecScratch;
 
     // Helper functions
-    flwr_local::Parameters GetWeightsAsParameters();
-    void SetParametersAsWeights(const flwr_local::Parameters& params);
+    flwr_local::Parameters GetWeightsAsParameters(bool sparse = false, size_t top_k = 0);
+    bool SetParametersAsWeights(const flwr_local::Parameters& params);
 };
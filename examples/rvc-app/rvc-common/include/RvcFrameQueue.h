@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief A single camera frame travelling through the inference pipeline.
+ *
+ * The pixel buffer is allocated once when the queue is created and reused for
+ * every frame, so the camera thread never touches the heap once running.
+ */
+struct RvcCameraFrame {
+    enum class PixelFormat : uint8_t {
+        kRgb888, // Packed 8-bit R, G, B
+        kNv12,   // 8-bit Y plane followed by an interleaved half-resolution UV plane
+    };
+
+    static size_t BytesFor(int width, int height, PixelFormat format)
+    {
+        size_t pixels = static_cast<size_t>(width) * height;
+        return (format == PixelFormat::kNv12) ? pixels + pixels / 2 : pixels * 3;
+    }
+
+    std::vector<uint8_t> pixels;
+    int width = 0;
+    int height = 0;
+    PixelFormat format = PixelFormat::kRgb888;
+    uint32_t sequence = 0;
+    int64_t timestampMs = 0;
+};
+
+/**
+ * @brief Bounded single-producer / single-consumer ring of camera frames.
+ *
+ * The producer (camera thread) and the consumer (inference worker) only
+ * synchronise through two atomic indices, so neither side ever blocks the
+ * other. Slots are written in place: the producer obtains a slot with
+ * BeginWrite(), fills it and publishes it with CommitWrite(); the consumer
+ * mirrors this with BeginRead()/CommitRead().
+ *
+ * @tparam kCapacity Number of slots. One slot is always kept free to tell a
+ *                   full ring from an empty one, so kCapacity - 1 frames can
+ *                   be in flight.
+ */
+template <size_t kCapacity>
+class RvcFrameQueue {
+public:
+    static_assert(kCapacity >= 2, "RvcFrameQueue needs at least two slots");
+
+    explicit RvcFrameQueue(size_t frameBytes = 0)
+    {
+        for (auto & slot : mSlots) {
+            slot.pixels.reserve(frameBytes);
+        }
+    }
+
+    // Producer side. Returns nullptr when the ring is full.
+    RvcCameraFrame * BeginWrite()
+    {
+        size_t head = mHead.load(std::memory_order_relaxed);
+        size_t next = Next(head);
+        if (next == mTail.load(std::memory_order_acquire)) {
+            mDropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        return &mSlots[head];
+    }
+
+    void CommitWrite()
+    {
+        mHead.store(Next(mHead.load(std::memory_order_relaxed)), std::memory_order_release);
+    }
+
+    // Consumer side. Returns nullptr when the ring is empty.
+    RvcCameraFrame * BeginRead()
+    {
+        size_t tail = mTail.load(std::memory_order_relaxed);
+        if (tail == mHead.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        return &mSlots[tail];
+    }
+
+    void CommitRead()
+    {
+        mTail.store(Next(mTail.load(std::memory_order_relaxed)), std::memory_order_release);
+    }
+
+    bool Empty() const { return mTail.load(std::memory_order_acquire) == mHead.load(std::memory_order_acquire); }
+
+    // Number of frames rejected by BeginWrite() because the consumer fell behind.
+    uint32_t DroppedCount() const { return mDropped.load(std::memory_order_relaxed); }
+
+private:
+    static size_t Next(size_t index) { return (index + 1) % kCapacity; }
+
+    RvcCameraFrame mSlots[kCapacity];
+
+    // Keep the indices on separate cache lines so the two threads do not false-share.
+    alignas(64) std::atomic<size_t> mHead{ 0 };
+    alignas(64) std::atomic<size_t> mTail{ 0 };
+    std::atomic<uint32_t> mDropped{ 0 };
+};
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+struct TFLMRegistration;
+
+/**
+ * Which kernels the interpreter runs for the ops that dominate YOLOv8n.
+ */
+enum class RvcKernelBackend : uint8_t {
+    kReference, // Stock TFLM reference kernels
+    kOptimized, // RvcInt8Kernels: SIMD int8 Conv2D and MaxPool2D, falling back to the reference ones
+};
+
+// Geometry and quantization of one int8 Conv2D, NHWC input, OHWI filter.
+struct RvcConvInt8Params {
+    int batches = 1;
+    int inputHeight = 0;
+    int inputWidth = 0;
+    int inputChannels = 0;
+    int filterHeight = 0;
+    int filterWidth = 0;
+    int outputHeight = 0;
+    int outputWidth = 0;
+    int outputChannels = 0;
+    int strideHeight = 1;
+    int strideWidth = 1;
+    int padHeight = 0; // Padding before the first row/column
+    int padWidth = 0;
+    int32_t inputZeroPoint = 0;
+    int32_t outputZeroPoint = 0;
+    const int32_t * outputMultiplier = nullptr; // Per output channel
+    const int32_t * outputShift = nullptr;      // Per output channel
+    int32_t activationMin = -128;
+    int32_t activationMax = 127;
+};
+
+// Geometry of one int8 MaxPool2D, NHWC.
+struct RvcPoolInt8Params {
+    int batches = 1;
+    int inputHeight = 0;
+    int inputWidth = 0;
+    int channels = 0;
+    int filterHeight = 0;
+    int filterWidth = 0;
+    int outputHeight = 0;
+    int outputWidth = 0;
+    int strideHeight = 1;
+    int strideWidth = 1;
+    int padHeight = 0;
+    int padWidth = 0;
+    int32_t activationMin = -128;
+    int32_t activationMax = 127;
+};
+
+/**
+ * @brief Optimized int8 kernels, bit-exact with the TFLM reference kernels.
+ *
+ * Conv2D is lowered to a GEMM: tiles of output pixels are unrolled into rows of
+ * filterHeight * filterWidth * inputChannels input values (im2col), which are
+ * then multiplied with the OHWI filter using AVX2 or NEON int8 dot products.
+ * 1x1 convolutions with stride 1 read the input directly. Output channels are
+ * split across a small thread pool.
+ *
+ * The input zero point is folded in once per output channel
+ * (sum((x - zp) * w) == sum(x * w) - zp * sum(w)), padding is filled with the
+ * zero point, and requantization uses the same MultiplyByQuantizedMultiplier()
+ * as the reference, so the results are identical to the last bit.
+ *
+ * Anything else (dilation, grouped convolutions, int4 or int16 tensors) is
+ * handed to the reference kernel. Add, Mul, Concatenation and
+ * ResizeNearestNeighbor stay on the reference kernels: they are memory bound and
+ * already copy whole rows.
+ */
+class RvcInt8Kernels {
+public:
+    static constexpr int kMaxThreads = 8;
+
+    // Drop-in registrations for MicroMutableOpResolver::AddConv2D() and AddMaxPool2D().
+    static TFLMRegistration Conv2DRegistration();
+    static TFLMRegistration MaxPool2DRegistration();
+
+    // Threads used per Conv2D, including the calling one. Set before the interpreter
+    // allocates its tensors: the im2col scratch is sized for this many threads.
+    static void SetThreadCount(int threads);
+    static int ThreadCount();
+
+    // Name of the instruction set the kernels were built for.
+    static const char * SimdName();
+
+    // Raw kernels, used by the registrations and by bench-int8-kernels.
+    static size_t ConvScratchBytes(const RvcConvInt8Params & params, int threads);
+    static void ConvInt8(const RvcConvInt8Params & params, const int8_t * input, const int8_t * filter, const int32_t * bias,
+                         int8_t * output, int8_t * scratch, int threads);
+    static void MaxPoolInt8(const RvcPoolInt8Params & params, const int8_t * input, int8_t * output);
+};
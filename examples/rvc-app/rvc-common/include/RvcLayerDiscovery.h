@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Forward declarations to avoid including heavy TFLM headers here
+namespace tflite {
+    struct Model;
+}
+
+// A Conv2D whose filter (and bias) can be trained, identified by tensor indices of subgraph 0.
+struct RvcTrainableLayer {
+    int operatorIndex = -1;
+    int inputTensor = -1;
+    int filterTensor = -1;
+    int biasTensor = -1; // -1 if the convolution has no bias
+    int outputTensor = -1;
+    std::string name;    // Output tensor name, for logs
+};
+
+enum class RvcLayerSelector : uint8_t {
+    kClassificationHeads, // Final conv of every class branch: no activation, one channel per class
+    kDetectionHeads,      // Final conv of every class and box branch
+    kByName,              // Any Conv2D whose filter or output tensor name contains namePattern
+};
+
+struct RvcLayerQuery {
+    RvcLayerSelector selector = RvcLayerSelector::kClassificationHeads;
+    std::string namePattern;
+};
+
+/**
+ * @brief Finds the trainable layers of a model by walking its operator graph.
+ *
+ * Replaces hard-coded tensor indices, which differ between model variants:
+ * - A detection head is a Conv2D that is not followed by an activation
+ *   (LOGISTIC/MUL, i.e. SiLU), does not read a SOFTMAX output (the fixed DFL
+ *   convolution) and whose output reaches a graph output.
+ * - Class heads are the ones with one output channel per class, the class
+ *   count being taken from the model output ([1, anchors, 4 + classes]).
+ *
+ * Layers are returned largest grid first, i.e. in the anchor order of the
+ * model output. Results are cached per model hash and query, so switching
+ * back to a model variant does not walk the graph again.
+ */
+class RvcLayerDiscovery {
+public:
+    // modelHash identifies the model variant, see ModelHash().
+    static bool Discover(const tflite::Model * model, uint64_t modelHash, const RvcLayerQuery & query,
+                         std::vector<RvcTrainableLayer> & layers);
+
+    // FNV-1a over the model flatbuffer.
+    static uint64_t ModelHash(const void * data, size_t size);
+
+private:
+    static bool Walk(const tflite::Model * model, const RvcLayerQuery & query, std::vector<RvcTrainableLayer> & layers);
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief The bytes of a .tflite model, either mapped from a file or compiled in.
+ *
+ * Files are mapped rather than read, so only the pages the interpreter touches
+ * are ever loaded, and they are shared with the page cache. Map() verifies the
+ * flatbuffer once; after that the interpreter trusts it.
+ *
+ * In training mode the weights are written in place, so the mapping is then
+ * private (copy-on-write): only the pages of the trained heads get copied, and
+ * nothing is ever written back to the file.
+ */
+class RvcModelFile {
+public:
+    RvcModelFile();
+    ~RvcModelFile();
+
+    RvcModelFile(const RvcModelFile &) = delete;
+    RvcModelFile & operator=(const RvcModelFile &) = delete;
+
+    bool Map(const std::string & path, bool writable);
+
+    // Uses a model that is already in memory, e.g. the compiled-in array. Not verified.
+    void UseEmbedded(const uint8_t * data, size_t size);
+
+    static bool Verify(const uint8_t * data, size_t size);
+
+    const uint8_t * Data() const { return mData; }
+    size_t Size() const { return mSize; }
+    bool IsMapped() const { return mMapped; }
+    const std::string & Path() const { return mPath; }
+
+private:
+    void Unmap();
+
+    const uint8_t * mData;
+    size_t mSize;
+    bool mMapped;
+    std::string mPath;
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * What the robot is doing, as far as perception is concerned. Set from the
+ * RvcDevice operational state.
+ */
+enum class RvcAIActivity : uint8_t {
+    kCleaning, // Running or returning to the dock: the robot moves
+    kIdle,     // Stopped, paused or in error away from the dock
+    kDocked,   // Docked, charging or running a dock task
+    kCount,
+};
+
+/**
+ * When a model runs: every period[activity]-th frame, 0 meaning never in that
+ * activity. Models that are due on the same frame run in priority order.
+ */
+struct RvcModelSchedule {
+    uint8_t priority = 0; // Higher runs first
+    std::array<uint16_t, static_cast<size_t>(RvcAIActivity::kCount)> period = {};
+};
+
+/**
+ * @brief Decides which of the models sharing the tensor arena run on each frame.
+ *
+ * All models run on the inference worker, one after the other, so the number
+ * of models per frame bounds the frame latency. Each frame, up to
+ * SetMaxModelsPerFrame() of the due models are picked: highest priority first,
+ * then the one that has waited longest past its period. A model that is not
+ * picked stays due and is considered again on the next frame.
+ *
+ * SetActivity() only stores the activity and RunsIn() only reads an atomic
+ * copy of the schedule, so both are safe to call from the CHIP thread while the
+ * worker swaps models; NextFrame() is for the inference worker only.
+ */
+class RvcModelScheduler {
+public:
+    static constexpr size_t kMaxModels = 4;
+
+    RvcModelScheduler();
+
+    // Slot numbers are chosen by the caller and identify the model in NextFrame() masks.
+    bool SetSchedule(size_t slot, const RvcModelSchedule & schedule);
+    void RemoveSchedule(size_t slot);
+    // Whether the model in the slot runs at all in the activity, i.e. has a non-zero period. Any thread.
+    bool RunsIn(size_t slot, RvcAIActivity activity) const;
+
+    void SetMaxModelsPerFrame(size_t count) { mMaxModelsPerFrame = count; }
+
+    void SetActivity(RvcAIActivity activity) { mActivity.store(activity); }
+    RvcAIActivity GetActivity() const { return mActivity.load(); }
+
+    // Returns the slots to run on the next frame, bit n standing for slot n.
+    uint32_t NextFrame();
+
+private:
+    struct Entry {
+        RvcModelSchedule schedule;
+        bool active = false;
+        uint32_t framesSinceRun = 0;
+        // Bit n set if the model runs in activity n; what RunsIn() reads from other threads.
+        std::atomic<uint8_t> activities{ 0 };
+    };
+    static_assert(static_cast<size_t>(RvcAIActivity::kCount) <= 8, "Entry::activities has one bit per activity");
+
+    // Frames a model has waited beyond its period; only meaningful if it is due.
+    static uint32_t Lateness(const Entry & entry, uint16_t period) { return entry.framesSinceRun + 1 - period; }
+
+    std::array<Entry, kMaxModels> mEntries;
+    size_t mMaxModelsPerFrame = 2;
+    std::atomic<RvcAIActivity> mActivity{ RvcAIActivity::kCleaning };
+};
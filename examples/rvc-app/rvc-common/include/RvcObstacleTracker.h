@@ -0,0 +1,81 @@
+#pragma once
+
+#include "RvcDetection.h"
+
+#include <cstddef>
+#include <cstdint>
+
+// An object followed across frames.
+struct RvcTrackedObstacle {
+    uint32_t trackId = 0;
+    int classId = 0;
+    float confidence = 0.0f; // Smoothed detection score
+    float x1 = 0.0f, y1 = 0.0f, x2 = 0.0f, y2 = 0.0f; // Last matched box, in frame pixels
+    uint32_t hits = 0;         // Frames the object was detected in
+    uint32_t missedFrames = 0; // Consecutive frames without a match
+    bool confirmed = false;    // Reported to controllers
+};
+
+// What changed for controllers in one frame. Only confirmed tracks are listed.
+struct RvcObstacleChanges {
+    size_t appearedCount = 0;
+    uint32_t appeared[kRvcMaxDetections];          // Track ids, now in the track list
+    size_t clearedCount = 0;
+    RvcTrackedObstacle cleared[kRvcMaxDetections]; // Copies: these tracks are gone
+    bool confidenceChanged = false; // A confirmed track moved to another confidence step
+
+    bool Any() const { return appearedCount > 0 || clearedCount > 0 || confidenceChanged; }
+};
+
+/**
+ * @brief Turns per-frame detections into stable obstacle tracks.
+ *
+ * Each frame, detections are matched to existing tracks of the same class by
+ * IoU (best overlap first). Unmatched detections start new tracks; tracks
+ * that go unmatched for more than maxMissedFrames frames are dropped. A track
+ * is confirmed, i.e. reported, once it was matched in confirmFrames frames.
+ *
+ * The result is that an object seen in every frame produces one "appeared"
+ * change, an object flickering for a frame or two produces none, and a
+ * detector running at 10+ fps does not turn into 10+ updates per second.
+ *
+ * Nothing is allocated; not thread-safe.
+ */
+class RvcObstacleTracker {
+public:
+    static constexpr size_t kMaxTracks = kRvcMaxDetections;
+
+    struct Config {
+        float matchIoU = 0.3f;
+        float minScore = 0.5f;          // Detections below this are ignored
+        uint32_t confirmFrames = 1;     // 1: reported in the first frame it is seen in
+        uint32_t maxMissedFrames = 5;   // ~0.5 s at 10 fps
+        float confidenceStep = 0.1f;    // Confidence changes smaller than this are not reported
+        float confidenceSmoothing = 0.5f; // Weight of the newest score in the running average
+    };
+
+    RvcObstacleTracker();
+
+    void Configure(const Config & config) { mConfig = config; }
+    const Config & GetConfig() const { return mConfig; }
+
+    // Matches one frame's detections and reports what controllers need to learn about.
+    void Update(const RvcDetectionResult & result, RvcObstacleChanges & changes);
+
+    // Drops every track, e.g. when the camera stops. Confirmed tracks are reported as cleared.
+    void Clear(RvcObstacleChanges & changes);
+
+    size_t GetTrackCount() const { return mTrackCount; }
+    const RvcTrackedObstacle & GetTrack(size_t index) const { return mTracks[index]; }
+    const RvcTrackedObstacle * FindTrack(uint32_t trackId) const;
+
+private:
+    static float IoU(const RvcTrackedObstacle & track, const RvcDetection & detection);
+    static int ConfidenceStep(float confidence, float step);
+    void RemoveTrack(size_t index, RvcObstacleChanges & changes);
+
+    Config mConfig;
+    RvcTrackedObstacle mTracks[kMaxTracks];
+    size_t mTrackCount;
+    uint32_t mNextTrackId;
+};
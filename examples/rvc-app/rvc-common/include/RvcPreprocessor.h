@@ -0,0 +1,86 @@
+#pragma once
+
+#include "RvcFrameQueue.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Writes camera frames straight into the int8 model input tensor.
+ *
+ * Replaces the decode -> stbir resize -> quantize sequence (three passes and
+ * two frame-sized allocations) with a single pass per output row:
+ * - The letterbox geometry and the source offsets/weights of every output
+ *   pixel are computed once per source resolution in Configure().
+ * - Each output row is gathered from the source through those tables
+ *   (nearest or bilinear), converting YUV to RGB on the fly when needed.
+ * - The int8 zero-point shift is applied to the row while it is still in
+ *   cache, with SSE2/NEON when the model uses the usual (1/255, -128) input
+ *   quantization and through a 256-entry lookup table otherwise.
+ *
+ * Nothing is allocated per frame.
+ */
+class RvcPreprocessor {
+public:
+    enum class ResizeMode : uint8_t {
+        kNearest,
+        kBilinear,
+    };
+
+    struct Config {
+        int srcWidth = 0;
+        int srcHeight = 0;
+        RvcCameraFrame::PixelFormat srcFormat = RvcCameraFrame::PixelFormat::kRgb888;
+        int dstWidth = 0;
+        int dstHeight = 0;
+        float inputScale = 1.0f / 255.0f; // Quantization of the model input tensor
+        int inputZeroPoint = -128;
+        ResizeMode resizeMode = ResizeMode::kBilinear;
+        uint8_t padValue = 114; // Letterbox colour used by the YOLO exporters
+    };
+
+    RvcPreprocessor();
+
+    bool Configure(const Config & config);
+
+    // True if frames of this geometry can be processed without calling Configure() again.
+    bool Matches(int srcWidth, int srcHeight, RvcCameraFrame::PixelFormat format) const;
+
+    // Fills dst (dstWidth * dstHeight * 3 int8 values, NHWC) from an image in the configured source format.
+    // NV12 frames are a full-resolution Y plane followed by an interleaved half-resolution UV plane.
+    void Run(const uint8_t * src, int8_t * dst) const;
+
+    // Maps a point of the model input, normalised to [0, 1], to source pixels, clamped to the source frame.
+    // Undoes the letterbox for boxes decoded from the model output.
+    void ModelToSource(float & x, float & y) const;
+    // Maps source pixels to the normalised model input; the inverse of ModelToSource().
+    void SourceToModel(float & x, float & y) const;
+
+private:
+    void BuildTables();
+    void FillRow(const uint8_t * src, int contentY, uint8_t * row) const;
+    void SampleRgbNearest(const uint8_t * srcRow, uint8_t * out) const;
+    void SampleRgbBilinear(const uint8_t * srcRow0, const uint8_t * srcRow1, int wy, uint8_t * out) const;
+    void SampleNv12(const uint8_t * src, int contentY, uint8_t * out) const;
+    void Quantize(uint8_t * row, size_t count) const;
+
+    Config mConfig;
+    bool mConfigured;
+    bool mShiftOnly; // Quantization is q = pixel - 128, i.e. a sign-bit flip
+    int8_t mLut[256];
+    ResizeMode mMode; // Mode actually used for the configured geometry
+
+    // Letterbox geometry: content is placed at (mOffsetX, mOffsetY) with size mContentWidth x mContentHeight.
+    int mContentWidth;
+    int mContentHeight;
+    int mOffsetX;
+    int mOffsetY;
+
+    // Per output column / row of the content area: source pixel (nearest or left/top tap) and
+    // 7-bit weight of the right/bottom tap for bilinear sampling.
+    std::vector<int32_t> mSrcX;
+    std::vector<uint8_t> mWeightX;
+    std::vector<int32_t> mSrcY;
+    std::vector<uint8_t> mWeightY;
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+// Forward declarations to avoid including heavy TFLM headers here
+namespace tflite {
+    struct Model;
+}
+struct TfLiteEvalTensor;
+
+/**
+ * @brief An int8 weight tensor paired with an fp32 master copy.
+ *
+ * The quantization parameters (per-channel scales and zero points, and the
+ * quantized dimension) are read from the model flatbuffer, so dequantizing
+ * and requantizing is exact instead of assuming a 1/127 scale.
+ *
+ * Training and the float weight API work on the master copy only. The int8
+ * tensor used by the interpreter is rewritten in one SIMD pass by Commit()
+ * (see RvcTrainerKernels), which callers run when the updated weights must
+ * become visible.
+ */
+class RvcQuantizedWeights {
+public:
+    RvcQuantizedWeights();
+
+    // Binds to a constant int8 tensor (e.g. from RvcAIInterface::GetWeightTensor()) and
+    // loads the master copy from it.
+    bool Bind(const tflite::Model * model, int tensorIndex, TfLiteEvalTensor * tensor);
+    bool IsBound() const { return mTensor != nullptr; }
+    int TensorIndex() const { return mTensorIndex; }
+
+    size_t Count() const { return mCount; }
+    int ChannelCount() const { return static_cast<int>(mScales.size()); }
+    // Number of consecutive elements that share a channel when the quantized dimension is the outermost one.
+    size_t ChannelSize() const { return mChannelSize; }
+    float Scale(int channel) const { return mScales[channel]; }
+    int ZeroPoint(int channel) const { return mZeroPoints[channel]; }
+
+    // fp32 master copy, 64-byte aligned. Call MarkDirty() after writing to it.
+    float * Master() { return mMaster.get(); }
+    const float * Master() const { return mMaster.get(); }
+    void MarkDirty() { mDirty = true; }
+    bool IsDirty() const { return mDirty; }
+
+    // Reloads the master copy from the int8 tensor (after it was written directly).
+    void Dequantize();
+
+    // Requantizes the master copy into the int8 tensor. No-op if nothing changed.
+    void Commit();
+
+    int8_t * Int8Data() const;
+
+private:
+    struct AlignedFree {
+        void operator()(float * p) const { std::free(p); }
+    };
+
+    TfLiteEvalTensor * mTensor;
+    int mTensorIndex;
+    size_t mCount;
+    size_t mChannelSize;
+    bool mPerChannelOuter; // Quantized dimension is 0 (Conv2D OHWI); otherwise it is the innermost one
+    bool mDirty;
+
+    std::vector<float> mScales;
+    std::vector<int32_t> mZeroPoints;
+    std::unique_ptr<float[], AlignedFree> mMaster;
+};
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "RvcDetection.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// One stored sample. The pointers point into the mapped file and stay valid
+// while the store is locked.
+struct RvcReplaySample {
+    const int8_t * input = nullptr; // Preprocessed model input
+    const RvcTrainingBox * boxes = nullptr;
+    size_t numBoxes = 0;
+    bool pseudoLabel = false; // Labelled by the model itself rather than by a user
+};
+
+/**
+ * @brief On-disk store of training samples, memory-mapped.
+ *
+ * Samples are kept as already preprocessed int8 model inputs plus their boxes,
+ * so training and evaluation never decode images. The file is a header
+ * followed by fixed-size slots:
+ *
+ *     FileHeader | slot 0 | slot 1 | ... | slot capacity-1
+ *     slot = SlotHeader | RvcTrainingBox[kMaxBoxes] | int8 input[inputBytes]
+ *
+ * Slots are appended until the byte budget is used up. After that, reservoir
+ * sampling decides whether a new sample replaces a random slot, so the store
+ * stays a uniform sample of everything seen, across restarts.
+ *
+ * Every kHoldoutStride-th slot is held out for evaluation and never trained on.
+ */
+class RvcReplayStore {
+public:
+    static constexpr size_t kMaxBoxes = kRvcMaxDetections;
+    static constexpr size_t kHoldoutStride = 10;
+
+    RvcReplayStore();
+    ~RvcReplayStore();
+
+    // Maps the store at path, creating it if needed. An existing file is reused only if it
+    // was created for the same input size and budget; otherwise it is reset.
+    bool Open(const std::string & path, size_t inputBytes, size_t byteBudget);
+    void Close();
+    bool IsOpen() const { return mBase != nullptr; }
+
+    // Offers a sample to the reservoir. With wait == false, gives up instead of blocking if
+    // the store is in use (for the inference worker). Returns true if the sample was stored.
+    bool Add(const int8_t * input, size_t inputBytes, const RvcTrainingBox * boxes, size_t numBoxes, bool pseudoLabel,
+             bool wait = true);
+
+    size_t Size() const;
+    size_t Capacity() const { return mCapacity; }
+    size_t InputBytes() const { return mInputBytes; }
+
+    // Hold the lock while using samples returned by Get(). The other methods take it
+    // themselves, so do not call them while holding it.
+    std::unique_lock<std::mutex> Lock() const { return std::unique_lock<std::mutex>(mMutex); }
+    bool Get(size_t index, RvcReplaySample & sample) const;
+
+    // Indices of the stored training (or held-out) samples, shuffled.
+    void GetSplit(bool holdout, std::vector<uint32_t> & indices);
+
+    static bool IsHoldout(size_t index) { return index % kHoldoutStride == kHoldoutStride - 1; }
+
+    // Starts writing dirty pages back to the file.
+    void Flush();
+
+private:
+    struct FileHeader;
+    struct SlotHeader;
+
+    FileHeader * Header() const;
+    uint8_t * Slot(size_t index) const;
+    uint64_t NextRandom();
+
+    mutable std::mutex mMutex;
+    int mFd;
+    uint8_t * mBase;
+    size_t mMappedBytes;
+    size_t mInputBytes;
+    size_t mSlotBytes;
+    size_t mCapacity;
+};
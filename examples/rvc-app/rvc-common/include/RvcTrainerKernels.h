@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Vector kernels for the training hot paths.
+ *
+ * Every kernel has an AVX2 (or SSE2) and a NEON path, chosen at compile time
+ * like RvcInt8Kernels, plus a scalar loop for the tail and for other targets.
+ * The integer kernels give the same result on every path. The float kernels
+ * may differ from the scalar loop in the last bit, since the vector paths fuse
+ * or reorder the same operations.
+ *
+ * None of them allocate: callers own every buffer.
+ */
+class RvcTrainerKernels {
+public:
+    // weights[i] = saturate_int8(weights[i] + deltas[i])
+    static void AddSaturateInt8(int8_t * weights, const int8_t * deltas, size_t count);
+    // weights[i] = saturate_int8(weights[i] - deltas[i])
+    static void SubSaturateInt8(int8_t * weights, const int8_t * deltas, size_t count);
+
+    // dst[i] = (src[i] - zeroPoint) * scale
+    static void Dequantize(const int8_t * src, float * dst, size_t count, float scale, int zeroPoint);
+    // dst[i] = clamp(round_half_even(src[i] * inverseScale) + zeroPoint, lo, 127), with lo = -127 for
+    // symmetric weights (zeroPoint == 0) and -128 otherwise.
+    static void Requantize(const float * src, int8_t * dst, size_t count, float inverseScale, int zeroPoint);
+
+    // dst[i] += src[i]. Used to sum gradients over the samples of a micro-batch.
+    static void Accumulate(float * dst, const float * src, size_t count);
+    // dst[i] += scale * src[i]
+    static void MultiplyAccumulate(float * dst, const float * src, float scale, size_t count);
+
+    // SGD with momentum and weight decay. gradientScale turns accumulated gradient sums into means.
+    //   velocity = momentum * velocity + gradientScale * gradients + weightDecay * weights
+    //   weights -= learningRate * velocity
+    static void MomentumStep(float * weights, float * velocity, const float * gradients, size_t count, float momentum,
+                             float weightDecay, float learningRate, float gradientScale);
+
+    // Name of the instruction set the kernels were built for.
+    static const char * SimdName();
+};
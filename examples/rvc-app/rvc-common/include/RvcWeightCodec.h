@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Wire encodings for int8 weight exchange with the Flower server.
+ *
+ * The encoding is carried in Parameters::tensor_type:
+ * - "int8":        the raw weights, one byte per weight.
+ * - "int8-sparse": only the weights that differ from a baseline both sides
+ *                  know (the global weights of the current round), as runs:
+ *                      repeated { varint skip; varint count; count int8 values }
+ *                  where skip is the number of unchanged weights before the run.
+ *                  Weights not covered by a run keep their baseline value.
+ *
+ * Most rounds change a small fraction of the head weights, so the sparse form
+ * is typically a few KB instead of ~92 KB.
+ */
+class RvcWeightCodec {
+public:
+    static constexpr const char * kDenseType = "int8";
+    static constexpr const char * kSparseType = "int8-sparse";
+
+    // Encodes current against baseline. If topK is non-zero, only the topK weights with the
+    // largest change are kept; the others are sent as unchanged. Returns the number of weights sent.
+    // scratch is reused between calls to avoid allocating per round.
+    static size_t EncodeSparse(const int8_t * baseline, const int8_t * current, size_t count, size_t topK,
+                               std::string & out, std::vector<uint32_t> & scratch);
+
+    // Applies a sparse encoding in place on top of the baseline weights. Returns false if the
+    // encoding is malformed or runs past count (weights may then be partially updated).
+    static bool ApplySparse(const std::string & in, int8_t * weights, size_t count);
+
+private:
+    static void PutVarint(std::string & out, uint32_t value);
+    static bool GetVarint(const uint8_t *& p, const uint8_t * end, uint32_t & value);
+};
@@ -1,6 +1,9 @@
 #pragma once
 
+#include "RvcDetection.h"
+#include "RvcObstacleTracker.h"
 #include "rvc-mode-delegates.h"
+#include "rvc-obstacle-detection-cluster.h"
 #include "rvc-operational-state-delegate.h"
 #include "rvc-service-area-delegate.h"
 #include "rvc-service-area-storage-delegate.h"
@@ -8,8 +11,10 @@
 #include <app/clusters/operational-state-server/operational-state-server.h>
 #include <app/clusters/service-area-server/service-area-delegate.h>
 #include <app/clusters/service-area-server/service-area-server.h>
+#include <app/server-cluster/ServerClusterInterfaceRegistry.h>
 
 #include <string>
+#include <vector>
 
 namespace chip {
 namespace app {
@@ -31,11 +36,34 @@ private:
     ServiceArea::RvcServiceAreaStorageDelegate mStorageDelegate;
     ServiceArea::Instance mServiceAreaInstance;
 
+    RvcObstacleTracker mObstacleTracker;
+    RegisteredServerCluster<RvcObstacleDetection::Cluster> mObstacleCluster;
+
     bool mDocked   = false;
     bool mCharging = false;
 
     uint8_t mStateBeforePause = 0;
 
+    bool mInMessageBatch = false;
+
+public:
+    using OperationalStateChangedCallback = void (*)(uint8_t operationalState, void * context);
+
+private:
+    OperationalStateChangedCallback mStateChangedCallback = nullptr;
+    void * mStateChangedContext                            = nullptr;
+
+    /**
+     * Sets the operational state and notifies the registered OperationalStateChangedCallback.
+     */
+    CHIP_ERROR SetOperationalState(uint8_t aOpState);
+
+    /**
+     * Saves the supported maps and areas if they changed, so that they are restored at start-up. Within a message batch this is
+     * deferred to EndMessageBatch().
+     */
+    void SaveServiceAreaMapsIfChanged();
+
 public:
     /**
      * This class is responsible for initialising all the RVC clusters and managing the interactions between them as required by
@@ -47,7 +75,8 @@ public:
         mCleanModeInstance(&mCleanModeDelegate, aRvcClustersEndpoint, RvcCleanMode::Id, 0), mOperationalStateDelegate(),
         mOperationalStateInstance(&mOperationalStateDelegate, aRvcClustersEndpoint), mServiceAreaDelegate(),
         mServiceAreaInstance(&mStorageDelegate, &mServiceAreaDelegate, aRvcClustersEndpoint,
-                             BitMask<ServiceArea::Feature>(ServiceArea::Feature::kMaps, ServiceArea::Feature::kProgressReporting))
+                             BitMask<ServiceArea::Feature>(ServiceArea::Feature::kMaps, ServiceArea::Feature::kProgressReporting)),
+        mObstacleCluster(aRvcClustersEndpoint)
     {
         // set the current-mode at start-up
         mRunModeInstance.UpdateCurrentMode(RvcRunMode::ModeIdle);
@@ -73,6 +102,16 @@ public:
      */
     void Init();
 
+    ~RvcDevice();
+
+    /**
+     * Registers a function that is called on the CHIP thread after every operational state change, e.g. to run background
+     * work only while the device is docked. The callback must not block.
+     */
+    void SetOperationalStateChangedCallback(OperationalStateChangedCallback aCallback, void * aContext);
+
+    uint8_t GetCurrentOperationalState() { return mOperationalStateInstance.GetCurrentOperationalState(); }
+
     /**
      * Sets the device to an idle state, that is either the STOPPED, DOCKED or CHARGING state, depending on physical information.
      * Note: in this example this is based on the mDocked and mChanging boolean variables.
@@ -137,6 +176,28 @@ public:
 
     void HandleAreaCompletedEvent();
 
+    /**
+     * Sets the Service Area progress status of an area, as reported by the navigation process.
+     */
+    void HandleProgressStatusMessage(uint32_t areaId, ServiceArea::OperationalStatusEnum status);
+
+    /**
+     * Sets the estimated time left for an area, as reported by the navigation process. Estimate-only changes are rate limited
+     * by the Service Area cluster.
+     */
+    void HandleProgressEstimateMessage(uint32_t areaId, const DataModel::Nullable<uint32_t> & estimatedTime);
+
+    /**
+     * Messages handled between BeginMessageBatch() and EndMessageBatch() are reported as one Service Area transaction, so a
+     * batch of progress updates results in one report per changed attribute, and map edits in the batch are saved once.
+     */
+    void BeginMessageBatch();
+
+    void EndMessageBatch();
+
+    /**
+     * Edits to the supported maps and areas. Each change is persisted, like HandleImportServiceAreaMaps().
+     */
     void HandleAddServiceAreaMap(uint32_t mapId, const CharSpan & mapName);
 
     void HandleAddServiceAreaArea(ServiceArea::AreaStructureWrapper & area);
@@ -145,6 +206,14 @@ public:
 
     void HandleRemoveServiceAreaArea(uint32_t areaId);
 
+    /**
+     * Replaces the supported maps and areas with a whole floor plan, e.g. after an exploration run. The change is applied as one
+     * ServiceArea transaction, so each attribute is reported once, and the result is persisted so that it is restored at start-up.
+     * Entries that fail the cluster's validation are skipped.
+     */
+    void HandleImportServiceAreaMaps(const std::vector<ServiceArea::MapStructureWrapper> & maps,
+                                     std::vector<ServiceArea::AreaStructureWrapper> & areas);
+
     /**
      * Sets the device to an error state with the error state ID matching the error name given.
      * @param error The error name. Could be one of UnableToStartOrResume, UnableToCompleteOperation, CommandInvalidInState,
@@ -162,6 +231,19 @@ public:
      * Sets any remaining Operating or Pending states to Skipped.
      */
     void UpdateServiceAreaProgressOnExit();
+
+    /**
+     * Feeds one frame of obstacle detections into the tracker and publishes the resulting changes through the
+     * RvcObstacleDetection cluster. Must be called on the CHIP thread.
+     */
+    void HandleDetectionResult(const RvcDetectionResult & result);
+
+    /**
+     * Drops every tracked obstacle and publishes them as cleared, for when the detector stops watching: the camera or the
+     * inference worker stopped, or the robot moved to an activity the detector is not scheduled in (by default, onto its
+     * dock). Must be called on the CHIP thread.
+     */
+    void ClearObstacles();
 };
 
 } // namespace Clusters
@@ -0,0 +1,155 @@
+/*
+ *
+ *    Copyright (c) 2025 Project CHIP Authors
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include "RvcObstacleTracker.h"
+
+#include <app/EventLoggingTypes.h>
+#include <app/data-model/Nullable.h>
+#include <app/server-cluster/DefaultServerCluster.h>
+#include <lib/core/DataModelTypes.h>
+#include <system/SystemClock.h>
+
+#include <array>
+
+namespace chip {
+namespace app {
+namespace Clusters {
+namespace RvcObstacleDetection {
+
+// Manufacturer-specific cluster, under the test vendor prefix. Not part of the ZAP configuration: the cluster is
+// implemented in code and registered on the RVC endpoint by RvcDevice.
+inline constexpr ClusterId Id       = 0xFFF1FC40;
+inline constexpr uint32_t kRevision = 1;
+
+namespace Structs {
+namespace ObstacleStruct {
+enum class Fields : uint8_t
+{
+    kTrackID    = 0,
+    kClassID    = 1,
+    kConfidence = 2,
+    kAreaID     = 3,
+};
+
+struct Type
+{
+    static constexpr bool kIsFabricScoped = false;
+
+    uint32_t trackID   = 0;
+    uint16_t classID   = 0;
+    Percent confidence = 0;
+    DataModel::Nullable<uint32_t> areaID; // ServiceArea CurrentArea when the obstacle was first seen
+
+    CHIP_ERROR Encode(TLV::TLVWriter & aWriter, TLV::Tag aTag) const;
+};
+} // namespace ObstacleStruct
+} // namespace Structs
+
+namespace Attributes {
+namespace Obstacles {
+inline constexpr AttributeId Id = 0x0000; // list<ObstacleStruct>, the obstacles currently tracked
+} // namespace Obstacles
+namespace SuppressedEventCount {
+inline constexpr AttributeId Id = 0x0001; // uint32, events dropped by the rate limit since start-up
+} // namespace SuppressedEventCount
+} // namespace Attributes
+
+namespace Events {
+// Both events carry the fields of ObstacleStruct.
+template <EventId kEventId>
+struct ObstacleEventType
+{
+    static constexpr PriorityLevel GetPriorityLevel() { return PriorityLevel::Info; }
+    static constexpr EventId GetEventId() { return kEventId; }
+    static constexpr ClusterId GetClusterId() { return RvcObstacleDetection::Id; }
+    static constexpr bool kIsFabricScoped = false;
+
+    Structs::ObstacleStruct::Type obstacle;
+
+    CHIP_ERROR Encode(TLV::TLVWriter & aWriter, TLV::Tag aTag) const { return obstacle.Encode(aWriter, aTag); }
+};
+
+namespace ObstacleDetected {
+inline constexpr EventId Id = 0x0000;
+using Type                  = ObstacleEventType<Id>;
+} // namespace ObstacleDetected
+namespace ObstacleCleared {
+inline constexpr EventId Id = 0x0001;
+using Type                  = ObstacleEventType<Id>;
+} // namespace ObstacleCleared
+} // namespace Events
+
+/**
+ * Publishes the obstacles tracked by RvcObstacleTracker. Reporting traffic is bounded regardless of the detector frame rate:
+ * - An obstacle appearing or clearing changes the Obstacles list right away (the same frame) and generates one event.
+ * - Confidence changes alone are folded into the list at most once per kMinConfidenceReportInterval.
+ * - Events are rate limited by a token bucket (kEventBurst, then one per kEventRefillInterval); events that do not fit are
+ *   dropped and counted in SuppressedEventCount, while the Obstacles list stays accurate.
+ */
+class Cluster : public DefaultServerCluster
+{
+public:
+    static constexpr System::Clock::Milliseconds32 kMinConfidenceReportInterval = System::Clock::Milliseconds32(2000);
+    static constexpr uint32_t kEventBurst                                        = 8;
+    static constexpr System::Clock::Milliseconds32 kEventRefillInterval          = System::Clock::Milliseconds32(250);
+
+    Cluster(EndpointId endpointId);
+
+    // Server cluster implementation
+    DataModel::ActionReturnStatus ReadAttribute(const DataModel::ReadAttributeRequest & request,
+                                                AttributeValueEncoder & encoder) override;
+    CHIP_ERROR Attributes(const ConcreteClusterPath & path, ReadOnlyBufferBuilder<DataModel::AttributeEntry> & builder) override;
+    void Shutdown() override;
+
+    /**
+     * Publishes the outcome of one tracker update. Call it for every processed frame, including frames without changes, and
+     * after RvcObstacleTracker::Clear(). A coalesced confidence update goes out with a later call once its interval has
+     * passed, or from a timer if no further call comes, e.g. because the detector stopped.
+     * @param tracker Read again by that timer, so it must outlive the cluster.
+     * @param areaId The ServiceArea CurrentArea, recorded for obstacles that appeared in this frame.
+     */
+    void Publish(const RvcObstacleTracker & tracker, const RvcObstacleChanges & changes,
+                 const DataModel::Nullable<uint32_t> & areaId);
+
+private:
+    static void HandleConfidenceReportTimer(System::Layer * layer, void * context);
+    bool TakeEventToken(System::Clock::Timestamp now);
+    const Structs::ObstacleStruct::Type * FindObstacle(uint32_t trackId) const;
+    template <typename EventType>
+    void GenerateObstacleEvent(const Structs::ObstacleStruct::Type & obstacle, System::Clock::Timestamp now);
+    void RebuildObstacles(const RvcObstacleTracker & tracker, const DataModel::Nullable<uint32_t> & areaId);
+
+    std::array<Structs::ObstacleStruct::Type, RvcObstacleTracker::kMaxTracks> mObstacles;
+    size_t mObstacleCount = 0;
+
+    const RvcObstacleTracker * mTracker = nullptr; // From the last Publish(), for the confidence report timer
+    bool mConfidencePending             = false;
+    System::Clock::Timestamp mLastListReport{ 0 };
+
+    uint32_t mEventTokens = kEventBurst;
+    System::Clock::Timestamp mLastRefill{ 0 };
+    uint32_t mSuppressedEventCount  = 0;
+    bool mSuppressedEventCountDirty = false;
+};
+
+} // namespace RvcObstacleDetection
+} // namespace Clusters
+} // namespace app
+} // namespace chip
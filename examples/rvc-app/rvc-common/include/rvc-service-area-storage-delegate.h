@@ -20,7 +20,9 @@
 
 #include <app/clusters/service-area-server/service-area-storage-delegate.h>
 #include <app/util/config.h>
+#include <lib/core/CHIPPersistentStorageDelegate.h>
 #include <cstring>
+#include <unordered_map>
 #include <vector>
 
 namespace chip {
@@ -40,6 +42,13 @@ private:
     std::vector<uint32_t> mSelectedAreas;
     std::vector<ServiceArea::Structs::ProgressStruct::Type> mProgressList;
 
+    // ID -> position in mSupportedAreas/mSupportedMaps. Kept in step with every change to the lists.
+    std::unordered_map<uint32_t, uint32_t> mSupportedAreaIndex;
+    std::unordered_map<uint32_t, uint32_t> mSupportedMapIndex;
+
+    // Set by every change to mSupportedAreas/mSupportedMaps, cleared by TakeSupportedMapsChanged().
+    bool mSupportedMapsChanged = false;
+
 public:
     //*************************************************************************
     // Supported Areas accessors
@@ -50,6 +59,8 @@ public:
 
     bool GetSupportedAreaById(uint32_t aAreaId, uint32_t & listIndex, AreaStructureWrapper & supportedArea) override;
 
+    bool IsSupportedArea(uint32_t aAreaId) override;
+
     bool AddSupportedAreaRaw(const AreaStructureWrapper & newArea, uint32_t & listIndex) override;
 
     bool ModifySupportedAreaRaw(uint32_t listIndex, const AreaStructureWrapper & modifiedArea) override;
@@ -105,6 +116,32 @@ public:
     bool ClearProgressRaw() override;
 
     bool RemoveProgressElementRaw(uint32_t areaId) override;
+
+    //*************************************************************************
+    // Persistence
+
+    /**
+     * Saves the supported maps and areas to aStorage as a single TLV blob.
+     */
+    CHIP_ERROR SaveSupportedMaps(PersistentStorageDelegate & aStorage);
+
+    /**
+     * Reads the maps and areas saved by SaveSupportedMaps. Returns CHIP_ERROR_PERSISTED_STORAGE_VALUE_NOT_FOUND if nothing was
+     * saved. The lists are not modified by this; the caller adds the entries through the server instance, which validates them.
+     */
+    CHIP_ERROR LoadSupportedMaps(PersistentStorageDelegate & aStorage, std::vector<MapStructureWrapper> & aMaps,
+                                 std::vector<AreaStructureWrapper> & aAreas);
+
+    /**
+     * Removes the blob written by SaveSupportedMaps.
+     */
+    CHIP_ERROR DeleteSavedSupportedMaps(PersistentStorageDelegate & aStorage);
+
+    /**
+     * Returns whether the supported maps or areas changed since the last call, and clears the flag. Used to save the lists
+     * once a change has gone through the server instance, whichever path made it.
+     */
+    bool TakeSupportedMapsChanged();
 };
 
 } // namespace ServiceArea
@@ -1,50 +1,159 @@
 #include "RvcAIInterface.h"
+#include "RvcAIProfiler.h"
+#include "RvcLayerDiscovery.h"
+#include "RvcReplayStore.h"
 
+#ifndef RVC_AI_EMBEDDED_MODEL
+#define RVC_AI_EMBEDDED_MODEL 1
+#endif
+
+#if RVC_AI_EMBEDDED_MODEL
 #include "model_data.h"
+#endif
+#include "tensorflow/lite/micro/micro_allocator.h"
 #include "tensorflow/lite/micro/micro_mutable_op_resolver.h"
 #include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/kernels/conv.h"
+#include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/pooling.h"
 #include "tensorflow/lite/schema/schema_generated.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb/stb_image.h"
-#define STB_IMAGE_RESIZE_IMPLEMENTATION
-#include "stb/stb_image_resize2.h"
 
 #include <iostream>
 #include <vector>
-#include <algorithm> // For std::max_element
-#include <thread>
 #include <chrono>
+#include <cstring>
+#include <new>
+#include <algorithm>
+
+namespace {
+constexpr const char * kTestImagePath = "examples/rvc-app/linux/test_data/000000000009.jpg";
+constexpr auto kWorkerIdleWait = std::chrono::milliseconds(100);
+constexpr float kConfidenceThreshold = 0.5f;
+constexpr float kNmsIouThreshold = 0.45f;
+
+// Default detector schedule: obstacles matter while the robot moves, a little while it
+// stands still, and not at all on the dock.
+constexpr uint16_t kDetectorCleaningPeriod = 1;
+constexpr uint16_t kDetectorIdlePeriod = 5;
+constexpr uint16_t kDetectorDockedPeriod = 0;
+constexpr uint8_t kDetectorPriority = 255;
+
+size_t ElementCount(const TfLiteIntArray * dims)
+{
+    size_t count = 1;
+    for (int i = 0; i < dims->size; ++i) { count *= static_cast<size_t>(dims->data[i]); }
+    return count;
+}
+} // namespace
+
+// Wraps the Conv2D kernel so activation taps can copy its input and output
+// right after it has run, before TFLM hands that memory to the next operator.
+// Each wrapped backend gets its own instantiation, so the inner invoke is
+// fixed per registration and interfaces on different backends never see each
+// other's kernel.
+struct RvcConv2DTapHook {
+    static thread_local RvcAIInterface * tActiveInterface; // Set only for the duration of RunForward()
 
-// Simple structure to hold detection results
-struct BoundingBox {
-    float x1, y1, x2, y2; // Top-left and bottom-right coordinates
-    float score;
-    int class_id;
+    template <TFLMRegistration (*tRegister)()>
+    static TFLMRegistration Registration()
+    {
+        TFLMRegistration registration = tRegister();
+        registration.invoke = &Invoke<tRegister>;
+        return registration;
+    }
+
+    template <TFLMRegistration (*tRegister)()>
+    static TfLiteStatus Invoke(TfLiteContext * context, TfLiteNode * node)
+    {
+        static const auto sInvoke = tRegister().invoke;
+        TfLiteStatus status = sInvoke(context, node);
+        if (status == kTfLiteOk && tActiveInterface) { tActiveInterface->CaptureActivations(context, node); }
+        return status;
+    }
 };
 
+thread_local RvcAIInterface * RvcConv2DTapHook::tActiveInterface = nullptr;
+
 RvcAIInterface::RvcAIInterface()
-    : mModel(nullptr), mInterpreter(nullptr), mInputTensor(nullptr), mOutputTensor(nullptr), mResolver(nullptr), mTensorArena(nullptr)
+    : mModel(nullptr), mInterpreter(nullptr), mInputTensor(nullptr), mOutputTensor(nullptr), mResolver(nullptr), mTensorArena(nullptr),
+      mFrameQueue(kMaxFrameWidth * kMaxFrameHeight * 3)
 {
+    RvcModelSchedule detector;
+    detector.priority = kDetectorPriority;
+    detector.period[static_cast<size_t>(RvcAIActivity::kCleaning)] = kDetectorCleaningPeriod;
+    detector.period[static_cast<size_t>(RvcAIActivity::kIdle)] = kDetectorIdlePeriod;
+    detector.period[static_cast<size_t>(RvcAIActivity::kDocked)] = kDetectorDockedPeriod;
+    mScheduler.SetSchedule(kDetectorSlot, detector);
 }
 
 RvcAIInterface::~RvcAIInterface()
 {
+    StopInferenceWorker();
 }
 
-bool RvcAIInterface::InitAI()
+int RvcAIInterface::AddClassifier(const std::string & modelPath, const RvcModelSchedule & schedule)
+{
+    if (mInterpreter) { std::cerr << "Error: Classifiers must be added before InitAI()." << std::endl; return -1; }
+    if (mClassifiers.size() >= kRvcMaxClassifiers) { std::cerr << "Error: Too many classifiers." << std::endl; return -1; }
+
+    Classifier classifier;
+    classifier.path = modelPath;
+    classifier.file = std::make_unique<RvcModelFile>();
+    if (!classifier.file->Map(modelPath, false)) { return -1; }
+
+    int index = static_cast<int>(mClassifiers.size());
+    mClassifiers.push_back(std::move(classifier));
+    mScheduler.SetSchedule(kDetectorSlot + 1 + index, schedule);
+    return index;
+}
+
+bool RvcAIInterface::InitAI(RvcAIMode mode)
+{
+    return InitAI(std::string(), mode);
+}
+
+bool RvcAIInterface::InitAI(const std::string & modelPath, RvcAIMode mode)
 {
     std::cout << "Initializing TFLM..." << std::endl;
+    mMode = mode;
 
-    mModel = tflite::GetModel(yolov8n_full_integer_quant_tflite);
-    if (mModel->version() != TFLITE_SCHEMA_VERSION) { std::cerr << "Error: Model schema version mismatch." << std::endl; return false; }
+    mModelFile = std::make_unique<RvcModelFile>();
+    if (modelPath.empty() || !mModelFile->Map(modelPath, mode != RvcAIMode::kInferenceOnly)) {
+#if RVC_AI_EMBEDDED_MODEL
+        if (!modelPath.empty()) { std::cerr << "Warning: Falling back to the embedded model." << std::endl; }
+        mModelFile->UseEmbedded(yolov8n_full_integer_quant_tflite, yolov8n_full_integer_quant_tflite_len);
+#else
+        std::cerr << "Error: No model file and no embedded model." << std::endl;
+        return false;
+#endif
+    }
+
+    const bool optimized = mKernelBackend == RvcKernelBackend::kOptimized;
+    const TFLMRegistration conv = optimized ? RvcInt8Kernels::Conv2DRegistration() : tflite::Register_CONV_2D();
+    const TFLMRegistration max_pool = optimized ? RvcInt8Kernels::MaxPool2DRegistration() : tflite::Register_MAX_POOL_2D();
+    if (optimized) {
+        std::cout << "Kernels: " << RvcInt8Kernels::SimdName() << ", " << RvcInt8Kernels::ThreadCount() << " threads" << std::endl;
+    }
 
-    mResolver = std::make_unique<tflite::MicroMutableOpResolver<14>>();
+    mResolver = std::make_unique<tflite::MicroMutableOpResolver<kOpCount>>();
     mResolver->AddAdd();
+    mResolver->AddAveragePool2D();
     mResolver->AddConcatenation();
-    mResolver->AddConv2D();
+    if (mode == RvcAIMode::kTraining) {
+        mResolver->AddConv2D(optimized ? RvcConv2DTapHook::Registration<&RvcInt8Kernels::Conv2DRegistration>()
+                                       : RvcConv2DTapHook::Registration<&tflite::Register_CONV_2D>());
+    }
+    else {
+        mResolver->AddConv2D(conv);
+    }
+    mResolver->AddDepthwiseConv2D();
+    mResolver->AddFullyConnected();
     mResolver->AddLogistic();
-    mResolver->AddMaxPool2D();
+    mResolver->AddMaxPool2D(max_pool);
+    mResolver->AddMean();
     mResolver->AddMul();
     mResolver->AddPad();
     mResolver->AddQuantize();
@@ -54,38 +163,391 @@ bool RvcAIInterface::InitAI()
     mResolver->AddStridedSlice();
     mResolver->AddSub();
     mResolver->AddTranspose();
-    mTensorArena = std::make_unique<uint8_t[]>(kTensorArenaSize);
+
+    if (!LoadModel()) { return false; }
+
+    std::cout << "TFLM Initialization Successful!" << std::endl;
+    return true;
+}
+
+bool RvcAIInterface::ReloadModel(const std::string & modelPath)
+{
+    if (!mResolver) { std::cerr << "Error: Interpreter not initialized." << std::endl; return false; }
+
+    // Map and verify outside the lock: inference keeps running on the current model meanwhile.
+    auto file = std::make_unique<RvcModelFile>();
+    if (!file->Map(modelPath, mMode != RvcAIMode::kInferenceOnly)) { return false; }
+
+    std::lock_guard<std::mutex> lock(mInterpreterMutex);
+    std::unique_ptr<RvcModelFile> previous = std::move(mModelFile);
+    mModelFile = std::move(file);
+    if (!LoadModel()) {
+        std::cerr << "Error: Cannot run " << modelPath << ", keeping " << previous->Path() << std::endl;
+        mModelFile = std::move(previous);
+        if (!LoadModel()) { std::cerr << "Error: Cannot restore the previous model." << std::endl; }
+        return false;
+    }
+    mModelGeneration++;
+
+    // The previous mapping goes away here, after the interpreter that used it.
+    std::cout << "Model swapped to " << modelPath << " (generation " << mModelGeneration.load() << ")" << std::endl;
+    return true;
+}
+
+void RvcAIInterface::RequestModelReload(const std::string & modelPath)
+{
+    if (!mWorkerRunning.load()) {
+        ReloadModel(modelPath);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mWakeMutex);
+        mPendingModelPath = modelPath;
+    }
+    mWakeCondition.notify_one();
+}
+
+bool RvcAIInterface::LoadModel()
+{
+    mModel = tflite::GetModel(mModelFile->Data());
+    if (mModel->version() != TFLITE_SCHEMA_VERSION) { std::cerr << "Error: Model schema version mismatch." << std::endl; return false; }
+    mModelHash = RvcLayerDiscovery::ModelHash(mModelFile->Data(), mModelFile->Size());
+
+    for (size_t i = 0; i < mClassifiers.size(); ++i) {
+        Classifier & classifier = mClassifiers[i];
+        classifier.model = tflite::GetModel(classifier.file->Data());
+        if (classifier.model->version() != TFLITE_SCHEMA_VERSION) {
+            std::cerr << "Warning: Skipping classifier " << classifier.path << ": schema version mismatch." << std::endl;
+            classifier.model = nullptr;
+            mScheduler.RemoveSchedule(kDetectorSlot + 1 + i);
+        }
+    }
+
+    if (mMode == RvcAIMode::kPreserveAllTensors) {
+        // Enable preserve_all_tensors so tools can access every intermediate tensor
+        if (!CreateInterpreters(kMaxTensorArenaSize, true)) { return false; }
+    }
+    else {
+        // Planning pass: let the TFLM memory planner lay out the arena inside a generous
+        // probe buffer, then re-create the interpreters in an arena of exactly that size.
+        if (!CreateInterpreters(kMaxTensorArenaSize, false)) { return false; }
+        size_t planned = (mAllocator->used_bytes() + kArenaHeadroom + 15) & ~static_cast<size_t>(15);
+        if (!CreateInterpreters(planned, false)) { return false; }
+    }
+
+    LogArenaReport();
+
+    mInputTensor = mInterpreter->input(0);
+    mOutputTensor = mInterpreter->output(0);
+
+    if (!mInputTensor || !mOutputTensor) { std::cerr << "Error: Failed to get input or output tensor." << std::endl; return false; }
+
+    RvcDetectionDecoder::Config decoderConfig;
+    decoderConfig.scoreThreshold = kConfidenceThreshold;
+    decoderConfig.iouThreshold = kNmsIouThreshold;
+    decoderConfig.outputScale = mOutputTensor->params.scale;
+    decoderConfig.outputZeroPoint = mOutputTensor->params.zero_point;
+    decoderConfig.numAnchors = mOutputTensor->dims->data[1]; // e.g., 8400
+    decoderConfig.numClasses = mOutputTensor->dims->data[2] - 4; // e.g., 84 - 4 = 80
+    if (!mDecoder.Configure(decoderConfig)) { return false; }
+
+    // The input geometry or quantization may differ between models.
+    mPreprocessor = RvcPreprocessor();
+    return true;
+}
+
+bool RvcAIInterface::CreateInterpreters(size_t arenaSize, bool preserveAllTensors)
+{
+    for (Classifier & classifier : mClassifiers) { classifier.interpreter.reset(); }
+    mInterpreter.reset();
+    mAllocator = nullptr;
+    mWeightViews.clear();
+
+    // Deliberately not value-initialised: only the pages TFLM actually uses get faulted in.
+    mTensorArena.reset(new (std::nothrow) uint8_t[arenaSize]);
+    mTensorArenaSize = arenaSize;
     if (!mTensorArena) { std::cerr << "Error: Failed to allocate tensor arena." << std::endl; return false; }
 
-    // Enable preserve_all_tensors so we can access weight tensors for training
+    // One allocator for every interpreter: each keeps its persistent buffers (tensor
+    // metadata, kernel state) at the tail of the arena, while the head, which holds the
+    // activations, is planned per model and sized for the largest one. The models never
+    // run at the same time, so their activations can overlap.
+    mAllocator = tflite::MicroAllocator::Create(mTensorArena.get(), arenaSize,
+        preserveAllTensors ? tflite::MemoryPlannerType::kLinear : tflite::MemoryPlannerType::kGreedy);
+    if (!mAllocator) { std::cerr << "Error: Failed to create the arena allocator." << std::endl; return false; }
+
     mInterpreter = std::make_unique<tflite::MicroInterpreter>(
-        mModel, *mResolver, mTensorArena.get(), kTensorArenaSize,
+        mModel, *mResolver, mAllocator,
         nullptr,  // resource_variables
-        nullptr,  // profiler
-        true      // preserve_all_tensors - CRITICAL for accessing weights!
+        mProfiler
     );
-    if (mInterpreter->AllocateTensors() != kTfLiteOk) { std::cerr << "Error: AllocateTensors() failed." << std::endl; return false; }
+    if (mInterpreter->AllocateTensors() != kTfLiteOk) {
+        std::cerr << "Error: AllocateTensors() failed with a " << arenaSize << " byte arena." << std::endl;
+        return false;
+    }
 
-    mInputTensor = mInterpreter->input(0);
-    mOutputTensor = mInterpreter->output(0);
+    for (size_t i = 0; i < mClassifiers.size(); ++i) {
+        Classifier & classifier = mClassifiers[i];
+        if (!classifier.model) { continue; }
 
-    if (!mInputTensor || !mOutputTensor) { std::cerr << "Error: Failed to get input or output tensor." << std::endl; return false; }
+        // Not profiled: the profiler reports on the detector.
+        classifier.interpreter = std::make_unique<tflite::MicroInterpreter>(classifier.model, *mResolver, mAllocator);
+        bool ok = classifier.interpreter->AllocateTensors() == kTfLiteOk;
+        if (ok) {
+            classifier.input = classifier.interpreter->input(0);
+            classifier.output = classifier.interpreter->output(0);
+            ok = classifier.input && classifier.output && classifier.input->type == kTfLiteInt8 &&
+                classifier.output->type == kTfLiteInt8 && classifier.input->dims->size == 4 &&
+                classifier.input->dims->data[3] == 3;
+        }
+        if (!ok) {
+            // A failed allocation leaves the shared allocator unusable: start over without this model.
+            std::cerr << "Warning: Skipping classifier " << classifier.path << ": the interpreter cannot run it." << std::endl;
+            classifier.model = nullptr;
+            mScheduler.RemoveSchedule(kDetectorSlot + 1 + i);
+            return CreateInterpreters(arenaSize, preserveAllTensors);
+        }
+        // The input geometry or quantization may differ between models.
+        classifier.preprocessor = RvcPreprocessor();
+    }
+    return true;
+}
 
-    std::cout << "TFLM Initialization Successful!" << std::endl;
+size_t RvcAIInterface::GetArenaUsedBytes() const
+{
+    return mAllocator ? mAllocator->used_bytes() : 0;
+}
+
+void RvcAIInterface::LogArenaReport() const
+{
+    static const char * const kModeNames[] = { "inference-only", "training", "preserve-all-tensors" };
+    size_t used = GetArenaUsedBytes();
+
+    std::cout << "TFLM arena report:" << std::endl;
+    std::cout << "  Mode:            " << kModeNames[static_cast<int>(mMode)] << std::endl;
+    size_t classifiers = std::count_if(mClassifiers.begin(), mClassifiers.end(), [](const Classifier & c) { return c.interpreter != nullptr; });
+    std::cout << "  Models:          detector + " << classifiers << " classifier(s)" << std::endl;
+    std::cout << "  Arena size:      " << mTensorArenaSize / 1024 << " KB" << std::endl;
+    std::cout << "  High-water mark: " << used / 1024 << " KB (arena_used_bytes)" << std::endl;
+    std::cout << "  Headroom:        " << (mTensorArenaSize - used) / 1024 << " KB" << std::endl;
+    if (mMode != RvcAIMode::kPreserveAllTensors) {
+        std::cout << "  Saved vs. fixed " << kMaxTensorArenaSize / (1024 * 1024) << " MB arena: "
+                  << (kMaxTensorArenaSize - mTensorArenaSize) / (1024 * 1024) << " MB" << std::endl;
+    }
+}
+
+TfLiteEvalTensor* RvcAIInterface::GetWeightTensor(int tensorIndex)
+{
+    if (mMode == RvcAIMode::kInferenceOnly) {
+        std::cerr << "Error: Weight tensors are not writable in inference-only mode." << std::endl;
+        return nullptr;
+    }
+    if (!mModel) { return nullptr; }
+
+    auto cached = mWeightViews.find(tensorIndex);
+    if (cached != mWeightViews.end()) { return &cached->second; }
+
+    const tflite::SubGraph* subgraph = mModel->subgraphs()->Get(0);
+    if (tensorIndex < 0 || static_cast<uint32_t>(tensorIndex) >= subgraph->tensors()->size()) { return nullptr; }
+
+    const tflite::Tensor* tensor = subgraph->tensors()->Get(tensorIndex);
+    const tflite::Buffer* buffer = mModel->buffers()->Get(tensor->buffer());
+    if (!buffer || !buffer->data() || buffer->data()->size() == 0) {
+        std::cerr << "Error: Tensor " << tensorIndex << " is not a constant tensor." << std::endl;
+        return nullptr;
+    }
+
+    TfLiteEvalTensor view;
+    switch (tensor->type()) {
+    case tflite::TensorType_INT8: view.type = kTfLiteInt8; break;
+    case tflite::TensorType_INT32: view.type = kTfLiteInt32; break;
+    case tflite::TensorType_FLOAT32: view.type = kTfLiteFloat32; break;
+    default:
+        std::cerr << "Error: Unsupported weight tensor type for tensor " << tensorIndex << std::endl;
+        return nullptr;
+    }
+    // Constant tensors are used in place by TFLM, so writes here are seen by the next Invoke().
+    view.data.data = const_cast<uint8_t*>(buffer->data()->data());
+    // A flatbuffer int vector has the same layout as TfLiteIntArray; TFLM relies on this too.
+    view.dims = reinterpret_cast<TfLiteIntArray*>(const_cast<flatbuffers::Vector<int32_t>*>(tensor->shape()));
+
+    return &mWeightViews.emplace(tensorIndex, view).first->second;
+}
+
+bool RvcAIInterface::AddActivationTap(RvcActivationTap * tap)
+{
+    if (mMode != RvcAIMode::kTraining) {
+        std::cerr << "Error: Activation taps are only available in training mode." << std::endl;
+        return false;
+    }
+    if (!tap || tap->filterTensorIndex < 0) { return false; }
+
+    std::lock_guard<std::mutex> lock(mInterpreterMutex);
+    if (std::find(mActivationTaps.begin(), mActivationTaps.end(), tap) == mActivationTaps.end()) {
+        mActivationTaps.push_back(tap);
+    }
     return true;
 }
 
-void RvcAIInterface::RunInferenceLoop()
+void RvcAIInterface::RemoveActivationTap(RvcActivationTap * tap)
 {
-    if (!mInterpreter || !mInputTensor) { std::cerr << "Error: Interpreter not initialized." << std::endl; return; }
+    std::lock_guard<std::mutex> lock(mInterpreterMutex);
+    mActivationTaps.erase(std::remove(mActivationTaps.begin(), mActivationTaps.end(), tap), mActivationTaps.end());
+}
+
+size_t RvcAIInterface::GetInputTensorBytes() const
+{
+    return mInputTensor ? mInputTensor->bytes : 0;
+}
+
+void RvcAIInterface::DecodeOutput(RvcDetectionResult & result)
+{
+    // The decoder scales normalised boxes by the image size, so 1x1 keeps them normalised.
+    result.imageWidth = 1;
+    result.imageHeight = 1;
+    result.detectorRan = true;
+    mDecoder.Decode(mOutputTensor->data.int8, 1, 1, result);
+}
+
+void RvcAIInterface::SetReplayCapture(RvcReplayStore * store, uint32_t captureInterval)
+{
+    mCaptureInterval.store(captureInterval);
+    mReplayStore.store(captureInterval > 0 ? store : nullptr);
+}
+
+void RvcAIInterface::CaptureSample(const RvcDetectionResult & result)
+{
+    RvcReplayStore * store = mReplayStore.load();
+    if (!store || result.detectionCount == 0 || mCaptureInput.size() != mInputTensor->bytes) { return; }
+
+    // The captured input is the letterboxed tensor, so its labels are normalised to the model input, not the frame.
+    mCaptureBoxes.resize(result.detectionCount);
+    for (size_t i = 0; i < result.detectionCount; ++i) {
+        RvcDetection det = result.detections[i];
+        mPreprocessor.SourceToModel(det.x1, det.y1);
+        mPreprocessor.SourceToModel(det.x2, det.y2);
+        mCaptureBoxes[i].cx = (det.x1 + det.x2) * 0.5f;
+        mCaptureBoxes[i].cy = (det.y1 + det.y2) * 0.5f;
+        mCaptureBoxes[i].w = det.x2 - det.x1;
+        mCaptureBoxes[i].h = det.y2 - det.y1;
+        mCaptureBoxes[i].class_id = det.class_id;
+    }
+    store->Add(mCaptureInput.data(), mCaptureInput.size(), mCaptureBoxes.data(), mCaptureBoxes.size(), true, false);
+}
+
+bool RvcAIInterface::RunForward(const int8_t * inputTensorData)
+{
+    if (!mInterpreter || !mInputTensor || !inputTensorData) { std::cerr << "Error: Interpreter not initialized." << std::endl; return false; }
+
+    std::memcpy(mInputTensor->data.int8, inputTensorData, mInputTensor->bytes);
+    for (RvcActivationTap * tap : mActivationTaps) { tap->captured = false; }
+
+    RvcConv2DTapHook::tActiveInterface = this;
+    bool ok = Invoke();
+    RvcConv2DTapHook::tActiveInterface = nullptr;
+    return ok;
+}
+
+void RvcAIInterface::CaptureActivations(TfLiteContext * context, TfLiteNode * node)
+{
+    if (node->inputs->size < 2) { return; }
+
+    for (RvcActivationTap * tap : mActivationTaps) {
+        if (node->inputs->data[1] != tap->filterTensorIndex) { continue; }
+
+        const TfLiteEvalTensor * input = tflite::micro::GetEvalInput(context, node, 0);
+        const TfLiteEvalTensor * output = tflite::micro::GetEvalOutput(context, node, 0);
+        if (!input || !output) { continue; }
+
+        // Sized on first capture, then reused.
+        tap->input.assign(input->data.int8, input->data.int8 + ElementCount(input->dims));
+        tap->output.assign(output->data.int8, output->data.int8 + ElementCount(output->dims));
+        tap->captured = true;
+    }
+}
+
+void RvcAIInterface::SetDetectionCallback(DetectionCallback callback, void * context)
+{
+    mDetectionCallback = callback;
+    mDetectionCallbackContext = context;
+}
+
+bool RvcAIInterface::StartInferenceWorker()
+{
+    if (!mInterpreter || !mInputTensor) { std::cerr << "Error: Interpreter not initialized." << std::endl; return false; }
+    if (mWorkerRunning.exchange(true)) { return true; }
+
+    mWorker = std::thread(&RvcAIInterface::InferenceWorkerMain, this);
+    std::cout << "AI inference worker started." << std::endl;
+    return true;
+}
+
+void RvcAIInterface::StopInferenceWorker()
+{
+    if (!mWorkerRunning.exchange(false)) { return; }
+
+    {
+        std::lock_guard<std::mutex> lock(mWakeMutex);
+    }
+    mWakeCondition.notify_one();
+    if (mWorker.joinable()) { mWorker.join(); }
+
+    std::cout << "AI inference worker stopped (" << mFrameQueue.DroppedCount() << " frames dropped)." << std::endl;
+}
+
+bool RvcAIInterface::SubmitFrame(const uint8_t * pixels, int width, int height, RvcCameraFrame::PixelFormat format,
+                                 int64_t timestampMs)
+{
+    if (!pixels || width <= 0 || height <= 0 || width > kMaxFrameWidth || height > kMaxFrameHeight) {
+        std::cerr << "Error: Invalid camera frame " << width << "x" << height << std::endl;
+        return false;
+    }
+
+    RvcCameraFrame * slot = mFrameQueue.BeginWrite();
+    if (!slot) { return false; }
+
+    // The slot buffer was reserved for the largest frame, so this never reallocates.
+    size_t bytes = RvcCameraFrame::BytesFor(width, height, format);
+    slot->pixels.resize(bytes);
+    std::memcpy(slot->pixels.data(), pixels, bytes);
+    slot->width = width;
+    slot->height = height;
+    slot->format = format;
+    slot->sequence = mNextFrameSequence++;
+    slot->timestampMs = timestampMs;
+    mFrameQueue.CommitWrite();
+
+    mWakeCondition.notify_one();
+    return true;
+}
+
+void RvcAIInterface::InferenceWorkerMain()
+{
+    while (mWorkerRunning.load()) {
+        std::string model_path;
+        {
+            std::lock_guard<std::mutex> lock(mWakeMutex);
+            model_path.swap(mPendingModelPath);
+        }
+        if (!model_path.empty()) {
+            ReloadModel(model_path);
+        }
 
-    std::cout << "Starting continuous AI inference loop..." << std::endl;
-    
-    while (true) {
-        RunSingleInference();
-        
-        // Wait 5 seconds before next inference
-        std::this_thread::sleep_for(std::chrono::seconds(5));
+        RvcCameraFrame * frame = mFrameQueue.BeginRead();
+        if (!frame) {
+            std::unique_lock<std::mutex> lock(mWakeMutex);
+            mWakeCondition.wait_for(lock, kWorkerIdleWait, [this] {
+                return !mWorkerRunning.load() || !mFrameQueue.Empty() || !mPendingModelPath.empty();
+            });
+            continue;
+        }
+
+        bool ok = ProcessFrame(*frame, mResult, mScheduler.NextFrame());
+        mFrameQueue.CommitRead();
+
+        if (ok && mDetectionCallback) {
+            mDetectionCallback(mResult, mDetectionCallbackContext);
+        }
     }
 }
 
@@ -93,73 +555,163 @@ void RvcAIInterface::RunSingleInference()
 {
     if (!mInterpreter || !mInputTensor) { std::cerr << "Error: Interpreter not initialized." << std::endl; return; }
 
-    // 1. Decode Image
-    std::string image_path = "examples/rvc-app/linux/test_data/000000000009.jpg";
-    int original_width, original_height, original_channels;
-    unsigned char *img_original = stbi_load(image_path.c_str(), &original_width, &original_height, &original_channels, 3);
-    if (img_original == nullptr) { std::cerr << "Error: Failed to load image: " << image_path << std::endl; return; }
-
-    // 2. Resize Image
-    int target_height = mInputTensor->dims->data[1];
-    int target_width = mInputTensor->dims->data[2];
-    int target_channels = mInputTensor->dims->data[3];
-    std::vector<uint8_t> img_resized(target_height * target_width * target_channels);
-    stbir_resize_uint8_srgb(img_original, original_width, original_height, 0, img_resized.data(), target_width, target_height, 0, STBIR_RGB);
+    RvcCameraFrame frame;
+    int original_channels;
+    unsigned char *img_original = stbi_load(kTestImagePath, &frame.width, &frame.height, &original_channels, 3);
+    if (img_original == nullptr) { std::cerr << "Error: Failed to load image: " << kTestImagePath << std::endl; return; }
+    frame.pixels.assign(img_original, img_original + static_cast<size_t>(frame.width) * frame.height * 3);
     stbi_image_free(img_original);
 
-    // 3. Quantize and copy to input tensor
-    for (size_t i = 0; i < img_resized.size(); ++i) {
-        mInputTensor->data.int8[i] = (int8_t)(img_resized[i] - 128);
-    }
-
-    // 4. Run Inference
-    if (mInterpreter->Invoke() != kTfLiteOk) { std::cerr << "Error: Invoke() failed." << std::endl; return; }
-
-    // 5. Post-process: Decode the output tensor
-    const float confidence_threshold = 0.5f;
-    float output_scale = mOutputTensor->params.scale;
-    int output_zero_point = mOutputTensor->params.zero_point;
-    int num_detections = mOutputTensor->dims->data[1]; // e.g., 8400
-    int num_classes = mOutputTensor->dims->data[2] - 4; // e.g., 84 - 4 = 80
-
-    std::vector<BoundingBox> detected_boxes;
-
-    for (int i = 0; i < num_detections; ++i) {
-        // Dequantize the bounding box and class scores
-        float cx = (mOutputTensor->data.int8[i * (num_classes + 4) + 0] - output_zero_point) * output_scale;
-        float cy = (mOutputTensor->data.int8[i * (num_classes + 4) + 1] - output_zero_point) * output_scale;
-        float w = (mOutputTensor->data.int8[i * (num_classes + 4) + 2] - output_zero_point) * output_scale;
-        float h = (mOutputTensor->data.int8[i * (num_classes + 4) + 3] - output_zero_point) * output_scale;
-
-        // Find the class with the highest score
-        float max_score = -1.0f;
-        int class_id = -1;
-        for (int j = 0; j < num_classes; ++j) {
-            float score = (mOutputTensor->data.int8[i * (num_classes + 4) + 4 + j] - output_zero_point) * output_scale;
-            if (score > max_score) {
-                max_score = score;
-                class_id = j;
-            }
+    RvcDetectionResult result;
+    if (!ProcessFrame(frame, result, kAllModels)) { return; }
+
+    std::cout << "--- Found " << result.detectionCount << " boxes (" << mDecoder.LastCandidateCount()
+              << " candidates before NMS) in " << result.inferenceMs << " ms ---" << std::endl;
+    for (size_t i = 0; i < result.detectionCount; ++i) {
+        const RvcDetection & box = result.detections[i];
+        std::cout << "Class " << box.class_id << ": Score=" << box.score
+                  << ", Box=[" << box.x1 << ", " << box.y1 << ", " << box.x2 << ", " << box.y2 << "]" << std::endl;
+    }
+    for (size_t i = 0; i < result.classificationCount; ++i) {
+        const RvcClassification & classification = result.classifications[i];
+        std::cout << "Classifier " << static_cast<int>(classification.model) << ": Class " << classification.class_id
+                  << ", Score=" << classification.score << std::endl;
+    }
+}
+
+bool RvcAIInterface::ProcessFrame(const RvcCameraFrame & frame, RvcDetectionResult & result, uint32_t models)
+{
+    if (models == 0) { return false; }
+
+    auto start = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(mInterpreterMutex);
+
+    result.frameSequence = frame.sequence;
+    result.frameTimestampMs = frame.timestampMs;
+    result.imageWidth = frame.width;
+    result.imageHeight = frame.height;
+    result.detectorRan = false;
+    result.detectionCount = 0;
+    result.classificationCount = 0;
+
+    // The classifiers run first: the detector's output must still be intact for replay capture.
+    for (size_t i = 0; i < mClassifiers.size(); ++i) {
+        Classifier & classifier = mClassifiers[i];
+        if (!(models & (1u << (kDetectorSlot + 1 + i))) || !classifier.interpreter) { continue; }
+
+        RvcClassification & classification = result.classifications[result.classificationCount];
+        classification.model = static_cast<uint8_t>(i);
+        if (!RunClassifier(classifier, frame, classification)) { return false; }
+        result.classificationCount++;
+    }
+
+    if (models & (1u << kDetectorSlot)) {
+        if (!PreprocessFrame(frame)) { return false; }
+
+        uint32_t interval = mCaptureInterval.load();
+        bool capture = mReplayStore.load() && interval > 0 && frame.sequence % interval == 0;
+        if (capture) {
+            mCaptureInput.assign(mInputTensor->data.int8, mInputTensor->data.int8 + mInputTensor->bytes);
         }
 
-        if (max_score > confidence_threshold) {
-            BoundingBox box;
-            box.x1 = (cx - w / 2) * original_width;
-            box.y1 = (cy - h / 2) * original_height;
-            box.x2 = (cx + w / 2) * original_width;
-            box.y2 = (cy + h / 2) * original_height;
-            box.score = max_score;
-            box.class_id = class_id;
-            detected_boxes.push_back(box);
+        if (!Invoke()) { return false; }
+        PostprocessOutput(frame, result);
+
+        if (capture) {
+            CaptureSample(result);
         }
     }
+    else if (result.classificationCount == 0) {
+        return false;
+    }
 
-    std::cout << "--- Found " << detected_boxes.size() << " candidate boxes (before NMS) ---" << std::endl;
-    for (const auto& box : detected_boxes) {
-        std::cout << "Class " << box.class_id << ": Score=" << box.score 
-                  << ", Box=[" << box.x1 << ", " << box.y1 << ", " << box.x2 << ", " << box.y2 << "]" << std::endl;
+    result.inferenceMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+bool RvcAIInterface::PreprocessFrame(const RvcCameraFrame & frame)
+{
+    // The resize tables only depend on the camera geometry, so they are rebuilt only if it changes.
+    if (!mPreprocessor.Matches(frame.width, frame.height, frame.format)) {
+        RvcPreprocessor::Config config;
+        config.srcWidth = frame.width;
+        config.srcHeight = frame.height;
+        config.srcFormat = frame.format;
+        config.dstHeight = mInputTensor->dims->data[1];
+        config.dstWidth = mInputTensor->dims->data[2];
+        config.inputScale = mInputTensor->params.scale;
+        config.inputZeroPoint = mInputTensor->params.zero_point;
+        if (mInputTensor->dims->data[3] != 3 || !mPreprocessor.Configure(config)) {
+            std::cerr << "Error: Cannot preprocess " << frame.width << "x" << frame.height << " frames." << std::endl;
+            return false;
+        }
     }
 
-    // TODO: 6. Apply Non-Maximum Suppression (NMS) to `detected_boxes` to get final results.
-    // TODO: 7. Based on final results, call RvcDevice functions.
+    mPreprocessor.Run(frame.pixels.data(), mInputTensor->data.int8);
+    return true;
+}
+
+bool RvcAIInterface::Invoke()
+{
+    if (mProfiler) { mProfiler->BeginInference(); }
+    TfLiteStatus status = mInterpreter->Invoke();
+    if (mProfiler) { mProfiler->EndInference(GetArenaUsedBytes()); }
+
+    if (status != kTfLiteOk) { std::cerr << "Error: Invoke() failed." << std::endl; return false; }
+    return true;
+}
+
+void RvcAIInterface::PostprocessOutput(const RvcCameraFrame & frame, RvcDetectionResult & result)
+{
+    result.detectorRan = true;
+
+    // Boxes come out normalised to the letterboxed model input; map them back onto the frame. The letterbox is a
+    // uniform scale plus an offset, so NMS gives the same result in either space.
+    mDecoder.Decode(mOutputTensor->data.int8, 1, 1, result);
+    size_t kept = 0;
+    for (size_t i = 0; i < result.detectionCount; ++i) {
+        RvcDetection det = result.detections[i];
+        mPreprocessor.ModelToSource(det.x1, det.y1);
+        mPreprocessor.ModelToSource(det.x2, det.y2);
+        // A box entirely inside the padding has nothing left once clamped to the frame.
+        if (det.x2 > det.x1 && det.y2 > det.y1) {
+            result.detections[kept++] = det;
+        }
+    }
+    result.detectionCount = kept;
+}
+
+bool RvcAIInterface::RunClassifier(Classifier & classifier, const RvcCameraFrame & frame, RvcClassification & classification)
+{
+    TfLiteTensor * input = classifier.input;
+    if (!classifier.preprocessor.Matches(frame.width, frame.height, frame.format)) {
+        RvcPreprocessor::Config config;
+        config.srcWidth = frame.width;
+        config.srcHeight = frame.height;
+        config.srcFormat = frame.format;
+        config.dstHeight = input->dims->data[1];
+        config.dstWidth = input->dims->data[2];
+        config.inputScale = input->params.scale;
+        config.inputZeroPoint = input->params.zero_point;
+        if (!classifier.preprocessor.Configure(config)) {
+            std::cerr << "Error: Cannot preprocess " << frame.width << "x" << frame.height << " frames for "
+                      << classifier.path << std::endl;
+            return false;
+        }
+    }
+
+    // The input lives in the shared part of the arena, so it is written right before Invoke().
+    classifier.preprocessor.Run(frame.pixels.data(), input->data.int8);
+    if (classifier.interpreter->Invoke() != kTfLiteOk) {
+        std::cerr << "Error: Invoke() failed for " << classifier.path << std::endl;
+        return false;
+    }
+
+    const TfLiteTensor * output = classifier.output;
+    size_t count = ElementCount(output->dims);
+    const int8_t * scores = output->data.int8;
+    const int8_t * best = std::max_element(scores, scores + count);
+    classification.class_id = static_cast<int>(best - scores);
+    classification.score = (static_cast<int>(*best) - output->params.zero_point) * output->params.scale;
+    return true;
 }
@@ -0,0 +1,188 @@
+#include "RvcAIProfiler.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+#if RVC_AI_MATTER_TRACING
+#include <tracing/macros.h>
+#include <tracing/metric_event.h>
+
+namespace {
+constexpr const char * kTraceGroup = "RvcAI";
+constexpr chip::Tracing::MetricKey kMetricRvcAIInference = "rvc_ai_inference_us";
+constexpr chip::Tracing::MetricKey kMetricRvcAIArenaUsed = "rvc_ai_arena_used_bytes";
+} // namespace
+#endif
+
+namespace {
+uint32_t MicrosSince(std::chrono::steady_clock::time_point start)
+{
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+}
+
+uint32_t Percentile(std::vector<uint32_t> & values, double fraction)
+{
+    size_t index = static_cast<size_t>(fraction * (values.size() - 1) + 0.5);
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+} // namespace
+
+RvcAIProfiler::RvcAIProfiler()
+    : mEventCount(0), mLatencies{}, mInferences(0), mGraphInferences(0), mLastUs(0), mMaxUs(0), mArenaUsedBytes(0)
+{
+}
+
+uint32_t RvcAIProfiler::BeginEvent(const char * tag)
+{
+    if (mEventCount >= kMaxEvents) { return kMaxEvents; }
+
+#if RVC_AI_MATTER_TRACING
+    // Perfetto needs a static event name, so the runtime operator tag goes in as the group argument.
+    MATTER_TRACE_BEGIN("RvcAIOp", tag);
+#endif
+    Event & event = mEvents[mEventCount];
+    event.tag = tag;
+    event.durationUs = 0;
+    event.start = Clock::now();
+    return static_cast<uint32_t>(mEventCount++);
+}
+
+void RvcAIProfiler::EndEvent(uint32_t eventHandle)
+{
+    if (eventHandle >= kMaxEvents) { return; }
+
+    Event & event = mEvents[eventHandle];
+    event.durationUs = MicrosSince(event.start);
+#if RVC_AI_MATTER_TRACING
+    MATTER_TRACE_END("RvcAIOp", event.tag);
+#endif
+}
+
+void RvcAIProfiler::BeginInference()
+{
+#if RVC_AI_MATTER_TRACING
+    MATTER_TRACE_BEGIN("Inference", kTraceGroup);
+#endif
+    mEventCount = 0;
+    mInferenceStart = Clock::now();
+}
+
+void RvcAIProfiler::EndInference(size_t arenaUsedBytes)
+{
+    uint32_t latency_us = MicrosSince(mInferenceStart);
+#if RVC_AI_MATTER_TRACING
+    MATTER_TRACE_END("Inference", kTraceGroup);
+    MATTER_LOG_METRIC(kMetricRvcAIInference, latency_us);
+    MATTER_LOG_METRIC(kMetricRvcAIArenaUsed, static_cast<uint32_t>(arenaUsedBytes));
+#endif
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    // A different graph (e.g. after a model swap) starts the per-layer statistics over.
+    bool same_graph = mLayers.size() == mEventCount;
+    for (size_t i = 0; same_graph && i < mEventCount; ++i) { same_graph = mLayers[i].tag == mEvents[i].tag; }
+    if (!same_graph) {
+        mLayers.assign(mEventCount, LayerTotals{});
+        for (size_t i = 0; i < mEventCount; ++i) { mLayers[i].tag = mEvents[i].tag; }
+        mOps.clear();
+        mGraphInferences = 0;
+    }
+
+    for (size_t i = 0; i < mEventCount; ++i) {
+        const Event & event = mEvents[i];
+        mLayers[i].totalUs += event.durationUs;
+        mLayers[i].maxUs = std::max(mLayers[i].maxUs, event.durationUs);
+
+        // Tags are the interpreter's static operator names, so pointers identify them.
+        auto op = std::find_if(mOps.begin(), mOps.end(), [&](const OpTotals & totals) { return totals.tag == event.tag; });
+        if (op == mOps.end()) { op = mOps.insert(mOps.end(), OpTotals{ event.tag, 0, 0 }); }
+        op->totalUs += event.durationUs;
+        if (!same_graph) { op->count++; }
+    }
+
+    mLatencies[mInferences % kLatencyWindow] = latency_us;
+    mInferences++;
+    mGraphInferences++;
+    mLastUs = latency_us;
+    mMaxUs = std::max(mMaxUs, latency_us);
+    mArenaUsedBytes = arenaUsedBytes;
+}
+
+RvcAIProfiler::Snapshot RvcAIProfiler::GetSnapshot() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    Snapshot snapshot;
+    snapshot.inferences = mInferences;
+    snapshot.graphInferences = mGraphInferences;
+    snapshot.lastUs = mLastUs;
+    snapshot.maxUs = mMaxUs;
+    snapshot.arenaUsedBytes = mArenaUsedBytes;
+    if (mInferences == 0) { return snapshot; }
+
+    snapshot.windowSize = static_cast<uint32_t>(std::min<size_t>(mInferences, kLatencyWindow));
+    std::vector<uint32_t> window(mLatencies, mLatencies + snapshot.windowSize);
+    snapshot.p50Us = Percentile(window, 0.50);
+    snapshot.p99Us = Percentile(window, 0.99);
+
+    uint64_t all_ops_us = 0;
+    for (const OpTotals & op : mOps) { all_ops_us += op.totalUs; }
+    for (const OpTotals & op : mOps) {
+        OpStats stats;
+        stats.tag = op.tag;
+        stats.count = op.count;
+        stats.averageUs = static_cast<double>(op.totalUs) / mGraphInferences;
+        stats.share = all_ops_us ? static_cast<double>(op.totalUs) / all_ops_us : 0.0;
+        snapshot.ops.push_back(stats);
+    }
+    std::sort(snapshot.ops.begin(), snapshot.ops.end(),
+              [](const OpStats & a, const OpStats & b) { return a.averageUs > b.averageUs; });
+
+    for (size_t i = 0; i < mLayers.size(); ++i) {
+        LayerStats stats;
+        stats.index = static_cast<uint32_t>(i);
+        stats.tag = mLayers[i].tag;
+        stats.averageUs = static_cast<double>(mLayers[i].totalUs) / mGraphInferences;
+        stats.maxUs = mLayers[i].maxUs;
+        snapshot.layers.push_back(stats);
+    }
+    size_t reported = std::min(kReportedLayers, snapshot.layers.size());
+    std::partial_sort(snapshot.layers.begin(), snapshot.layers.begin() + reported, snapshot.layers.end(),
+                      [](const LayerStats & a, const LayerStats & b) { return a.averageUs > b.averageUs; });
+    snapshot.layers.resize(reported);
+    return snapshot;
+}
+
+void RvcAIProfiler::LogReport() const
+{
+    Snapshot snapshot = GetSnapshot();
+    if (snapshot.inferences == 0) { std::cout << "AI profiler: no inferences yet." << std::endl; return; }
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "AI profiler: " << snapshot.inferences << " inferences, p50 " << snapshot.p50Us / 1000.0 << " ms, p99 "
+              << snapshot.p99Us / 1000.0 << " ms, max " << snapshot.maxUs / 1000.0 << " ms (last " << snapshot.windowSize
+              << "), arena " << snapshot.arenaUsedBytes / 1024 << " KB" << std::endl;
+    for (const OpStats & op : snapshot.ops) {
+        std::cout << "  " << std::left << std::setw(28) << op.tag << std::right << std::setw(4) << op.count << "x "
+                  << std::setw(10) << op.averageUs / 1000.0 << " ms " << std::setw(6) << op.share * 100.0 << "%" << std::endl;
+    }
+    std::cout << "  Slowest layers:" << std::endl;
+    for (const LayerStats & layer : snapshot.layers) {
+        std::cout << "    #" << std::left << std::setw(4) << layer.index << std::setw(24) << layer.tag << std::right
+                  << std::setw(10) << layer.averageUs / 1000.0 << " ms (max " << layer.maxUs / 1000.0 << ")" << std::endl;
+    }
+}
+
+void RvcAIProfiler::Reset()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mLayers.clear();
+    mOps.clear();
+    mInferences = 0;
+    mGraphInferences = 0;
+    mLastUs = 0;
+    mMaxUs = 0;
+    mArenaUsedBytes = 0;
+}
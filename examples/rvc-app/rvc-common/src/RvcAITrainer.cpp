@@ -1,34 +1,45 @@
 #include "RvcAITrainer.h"
 #include "RvcAIInterface.h"
+#include "RvcTrainerKernels.h"
 
 #include <tensorflow/lite/micro/micro_interpreter.h>
 #include <tensorflow/lite/schema/schema_generated.h>
 #include <tensorflow/lite/c/common.h>
 
 #include <iostream>
+#include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <cstring>
 
+namespace {
+// Strides of the YOLOv8 detection heads, in the order their anchors appear in the model output.
+constexpr int kHeadStrides[] = { 8, 16, 32 };
+} // namespace
+
 RvcAITrainer::RvcAITrainer()
-    : mInferenceEngine(nullptr), mInterpreter(nullptr), mLastLayerEvalTensor(nullptr)
+    : mInferenceEngine(nullptr), mInterpreter(nullptr)
 {
     std::cout << "RvcAITrainer created." << std::endl;
 }
 
 RvcAITrainer::~RvcAITrainer()
 {
+    ReleaseHeads();
     std::cout << "RvcAITrainer destroyed." << std::endl;
 }
 
-bool RvcAITrainer::AttachInferenceEngine(RvcAIInterface* inference_engine)
+bool RvcAITrainer::AttachInferenceEngine(RvcAIInterface* inference_engine, const RvcLayerQuery& query)
 {
     if (!inference_engine) {
         std::cerr << "Error: Cannot attach null inference engine." << std::endl;
         return false;
     }
 
+    ReleaseHeads();
     mInferenceEngine = inference_engine;
     mInterpreter = inference_engine->GetInterpreter();
+    mLayerQuery = query;
 
     if (!mInterpreter) {
         std::cerr << "Error: Interpreter not initialized in inference engine." << std::endl;
@@ -36,58 +47,91 @@ bool RvcAITrainer::AttachInferenceEngine(RvcAIInterface* inference_engine)
     }
 
     std::cout << "Inference engine attached to trainer successfully." << std::endl;
-    return LocateLastLayer();
+    return LocateTrainableLayers();
+}
+
+void RvcAITrainer::ReleaseHeads()
+{
+    if (mInferenceEngine) {
+        for (auto& head : mHeads) {
+            mInferenceEngine->RemoveActivationTap(&head->tap);
+        }
+    }
+    mHeads.clear();
 }
 
-bool RvcAITrainer::LocateLastLayer()
+bool RvcAITrainer::LocateTrainableLayers()
 {
     if (!mInterpreter) {
-        std::cerr << "Error: Interpreter not available. Cannot locate last layer." << std::endl;
+        std::cerr << "Error: Interpreter not available. Cannot locate trainable layers." << std::endl;
         return false;
     }
 
-    // Based on tensor inspection, we know that:
-    // - Tensor 47: [80, 3, 3, 128] with 92,160 elements is a large Conv2D weight
-    // - This is likely one of the last significant layers in YOLO
-
-    // Try to access Tensor 47 (largest Conv2D weight tensor)
-    mLastLayerEvalTensor = mInterpreter->GetTensor(47);
-
-    if (!mLastLayerEvalTensor) {
-        std::cerr << "Error: Could not access Tensor 47." << std::endl;
+    // Resolved from the operator graph rather than hard-coded tensor indices, so every
+    // model variant works without a manual inspect-and-rebuild cycle.
+    mModelGeneration = mInferenceEngine->GetModelGeneration();
+    std::vector<RvcTrainableLayer> layers;
+    if (!RvcLayerDiscovery::Discover(mInferenceEngine->GetModel(), mInferenceEngine->GetModelHash(), mLayerQuery, layers)) {
         return false;
     }
 
-    std::cout << "Last layer located (Tensor 47 - Conv2D weight). Shape: [";
-    for (int i = 0; i < mLastLayerEvalTensor->dims->size; ++i) {
-        std::cout << mLastLayerEvalTensor->dims->data[i];
-        if (i < mLastLayerEvalTensor->dims->size - 1) std::cout << ", ";
-    }
-    std::cout << "]" << std::endl;
-    std::cout << "Type: " << mLastLayerEvalTensor->type << std::endl;
+    size_t total_elements = 0;
+    for (const RvcTrainableLayer& layer : layers) {
+        // Weights are read from the model flatbuffer, so this works without preserve_all_tensors.
+        TfLiteEvalTensor* filter = mInferenceEngine->GetWeightTensor(layer.filterTensor);
+        if (!filter) {
+            std::cerr << "Error: Could not access filter tensor " << layer.filterTensor << std::endl;
+            ReleaseHeads();
+            return false;
+        }
 
-    // Calculate total elements
-    int total_elements = 1;
-    for (int i = 0; i < mLastLayerEvalTensor->dims->size; ++i) {
-        total_elements *= mLastLayerEvalTensor->dims->data[i];
+        auto head = std::make_unique<TrainableHead>();
+        head->layer = layer;
+        // Reads the real per-channel scales and keeps an fp32 master copy for training.
+        if (!head->weights.Bind(mInferenceEngine->GetModel(), layer.filterTensor, filter)) {
+            ReleaseHeads();
+            return false;
+        }
+
+        std::cout << "Trainable layer '" << layer.name << "' (tensor " << layer.filterTensor << "). Shape: [";
+        for (int i = 0; i < filter->dims->size; ++i) {
+            std::cout << filter->dims->data[i];
+            if (i < filter->dims->size - 1) std::cout << ", ";
+        }
+        std::cout << "], " << head->weights.ChannelCount() << " quantization channels" << std::endl;
+
+        total_elements += head->weights.Count();
+        mHeads.push_back(std::move(head));
     }
     std::cout << "Total weight parameters: " << total_elements << std::endl;
 
     return true;
 }
 
-size_t RvcAITrainer::GetLastLayerWeightsCount()
+bool RvcAITrainer::FollowModelSwap()
 {
-    if (!mLastLayerEvalTensor) {
-        return 0;
+    if (!mInferenceEngine || mModelGeneration == mInferenceEngine->GetModelGeneration()) {
+        return true;
     }
 
-    // Calculate total number of elements in the tensor
-    size_t count = 1;
-    for (int i = 0; i < mLastLayerEvalTensor->dims->size; ++i) {
-        count *= mLastLayerEvalTensor->dims->data[i];
-    }
+    // The old heads point into the previous model's weights, which are gone.
+    std::cout << "Model was swapped, locating trainable layers again." << std::endl;
+    ReleaseHeads();
+    mInterpreter = mInferenceEngine->GetInterpreter();
+    return LocateTrainableLayers();
+}
+
+const RvcTrainableLayer* RvcAITrainer::GetTrainableLayer(size_t index) const
+{
+    return index < mHeads.size() ? &mHeads[index]->layer : nullptr;
+}
 
+size_t RvcAITrainer::GetLastLayerWeightsCount()
+{
+    size_t count = 0;
+    for (const auto& head : mHeads) {
+        count += head->weights.Count();
+    }
     return count;
 }
 
@@ -97,8 +141,8 @@ size_t RvcAITrainer::GetLastLayerWeightsCount()
 
 bool RvcAITrainer::GetLastLayerWeightsInt8(int8_t* weights_buffer, size_t* buffer_size)
 {
-    if (!mLastLayerEvalTensor) {
-        std::cerr << "Error: Last layer not located yet." << std::endl;
+    if (!FollowModelSwap() || mHeads.empty()) {
+        std::cerr << "Error: Trainable layers not located yet." << std::endl;
         return false;
     }
 
@@ -110,26 +154,28 @@ bool RvcAITrainer::GetLastLayerWeightsInt8(int8_t* weights_buffer, size_t* buffe
         return true;
     }
 
-    // Type 9 is kTfLiteInt8
-    if (mLastLayerEvalTensor->type == 9) {  // kTfLiteInt8
-        int8_t* tensor_data = mLastLayerEvalTensor->data.int8;
+    // Pending float updates must reach the int8 tensors first.
+    CommitWeights();
 
-        // Direct copy - no conversion!
-        std::memcpy(weights_buffer, tensor_data, weight_count * sizeof(int8_t));
-
-        std::cout << "Extracted " << weight_count << " int8 weights (direct copy)." << std::endl;
-        return true;
-    }
-    else {
-        std::cerr << "Error: Unsupported tensor type: " << mLastLayerEvalTensor->type << std::endl;
+    // Direct copy - no conversion!
+    auto lock = mInferenceEngine->LockInterpreter();
+    if (ModelSwapped()) {
+        std::cerr << "Error: Model was swapped while reading weights." << std::endl;
         return false;
     }
+    for (const auto& head : mHeads) {
+        std::memcpy(weights_buffer, head->weights.Int8Data(), head->weights.Count() * sizeof(int8_t));
+        weights_buffer += head->weights.Count();
+    }
+
+    std::cout << "Extracted " << weight_count << " int8 weights (direct copy)." << std::endl;
+    return true;
 }
 
 bool RvcAITrainer::SetLastLayerWeightsInt8(const int8_t* weights, size_t size)
 {
-    if (!mLastLayerEvalTensor) {
-        std::cerr << "Error: Last layer not located yet." << std::endl;
+    if (!FollowModelSwap() || mHeads.empty()) {
+        std::cerr << "Error: Trainable layers not located yet." << std::endl;
         return false;
     }
 
@@ -140,26 +186,26 @@ bool RvcAITrainer::SetLastLayerWeightsInt8(const int8_t* weights, size_t size)
         return false;
     }
 
-    // Type 9 is kTfLiteInt8
-    if (mLastLayerEvalTensor->type == 9) {  // kTfLiteInt8
-        int8_t* tensor_data = mLastLayerEvalTensor->data.int8;
-
-        // Direct copy - no conversion!
-        std::memcpy(tensor_data, weights, size * sizeof(int8_t));
-
-        std::cout << "Updated " << size << " int8 weights (direct copy)." << std::endl;
-        return true;
-    }
-    else {
-        std::cerr << "Error: Unsupported tensor type: " << mLastLayerEvalTensor->type << std::endl;
+    // Direct copy - no conversion! The master copies are refreshed from the new values.
+    auto lock = mInferenceEngine->LockInterpreter();
+    if (ModelSwapped()) {
+        std::cerr << "Error: Model was swapped while writing weights." << std::endl;
         return false;
     }
+    for (auto& head : mHeads) {
+        std::memcpy(head->weights.Int8Data(), weights, head->weights.Count() * sizeof(int8_t));
+        head->weights.Dequantize();
+        weights += head->weights.Count();
+    }
+
+    std::cout << "Updated " << size << " int8 weights (direct copy)." << std::endl;
+    return true;
 }
 
 bool RvcAITrainer::UpdateWeightsInt8(const int8_t* gradients, size_t size)
 {
-    if (!mLastLayerEvalTensor) {
-        std::cerr << "Error: Last layer not located yet." << std::endl;
+    if (!FollowModelSwap() || mHeads.empty()) {
+        std::cerr << "Error: Trainable layers not located yet." << std::endl;
         return false;
     }
 
@@ -170,40 +216,33 @@ bool RvcAITrainer::UpdateWeightsInt8(const int8_t* gradients, size_t size)
         return false;
     }
 
-    // Type 9 is kTfLiteInt8
-    if (mLastLayerEvalTensor->type == 9) {  // kTfLiteInt8
-        int8_t* tensor_data = mLastLayerEvalTensor->data.int8;
-
-        // Direct int8 update: weight -= gradient
-        // This avoids float conversion and precision loss!
-        for (size_t i = 0; i < weight_count; ++i) {
-            // Compute new weight
-            int16_t new_weight = static_cast<int16_t>(tensor_data[i]) - static_cast<int16_t>(gradients[i]);
-
-            // Clamp to int8 range [-128, 127]
-            if (new_weight > 127) new_weight = 127;
-            if (new_weight < -128) new_weight = -128;
-
-            tensor_data[i] = static_cast<int8_t>(new_weight);
-        }
+    CommitWeights();
 
-        std::cout << "Updated " << weight_count << " int8 weights (direct int8 arithmetic)." << std::endl;
-        return true;
-    }
-    else {
-        std::cerr << "Error: Unsupported tensor type: " << mLastLayerEvalTensor->type << std::endl;
+    auto lock = mInferenceEngine->LockInterpreter();
+    if (ModelSwapped()) {
+        std::cerr << "Error: Model was swapped while writing weights." << std::endl;
         return false;
     }
+    for (auto& head : mHeads) {
+        // Direct int8 update: weight -= gradient, saturated to [-128, 127]
+        // This avoids float conversion and precision loss!
+        RvcTrainerKernels::SubSaturateInt8(head->weights.Int8Data(), gradients, head->weights.Count());
+        head->weights.Dequantize();
+        gradients += head->weights.Count();
+    }
+
+    std::cout << "Updated " << weight_count << " int8 weights (direct int8 arithmetic)." << std::endl;
+    return true;
 }
 
 // ============================================================================
-// Legacy Float Weight Access (Lossy - Not Recommended)
+// Float Weight Access (fp32 master copy, real quantization parameters)
 // ============================================================================
 
 bool RvcAITrainer::GetLastLayerWeights(float* weights_buffer, size_t* buffer_size)
 {
-    if (!mLastLayerEvalTensor) {
-        std::cerr << "Error: Last layer not located yet." << std::endl;
+    if (!FollowModelSwap() || mHeads.empty()) {
+        std::cerr << "Error: Trainable layers not located yet." << std::endl;
         return false;
     }
 
@@ -215,29 +254,18 @@ bool RvcAITrainer::GetLastLayerWeights(float* weights_buffer, size_t* buffer_siz
         return true;
     }
 
-    // Type 9 is kTfLiteInt8
-    if (mLastLayerEvalTensor->type == 9) {  // kTfLiteInt8
-        int8_t* tensor_data = mLastLayerEvalTensor->data.int8;
-
-        // Simple dequantization: convert int8 to float
-        // Note: Without quantization params, this is approximate
-        // We use a simple scale of 1/127.0 (assuming symmetric quantization)
-        for (size_t i = 0; i < weight_count; ++i) {
-            weights_buffer[i] = static_cast<float>(tensor_data[i]) / 127.0f;
-        }
-        std::cout << "Extracted " << weight_count << " int8 weights (approximate dequantization)." << std::endl;
-        return true;
-    }
-    else {
-        std::cerr << "Error: Unsupported tensor type: " << mLastLayerEvalTensor->type << std::endl;
-        return false;
+    // The master copies already hold (q - zero_point) * scale per channel, or newer trained values.
+    for (const auto& head : mHeads) {
+        std::memcpy(weights_buffer, head->weights.Master(), head->weights.Count() * sizeof(float));
+        weights_buffer += head->weights.Count();
     }
+    return true;
 }
 
 bool RvcAITrainer::SetLastLayerWeights(const float* weights, size_t size)
 {
-    if (!mLastLayerEvalTensor) {
-        std::cerr << "Error: Last layer not located yet." << std::endl;
+    if (!FollowModelSwap() || mHeads.empty()) {
+        std::cerr << "Error: Trainable layers not located yet." << std::endl;
         return false;
     }
 
@@ -248,24 +276,83 @@ bool RvcAITrainer::SetLastLayerWeights(const float* weights, size_t size)
         return false;
     }
 
-    // Type 9 is kTfLiteInt8
-    if (mLastLayerEvalTensor->type == 9) {  // kTfLiteInt8
-        int8_t* tensor_data = mLastLayerEvalTensor->data.int8;
+    // Only the master copies change here; CommitWeights() requantizes them into the model.
+    for (auto& head : mHeads) {
+        std::memcpy(head->weights.Master(), weights, head->weights.Count() * sizeof(float));
+        head->weights.MarkDirty();
+        weights += head->weights.Count();
+    }
+    return true;
+}
+
+void RvcAITrainer::CommitWeights()
+{
+    if (!mInferenceEngine) {
+        return;
+    }
 
-        // Simple quantization: convert float to int8
-        // Note: Without quantization params, this is approximate
-        // We use a simple scale of 127.0 (assuming symmetric quantization)
-        for (size_t i = 0; i < size; ++i) {
-            float clamped = std::max(-1.0f, std::min(1.0f, weights[i]));
-            tensor_data[i] = static_cast<int8_t>(std::round(clamped * 127.0f));
+    auto lock = mInferenceEngine->LockInterpreter();
+    if (ModelSwapped()) {
+        return;
+    }
+    for (auto& head : mHeads) {
+        if (head->trainer.IsConfigured()) {
+            head->trainer.Commit();
+        }
+        else {
+            head->weights.Commit();
         }
-        std::cout << "Updated " << size << " int8 weights (approximate quantization)." << std::endl;
-        return true;
     }
-    else {
-        std::cerr << "Error: Unsupported tensor type: " << mLastLayerEvalTensor->type << std::endl;
+}
+
+bool RvcAITrainer::EvaluateSample(const int8_t* input_tensor, const RvcTrainingBox* boxes, size_t num_boxes,
+                                  float* loss, RvcDetectionResult* detections)
+{
+    if (!mInferenceEngine || !FollowModelSwap() || mHeads.empty()) {
+        std::cerr << "Error: No inference engine attached." << std::endl;
+        return false;
+    }
+    if (!input_tensor || (num_boxes > 0 && !boxes)) {
+        std::cerr << "Error: Null pointers in EvaluateSample." << std::endl;
+        return false;
+    }
+    for (auto& head : mHeads) {
+        if (!head->trainer.IsConfigured() && !ConfigureHead(*head)) {
+            return false;
+        }
+    }
+
+    auto lock = mInferenceEngine->LockInterpreter();
+    if (ModelSwapped()) {
+        std::cerr << "Error: Model was swapped during evaluation." << std::endl;
         return false;
     }
+    for (auto& head : mHeads) {
+        head->trainer.Commit();
+    }
+    if (!mInferenceEngine->RunForward(input_tensor)) {
+        return false;
+    }
+
+    float class_loss = 0.0f;
+    for (auto& head : mHeads) {
+        if (!head->tap.captured) {
+            std::cerr << "Error: Activations of '" << head->layer.name << "' were not captured." << std::endl;
+            return false;
+        }
+        float head_loss = head->trainer.ComputeLoss(head->tap.output.data(), boxes, num_boxes, GatherPredictedBoxes(*head),
+                                                    nullptr);
+        if (head->trainer.GetHeadType() == RvcConvHeadTrainer::HeadType::kClassification) {
+            class_loss += head_loss;
+        }
+    }
+    if (loss) {
+        *loss = class_loss;
+    }
+    if (detections) {
+        mInferenceEngine->DecodeOutput(*detections);
+    }
+    return true;
 }
 
 float RvcAITrainer::ComputeLoss(const float* predictions, const float* ground_truth, size_t num_elements)
@@ -285,83 +372,230 @@ float RvcAITrainer::ComputeLoss(const float* predictions, const float* ground_tr
     return total_loss / static_cast<float>(num_elements);
 }
 
-void RvcAITrainer::ComputeGradients(const float* predictions, const float* ground_truth, size_t num_elements)
+bool RvcAITrainer::ConfigureHead(TrainableHead& head)
 {
-    // Gradient of MSE loss: dL/dy = 2 * (prediction - ground_truth) / n
-    // Simplified: (prediction - ground_truth) / n (omitting constant 2)
+    const tflite::Model* model = mInferenceEngine->GetModel();
+    const tflite::SubGraph* subgraph = model->subgraphs()->Get(0);
+    auto tensors = subgraph->tensors();
+    const tflite::Operator* op = subgraph->operators()->Get(head.layer.operatorIndex);
+
+    const tflite::Tensor* input = tensors->Get(head.layer.inputTensor);
+    const tflite::Tensor* filter = tensors->Get(head.layer.filterTensor);
+    const tflite::Tensor* output = tensors->Get(head.layer.outputTensor);
+    const tflite::Conv2DOptions* options = op->builtin_options_as_Conv2DOptions();
+    if (!options || input->shape()->size() != 4 || filter->shape()->size() != 4 || output->shape()->size() != 4) {
+        std::cerr << "Error: Unexpected head Conv2D layout." << std::endl;
+        return false;
+    }
+    if (options->dilation_h_factor() != 1 || options->dilation_w_factor() != 1) {
+        std::cerr << "Error: Dilated head convolutions are not supported." << std::endl;
+        return false;
+    }
 
-    mGradients.resize(num_elements);
+    // NHWC activations, OHWI filter.
+    RvcConvHeadTrainer::Geometry geometry;
+    geometry.inHeight = input->shape()->Get(1);
+    geometry.inWidth = input->shape()->Get(2);
+    geometry.inChannels = input->shape()->Get(3);
+    geometry.outHeight = output->shape()->Get(1);
+    geometry.outWidth = output->shape()->Get(2);
+    geometry.outChannels = output->shape()->Get(3);
+    geometry.kernelHeight = filter->shape()->Get(1);
+    geometry.kernelWidth = filter->shape()->Get(2);
+    geometry.strideHeight = options->stride_h();
+    geometry.strideWidth = options->stride_w();
+    // Same arithmetic as TFLM's ComputePaddingHeightWidth(); yields 0 for VALID padding.
+    geometry.padTop = std::max(0, (geometry.outHeight - 1) * geometry.strideHeight + geometry.kernelHeight - geometry.inHeight) / 2;
+    geometry.padLeft = std::max(0, (geometry.outWidth - 1) * geometry.strideWidth + geometry.kernelWidth - geometry.inWidth) / 2;
+
+    const tflite::QuantizationParameters* in_q = input->quantization();
+    const tflite::QuantizationParameters* out_q = output->quantization();
+    if (!in_q || !out_q || !in_q->scale() || !out_q->scale() || !in_q->zero_point() || !out_q->zero_point()) {
+        std::cerr << "Error: Head Conv2D is not fully quantized." << std::endl;
+        return false;
+    }
 
-    for (size_t i = 0; i < num_elements; ++i) {
-        mGradients[i] = (predictions[i] - ground_truth[i]) / static_cast<float>(num_elements);
+    RvcConvHeadTrainer::Quantization quantization;
+    quantization.inputScale = in_q->scale()->Get(0);
+    quantization.inputZeroPoint = static_cast<int>(in_q->zero_point()->Get(0));
+    quantization.outputScale = out_q->scale()->Get(0);
+    quantization.outputZeroPoint = static_cast<int>(out_q->zero_point()->Get(0));
+
+    // Class heads have one channel per class; box heads feed the DFL with 4 sides x kRegMax distance bins.
+    // Anything else has no loss to train it with, and training it towards class targets would corrupt it.
+    TfLiteTensor* model_output = mInferenceEngine->GetOutputTensor();
+    const int num_classes = (model_output && model_output->dims->size == 3) ? model_output->dims->data[2] - 4 : -1;
+    RvcConvHeadTrainer::HeadType type;
+    if (geometry.outChannels == num_classes) {
+        type = RvcConvHeadTrainer::HeadType::kClassification;
+    }
+    else if (geometry.outChannels == 4 * RvcConvHeadTrainer::kRegMax) {
+        type = RvcConvHeadTrainer::HeadType::kBoxDistribution;
+    }
+    else {
+        std::cerr << "Error: Cannot train '" << head.layer.name << "': " << geometry.outChannels
+                  << " output channels is neither a class head (" << num_classes << " classes) nor a box head ("
+                  << 4 * RvcConvHeadTrainer::kRegMax << " channels)." << std::endl;
+        return false;
     }
 
-    std::cout << "Gradients computed for " << num_elements << " elements." << std::endl;
-}
+    int32_t* bias = nullptr;
+    if (head.layer.biasTensor >= 0) {
+        TfLiteEvalTensor* bias_tensor = mInferenceEngine->GetWeightTensor(head.layer.biasTensor);
+        if (bias_tensor && bias_tensor->type == kTfLiteInt32) {
+            bias = bias_tensor->data.i32;
+        }
+    }
 
-void RvcAITrainer::UpdateWeightsWithSGD(float learning_rate)
-{
-    if (!mLastLayerEvalTensor) {
-        std::cerr << "Error: Cannot update weights - last layer not located." << std::endl;
-        return;
+    if (!head.trainer.Configure(type, geometry, quantization, &head.weights, bias,
+                                RvcConvHeadTrainer::Hyperparameters())) {
+        return false;
     }
 
-    if (mGradients.empty()) {
-        std::cerr << "Error: No gradients computed yet." << std::endl;
-        return;
+    // Locate this head's anchors in the concatenated [1, anchors, 4 + classes] output.
+    TfLiteTensor* model_input = mInterpreter->input(0);
+    size_t offset = 0;
+    size_t head_cells = static_cast<size_t>(geometry.outHeight) * geometry.outWidth;
+    head.anchorOffset = SIZE_MAX;
+    for (int stride : kHeadStrides) {
+        size_t cells = static_cast<size_t>(model_input->dims->data[1] / stride) * (model_input->dims->data[2] / stride);
+        if (cells == head_cells) {
+            head.anchorOffset = offset;
+            break;
+        }
+        offset += cells;
     }
+    if (head.anchorOffset == SIZE_MAX && type == RvcConvHeadTrainer::HeadType::kClassification) {
+        std::cout << "Warning: Head grid does not match a detection stride; training without box IoU targets." << std::endl;
+    }
+    head.predictedBoxes.resize(head_cells * 4);
 
-    size_t weight_count = GetLastLayerWeightsCount();
-    if (mGradients.size() != weight_count) {
-        std::cerr << "Error: Gradient size mismatch. Expected " << weight_count
-                  << " but got " << mGradients.size() << std::endl;
-        return;
+    head.tap.filterTensorIndex = head.layer.filterTensor;
+    if (!mInferenceEngine->AddActivationTap(&head.tap)) {
+        return false;
     }
 
-    // Get current weights
-    std::vector<float> current_weights(weight_count);
-    size_t buffer_size;
-    if (!GetLastLayerWeights(current_weights.data(), &buffer_size)) {
-        std::cerr << "Error: Failed to get current weights." << std::endl;
-        return;
+    std::cout << "Head trainer configured for '" << head.layer.name << "': " << geometry.inHeight << "x" << geometry.inWidth
+              << "x" << geometry.inChannels << " -> " << geometry.outHeight << "x" << geometry.outWidth << "x"
+              << geometry.outChannels << ", " << geometry.kernelHeight << "x" << geometry.kernelWidth << " kernel"
+              << (bias ? ", with bias" : "") << std::endl;
+    return true;
+}
+
+const float* RvcAITrainer::GatherPredictedBoxes(TrainableHead& head)
+{
+    // Box heads compute their boxes from their own distributions.
+    if (head.anchorOffset == SIZE_MAX || head.trainer.GetHeadType() != RvcConvHeadTrainer::HeadType::kClassification) {
+        return nullptr;
     }
 
-    // Apply SGD: weight = weight - learning_rate * gradient
-    for (size_t i = 0; i < weight_count; ++i) {
-        current_weights[i] -= learning_rate * mGradients[i];
+    TfLiteTensor* output = mInferenceEngine->GetOutputTensor();
+    const int row_size = output->dims->data[2];
+    const float scale = output->params.scale;
+    const int zero_point = output->params.zero_point;
+    const size_t anchors = head.predictedBoxes.size() / 4;
+    if (head.anchorOffset + anchors > static_cast<size_t>(output->dims->data[1])) {
+        return nullptr;
     }
 
-    // Set updated weights back
-    if (!SetLastLayerWeights(current_weights.data(), weight_count)) {
-        std::cerr << "Error: Failed to set updated weights." << std::endl;
-        return;
+    const int8_t* row = output->data.int8 + head.anchorOffset * row_size;
+    for (size_t i = 0; i < anchors; ++i, row += row_size) {
+        for (int k = 0; k < 4; ++k) {
+            head.predictedBoxes[i * 4 + k] = (row[k] - zero_point) * scale;
+        }
     }
+    return head.predictedBoxes.data();
+}
 
-    std::cout << "Weights updated successfully with learning rate: " << learning_rate << std::endl;
+bool RvcAITrainer::TrainSingleStep(const int8_t* input_tensor, const RvcTrainingBox* boxes,
+                                    size_t num_boxes, float learning_rate, float* loss)
+{
+    return AccumulateStep(input_tensor, boxes, num_boxes, loss) && ApplyAccumulatedUpdate(learning_rate);
 }
 
-bool RvcAITrainer::TrainSingleStep(const float* input_image, const float* ground_truth_boxes,
-                                    size_t num_boxes, float learning_rate)
+bool RvcAITrainer::AccumulateStep(const int8_t* input_tensor, const RvcTrainingBox* boxes, size_t num_boxes, float* loss)
 {
-    if (!mInferenceEngine) {
+    if (!mInferenceEngine || !FollowModelSwap() || mHeads.empty()) {
         std::cerr << "Error: No inference engine attached." << std::endl;
         return false;
     }
+    if (!input_tensor || (num_boxes > 0 && !boxes)) {
+        std::cerr << "Error: Null pointers in AccumulateStep." << std::endl;
+        return false;
+    }
+    for (auto& head : mHeads) {
+        if (!head->trainer.IsConfigured() && !ConfigureHead(*head)) {
+            return false;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    float class_loss = 0.0f;
+    float box_loss = 0.0f;
+
+    // Step 1: Forward pass, capturing every head's input and output activations. The previous
+    // step's update is requantized first so the loss is computed with the current weights.
+    {
+        auto lock = mInferenceEngine->LockInterpreter();
+        if (ModelSwapped()) {
+            std::cerr << "Error: Model was swapped during the step." << std::endl;
+            return false;
+        }
+        for (auto& head : mHeads) {
+            head->trainer.Commit();
+        }
+        if (!mInferenceEngine->RunForward(input_tensor)) {
+            return false;
+        }
+
+        // Step 2: Loss and dL/dZ on each head's logits
+        for (auto& head : mHeads) {
+            if (!head->tap.captured) {
+                std::cerr << "Error: Activations of '" << head->layer.name << "' were not captured." << std::endl;
+                return false;
+            }
+            float head_box_loss = 0.0f;
+            float head_loss = head->trainer.ComputeLoss(head->tap.output.data(), boxes, num_boxes, GatherPredictedBoxes(*head),
+                                                        &head_box_loss);
+            if (head->trainer.GetHeadType() == RvcConvHeadTrainer::HeadType::kClassification) {
+                class_loss += head_loss;
+            }
+            box_loss += head_box_loss / mHeads.size();
+        }
+    }
 
-    // Step 1: Run forward pass (inference) to get predictions
-    // TODO: Get predictions from inference engine
-    // This requires exposing output tensor from RvcAIInterface
+    // Step 3: dL/dW and dL/db, added to the micro-batch. Only reads the tap, so inference can run meanwhile.
+    for (auto& head : mHeads) {
+        head->trainer.Backward(head->tap.input.data());
+    }
 
-    // Step 2: Compute loss
-    // float loss = ComputeLoss(predictions, ground_truth_boxes, num_elements);
-    // std::cout << "Loss: " << loss << std::endl;
+    float elapsed_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Training step: cls_loss=" << class_loss << " box_loss=" << box_loss << " (" << num_boxes
+              << " boxes, " << mHeads.size() << " heads, " << elapsed_ms << " ms)" << std::endl;
 
-    // Step 3: Compute gradients
-    // ComputeGradients(predictions, ground_truth_boxes, num_elements);
+    if (loss) {
+        *loss = class_loss;
+    }
+    return true;
+}
 
-    // Step 4: Update weights
-    // UpdateWeightsWithSGD(learning_rate);
+bool RvcAITrainer::ApplyAccumulatedUpdate(float learning_rate)
+{
+    if (!mInferenceEngine || !FollowModelSwap() || mHeads.empty()) {
+        std::cerr << "Error: No inference engine attached." << std::endl;
+        return false;
+    }
 
-    std::cout << "TrainSingleStep: Framework ready, but needs RvcAIInterface integration." << std::endl;
+    // Step 4: Update the fp32 master weights; they reach the model at the next step or CommitWeights()
+    for (auto& head : mHeads) {
+        head->trainer.ApplyUpdate(learning_rate);
+    }
     return true;
 }
+
+void RvcAITrainer::DiscardAccumulatedGradients()
+{
+    for (auto& head : mHeads) {
+        head->trainer.DiscardGradients();
+    }
+}
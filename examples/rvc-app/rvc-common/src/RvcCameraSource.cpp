@@ -0,0 +1,61 @@
+#include "RvcCameraSource.h"
+#include "RvcAIInterface.h"
+
+#include "stb/stb_image.h"
+
+#include <chrono>
+#include <iostream>
+
+RvcCameraSource::RvcCameraSource()
+    : mSink(nullptr), mWidth(0), mHeight(0), mFramesPerSecond(0)
+{
+}
+
+RvcCameraSource::~RvcCameraSource()
+{
+    Stop();
+}
+
+bool RvcCameraSource::Start(RvcAIInterface * sink, const std::string & imagePath, int framesPerSecond)
+{
+    if (!sink || framesPerSecond <= 0) { std::cerr << "Error: Invalid camera source configuration." << std::endl; return false; }
+    if (mRunning.load()) { return true; }
+
+    // Decode once up-front; the capture loop only copies raw pixels from here on.
+    int channels;
+    unsigned char * img = stbi_load(imagePath.c_str(), &mWidth, &mHeight, &channels, 3);
+    if (img == nullptr) { std::cerr << "Error: Failed to load image: " << imagePath << std::endl; return false; }
+    mFrame.assign(img, img + static_cast<size_t>(mWidth) * mHeight * 3);
+    stbi_image_free(img);
+
+    mSink = sink;
+    mFramesPerSecond = framesPerSecond;
+    mRunning.store(true);
+    mThread = std::thread(&RvcCameraSource::CaptureThreadMain, this);
+
+    std::cout << "Camera source started: " << mWidth << "x" << mHeight << " @ " << framesPerSecond << " fps" << std::endl;
+    return true;
+}
+
+void RvcCameraSource::Stop()
+{
+    if (!mRunning.exchange(false)) { return; }
+    if (mThread.joinable()) { mThread.join(); }
+}
+
+void RvcCameraSource::CaptureThreadMain()
+{
+    const auto period = std::chrono::microseconds(1000000 / mFramesPerSecond);
+    auto next = std::chrono::steady_clock::now();
+
+    while (mRunning.load()) {
+        auto now = std::chrono::steady_clock::now();
+        int64_t timestampMs = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
+
+        // A full queue means the worker is still busy; the frame is simply dropped.
+        mSink->SubmitFrame(mFrame.data(), mWidth, mHeight, RvcCameraFrame::PixelFormat::kRgb888, timestampMs);
+
+        next += period;
+        std::this_thread::sleep_until(next);
+    }
+}
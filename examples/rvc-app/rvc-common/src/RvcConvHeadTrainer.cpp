@@ -0,0 +1,463 @@
+#include "RvcConvHeadTrainer.h"
+#include "RvcTrainerKernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <thread>
+
+namespace {
+
+// GEMM tiling: a block of im2col rows (kBlockPositions x kBlockPatch int8 = 16KB) stays in L1/L2
+// while every output channel owned by a thread accumulates into its slice of the gradient row.
+constexpr size_t kBlockPositions = 64;
+constexpr size_t kBlockPatch = 256;
+
+// Below this many MACs the thread start-up cost outweighs the parallel speed-up.
+constexpr size_t kMinMacsPerThread = 1 << 20;
+
+inline float Sigmoid(float x)
+{
+    return 1.0f / (1.0f + std::exp(-x));
+}
+
+float BoxIoU(float acx, float acy, float aw, float ah, const RvcTrainingBox & b)
+{
+    float ix1 = std::max(acx - aw / 2, b.cx - b.w / 2);
+    float iy1 = std::max(acy - ah / 2, b.cy - b.h / 2);
+    float ix2 = std::min(acx + aw / 2, b.cx + b.w / 2);
+    float iy2 = std::min(acy + ah / 2, b.cy + b.h / 2);
+    float inter = std::max(0.0f, ix2 - ix1) * std::max(0.0f, iy2 - iy1);
+    float uni = aw * ah + b.w * b.h - inter;
+    return uni > 0.0f ? inter / uni : 0.0f;
+}
+
+// 1 - IoU of a predicted and a target box, both given as (l, t, r, b) distances from the same anchor point, and
+// the gradient with respect to the predicted distances. The anchor lies inside both boxes, so the intersection is
+// min(l, tl) + min(r, tr) wide and min(t, tt) + min(b, tb) high.
+float DistanceIoULoss(const float pred[4], const float target[4], float grad[4])
+{
+    const float iw = std::min(pred[0], target[0]) + std::min(pred[2], target[2]);
+    const float ih = std::min(pred[1], target[1]) + std::min(pred[3], target[3]);
+    const float inter = iw * ih;
+    const float predWidth = pred[0] + pred[2];
+    const float predHeight = pred[1] + pred[3];
+    const float uni = predWidth * predHeight + (target[0] + target[2]) * (target[1] + target[3]) - inter;
+    if (uni <= 0.0f) {
+        std::fill_n(grad, 4, 0.0f);
+        return 1.0f;
+    }
+
+    for (int side = 0; side < 4; ++side) {
+        const bool horizontal = (side % 2) == 0;
+        // d(inter)/d(side) is the other extent while the prediction is the inner edge on that side.
+        const float dInter = pred[side] < target[side] ? (horizontal ? ih : iw) : 0.0f;
+        const float dUnion = (horizontal ? predHeight : predWidth) - dInter;
+        grad[side] = -(dInter * uni - inter * dUnion) / (uni * uni);
+    }
+    return 1.0f - inter / uni;
+}
+
+} // namespace
+
+RvcConvHeadTrainer::RvcConvHeadTrainer()
+    : mType(HeadType::kClassification), mWeights(nullptr), mBias(nullptr), mBiasDirty(false), mPatchSize(0), mNumPositions(0),
+      mAccumulatedSamples(0)
+{
+}
+
+bool RvcConvHeadTrainer::Configure(HeadType type, const Geometry & geometry, const Quantization & quantization,
+                                   RvcQuantizedWeights * weights, int32_t * bias, const Hyperparameters & hyperparameters)
+{
+    const size_t patchSize = static_cast<size_t>(geometry.kernelHeight) * geometry.kernelWidth * geometry.inChannels;
+    if (!weights || !weights->IsBound() || geometry.inChannels <= 0 || geometry.outChannels <= 0 || geometry.outHeight <= 0 ||
+        geometry.outWidth <= 0 || geometry.strideHeight <= 0 || geometry.strideWidth <= 0 ||
+        weights->Count() != patchSize * geometry.outChannels ||
+        (weights->ChannelCount() != 1 && (weights->ChannelCount() != geometry.outChannels || weights->ChannelSize() != patchSize))) {
+        std::cerr << "Error: Invalid Conv2D head configuration." << std::endl;
+        return false;
+    }
+    if (type == HeadType::kBoxDistribution && geometry.outChannels != 4 * kRegMax) {
+        std::cerr << "Error: A box distribution head needs " << 4 * kRegMax << " output channels, not " << geometry.outChannels
+                  << "." << std::endl;
+        return false;
+    }
+
+    mType = type;
+    mGeometry = geometry;
+    mQuantization = quantization;
+    mHyperparameters = hyperparameters;
+    mWeights = weights;
+    mBias = bias;
+    mBiasDirty = false;
+
+    mPatchSize = patchSize;
+    mNumPositions = static_cast<size_t>(geometry.outHeight) * geometry.outWidth;
+    const size_t outChannels = static_cast<size_t>(geometry.outChannels);
+
+    // All buffers are sized once here and reused by every step.
+    mColumns.resize(mNumPositions * mPatchSize);
+    mOutputGrad.assign(mNumPositions * outChannels, 0.0f);
+    mWeightGrad.assign(outChannels * mPatchSize, 0.0f);
+    mBiasGrad.assign(outChannels, 0.0f);
+    mTiles.assign(static_cast<size_t>(kMaxThreads) * kBlockPositions * kBlockPatch, 0.0f);
+    mWeightGradSum.assign(outChannels * mPatchSize, 0.0f);
+    mBiasGradSum.assign(outChannels, 0.0f);
+    mAccumulatedSamples = 0;
+    mWeightVelocity.assign(outChannels * mPatchSize, 0.0f);
+    mBiasVelocity.assign(outChannels, 0.0f);
+
+    mMasterBias.assign(outChannels, 0.0f);
+    if (mBias) {
+        for (size_t co = 0; co < outChannels; ++co) {
+            mMasterBias[co] = mBias[co] * WeightScale(static_cast<int>(co)) * mQuantization.inputScale;
+        }
+    }
+
+    std::cout << "Conv2D head trainer: " << geometry.inHeight << "x" << geometry.inWidth << "x" << geometry.inChannels
+              << " -> " << geometry.outHeight << "x" << geometry.outWidth << "x" << geometry.outChannels << ", kernel "
+              << geometry.kernelHeight << "x" << geometry.kernelWidth << (type == HeadType::kBoxDistribution ? ", box" : ", class")
+              << " loss, im2col " << mColumns.size() / 1024 << " KB"
+              << std::endl;
+    return true;
+}
+
+float RvcConvHeadTrainer::WeightScale(int outChannel) const
+{
+    return mWeights->Scale(mWeights->ChannelCount() == 1 ? 0 : outChannel);
+}
+
+const RvcTrainingBox * RvcConvHeadTrainer::AssignBox(size_t position, const RvcTrainingBox * boxes, size_t numBoxes) const
+{
+    const float cellX = (static_cast<float>(position % mGeometry.outWidth) + 0.5f) / mGeometry.outWidth;
+    const float cellY = (static_cast<float>(position / mGeometry.outWidth) + 0.5f) / mGeometry.outHeight;
+
+    // Centre-sampling assignment: the smallest ground-truth box containing the anchor centre.
+    const RvcTrainingBox * assigned = nullptr;
+    for (size_t b = 0; b < numBoxes; ++b) {
+        const RvcTrainingBox & gt = boxes[b];
+        if (std::fabs(cellX - gt.cx) <= gt.w / 2 && std::fabs(cellY - gt.cy) <= gt.h / 2 &&
+            (assigned == nullptr || gt.w * gt.h < assigned->w * assigned->h)) {
+            assigned = &gt;
+        }
+    }
+    return assigned;
+}
+
+float RvcConvHeadTrainer::ComputeLoss(const int8_t * headOutput, const RvcTrainingBox * boxes, size_t numBoxes,
+                                      const float * predictedBoxes, float * boxLoss)
+{
+    if (mType == HeadType::kBoxDistribution) {
+        return ComputeBoxLoss(headOutput, boxes, numBoxes, boxLoss);
+    }
+    return ComputeClassLoss(headOutput, boxes, numBoxes, predictedBoxes, boxLoss);
+}
+
+float RvcConvHeadTrainer::ComputeClassLoss(const int8_t * headOutput, const RvcTrainingBox * boxes, size_t numBoxes,
+                                           const float * predictedBoxes, float * boxLoss)
+{
+    const int outChannels = mGeometry.outChannels;
+    const float scale = mQuantization.outputScale;
+    const int zp = mQuantization.outputZeroPoint;
+
+    float targetSum = 0.0f;
+    float classLoss = 0.0f;
+    float iouLoss = 0.0f;
+    size_t positives = 0;
+
+    for (size_t p = 0; p < mNumPositions; ++p) {
+        const RvcTrainingBox * assigned = AssignBox(p, boxes, numBoxes);
+
+        float target = 0.0f;
+        int targetClass = -1;
+        if (assigned && assigned->class_id >= 0 && assigned->class_id < outChannels) {
+            targetClass = assigned->class_id;
+            target = 1.0f;
+            if (predictedBoxes) {
+                const float * pb = predictedBoxes + p * 4;
+                float iou = BoxIoU(pb[0], pb[1], pb[2], pb[3], *assigned);
+                iouLoss += 1.0f - iou;
+                target = iou;
+            }
+            targetSum += target;
+            ++positives;
+        }
+
+        const int8_t * logits = headOutput + p * outChannels;
+        float * grad = &mOutputGrad[p * outChannels];
+        for (int c = 0; c < outChannels; ++c) {
+            const float z = (logits[c] - zp) * scale;
+            const float t = (c == targetClass) ? target : 0.0f;
+            // Numerically stable BCE with logits.
+            classLoss += std::max(z, 0.0f) - z * t + std::log1p(std::exp(-std::fabs(z)));
+            grad[c] = Sigmoid(z) - t;
+        }
+    }
+
+    // Normalise by the total target score, as YOLOv8 does, so the loss scale does not depend on the grid size.
+    const float norm = std::max(targetSum, 1.0f);
+    for (float & g : mOutputGrad) {
+        g /= norm;
+    }
+
+    if (boxLoss) {
+        *boxLoss = positives ? iouLoss / positives : 0.0f;
+    }
+    return classLoss / norm;
+}
+
+float RvcConvHeadTrainer::ComputeBoxLoss(const int8_t * headOutput, const RvcTrainingBox * boxes, size_t numBoxes,
+                                         float * boxLoss)
+{
+    const int outChannels = mGeometry.outChannels;
+    const float scale = mQuantization.outputScale; // The zero point cancels out of the softmax
+    // Largest distance the distribution can express; targets are clamped just below it, as in YOLOv8.
+    const float maxDistance = static_cast<float>(kRegMax - 1) - 0.01f;
+
+    std::fill(mOutputGrad.begin(), mOutputGrad.end(), 0.0f);
+
+    float iouLoss = 0.0f;
+    float dflLoss = 0.0f;
+    size_t positives = 0;
+
+    for (size_t p = 0; p < mNumPositions; ++p) {
+        const RvcTrainingBox * assigned = AssignBox(p, boxes, numBoxes);
+        if (!assigned) {
+            continue;
+        }
+        ++positives;
+
+        // Everything in grid cells of this head, relative to the anchor point.
+        const float anchorX = static_cast<float>(p % mGeometry.outWidth) + 0.5f;
+        const float anchorY = static_cast<float>(p / mGeometry.outWidth) + 0.5f;
+        const float target[4] = {
+            anchorX - (assigned->cx - assigned->w / 2) * mGeometry.outWidth,
+            anchorY - (assigned->cy - assigned->h / 2) * mGeometry.outHeight,
+            (assigned->cx + assigned->w / 2) * mGeometry.outWidth - anchorX,
+            (assigned->cy + assigned->h / 2) * mGeometry.outHeight - anchorY,
+        };
+
+        const int8_t * logits = headOutput + p * outChannels;
+        float * grad = &mOutputGrad[p * outChannels];
+
+        // Softmax of every side and its expected distance, as the DFL convolution decodes it.
+        float prob[4][kRegMax];
+        float expected[4];
+        for (int side = 0; side < 4; ++side) {
+            const int8_t * z = logits + side * kRegMax;
+            const int8_t zMax = *std::max_element(z, z + kRegMax);
+            float sum = 0.0f;
+            for (int i = 0; i < kRegMax; ++i) {
+                prob[side][i] = std::exp((z[i] - zMax) * scale);
+                sum += prob[side][i];
+            }
+            expected[side] = 0.0f;
+            for (int i = 0; i < kRegMax; ++i) {
+                prob[side][i] /= sum;
+                expected[side] += prob[side][i] * i;
+            }
+        }
+
+        float iouGrad[4];
+        iouLoss += DistanceIoULoss(expected, target, iouGrad);
+
+        for (int side = 0; side < 4; ++side) {
+            // DFL: cross-entropy towards the two bins around the target, weighted by proximity.
+            const float t = std::max(0.0f, std::min(maxDistance, target[side]));
+            const int left = static_cast<int>(t);
+            const float weightRight = t - static_cast<float>(left);
+            const float weightLeft = 1.0f - weightRight;
+            const float * pr = prob[side];
+            dflLoss -= (weightLeft * std::log(std::max(pr[left], 1e-12f)) +
+                        weightRight * std::log(std::max(pr[left + 1], 1e-12f))) / 4;
+
+            for (int i = 0; i < kRegMax; ++i) {
+                const float dflTarget = (i == left) ? weightLeft : ((i == left + 1) ? weightRight : 0.0f);
+                // d(expected)/dz_i = p_i * (i - expected), through the softmax.
+                grad[side * kRegMax + i] = (pr[i] - dflTarget) / 4 + iouGrad[side] * pr[i] * (i - expected[side]);
+            }
+        }
+    }
+
+    // The distances only see positives, so the loss is their mean.
+    const float norm = static_cast<float>(std::max<size_t>(positives, 1));
+    for (float & g : mOutputGrad) {
+        g /= norm;
+    }
+
+    if (boxLoss) {
+        *boxLoss = positives ? iouLoss / positives : 0.0f;
+    }
+    return (iouLoss + dflLoss) / norm;
+}
+
+void RvcConvHeadTrainer::Im2Col(const int8_t * headInput)
+{
+    const int inChannels = mGeometry.inChannels;
+    const int8_t padValue = static_cast<int8_t>(mQuantization.inputZeroPoint); // Real value 0
+    int8_t * col = mColumns.data();
+
+    for (int oy = 0; oy < mGeometry.outHeight; ++oy) {
+        for (int ox = 0; ox < mGeometry.outWidth; ++ox) {
+            for (int kh = 0; kh < mGeometry.kernelHeight; ++kh) {
+                const int iy = oy * mGeometry.strideHeight - mGeometry.padTop + kh;
+                for (int kw = 0; kw < mGeometry.kernelWidth; ++kw) {
+                    const int ix = ox * mGeometry.strideWidth - mGeometry.padLeft + kw;
+                    if (iy < 0 || iy >= mGeometry.inHeight || ix < 0 || ix >= mGeometry.inWidth) {
+                        std::memset(col, padValue, inChannels);
+                    }
+                    else {
+                        std::memcpy(col, headInput + (static_cast<size_t>(iy) * mGeometry.inWidth + ix) * inChannels,
+                                    inChannels);
+                    }
+                    col += inChannels;
+                }
+            }
+        }
+    }
+}
+
+void RvcConvHeadTrainer::GemmOutputChannels(int firstChannel, int lastChannel, float * tile)
+{
+    const size_t outChannels = static_cast<size_t>(mGeometry.outChannels);
+    const int8_t * columns = mColumns.data();
+    const float * outputGrad = mOutputGrad.data();
+
+    for (int co = firstChannel; co < lastChannel; ++co) {
+        std::fill_n(&mWeightGrad[co * mPatchSize], mPatchSize, 0.0f);
+    }
+
+    // The int8 tile is widened to float once per block and then reused by every output channel.
+
+    for (size_t p0 = 0; p0 < mNumPositions; p0 += kBlockPositions) {
+        const size_t p1 = std::min(mNumPositions, p0 + kBlockPositions);
+        for (size_t k0 = 0; k0 < mPatchSize; k0 += kBlockPatch) {
+            const size_t kLen = std::min(mPatchSize, k0 + kBlockPatch) - k0;
+            for (size_t p = p0; p < p1; ++p) {
+                const int8_t * col = columns + p * mPatchSize + k0;
+                float * row = &tile[(p - p0) * kBlockPatch];
+                for (size_t k = 0; k < kLen; ++k) {
+                    row[k] = static_cast<float>(col[k]);
+                }
+            }
+
+            for (int co = firstChannel; co < lastChannel; ++co) {
+                float * dw = &mWeightGrad[co * mPatchSize + k0];
+                for (size_t p = p0; p < p1; ++p) {
+                    RvcTrainerKernels::MultiplyAccumulate(dw, &tile[(p - p0) * kBlockPatch], outputGrad[p * outChannels + co],
+                                                          kLen);
+                }
+            }
+        }
+    }
+
+    // dW = sA * sum_p g * (a_q - zA): the zero-point term only depends on the per-channel sum of g.
+    for (int co = firstChannel; co < lastChannel; ++co) {
+        float gradSum = 0.0f;
+        for (size_t p = 0; p < mNumPositions; ++p) {
+            gradSum += outputGrad[p * outChannels + co];
+        }
+        mBiasGrad[co] = gradSum;
+
+        const float zeroPointTerm = gradSum * static_cast<float>(mQuantization.inputZeroPoint);
+        float * dw = &mWeightGrad[co * mPatchSize];
+        for (size_t k = 0; k < mPatchSize; ++k) {
+            dw[k] = (dw[k] - zeroPointTerm) * mQuantization.inputScale;
+        }
+    }
+}
+
+void RvcConvHeadTrainer::Backward(const int8_t * headInput)
+{
+    if (!IsConfigured() || !headInput) {
+        return;
+    }
+
+    Im2Col(headInput);
+
+    const int outChannels = mGeometry.outChannels;
+    const size_t macs = mNumPositions * mPatchSize * outChannels;
+    int threads = static_cast<int>(std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), kMaxThreads));
+    threads = std::max(1, std::min({ threads, outChannels, static_cast<int>(macs / kMinMacsPerThread) }));
+
+    if (threads == 1) {
+        GemmOutputChannels(0, outChannels, mTiles.data());
+    }
+    else {
+        RunGemmThreads(threads);
+    }
+
+    RvcTrainerKernels::Accumulate(mWeightGradSum.data(), mWeightGrad.data(), mWeightGrad.size());
+    RvcTrainerKernels::Accumulate(mBiasGradSum.data(), mBiasGrad.data(), mBiasGrad.size());
+    mAccumulatedSamples++;
+}
+
+void RvcConvHeadTrainer::RunGemmThreads(int threads)
+{
+    const int outChannels = mGeometry.outChannels;
+    const size_t tileSize = kBlockPositions * kBlockPatch;
+
+    // Each thread owns a contiguous range of output channels, i.e. disjoint rows of dW: no reduction needed.
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    const int perThread = (outChannels + threads - 1) / threads;
+    for (int t = 1; t < threads; ++t) {
+        int first = t * perThread;
+        int last = std::min(outChannels, first + perThread);
+        if (first < last) {
+            workers.emplace_back(&RvcConvHeadTrainer::GemmOutputChannels, this, first, last, &mTiles[t * tileSize]);
+        }
+    }
+    GemmOutputChannels(0, std::min(outChannels, perThread), mTiles.data());
+    for (auto & worker : workers) {
+        worker.join();
+    }
+}
+
+void RvcConvHeadTrainer::ApplyUpdate(float learningRate)
+{
+    if (!IsConfigured() || mAccumulatedSamples == 0) {
+        return;
+    }
+
+    const float momentum = mHyperparameters.momentum;
+    const float mean = 1.0f / static_cast<float>(mAccumulatedSamples);
+    RvcTrainerKernels::MomentumStep(mWeights->Master(), mWeightVelocity.data(), mWeightGradSum.data(), mWeightGradSum.size(),
+                                    momentum, mHyperparameters.weightDecay, learningRate, mean);
+    // No weight decay on the bias.
+    RvcTrainerKernels::MomentumStep(mMasterBias.data(), mBiasVelocity.data(), mBiasGradSum.data(), mBiasGradSum.size(), momentum,
+                                    0.0f, learningRate, mean);
+
+    DiscardGradients();
+
+    mWeights->MarkDirty();
+    mBiasDirty = (mBias != nullptr);
+}
+
+void RvcConvHeadTrainer::DiscardGradients()
+{
+    std::fill(mWeightGradSum.begin(), mWeightGradSum.end(), 0.0f);
+    std::fill(mBiasGradSum.begin(), mBiasGradSum.end(), 0.0f);
+    mAccumulatedSamples = 0;
+}
+
+void RvcConvHeadTrainer::Commit()
+{
+    if (!IsConfigured()) {
+        return;
+    }
+
+    mWeights->Commit();
+
+    if (mBiasDirty) {
+        // Bias is int32 with scale weightScale * inputScale and no zero point.
+        for (int co = 0; co < mGeometry.outChannels; ++co) {
+            double v = std::nearbyint(mMasterBias[co] / (WeightScale(co) * mQuantization.inputScale));
+            v = std::max<double>(std::numeric_limits<int32_t>::min(), std::min<double>(std::numeric_limits<int32_t>::max(), v));
+            mBias[co] = static_cast<int32_t>(v);
+        }
+        mBiasDirty = false;
+    }
+}
@@ -0,0 +1,227 @@
+#include "RvcDetectionDecoder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+// Largest value of an int8 row. Most anchors are rejected on this value alone,
+// so the index of the maximum is only searched for rows that pass the threshold.
+int8_t MaxInt8(const int8_t * data, int count)
+{
+    int i = 0;
+    int8_t best = -128;
+
+#if defined(__AVX2__)
+    if (count >= 32) {
+        __m256i vmax = _mm256_set1_epi8(-128);
+        for (; i + 32 <= count; i += 32) {
+            vmax = _mm256_max_epi8(vmax, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i)));
+        }
+        __m128i m = _mm_max_epi8(_mm256_castsi256_si128(vmax), _mm256_extracti128_si256(vmax, 1));
+        m = _mm_max_epi8(m, _mm_srli_si128(m, 8));
+        m = _mm_max_epi8(m, _mm_srli_si128(m, 4));
+        m = _mm_max_epi8(m, _mm_srli_si128(m, 2));
+        m = _mm_max_epi8(m, _mm_srli_si128(m, 1));
+        best = static_cast<int8_t>(_mm_cvtsi128_si32(m));
+    }
+    if (i + 16 <= count) {
+        __m128i m = _mm_max_epi8(_mm_set1_epi8(best), _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i)));
+        m = _mm_max_epi8(m, _mm_srli_si128(m, 8));
+        m = _mm_max_epi8(m, _mm_srli_si128(m, 4));
+        m = _mm_max_epi8(m, _mm_srli_si128(m, 2));
+        m = _mm_max_epi8(m, _mm_srli_si128(m, 1));
+        best = static_cast<int8_t>(_mm_cvtsi128_si32(m));
+        i += 16;
+    }
+#elif defined(__SSE2__)
+    // SSE2 only has an unsigned byte max: flip the sign bit to map int8 onto uint8 order.
+    if (count >= 16) {
+        const __m128i bias = _mm_set1_epi8(static_cast<char>(0x80));
+        __m128i vmax = _mm_setzero_si128();
+        for (; i + 16 <= count; i += 16) {
+            __m128i v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i)), bias);
+            vmax = _mm_max_epu8(vmax, v);
+        }
+        vmax = _mm_max_epu8(vmax, _mm_srli_si128(vmax, 8));
+        vmax = _mm_max_epu8(vmax, _mm_srli_si128(vmax, 4));
+        vmax = _mm_max_epu8(vmax, _mm_srli_si128(vmax, 2));
+        vmax = _mm_max_epu8(vmax, _mm_srli_si128(vmax, 1));
+        best = static_cast<int8_t>(static_cast<uint8_t>(_mm_cvtsi128_si32(vmax)) ^ 0x80);
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    if (count >= 16) {
+        int8x16_t vmax = vdupq_n_s8(-128);
+        for (; i + 16 <= count; i += 16) {
+            vmax = vmaxq_s8(vmax, vld1q_s8(data + i));
+        }
+        best = vmaxvq_s8(vmax);
+    }
+#endif
+
+    for (; i < count; ++i) {
+        best = std::max(best, data[i]);
+    }
+    return best;
+}
+
+int FirstIndexOf(const int8_t * data, int count, int8_t value)
+{
+    for (int i = 0; i < count; ++i) {
+        if (data[i] == value) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+float IoU(const RvcDetection & a, const RvcDetection & b)
+{
+    float ix1 = std::max(a.x1, b.x1);
+    float iy1 = std::max(a.y1, b.y1);
+    float ix2 = std::min(a.x2, b.x2);
+    float iy2 = std::min(a.y2, b.y2);
+    float iw = std::max(0.0f, ix2 - ix1);
+    float ih = std::max(0.0f, iy2 - iy1);
+    float inter = iw * ih;
+    float uni = (a.x2 - a.x1) * (a.y2 - a.y1) + (b.x2 - b.x1) * (b.y2 - b.y1) - inter;
+    return uni > 0.0f ? inter / uni : 0.0f;
+}
+
+} // namespace
+
+RvcDetectionDecoder::RvcDetectionDecoder()
+    : mScoreThresholdQ(128), mCandidates(new Candidate[kMaxCandidates]), mLastCandidateCount(0)
+{
+}
+
+RvcDetectionDecoder::~RvcDetectionDecoder()
+{
+}
+
+bool RvcDetectionDecoder::Configure(const Config & config)
+{
+    if (config.outputScale <= 0.0f || config.numAnchors <= 0 || config.numClasses <= 0) {
+        std::cerr << "Error: Invalid detection decoder configuration." << std::endl;
+        return false;
+    }
+
+    mConfig = config;
+
+    // (q - zp) * scale > threshold  <=>  q > threshold / scale + zp
+    float boundary = config.scoreThreshold / config.outputScale + static_cast<float>(config.outputZeroPoint);
+    mScoreThresholdQ = static_cast<int>(std::floor(boundary)) + 1;
+    mScoreThresholdQ = std::max(-128, std::min(128, mScoreThresholdQ));
+
+    std::cout << "Detection decoder: " << config.numAnchors << " anchors, " << config.numClasses
+              << " classes, int8 score threshold " << mScoreThresholdQ << std::endl;
+    return true;
+}
+
+int RvcDetectionDecoder::ArgMaxInt8(const int8_t * scores, int count, int8_t * maxValue)
+{
+    int8_t best = MaxInt8(scores, count);
+    if (maxValue) {
+        *maxValue = best;
+    }
+    return FirstIndexOf(scores, count, best);
+}
+
+void RvcDetectionDecoder::Decode(const int8_t * output, int imageWidth, int imageHeight, RvcDetectionResult & result)
+{
+    result.detectionCount = 0;
+    mLastCandidateCount = 0;
+    if (mScoreThresholdQ > 127) {
+        return;
+    }
+
+    const int stride = mConfig.numClasses + 4;
+    const float scale = mConfig.outputScale;
+    const int zp = mConfig.outputZeroPoint;
+    const int8_t thresholdQ = static_cast<int8_t>(mScoreThresholdQ);
+
+    size_t count = 0;
+    size_t passed = 0;
+    for (int i = 0; i < mConfig.numAnchors; ++i) {
+        const int8_t * row = output + static_cast<size_t>(i) * stride;
+        const int8_t * scores = row + 4;
+
+        int8_t best = MaxInt8(scores, mConfig.numClasses);
+        if (best < thresholdQ) {
+            continue;
+        }
+
+        if (count == kMaxCandidates) {
+            count = SelectTopCandidates(count);
+        }
+
+        float cx = (row[0] - zp) * scale;
+        float cy = (row[1] - zp) * scale;
+        float w = (row[2] - zp) * scale;
+        float h = (row[3] - zp) * scale;
+
+        Candidate & c = mCandidates[count++];
+        c.box.x1 = (cx - w / 2) * imageWidth;
+        c.box.y1 = (cy - h / 2) * imageHeight;
+        c.box.x2 = (cx + w / 2) * imageWidth;
+        c.box.y2 = (cy + h / 2) * imageHeight;
+        c.box.score = (best - zp) * scale;
+        c.box.class_id = FirstIndexOf(scores, mConfig.numClasses, best);
+        c.rawScore = best;
+        c.suppressed = false;
+        ++passed;
+    }
+
+    mLastCandidateCount = passed;
+    RunNms(SelectTopCandidates(count), result);
+}
+
+size_t RvcDetectionDecoder::SelectTopCandidates(size_t count)
+{
+    if (count <= kMaxNmsCandidates) {
+        return count;
+    }
+
+    // Partial selection: the first kMaxNmsCandidates entries end up being the best ones, in no particular order.
+    std::nth_element(mCandidates.get(), mCandidates.get() + kMaxNmsCandidates - 1, mCandidates.get() + count,
+                     [](const Candidate & a, const Candidate & b) { return a.rawScore > b.rawScore; });
+    return kMaxNmsCandidates;
+}
+
+void RvcDetectionDecoder::RunNms(size_t count, RvcDetectionResult & result)
+{
+    Candidate * candidates = mCandidates.get();
+
+    while (result.detectionCount < kRvcMaxDetections) {
+        // Best remaining candidate; a linear scan is cheaper than sorting for the few boxes that survive.
+        Candidate * best = nullptr;
+        for (size_t i = 0; i < count; ++i) {
+            if (!candidates[i].suppressed && (best == nullptr || candidates[i].rawScore > best->rawScore)) {
+                best = &candidates[i];
+            }
+        }
+        if (best == nullptr) {
+            break;
+        }
+
+        best->suppressed = true;
+        result.detections[result.detectionCount++] = best->box;
+
+        for (size_t i = 0; i < count; ++i) {
+            Candidate & other = candidates[i];
+            if (!other.suppressed && other.box.class_id == best->box.class_id &&
+                IoU(other.box, best->box) > mConfig.iouThreshold) {
+                other.suppressed = true;
+            }
+        }
+    }
+}
@@ -0,0 +1,95 @@
+#include "RvcFLScheduler.h"
+#include "RvcFlowerClient.h"
+#include "start.h" // Flower C++ SDK
+
+#include <chrono>
+#include <iostream>
+
+#if defined(__linux__)
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+// Lowest CPU priority: training must never delay inference or the Matter stack.
+constexpr int kSchedulerNiceValue = 19;
+} // namespace
+
+RvcFLScheduler::RvcFLScheduler()
+    : mClient(nullptr)
+{
+}
+
+RvcFLScheduler::~RvcFLScheduler()
+{
+    Stop();
+}
+
+bool RvcFLScheduler::Start(RvcFlowerClient * client, const std::string & serverAddress)
+{
+    if (!client || serverAddress.empty()) { std::cerr << "Error: Invalid FL scheduler configuration." << std::endl; return false; }
+    if (mRunning.load()) { return true; }
+
+    mClient = client;
+    mServerAddress = serverAddress;
+    mClient->SetPreempted(!mTrainingAllowed.load());
+    mRunning.store(true);
+    mThread = std::thread(&RvcFLScheduler::SchedulerThreadMain, this);
+
+    std::cout << "FL scheduler started, server " << serverAddress << std::endl;
+    return true;
+}
+
+void RvcFLScheduler::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (!mRunning.exchange(false)) { return; }
+    }
+    // Abort a running fit() rather than waiting for the whole round.
+    mClient->SetPreempted(true);
+    mCondition.notify_all();
+    if (mThread.joinable()) { mThread.join(); }
+}
+
+void RvcFLScheduler::SetTrainingAllowed(bool allowed)
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (mTrainingAllowed.exchange(allowed) == allowed) { return; }
+        if (mClient) { mClient->SetPreempted(!allowed); }
+    }
+    mCondition.notify_all();
+
+    std::cout << "FL scheduler: training " << (allowed ? "allowed" : "pre-empted") << std::endl;
+}
+
+void RvcFLScheduler::SchedulerThreadMain()
+{
+#if defined(__linux__)
+    // On Linux the nice value is per thread.
+    if (setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), kSchedulerNiceValue) != 0) {
+        std::cerr << "Warning: Failed to lower the FL scheduler thread priority." << std::endl;
+    }
+#endif
+
+    while (mRunning.load()) {
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mCondition.wait(lock, [this] { return !mRunning.load() || mTrainingAllowed.load(); });
+        }
+        if (!mRunning.load()) { break; }
+
+        // Blocks for as long as the robot stays docked; fit() and evaluate() are driven by the server.
+        std::cout << "FL scheduler: joining the federation" << std::endl;
+        start::start_client(mServerAddress, mClient, [this] { return KeepFederating(); });
+        std::cout << "FL scheduler: left the federation" << std::endl;
+
+        // The server ended the session while still docked: don't reconnect in a tight loop.
+        if (KeepFederating()) {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mCondition.wait_for(lock, std::chrono::seconds(30), [this] { return !KeepFederating(); });
+        }
+    }
+}
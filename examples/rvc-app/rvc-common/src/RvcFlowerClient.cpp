@@ -1,10 +1,36 @@
 #include "RvcFlowerClient.h"
+#include "RvcWeightCodec.h"
 
 #include <iostream>
 #include <list>
 #include <vector>
+#include <algorithm>
 #include <cstring>
 
+namespace {
+constexpr float kDefaultLearningRate = 0.01f;
+constexpr int kDefaultLocalEpochs = 1;
+constexpr int kDefaultBatchSize = 8;
+constexpr float kMatchIoU = 0.5f;
+
+// IoU of a label (centre format) and a detection (corner format), both normalised.
+float BoxIoU(const RvcTrainingBox& label, const RvcDetection& det)
+{
+    float lx1 = label.cx - label.w * 0.5f;
+    float ly1 = label.cy - label.h * 0.5f;
+    float lx2 = label.cx + label.w * 0.5f;
+    float ly2 = label.cy + label.h * 0.5f;
+    float iw = std::min(lx2, det.x2) - std::max(lx1, det.x1);
+    float ih = std::min(ly2, det.y2) - std::max(ly1, det.y1);
+    if (iw <= 0.0f || ih <= 0.0f) {
+        return 0.0f;
+    }
+    float inter = iw * ih;
+    float uni = label.w * label.h + (det.x2 - det.x1) * (det.y2 - det.y1) - inter;
+    return uni > 0.0f ? inter / uni : 0.0f;
+}
+} // namespace
+
 RvcFlowerClient::RvcFlowerClient(RvcAIInterface* ai_interface, RvcAITrainer* trainer, int node_id)
     : mAIInterface(ai_interface), mTrainer(trainer), mNodeId(node_id)
 {
@@ -16,56 +42,95 @@ RvcFlowerClient::~RvcFlowerClient()
     std::cout << "RvcFlowerClient destroyed." << std::endl;
 }
 
-flwr_local::Parameters RvcFlowerClient::GetWeightsAsParameters()
+flwr_local::Parameters RvcFlowerClient::GetWeightsAsParameters(bool sparse, size_t top_k)
 {
-    // Get int8 weights from trainer
     size_t weight_count = mTrainer->GetLastLayerWeightsCount();
-    std::vector<int8_t> weights(weight_count);
-    size_t buffer_size;
 
-    if (!mTrainer->GetLastLayerWeightsInt8(weights.data(), &buffer_size)) {
+    // Serialise straight from the tensor arena into the message buffer.
+    std::string weights_bytes(weight_count, '\0');
+    size_t buffer_size;
+    if (!mTrainer->GetLastLayerWeightsInt8(reinterpret_cast<int8_t*>(&weights_bytes[0]), &buffer_size)) {
         std::cerr << "Error: Failed to get weights from trainer!" << std::endl;
         return flwr_local::Parameters();
     }
 
-    // Convert int8 weights to string (bytes)
-    std::string weights_bytes(reinterpret_cast<char*>(weights.data()), weight_count);
+    std::string tensor_type = RvcWeightCodec::kDenseType;
+    if (sparse && mHasBaseline && mBaseline.size() == weight_count) {
+        std::string encoded;
+        size_t sent = RvcWeightCodec::EncodeSparse(mBaseline.data(), reinterpret_cast<const int8_t*>(weights_bytes.data()),
+                                                   weight_count, top_k, encoded, mCodecScratch);
+        // A dense upload is both smaller and simpler once most weights changed.
+        if (encoded.size() < weights_bytes.size()) {
+            std::cout << "Node " << mNodeId << ": Sparse upload of " << sent << " changed weights, " << encoded.size()
+                      << " bytes instead of " << weights_bytes.size() << std::endl;
+            weights_bytes.swap(encoded);
+            tensor_type = RvcWeightCodec::kSparseType;
+        }
+    }
 
-    // Create list of tensors (in this case, just one tensor)
     std::list<std::string> tensors;
-    tensors.push_back(weights_bytes);
-
-    // Create Parameters object
-    flwr_local::Parameters params(tensors, "int8");
+    tensors.push_back(std::move(weights_bytes));
 
-    std::cout << "Node " << mNodeId << ": Exported " << weight_count << " weights" << std::endl;
+    std::cout << "Node " << mNodeId << ": Exported " << weight_count << " weights (" << tensor_type << ")" << std::endl;
 
-    return params;
+    return flwr_local::Parameters(std::move(tensors), tensor_type);
 }
 
-void RvcFlowerClient::SetParametersAsWeights(const flwr_local::Parameters& params)
+bool RvcFlowerClient::SetParametersAsWeights(const flwr_local::Parameters& params)
 {
-    // Get tensors from parameters
-    std::list<std::string> tensors = params.getTensors();
-
+    const std::list<std::string>& tensors = params.getTensors();
     if (tensors.empty()) {
         std::cerr << "Error: No tensors in parameters!" << std::endl;
-        return;
+        return false;
     }
 
-    // Get first tensor (we only have one)
-    std::string weights_bytes = tensors.front();
-
-    // Convert string to int8 vector
-    std::vector<int8_t> weights(weights_bytes.begin(), weights_bytes.end());
+    // All trainable heads travel concatenated in the first tensor.
+    const std::string& weights_bytes = tensors.front();
+    const std::string tensor_type = params.getTensor_type();
+    size_t weight_count = mTrainer->GetLastLayerWeightsCount();
+    const int8_t* weights = reinterpret_cast<const int8_t*>(weights_bytes.data());
+
+    if (tensor_type == RvcWeightCodec::kSparseType) {
+        // Changes relative to the previous global weights, applied in place.
+        if (!mHasBaseline || !RvcWeightCodec::ApplySparse(weights_bytes, mBaseline.data(), mBaseline.size())) {
+            std::cerr << "Error: Cannot apply sparse parameters without a matching baseline!" << std::endl;
+            mHasBaseline = false;
+            return false;
+        }
+        weights = mBaseline.data();
+    }
+    else if (weights_bytes.size() != weight_count) {
+        std::cerr << "Error: Expected " << weight_count << " weights but got " << weights_bytes.size() << std::endl;
+        return false;
+    }
 
-    // Set weights to trainer
-    if (!mTrainer->SetLastLayerWeightsInt8(weights.data(), weights.size())) {
+    // Straight from the message buffer (or the baseline) into the tensor arena.
+    if (!mTrainer->SetLastLayerWeightsInt8(weights, weight_count)) {
         std::cerr << "Error: Failed to set weights to trainer!" << std::endl;
-        return;
+        return false;
     }
 
-    std::cout << "Node " << mNodeId << ": Imported " << weights.size() << " weights" << std::endl;
+    if (weights != mBaseline.data()) {
+        mBaseline.assign(weights, weights + weight_count);
+    }
+    mHasBaseline = true;
+
+    std::cout << "Node " << mNodeId << ": Imported " << weight_count << " weights (" << tensor_type << ")" << std::endl;
+    return true;
+}
+
+bool RvcFlowerClient::AddTrainingSample(const int8_t* input_tensor, size_t size, const RvcTrainingBox* boxes,
+                                        size_t num_boxes)
+{
+    if (!mStore || !mStore->IsOpen()) {
+        std::cerr << "Error: No replay store to add the training sample to." << std::endl;
+        return false;
+    }
+    if (!input_tensor || size != mAIInterface->GetInputTensorBytes()) {
+        std::cerr << "Error: Training sample does not match the model input." << std::endl;
+        return false;
+    }
+    return mStore->Add(input_tensor, size, boxes, num_boxes, false);
 }
 
 // ============================================================================
@@ -93,32 +158,116 @@ flwr_local::FitRes RvcFlowerClient::fit(flwr_local::FitIns ins)
 {
     std::cout << "Node " << mNodeId << ": fit() called - Starting training..." << std::endl;
 
-    // Step 1: Set global weights from server
-    SetParametersAsWeights(ins.getParameters());
+    // Step 1: Set global weights from server. Training on top of anything else would hand the server an
+    // update against the wrong base, so skip the round and report no examples to keep it out of the average.
+    if (!SetParametersAsWeights(ins.getParameters())) {
+        std::cerr << "Node " << mNodeId << ": Cannot apply the global weights, skipping this round." << std::endl;
+        flwr_local::FitRes res;
+        res.setParameters(GetWeightsAsParameters());
+        res.setNum_example(0);
+        flwr_local::Metrics metrics;
+        flwr_local::Scalar rejected_flag;
+        rejected_flag.setInt(1);
+        metrics["weights_rejected"] = rejected_flag;
+        res.setMetrics(metrics);
+        return res;
+    }
 
     // Step 2: Perform local training
-    // TODO: Implement actual training with gradient calculation
-    // For now, we'll do a simple dummy update
-    size_t weight_count = mTrainer->GetLastLayerWeightsCount();
-    std::vector<int8_t> dummy_gradients(weight_count, 1); // All gradients = 1
+    float learning_rate = kDefaultLearningRate;
+    int local_epochs = kDefaultLocalEpochs;
+    std::map<std::string, flwr_local::Scalar> config = ins.getConfig();
+    if (config.count("lr") && config["lr"].getDouble()) {
+        learning_rate = static_cast<float>(*config["lr"].getDouble());
+    }
+    if (config.count("local_epochs") && config["local_epochs"].getInt()) {
+        local_epochs = *config["local_epochs"].getInt();
+    }
+    bool sparse_upload = config.count("weight_encoding") && config["weight_encoding"].getString() &&
+        *config["weight_encoding"].getString() == RvcWeightCodec::kSparseType;
+    size_t sparse_top_k = 0;
+    if (config.count("sparse_top_k") && config["sparse_top_k"].getInt()) {
+        sparse_top_k = static_cast<size_t>(std::max(0, *config["sparse_top_k"].getInt()));
+    }
 
-    std::cout << "Node " << mNodeId << ": Applying dummy gradients..." << std::endl;
-    mTrainer->UpdateWeightsInt8(dummy_gradients.data(), dummy_gradients.size());
+    int batch_size = kDefaultBatchSize;
+    if (config.count("batch_size") && config["batch_size"].getInt() && *config["batch_size"].getInt() > 0) {
+        batch_size = *config["batch_size"].getInt();
+    }
 
-    std::cout << "Node " << mNodeId << ": Training finished." << std::endl;
+    double total_loss = 0.0;
+    int steps = 0;
+    size_t num_examples = 0;
+    bool preempted = false;
+    for (int epoch = 0; epoch < local_epochs && !preempted && mStore; ++epoch) {
+        // Reshuffled every epoch. Samples stream from the mapped store one mini-batch per lock,
+        // so the inference worker can keep capturing between batches.
+        mStore->GetSplit(false, mOrder);
+        num_examples = mOrder.size();
+        for (size_t first = 0; first < mOrder.size() && !preempted; first += batch_size) {
+            size_t last = std::min(mOrder.size(), first + static_cast<size_t>(batch_size));
+            auto lock = mStore->Lock();
+            int batch_steps = 0;
+            for (size_t i = first; i < last; ++i) {
+                if (mPreempted.load()) {
+                    preempted = true;
+                    break;
+                }
+                RvcReplaySample sample;
+                if (!mStore->Get(mOrder[i], sample)) {
+                    continue;
+                }
+                float loss = 0.0f;
+                if (!mTrainer->AccumulateStep(sample.input, sample.boxes, sample.numBoxes, &loss)) {
+                    std::cerr << "Node " << mNodeId << ": Training step failed." << std::endl;
+                    continue;
+                }
+                total_loss += loss;
+                ++steps;
+                ++batch_steps;
+            }
+            // One SGD step per mini-batch on the mean gradient. A pre-empted batch is dropped,
+            // the weights are restored below anyway.
+            if (preempted) {
+                mTrainer->DiscardAccumulatedGradients();
+            }
+            else if (batch_steps > 0) {
+                mTrainer->ApplyAccumulatedUpdate(learning_rate);
+            }
+        }
+    }
+    if (num_examples == 0) {
+        std::cout << "Node " << mNodeId << ": No local samples, returning the global weights unchanged." << std::endl;
+    }
 
-    // Step 3: Return updated weights
-    flwr_local::Parameters updated_params = GetWeightsAsParameters();
 
+
+    // Step 3: Return updated weights
     // Create FitRes
     flwr_local::FitRes res;
-    res.setParameters(updated_params);
-    res.setNum_example(100);  // Dummy: number of training samples
+    flwr_local::Metrics metrics;
+    if (preempted) {
+        // Put the global weights back so the robot does not clean with a half-trained head,
+        // and report no examples so the server gives this result no weight.
+        std::cout << "Node " << mNodeId << ": Training pre-empted after " << steps << " steps." << std::endl;
+        if (mHasBaseline) {
+            mTrainer->SetLastLayerWeightsInt8(mBaseline.data(), mBaseline.size());
+        }
+        res.setParameters(GetWeightsAsParameters());
+        res.setNum_example(0);
+        flwr_local::Scalar preempted_flag;
+        preempted_flag.setInt(1);
+        metrics["preempted"] = preempted_flag;
+    }
+    else {
+        std::cout << "Node " << mNodeId << ": Training finished (" << steps << " steps)." << std::endl;
+        res.setParameters(GetWeightsAsParameters(sparse_upload, sparse_top_k));
+        res.setNum_example(static_cast<int>(num_examples));
+    }
 
     // Optional: Add metrics
-    flwr_local::Metrics metrics;
     flwr_local::Scalar train_loss;
-    train_loss.setDouble(0.5);  // Dummy loss value
+    train_loss.setDouble(steps > 0 ? total_loss / steps : 0.0);
     metrics["train_loss"] = train_loss;
     res.setMetrics(metrics);
 
@@ -132,26 +281,108 @@ flwr_local::EvaluateRes RvcFlowerClient::evaluate(flwr_local::EvaluateIns ins)
     // Step 1: Set weights from server
     SetParametersAsWeights(ins.getParameters());
 
-    // Step 2: Evaluate model
-    // TODO: Implement actual evaluation
-    // For now, return dummy metrics
+    // Step 2: Evaluate model on the held-out split. User labels are the ground truth when
+    // there are any; pseudo-labels are only used as a fallback.
+    double total_loss = 0.0;
+    size_t evaluated = 0;
+    size_t true_positives = 0;
+    size_t false_positives = 0;
+    size_t false_negatives = 0;
+    if (mStore) {
+        mStore->GetSplit(true, mOrder);
+    }
+    else {
+        mOrder.clear();
+    }
 
-    float dummy_loss = 0.5f;
-    float dummy_accuracy = 0.8f;
+    bool has_user_labels = false;
+    if (mStore) {
+        auto lock = mStore->Lock();
+        for (uint32_t index : mOrder) {
+            RvcReplaySample sample;
+            has_user_labels = has_user_labels || (mStore->Get(index, sample) && !sample.pseudoLabel);
+        }
+    }
+
+    RvcDetectionResult detections;
+    std::vector<bool> matched;
+    for (uint32_t index : mOrder) {
+        if (mPreempted.load()) {
+            break;
+        }
+        // Only the copy holds the store lock; the forward pass runs without it, so replay capture is
+        // never blocked for a whole evaluation.
+        {
+            auto lock = mStore->Lock();
+            RvcReplaySample sample;
+            if (!mStore->Get(index, sample) || (has_user_labels && sample.pseudoLabel)) {
+                continue;
+            }
+            mEvalInput.assign(sample.input, sample.input + mStore->InputBytes());
+            mEvalBoxes.assign(sample.boxes, sample.boxes + sample.numBoxes);
+        }
+        float loss = 0.0f;
+        if (!mTrainer->EvaluateSample(mEvalInput.data(), mEvalBoxes.data(), mEvalBoxes.size(), &loss, &detections)) {
+            continue;
+        }
+        total_loss += loss;
+        ++evaluated;
+
+        // Greedy matching in score order: a detection is correct if it overlaps an unmatched
+        // label of the same class by at least kMatchIoU.
+        matched.assign(mEvalBoxes.size(), false);
+        for (size_t d = 0; d < detections.detectionCount; ++d) {
+            const RvcDetection& det = detections.detections[d];
+            int best = -1;
+            float best_iou = kMatchIoU;
+            for (size_t l = 0; l < mEvalBoxes.size(); ++l) {
+                float iou = BoxIoU(mEvalBoxes[l], det);
+                if (!matched[l] && mEvalBoxes[l].class_id == det.class_id && iou >= best_iou) {
+                    best = static_cast<int>(l);
+                    best_iou = iou;
+                }
+            }
+            if (best >= 0) {
+                matched[best] = true;
+                ++true_positives;
+            }
+            else {
+                ++false_positives;
+            }
+        }
+        false_negatives += std::count(matched.begin(), matched.end(), false);
+    }
 
-    std::cout << "Node " << mNodeId << ": Evaluation finished. Loss=" << dummy_loss
-              << ", Accuracy=" << dummy_accuracy << std::endl;
+    double mean_loss = evaluated > 0 ? total_loss / evaluated : 0.0;
+    double precision = (true_positives + false_positives) > 0 ?
+        static_cast<double>(true_positives) / (true_positives + false_positives) : 0.0;
+    double recall = (true_positives + false_negatives) > 0 ?
+        static_cast<double>(true_positives) / (true_positives + false_negatives) : 0.0;
+    double f1 = (precision + recall) > 0.0 ? 2.0 * precision * recall / (precision + recall) : 0.0;
+
+    std::cout << "Node " << mNodeId << ": Evaluation finished on " << evaluated
+              << (has_user_labels ? " labelled" : " pseudo-labelled") << " samples. Loss=" << mean_loss
+              << ", Precision=" << precision << ", Recall=" << recall << std::endl;
 
     // Create EvaluateRes
     flwr_local::EvaluateRes res;
-    res.setLoss(dummy_loss);
-    res.setNum_example(100);  // Dummy: number of test samples
+    res.setLoss(static_cast<float>(mean_loss));
+    res.setNum_example(static_cast<int>(evaluated));
 
-    // Optional: Add metrics
     flwr_local::Metrics metrics;
+    flwr_local::Scalar precision_scalar;
+    precision_scalar.setDouble(precision);
+    metrics["precision"] = precision_scalar;
+    flwr_local::Scalar recall_scalar;
+    recall_scalar.setDouble(recall);
+    metrics["recall"] = recall_scalar;
+    // Detection has no single accuracy; F1 at IoU 0.5 is reported under the key the server reads.
     flwr_local::Scalar acc_scalar;
-    acc_scalar.setDouble(static_cast<double>(dummy_accuracy));
+    acc_scalar.setDouble(f1);
     metrics["accuracy"] = acc_scalar;
+    flwr_local::Scalar pseudo_scalar;
+    pseudo_scalar.setInt(has_user_labels ? 0 : 1);
+    metrics["pseudo_labels"] = pseudo_scalar;
     res.setMetrics(metrics);
 
     return res;
@@ -0,0 +1,679 @@
+#include "RvcInt8Kernels.h"
+
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/micro/kernels/conv.h"
+#include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/pooling.h"
+#include "tensorflow/lite/micro/micro_context.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace {
+// Output pixels unrolled per im2col tile. 32 rows of the widest YOLOv8n kernel (3x3x256) is 72KB.
+constexpr int kTilePixels = 32;
+constexpr size_t kScratchAlignment = 64;
+// Below this many 4-channel blocks per thread, a Conv2D is split by pixels rather than channels.
+constexpr int kMinBlocksPerThread = 4;
+
+size_t AlignUp(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// Runs one task per thread, the caller being task 0. Only one Run() at a time.
+class KernelThreadPool {
+public:
+    ~KernelThreadPool() { Resize(1); }
+
+    void Resize(int threads)
+    {
+        std::lock_guard<std::mutex> run_lock(mRunMutex);
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStop = true;
+        }
+        mWakeCondition.notify_all();
+        for (std::thread & worker : mWorkers) { worker.join(); }
+        mWorkers.clear();
+        mStop = false;
+
+        for (int i = 1; i < threads; ++i) {
+            mWorkers.emplace_back(&KernelThreadPool::WorkerMain, this, i);
+        }
+        mSize.store(threads);
+    }
+
+    int Size() const { return mSize.load(); }
+
+    void Run(int tasks, const std::function<void(int, int)> & task)
+    {
+        std::lock_guard<std::mutex> run_lock(mRunMutex);
+        tasks = std::min(tasks, mSize.load());
+        if (tasks <= 1) {
+            task(0, 1);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mTask = &task;
+            mTasks = tasks;
+            mPending = tasks - 1;
+            mGeneration++;
+        }
+        mWakeCondition.notify_all();
+
+        task(0, tasks);
+
+        std::unique_lock<std::mutex> lock(mMutex);
+        mDoneCondition.wait(lock, [this] { return mPending == 0; });
+        mTask = nullptr;
+    }
+
+private:
+    void WorkerMain(int index)
+    {
+        uint64_t seen = 0;
+        std::unique_lock<std::mutex> lock(mMutex);
+        while (true) {
+            mWakeCondition.wait(lock, [&] { return mStop || mGeneration != seen; });
+            if (mStop) { return; }
+            seen = mGeneration;
+            if (index >= mTasks) { continue; }
+
+            const std::function<void(int, int)> * task = mTask;
+            int tasks = mTasks;
+            lock.unlock();
+            (*task)(index, tasks);
+            lock.lock();
+            if (--mPending == 0) { mDoneCondition.notify_one(); }
+        }
+    }
+
+    std::mutex mRunMutex;
+    std::mutex mMutex;
+    std::condition_variable mWakeCondition;
+    std::condition_variable mDoneCondition;
+    std::vector<std::thread> mWorkers;
+    std::atomic<int> mSize{ 1 };
+    const std::function<void(int, int)> * mTask = nullptr;
+    int mTasks = 0;
+    int mPending = 0;
+    uint64_t mGeneration = 0;
+    bool mStop = false;
+};
+
+KernelThreadPool & Pool()
+{
+    static KernelThreadPool pool;
+    static std::once_flag started;
+    std::call_once(started, [] {
+        unsigned int cores = std::thread::hardware_concurrency();
+        pool.Resize(static_cast<int>(std::max(1u, std::min(cores, 4u))));
+    });
+    return pool;
+}
+
+#if defined(__SSE2__)
+int32_t HorizontalSum(__m128i sum)
+{
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sum);
+}
+#endif
+
+#if defined(__AVX2__)
+int32_t HorizontalSum(__m256i v)
+{
+    return HorizontalSum(_mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1)));
+}
+#elif defined(__SSE2__)
+
+// Sign-extends the low or high 8 bytes to int16 (SSE2 has no cvtepi8).
+__m128i WidenLow(__m128i v)
+{
+    return _mm_srai_epi16(_mm_unpacklo_epi8(v, v), 8);
+}
+
+__m128i WidenHigh(__m128i v)
+{
+    return _mm_srai_epi16(_mm_unpackhi_epi8(v, v), 8);
+}
+#endif
+
+// acc[r][c] = dot(rows[r], filter + c * depth) for kRows input rows and kCols filter rows.
+// Products are widened to 16 bits and summed pairwise into 32 bits, so nothing saturates.
+template <int kRows, int kCols>
+void DotBlock(const int8_t * const * rows, const int8_t * filter, size_t depth, int32_t (&acc)[kRows][kCols])
+{
+    size_t k = 0;
+#if defined(__AVX2__)
+    __m256i sum[kRows][kCols];
+    for (int r = 0; r < kRows; ++r) {
+        for (int c = 0; c < kCols; ++c) { sum[r][c] = _mm256_setzero_si256(); }
+    }
+    for (; k + 16 <= depth; k += 16) {
+        __m256i a[kRows];
+        for (int r = 0; r < kRows; ++r) {
+            a[r] = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(rows[r] + k)));
+        }
+        for (int c = 0; c < kCols; ++c) {
+            __m256i b = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(filter + c * depth + k)));
+            for (int r = 0; r < kRows; ++r) { sum[r][c] = _mm256_add_epi32(sum[r][c], _mm256_madd_epi16(a[r], b)); }
+        }
+    }
+    for (int r = 0; r < kRows; ++r) {
+        for (int c = 0; c < kCols; ++c) { acc[r][c] = HorizontalSum(sum[r][c]); }
+    }
+    // Depths like the stem's 3x3x3 = 27 spend a large share in the tail: take 8 more at once.
+    if (k + 8 <= depth) {
+        __m128i a[kRows];
+        for (int r = 0; r < kRows; ++r) {
+            a[r] = _mm_cvtepi8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(rows[r] + k)));
+        }
+        for (int c = 0; c < kCols; ++c) {
+            __m128i b = _mm_cvtepi8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(filter + c * depth + k)));
+            for (int r = 0; r < kRows; ++r) { acc[r][c] += HorizontalSum(_mm_madd_epi16(a[r], b)); }
+        }
+        k += 8;
+    }
+#elif defined(__SSE2__)
+    __m128i sum[kRows][kCols];
+    for (int r = 0; r < kRows; ++r) {
+        for (int c = 0; c < kCols; ++c) { sum[r][c] = _mm_setzero_si128(); }
+    }
+    for (; k + 16 <= depth; k += 16) {
+        __m128i a_lo[kRows];
+        __m128i a_hi[kRows];
+        for (int r = 0; r < kRows; ++r) {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rows[r] + k));
+            a_lo[r] = WidenLow(a);
+            a_hi[r] = WidenHigh(a);
+        }
+        for (int c = 0; c < kCols; ++c) {
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(filter + c * depth + k));
+            __m128i b_lo = WidenLow(b);
+            __m128i b_hi = WidenHigh(b);
+            for (int r = 0; r < kRows; ++r) {
+                sum[r][c] = _mm_add_epi32(sum[r][c], _mm_madd_epi16(a_lo[r], b_lo));
+                sum[r][c] = _mm_add_epi32(sum[r][c], _mm_madd_epi16(a_hi[r], b_hi));
+            }
+        }
+    }
+    for (int r = 0; r < kRows; ++r) {
+        for (int c = 0; c < kCols; ++c) { acc[r][c] = HorizontalSum(sum[r][c]); }
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    int32x4_t sum[kRows][kCols];
+    for (int r = 0; r < kRows; ++r) {
+        for (int c = 0; c < kCols; ++c) { sum[r][c] = vdupq_n_s32(0); }
+    }
+    for (; k + 16 <= depth; k += 16) {
+        int8x16_t a[kRows];
+        for (int r = 0; r < kRows; ++r) { a[r] = vld1q_s8(rows[r] + k); }
+        for (int c = 0; c < kCols; ++c) {
+            int8x16_t b = vld1q_s8(filter + c * depth + k);
+            for (int r = 0; r < kRows; ++r) {
+#if defined(__ARM_FEATURE_DOTPROD)
+                sum[r][c] = vdotq_s32(sum[r][c], a[r], b);
+#else
+                sum[r][c] = vpadalq_s16(sum[r][c], vmull_s8(vget_low_s8(a[r]), vget_low_s8(b)));
+                sum[r][c] = vpadalq_s16(sum[r][c], vmull_high_s8(a[r], b));
+#endif
+            }
+        }
+    }
+    for (int r = 0; r < kRows; ++r) {
+        for (int c = 0; c < kCols; ++c) { acc[r][c] = vaddvq_s32(sum[r][c]); }
+    }
+#else
+    for (int r = 0; r < kRows; ++r) {
+        for (int c = 0; c < kCols; ++c) { acc[r][c] = 0; }
+    }
+#endif
+    for (; k < depth; ++k) {
+        for (int r = 0; r < kRows; ++r) {
+            for (int c = 0; c < kCols; ++c) { acc[r][c] += rows[r][k] * filter[c * depth + k]; }
+        }
+    }
+}
+
+int8_t Requantize(int32_t acc, int channel, const RvcConvInt8Params & params)
+{
+    acc = tflite::MultiplyByQuantizedMultiplier(acc, params.outputMultiplier[channel], params.outputShift[channel]);
+    acc += params.outputZeroPoint;
+    acc = std::max(acc, params.activationMin);
+    acc = std::min(acc, params.activationMax);
+    return static_cast<int8_t>(acc);
+}
+
+// Multiplies rowCount input rows with filter rows [first, last) and writes the requantized outputs.
+template <int kCols>
+void ConvChannelBlock(const RvcConvInt8Params & params, const int8_t * const * rows, int rowCount, const int8_t * filter,
+                      size_t depth, const int32_t * offsets, int channel, int8_t * output)
+{
+    const int8_t * channel_filter = filter + static_cast<size_t>(channel) * depth;
+    int r = 0;
+    for (; r + 2 <= rowCount; r += 2) {
+        int32_t acc[2][kCols];
+        DotBlock<2, kCols>(rows + r, channel_filter, depth, acc);
+        for (int i = 0; i < 2; ++i) {
+            int8_t * out = output + static_cast<size_t>(r + i) * params.outputChannels + channel;
+            for (int c = 0; c < kCols; ++c) { out[c] = Requantize(acc[i][c] + offsets[channel + c], channel + c, params); }
+        }
+    }
+    if (r < rowCount) {
+        int32_t acc[1][kCols];
+        DotBlock<1, kCols>(rows + r, channel_filter, depth, acc);
+        int8_t * out = output + static_cast<size_t>(r) * params.outputChannels + channel;
+        for (int c = 0; c < kCols; ++c) { out[c] = Requantize(acc[0][c] + offsets[channel + c], channel + c, params); }
+    }
+}
+
+bool IsPointwise(const RvcConvInt8Params & params)
+{
+    return params.filterHeight == 1 && params.filterWidth == 1 && params.strideHeight == 1 && params.strideWidth == 1 &&
+        params.padHeight == 0 && params.padWidth == 0 && params.outputHeight == params.inputHeight &&
+        params.outputWidth == params.inputWidth;
+}
+
+size_t TileBytes(const RvcConvInt8Params & params)
+{
+    size_t depth = static_cast<size_t>(params.filterHeight) * params.filterWidth * params.inputChannels;
+    return IsPointwise(params) ? 0 : AlignUp(kTilePixels * depth, kScratchAlignment);
+}
+
+// Unrolls output pixels [first, first + count) of one image into rows of the tile.
+void Im2Col(const RvcConvInt8Params & params, const int8_t * input, int first, int count, int8_t * tile)
+{
+    const size_t channels = static_cast<size_t>(params.inputChannels);
+    const size_t depth = params.filterHeight * params.filterWidth * channels;
+    const int8_t zero_point = static_cast<int8_t>(params.inputZeroPoint);
+
+    for (int i = 0; i < count; ++i) {
+        int out_y = (first + i) / params.outputWidth;
+        int out_x = (first + i) % params.outputWidth;
+        int in_y0 = out_y * params.strideHeight - params.padHeight;
+        int in_x0 = out_x * params.strideWidth - params.padWidth;
+        int8_t * dst = tile + i * depth;
+
+        for (int ky = 0; ky < params.filterHeight; ++ky) {
+            int in_y = in_y0 + ky;
+            bool row_inside = in_y >= 0 && in_y < params.inputHeight;
+            for (int kx = 0; kx < params.filterWidth; ++kx, dst += channels) {
+                int in_x = in_x0 + kx;
+                // Padding contributes (zp - zp) * w == 0, exactly like the reference skipping it.
+                if (!row_inside || in_x < 0 || in_x >= params.inputWidth) {
+                    std::memset(dst, zero_point, channels);
+                    continue;
+                }
+                std::memcpy(dst, input + (static_cast<size_t>(in_y) * params.inputWidth + in_x) * channels, channels);
+            }
+        }
+    }
+}
+
+// Computes output pixels [firstPixel, lastPixel) x channels [firstChannel, lastChannel) of every image.
+void ConvSlice(const RvcConvInt8Params & params, const int8_t * input, const int8_t * filter, const int32_t * offsets,
+               int8_t * output, int8_t * tile, int firstPixel, int lastPixel, int firstChannel, int lastChannel)
+{
+    const size_t depth = static_cast<size_t>(params.filterHeight) * params.filterWidth * params.inputChannels;
+    const bool pointwise = IsPointwise(params);
+    const int pixels = params.outputHeight * params.outputWidth;
+
+    const int8_t * rows[kTilePixels];
+    for (int b = 0; b < params.batches; ++b) {
+        const int8_t * image = input + static_cast<size_t>(b) * params.inputHeight * params.inputWidth * params.inputChannels;
+        int8_t * image_output = output + static_cast<size_t>(b) * pixels * params.outputChannels;
+
+        for (int first = firstPixel; first < lastPixel; first += kTilePixels) {
+            int count = std::min(kTilePixels, lastPixel - first);
+            if (pointwise) {
+                for (int i = 0; i < count; ++i) { rows[i] = image + static_cast<size_t>(first + i) * depth; }
+            }
+            else {
+                Im2Col(params, image, first, count, tile);
+                for (int i = 0; i < count; ++i) { rows[i] = tile + static_cast<size_t>(i) * depth; }
+            }
+
+            int8_t * tile_output = image_output + static_cast<size_t>(first) * params.outputChannels;
+            int o = firstChannel;
+            for (; o + 4 <= lastChannel; o += 4) {
+                ConvChannelBlock<4>(params, rows, count, filter, depth, offsets, o, tile_output);
+            }
+            for (; o < lastChannel; ++o) {
+                ConvChannelBlock<1>(params, rows, count, filter, depth, offsets, o, tile_output);
+            }
+        }
+    }
+}
+
+// Conv2D
+
+struct ConvOpData {
+    tflite::OpDataConv reference; // Must stay first: the reference Prepare() and Eval() use it as OpDataConv
+    bool optimized;
+    int threads;
+    int scratchIndex;
+};
+
+TFLMRegistration sReferenceConv;
+
+void * ConvInit(TfLiteContext * context, const char * buffer, size_t length)
+{
+    return context->AllocatePersistentBuffer(context, sizeof(ConvOpData));
+}
+
+TfLiteStatus ConvPrepare(TfLiteContext * context, TfLiteNode * node)
+{
+    TfLiteStatus status = sReferenceConv.prepare(context, node);
+    if (status != kTfLiteOk) { return status; }
+
+    ConvOpData * data = static_cast<ConvOpData *>(node->user_data);
+    data->optimized = false;
+    data->threads = 1;
+    data->scratchIndex = -1;
+
+    tflite::MicroContext * micro_context = tflite::GetMicroContext(context);
+    TfLiteTensor * input = micro_context->AllocateTempInputTensor(node, tflite::kConvInputTensor);
+    TfLiteTensor * filter = micro_context->AllocateTempInputTensor(node, tflite::kConvWeightsTensor);
+    TfLiteTensor * bias = node->inputs->size == 3 ? micro_context->AllocateTempInputTensor(node, tflite::kConvBiasTensor) : nullptr;
+    TfLiteTensor * output = micro_context->AllocateTempOutputTensor(node, tflite::kConvOutputTensor);
+    const TfLiteConvParams * conv = static_cast<const TfLiteConvParams *>(node->builtin_data);
+
+    bool supported = input && filter && output && input->type == kTfLiteInt8 && filter->type == kTfLiteInt8 &&
+        output->type == kTfLiteInt8 && (!bias || bias->type == kTfLiteInt32) && conv->dilation_width_factor == 1 &&
+        conv->dilation_height_factor == 1 && input->dims->data[3] == filter->dims->data[3];
+
+    if (supported) {
+        RvcConvInt8Params params;
+        params.inputHeight = input->dims->data[1];
+        params.inputWidth = input->dims->data[2];
+        params.inputChannels = input->dims->data[3];
+        params.filterHeight = filter->dims->data[1];
+        params.filterWidth = filter->dims->data[2];
+        params.outputHeight = output->dims->data[1];
+        params.outputWidth = output->dims->data[2];
+        params.outputChannels = output->dims->data[3];
+        params.strideHeight = conv->stride_height;
+        params.strideWidth = conv->stride_width;
+        params.padHeight = data->reference.padding.height;
+        params.padWidth = data->reference.padding.width;
+
+        data->threads = RvcInt8Kernels::ThreadCount();
+        // An arena too small for the im2col scratch is not an error: the
+        // node just stays on the reference kernel prepared above.
+        data->optimized = context->RequestScratchBufferInArena(context, RvcInt8Kernels::ConvScratchBytes(params, data->threads),
+                                                               &data->scratchIndex) == kTfLiteOk;
+        if (!data->optimized) {
+            data->threads = 1;
+            data->scratchIndex = -1;
+        }
+    }
+
+    micro_context->DeallocateTempTfLiteTensor(input);
+    micro_context->DeallocateTempTfLiteTensor(filter);
+    if (bias) { micro_context->DeallocateTempTfLiteTensor(bias); }
+    micro_context->DeallocateTempTfLiteTensor(output);
+    return kTfLiteOk;
+}
+
+TfLiteStatus ConvEval(TfLiteContext * context, TfLiteNode * node)
+{
+    const ConvOpData * data = static_cast<const ConvOpData *>(node->user_data);
+    if (!data->optimized) { return sReferenceConv.invoke(context, node); }
+
+    const TfLiteEvalTensor * input = tflite::micro::GetEvalInput(context, node, tflite::kConvInputTensor);
+    const TfLiteEvalTensor * filter = tflite::micro::GetEvalInput(context, node, tflite::kConvWeightsTensor);
+    const TfLiteEvalTensor * bias =
+        node->inputs->size == 3 ? tflite::micro::GetEvalInput(context, node, tflite::kConvBiasTensor) : nullptr;
+    TfLiteEvalTensor * output = tflite::micro::GetEvalOutput(context, node, tflite::kConvOutputTensor);
+    const TfLiteConvParams * conv = static_cast<const TfLiteConvParams *>(node->builtin_data);
+
+    RvcConvInt8Params params;
+    params.batches = input->dims->data[0];
+    params.inputHeight = input->dims->data[1];
+    params.inputWidth = input->dims->data[2];
+    params.inputChannels = input->dims->data[3];
+    params.filterHeight = filter->dims->data[1];
+    params.filterWidth = filter->dims->data[2];
+    params.outputHeight = output->dims->data[1];
+    params.outputWidth = output->dims->data[2];
+    params.outputChannels = output->dims->data[3];
+    params.strideHeight = conv->stride_height;
+    params.strideWidth = conv->stride_width;
+    params.padHeight = data->reference.padding.height;
+    params.padWidth = data->reference.padding.width;
+    params.inputZeroPoint = data->reference.input_zero_point;
+    params.outputZeroPoint = data->reference.output_zero_point;
+    params.outputMultiplier = data->reference.per_channel_output_multiplier;
+    params.outputShift = data->reference.per_channel_output_shift;
+    params.activationMin = data->reference.output_activation_min;
+    params.activationMax = data->reference.output_activation_max;
+
+    RvcInt8Kernels::ConvInt8(params, tflite::micro::GetTensorData<int8_t>(input), tflite::micro::GetTensorData<int8_t>(filter),
+                             bias ? tflite::micro::GetTensorData<int32_t>(bias) : nullptr,
+                             tflite::micro::GetTensorData<int8_t>(output),
+                             static_cast<int8_t *>(context->GetScratchBuffer(context, data->scratchIndex)), data->threads);
+    return kTfLiteOk;
+}
+
+// MaxPool2D
+
+TFLMRegistration sReferenceMaxPool;
+
+TfLiteStatus MaxPoolEval(TfLiteContext * context, TfLiteNode * node)
+{
+    const TfLiteEvalTensor * input = tflite::micro::GetEvalInput(context, node, 0);
+    TfLiteEvalTensor * output = tflite::micro::GetEvalOutput(context, node, 0);
+    if (input->type != kTfLiteInt8) { return sReferenceMaxPool.invoke(context, node); }
+
+    const TfLitePoolParams * pool = static_cast<const TfLitePoolParams *>(node->builtin_data);
+    const tflite::OpDataPooling * data = static_cast<const tflite::OpDataPooling *>(node->user_data);
+
+    RvcPoolInt8Params params;
+    params.batches = input->dims->data[0];
+    params.inputHeight = input->dims->data[1];
+    params.inputWidth = input->dims->data[2];
+    params.channels = input->dims->data[3];
+    params.filterHeight = pool->filter_height;
+    params.filterWidth = pool->filter_width;
+    params.outputHeight = output->dims->data[1];
+    params.outputWidth = output->dims->data[2];
+    params.strideHeight = pool->stride_height;
+    params.strideWidth = pool->stride_width;
+    params.padHeight = data->padding.height;
+    params.padWidth = data->padding.width;
+    params.activationMin = data->activation_min;
+    params.activationMax = data->activation_max;
+
+    RvcInt8Kernels::MaxPoolInt8(params, tflite::micro::GetTensorData<int8_t>(input), tflite::micro::GetTensorData<int8_t>(output));
+    return kTfLiteOk;
+}
+} // namespace
+
+TFLMRegistration RvcInt8Kernels::Conv2DRegistration()
+{
+    if (!sReferenceConv.invoke) { sReferenceConv = tflite::Register_CONV_2D(); }
+    TFLMRegistration registration = sReferenceConv;
+    registration.init = &ConvInit;
+    registration.prepare = &ConvPrepare;
+    registration.invoke = &ConvEval;
+    return registration;
+}
+
+TFLMRegistration RvcInt8Kernels::MaxPool2DRegistration()
+{
+    if (!sReferenceMaxPool.invoke) { sReferenceMaxPool = tflite::Register_MAX_POOL_2D(); }
+    TFLMRegistration registration = sReferenceMaxPool;
+    registration.invoke = &MaxPoolEval;
+    return registration;
+}
+
+void RvcInt8Kernels::SetThreadCount(int threads)
+{
+    Pool().Resize(std::max(1, std::min(threads, kMaxThreads)));
+}
+
+int RvcInt8Kernels::ThreadCount()
+{
+    return Pool().Size();
+}
+
+const char * RvcInt8Kernels::SimdName()
+{
+#if defined(__AVX2__)
+    return "AVX2";
+#elif defined(__SSE2__)
+    return "SSE2";
+#elif defined(__ARM_NEON) && defined(__aarch64__) && defined(__ARM_FEATURE_DOTPROD)
+    return "NEON+dotprod";
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    return "NEON";
+#else
+    return "scalar";
+#endif
+}
+
+size_t RvcInt8Kernels::ConvScratchBytes(const RvcConvInt8Params & params, int threads)
+{
+    return AlignUp(params.outputChannels * sizeof(int32_t), kScratchAlignment) + threads * TileBytes(params);
+}
+
+void RvcInt8Kernels::ConvInt8(const RvcConvInt8Params & params, const int8_t * input, const int8_t * filter, const int32_t * bias,
+                              int8_t * output, int8_t * scratch, int threads)
+{
+    const size_t depth = static_cast<size_t>(params.filterHeight) * params.filterWidth * params.inputChannels;
+    const int pixels = params.outputHeight * params.outputWidth;
+    int32_t * offsets = reinterpret_cast<int32_t *>(scratch);
+    int8_t * tiles = scratch + AlignUp(params.outputChannels * sizeof(int32_t), kScratchAlignment);
+    const size_t tile_bytes = TileBytes(params);
+
+    // Bias plus the input zero point folded in: sum((x - zp) * w) = sum(x * w) - zp * sum(w).
+    // Recomputed on every call because training updates the filters in place.
+    for (int o = 0; o < params.outputChannels; ++o) {
+        const int8_t * w = filter + static_cast<size_t>(o) * depth;
+        int32_t sum = 0;
+        for (size_t k = 0; k < depth; ++k) { sum += w[k]; }
+        offsets[o] = (bias ? bias[o] : 0) - params.inputZeroPoint * sum;
+    }
+
+    // Wide layers are split by output channels, in multiples of the 4-channel block, so each
+    // thread streams only its share of the filter. Each thread unrolls its own tiles, which is
+    // cheap next to the dot products as long as it has enough channels; narrow layers (the
+    // stem) are split by output pixels instead.
+    const int blocks = (params.outputChannels + 3) / 4;
+    const bool split_channels = blocks >= threads * kMinBlocksPerThread;
+    threads = std::max(1, std::min(threads, split_channels ? blocks : (pixels + kTilePixels - 1) / kTilePixels));
+    Pool().Run(threads, [&](int task, int tasks) {
+        int8_t * tile = tiles + task * tile_bytes;
+        if (split_channels) {
+            int per_task = (blocks + tasks - 1) / tasks * 4;
+            int first = task * per_task;
+            int last = std::min(params.outputChannels, first + per_task);
+            if (first < last) { ConvSlice(params, input, filter, offsets, output, tile, 0, pixels, first, last); }
+        }
+        else {
+            int per_task = (pixels + tasks - 1) / tasks;
+            int first = task * per_task;
+            int last = std::min(pixels, first + per_task);
+            if (first < last) { ConvSlice(params, input, filter, offsets, output, tile, first, last, 0, params.outputChannels); }
+        }
+    });
+}
+
+void RvcInt8Kernels::MaxPoolInt8(const RvcPoolInt8Params & params, const int8_t * input, int8_t * output)
+{
+    const int channels = params.channels;
+    for (int b = 0; b < params.batches; ++b) {
+        for (int out_y = 0; out_y < params.outputHeight; ++out_y) {
+            int in_y0 = out_y * params.strideHeight - params.padHeight;
+            int y_start = std::max(0, -in_y0);
+            int y_end = std::min(params.filterHeight, params.inputHeight - in_y0);
+
+            for (int out_x = 0; out_x < params.outputWidth; ++out_x) {
+                int in_x0 = out_x * params.strideWidth - params.padWidth;
+                int x_start = std::max(0, -in_x0);
+                int x_end = std::min(params.filterWidth, params.inputWidth - in_x0);
+                int8_t * out = output + ((static_cast<size_t>(b) * params.outputHeight + out_y) * params.outputWidth + out_x) * channels;
+
+                int c = 0;
+#if defined(__AVX2__)
+                const __m256i act_min = _mm256_set1_epi8(static_cast<int8_t>(params.activationMin));
+                const __m256i act_max = _mm256_set1_epi8(static_cast<int8_t>(params.activationMax));
+                for (; c + 32 <= channels; c += 32) {
+                    __m256i max = _mm256_set1_epi8(-128);
+                    for (int fy = y_start; fy < y_end; ++fy) {
+                        for (int fx = x_start; fx < x_end; ++fx) {
+                            const int8_t * in = input +
+                                ((static_cast<size_t>(b) * params.inputHeight + in_y0 + fy) * params.inputWidth + in_x0 + fx) * channels + c;
+                            max = _mm256_max_epi8(max, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in)));
+                        }
+                    }
+                    max = _mm256_min_epi8(_mm256_max_epi8(max, act_min), act_max);
+                    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + c), max);
+                }
+#elif defined(__SSE2__)
+                // SSE2 only has an unsigned byte max: flip the sign bit around it.
+                const __m128i sign = _mm_set1_epi8(static_cast<char>(0x80));
+                const __m128i act_min = _mm_xor_si128(_mm_set1_epi8(static_cast<int8_t>(params.activationMin)), sign);
+                const __m128i act_max = _mm_xor_si128(_mm_set1_epi8(static_cast<int8_t>(params.activationMax)), sign);
+                for (; c + 16 <= channels; c += 16) {
+                    __m128i max = _mm_setzero_si128(); // -128 with the sign bit flipped
+                    for (int fy = y_start; fy < y_end; ++fy) {
+                        for (int fx = x_start; fx < x_end; ++fx) {
+                            const int8_t * in = input +
+                                ((static_cast<size_t>(b) * params.inputHeight + in_y0 + fy) * params.inputWidth + in_x0 + fx) * channels + c;
+                            max = _mm_max_epu8(max, _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in)), sign));
+                        }
+                    }
+                    max = _mm_min_epu8(_mm_max_epu8(max, act_min), act_max);
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + c), _mm_xor_si128(max, sign));
+                }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+                const int8x16_t act_min = vdupq_n_s8(static_cast<int8_t>(params.activationMin));
+                const int8x16_t act_max = vdupq_n_s8(static_cast<int8_t>(params.activationMax));
+                for (; c + 16 <= channels; c += 16) {
+                    int8x16_t max = vdupq_n_s8(-128);
+                    for (int fy = y_start; fy < y_end; ++fy) {
+                        for (int fx = x_start; fx < x_end; ++fx) {
+                            const int8_t * in = input +
+                                ((static_cast<size_t>(b) * params.inputHeight + in_y0 + fy) * params.inputWidth + in_x0 + fx) * channels + c;
+                            max = vmaxq_s8(max, vld1q_s8(in));
+                        }
+                    }
+                    vst1q_s8(out + c, vminq_s8(vmaxq_s8(max, act_min), act_max));
+                }
+#endif
+                for (; c < channels; ++c) {
+                    int32_t max = -128;
+                    for (int fy = y_start; fy < y_end; ++fy) {
+                        for (int fx = x_start; fx < x_end; ++fx) {
+                            int32_t value = input[((static_cast<size_t>(b) * params.inputHeight + in_y0 + fy) * params.inputWidth + in_x0 + fx) *
+                                                      channels + c];
+                            max = std::max(max, value);
+                        }
+                    }
+                    max = std::min(std::max(max, params.activationMin), params.activationMax);
+                    out[c] = static_cast<int8_t>(max);
+                }
+            }
+        }
+    }
+}
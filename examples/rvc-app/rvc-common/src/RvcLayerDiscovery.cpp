@@ -0,0 +1,184 @@
+#include "RvcLayerDiscovery.h"
+
+#include "tensorflow/lite/schema/schema_generated.h"
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <mutex>
+
+namespace {
+
+std::mutex sCacheMutex;
+std::map<std::string, std::vector<RvcTrainableLayer>> sCache;
+
+const char * TensorName(const tflite::Tensor * tensor)
+{
+    return (tensor && tensor->name()) ? tensor->name()->c_str() : "";
+}
+
+bool IsConstantInt8(const tflite::Model * model, const tflite::Tensor * tensor)
+{
+    if (tensor->type() != tflite::TensorType_INT8 || !tensor->shape() || tensor->shape()->size() != 4) {
+        return false;
+    }
+    const tflite::Buffer * buffer = model->buffers()->Get(tensor->buffer());
+    return buffer && buffer->data() && buffer->data()->size() > 0;
+}
+
+} // namespace
+
+uint64_t RvcLayerDiscovery::ModelHash(const void * data, size_t size)
+{
+    const uint8_t * bytes = static_cast<const uint8_t *>(data);
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+bool RvcLayerDiscovery::Discover(const tflite::Model * model, uint64_t modelHash, const RvcLayerQuery & query,
+                                 std::vector<RvcTrainableLayer> & layers)
+{
+    if (!model) {
+        return false;
+    }
+
+    std::string key = std::to_string(modelHash) + ":" + std::to_string(static_cast<int>(query.selector)) +
+        ":" + query.namePattern;
+
+    std::lock_guard<std::mutex> lock(sCacheMutex);
+    auto cached = sCache.find(key);
+    if (cached != sCache.end()) {
+        layers = cached->second;
+        return !layers.empty();
+    }
+
+    layers.clear();
+    if (!Walk(model, query, layers)) {
+        return false;
+    }
+    sCache[key] = layers;
+    return true;
+}
+
+bool RvcLayerDiscovery::Walk(const tflite::Model * model, const RvcLayerQuery & query, std::vector<RvcTrainableLayer> & layers)
+{
+    const tflite::SubGraph * subgraph = model->subgraphs()->Get(0);
+    const auto * tensors = subgraph->tensors();
+    const auto * operators = subgraph->operators();
+    const size_t num_tensors = tensors->size();
+
+    // Producer and consumers of every tensor.
+    std::vector<int> producers(num_tensors, -1);
+    std::vector<std::vector<int>> consumers(num_tensors);
+    std::vector<tflite::BuiltinOperator> codes(operators->size());
+    for (uint32_t i = 0; i < operators->size(); ++i) {
+        const tflite::Operator * op = operators->Get(i);
+        codes[i] = tflite::GetBuiltinCode(model->operator_codes()->Get(op->opcode_index()));
+        for (uint32_t k = 0; k < op->inputs()->size(); ++k) {
+            int t = op->inputs()->Get(k);
+            if (t >= 0) {
+                consumers[t].push_back(static_cast<int>(i));
+            }
+        }
+        for (uint32_t k = 0; k < op->outputs()->size(); ++k) {
+            producers[op->outputs()->Get(k)] = static_cast<int>(i);
+        }
+    }
+
+    // Tensors from which a graph output can be reached. Operators are stored in execution
+    // order, so one reverse sweep is enough.
+    std::vector<bool> reaches_output(num_tensors, false);
+    for (uint32_t k = 0; k < subgraph->outputs()->size(); ++k) {
+        reaches_output[subgraph->outputs()->Get(k)] = true;
+    }
+    for (int i = static_cast<int>(operators->size()) - 1; i >= 0; --i) {
+        const tflite::Operator * op = operators->Get(i);
+        bool live = false;
+        for (uint32_t k = 0; k < op->outputs()->size(); ++k) {
+            live = live || reaches_output[op->outputs()->Get(k)];
+        }
+        for (uint32_t k = 0; live && k < op->inputs()->size(); ++k) {
+            if (op->inputs()->Get(k) >= 0) {
+                reaches_output[op->inputs()->Get(k)] = true;
+            }
+        }
+    }
+
+    // [1, anchors, 4 + classes]
+    int num_classes = -1;
+    const tflite::Tensor * model_output = tensors->Get(subgraph->outputs()->Get(0));
+    if (model_output->shape() && model_output->shape()->size() == 3) {
+        num_classes = model_output->shape()->Get(2) - 4;
+    }
+
+    for (uint32_t i = 0; i < operators->size(); ++i) {
+        const tflite::Operator * op = operators->Get(i);
+        if (codes[i] != tflite::BuiltinOperator_CONV_2D || op->inputs()->size() < 2) {
+            continue;
+        }
+
+        RvcTrainableLayer layer;
+        layer.operatorIndex = static_cast<int>(i);
+        layer.inputTensor = op->inputs()->Get(0);
+        layer.filterTensor = op->inputs()->Get(1);
+        layer.biasTensor = op->inputs()->size() >= 3 ? op->inputs()->Get(2) : -1;
+        layer.outputTensor = op->outputs()->Get(0);
+
+        const tflite::Tensor * filter = tensors->Get(layer.filterTensor);
+        if (!IsConstantInt8(model, filter)) {
+            continue;
+        }
+        layer.name = TensorName(tensors->Get(layer.outputTensor));
+
+        if (query.selector == RvcLayerSelector::kByName) {
+            if (query.namePattern.empty() ||
+                (layer.name.find(query.namePattern) == std::string::npos &&
+                 std::string(TensorName(filter)).find(query.namePattern) == std::string::npos)) {
+                continue;
+            }
+            layers.push_back(layer);
+            continue;
+        }
+
+        // Followed by SiLU (x * sigmoid(x)): a hidden layer, not a head.
+        bool activated = false;
+        for (int consumer : consumers[layer.outputTensor]) {
+            activated = activated || codes[consumer] == tflite::BuiltinOperator_LOGISTIC ||
+                codes[consumer] == tflite::BuiltinOperator_MUL;
+        }
+        int producer = producers[layer.inputTensor];
+        bool dfl = producer >= 0 && codes[producer] == tflite::BuiltinOperator_SOFTMAX;
+        if (activated || dfl || !reaches_output[layer.outputTensor]) {
+            continue;
+        }
+
+        bool classification = filter->shape()->Get(0) == num_classes;
+        if (query.selector == RvcLayerSelector::kClassificationHeads && !classification) {
+            continue;
+        }
+        layers.push_back(layer);
+    }
+
+    if (layers.empty()) {
+        std::cerr << "Error: No trainable layer matches the query." << std::endl;
+        return false;
+    }
+
+    // Largest grid (smallest stride) first, as in the model output.
+    auto cells = [tensors](const RvcTrainableLayer & layer) {
+        const auto * shape = tensors->Get(layer.outputTensor)->shape();
+        return shape->size() == 4 ? shape->Get(1) * shape->Get(2) : 0;
+    };
+    std::stable_sort(layers.begin(), layers.end(),
+                     [&cells](const RvcTrainableLayer & a, const RvcTrainableLayer & b) { return cells(a) > cells(b); });
+
+    std::cout << "Layer discovery: " << layers.size() << " trainable layer(s)" << std::endl;
+    for (const RvcTrainableLayer & layer : layers) {
+        std::cout << "  op " << layer.operatorIndex << ": filter " << layer.filterTensor << ", bias " << layer.biasTensor
+                  << ", output '" << layer.name << "'" << std::endl;
+    }
+    return true;
+}
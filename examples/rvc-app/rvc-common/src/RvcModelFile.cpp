@@ -0,0 +1,82 @@
+#include "RvcModelFile.h"
+
+#include "tensorflow/lite/schema/schema_generated.h"
+
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+RvcModelFile::RvcModelFile()
+    : mData(nullptr), mSize(0), mMapped(false)
+{
+}
+
+RvcModelFile::~RvcModelFile()
+{
+    Unmap();
+}
+
+bool RvcModelFile::Map(const std::string & path, bool writable)
+{
+    Unmap();
+
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) { std::cerr << "Error: Cannot open model file " << path << std::endl; return false; }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        std::cerr << "Error: Cannot read model file " << path << std::endl;
+        close(fd);
+        return false;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+
+    // Writable mappings are private, so the file itself is never modified.
+    void * data = writable ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0)
+                           : mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) { std::cerr << "Error: Cannot map model file " << path << std::endl; return false; }
+
+    if (!Verify(static_cast<const uint8_t *>(data), size)) {
+        std::cerr << "Error: " << path << " is not a valid TFLite model." << std::endl;
+        munmap(data, size);
+        return false;
+    }
+
+    mData = static_cast<const uint8_t *>(data);
+    mSize = size;
+    mMapped = true;
+    mPath = path;
+
+    std::cout << "Model mapped from " << path << " (" << size / 1024 << " KB, " << (writable ? "copy-on-write" : "read-only")
+              << ")" << std::endl;
+    return true;
+}
+
+void RvcModelFile::UseEmbedded(const uint8_t * data, size_t size)
+{
+    Unmap();
+    mData = data;
+    mSize = size;
+    mPath = "<embedded>";
+}
+
+bool RvcModelFile::Verify(const uint8_t * data, size_t size)
+{
+    flatbuffers::Verifier verifier(data, size);
+    return tflite::VerifyModelBuffer(verifier);
+}
+
+void RvcModelFile::Unmap()
+{
+    if (mMapped) {
+        munmap(const_cast<uint8_t *>(mData), mSize);
+    }
+    mData = nullptr;
+    mSize = 0;
+    mMapped = false;
+    mPath.clear();
+}
@@ -0,0 +1,80 @@
+#include "RvcModelScheduler.h"
+
+namespace {
+// Caps the wait counters; any model that has waited this long is due whatever its period.
+constexpr uint32_t kMaxFramesSinceRun = UINT16_MAX;
+} // namespace
+
+RvcModelScheduler::RvcModelScheduler()
+{
+}
+
+bool RvcModelScheduler::SetSchedule(size_t slot, const RvcModelSchedule & schedule)
+{
+    if (slot >= kMaxModels) { return false; }
+
+    Entry & entry = mEntries[slot];
+    entry.schedule = schedule;
+    entry.active = true;
+    entry.framesSinceRun = kMaxFramesSinceRun; // Due on the next frame
+
+    uint8_t activities = 0;
+    for (size_t i = 0; i < schedule.period.size(); ++i) {
+        if (schedule.period[i] > 0) { activities |= static_cast<uint8_t>(1u << i); }
+    }
+    entry.activities.store(activities);
+    return true;
+}
+
+void RvcModelScheduler::RemoveSchedule(size_t slot)
+{
+    if (slot >= kMaxModels) { return; }
+    mEntries[slot].active = false;
+    mEntries[slot].activities.store(0);
+}
+
+bool RvcModelScheduler::RunsIn(size_t slot, RvcAIActivity activity) const
+{
+    if (slot >= kMaxModels) { return false; }
+    return (mEntries[slot].activities.load() & (1u << static_cast<size_t>(activity))) != 0;
+}
+
+uint32_t RvcModelScheduler::NextFrame()
+{
+    const size_t activity = static_cast<size_t>(mActivity.load());
+
+    uint32_t selected = 0;
+    for (size_t picked = 0; picked < mMaxModelsPerFrame; ++picked) {
+        size_t best = kMaxModels;
+        for (size_t i = 0; i < kMaxModels; ++i) {
+            const Entry & entry = mEntries[i];
+            uint16_t period = entry.active ? entry.schedule.period[activity] : 0;
+            if (period == 0 || (selected & (1u << i)) || entry.framesSinceRun + 1 < period) { continue; }
+            if (best == kMaxModels) {
+                best = i;
+                continue;
+            }
+
+            const Entry & current = mEntries[best];
+            if (entry.schedule.priority != current.schedule.priority) {
+                if (entry.schedule.priority > current.schedule.priority) { best = i; }
+            }
+            else if (Lateness(entry, period) > Lateness(current, current.schedule.period[activity])) {
+                best = i;
+            }
+        }
+        if (best == kMaxModels) { break; }
+        selected |= 1u << best;
+    }
+
+    for (size_t i = 0; i < kMaxModels; ++i) {
+        Entry & entry = mEntries[i];
+        if (selected & (1u << i)) {
+            entry.framesSinceRun = 0;
+        }
+        else if (entry.framesSinceRun < kMaxFramesSinceRun) {
+            entry.framesSinceRun++;
+        }
+    }
+    return selected;
+}
@@ -0,0 +1,120 @@
+#include "RvcObstacleTracker.h"
+
+#include <algorithm>
+
+RvcObstacleTracker::RvcObstacleTracker() : mTrackCount(0), mNextTrackId(1)
+{
+}
+
+float RvcObstacleTracker::IoU(const RvcTrackedObstacle & track, const RvcDetection & detection)
+{
+    float iw = std::min(track.x2, detection.x2) - std::max(track.x1, detection.x1);
+    float ih = std::min(track.y2, detection.y2) - std::max(track.y1, detection.y1);
+    if (iw <= 0.0f || ih <= 0.0f) { return 0.0f; }
+    float inter = iw * ih;
+    float uni = (track.x2 - track.x1) * (track.y2 - track.y1) + (detection.x2 - detection.x1) * (detection.y2 - detection.y1) -
+        inter;
+    return uni > 0.0f ? inter / uni : 0.0f;
+}
+
+int RvcObstacleTracker::ConfidenceStep(float confidence, float step)
+{
+    return step > 0.0f ? static_cast<int>(confidence / step) : 0;
+}
+
+const RvcTrackedObstacle * RvcObstacleTracker::FindTrack(uint32_t trackId) const
+{
+    for (size_t i = 0; i < mTrackCount; ++i) {
+        if (mTracks[i].trackId == trackId) { return &mTracks[i]; }
+    }
+    return nullptr;
+}
+
+void RvcObstacleTracker::RemoveTrack(size_t index, RvcObstacleChanges & changes)
+{
+    if (mTracks[index].confirmed) { changes.cleared[changes.clearedCount++] = mTracks[index]; }
+    mTracks[index] = mTracks[--mTrackCount];
+}
+
+void RvcObstacleTracker::Update(const RvcDetectionResult & result, RvcObstacleChanges & changes)
+{
+    changes = RvcObstacleChanges();
+
+    bool matched_track[kMaxTracks] = {};
+    bool matched_detection[kRvcMaxDetections] = {};
+    size_t detection_count = std::min(result.detectionCount, kRvcMaxDetections);
+
+    // Greedy assignment, best overlap first. Both sides are at most kRvcMaxDetections long.
+    while (true) {
+        float best_iou = mConfig.matchIoU;
+        size_t best_track = kMaxTracks;
+        size_t best_detection = 0;
+        for (size_t d = 0; d < detection_count; ++d) {
+            const RvcDetection & detection = result.detections[d];
+            if (matched_detection[d] || detection.score < mConfig.minScore) { continue; }
+            for (size_t t = 0; t < mTrackCount; ++t) {
+                if (matched_track[t] || mTracks[t].classId != detection.class_id) { continue; }
+                float iou = IoU(mTracks[t], detection);
+                if (iou >= best_iou) {
+                    best_iou = iou;
+                    best_track = t;
+                    best_detection = d;
+                }
+            }
+        }
+        if (best_track == kMaxTracks) { break; }
+
+        matched_track[best_track] = true;
+        matched_detection[best_detection] = true;
+        RvcTrackedObstacle & track = mTracks[best_track];
+        const RvcDetection & detection = result.detections[best_detection];
+        int old_step = ConfidenceStep(track.confidence, mConfig.confidenceStep);
+        track.confidence += mConfig.confidenceSmoothing * (detection.score - track.confidence);
+        track.x1 = detection.x1;
+        track.y1 = detection.y1;
+        track.x2 = detection.x2;
+        track.y2 = detection.y2;
+        track.hits++;
+        track.missedFrames = 0;
+        if (!track.confirmed && track.hits >= mConfig.confirmFrames) {
+            track.confirmed = true;
+            changes.appeared[changes.appearedCount++] = track.trackId;
+        }
+        else if (track.confirmed && ConfidenceStep(track.confidence, mConfig.confidenceStep) != old_step) {
+            changes.confidenceChanged = true;
+        }
+    }
+
+    // Age the tracks that were not seen; iterate backwards since removal moves the last track into the hole.
+    for (size_t t = mTrackCount; t-- > 0;) {
+        if (!matched_track[t] && ++mTracks[t].missedFrames > mConfig.maxMissedFrames) { RemoveTrack(t, changes); }
+    }
+
+    // New objects. If all slots are taken, the new detection waits for a track to expire.
+    for (size_t d = 0; d < detection_count && mTrackCount < kMaxTracks; ++d) {
+        const RvcDetection & detection = result.detections[d];
+        if (matched_detection[d] || detection.score < mConfig.minScore) { continue; }
+
+        RvcTrackedObstacle & track = mTracks[mTrackCount++];
+        track = RvcTrackedObstacle();
+        track.trackId = mNextTrackId++;
+        if (mNextTrackId == 0) { mNextTrackId = 1; }
+        track.classId = detection.class_id;
+        track.confidence = detection.score;
+        track.x1 = detection.x1;
+        track.y1 = detection.y1;
+        track.x2 = detection.x2;
+        track.y2 = detection.y2;
+        track.hits = 1;
+        if (mConfig.confirmFrames <= 1) {
+            track.confirmed = true;
+            changes.appeared[changes.appearedCount++] = track.trackId;
+        }
+    }
+}
+
+void RvcObstacleTracker::Clear(RvcObstacleChanges & changes)
+{
+    changes = RvcObstacleChanges();
+    while (mTrackCount > 0) { RemoveTrack(mTrackCount - 1, changes); }
+}
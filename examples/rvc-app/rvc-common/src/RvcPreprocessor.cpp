@@ -0,0 +1,268 @@
+#include "RvcPreprocessor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+constexpr int kWeightBits = 7;
+constexpr int kWeightOne = 1 << kWeightBits;
+
+inline uint8_t Clamp255(int v)
+{
+    return static_cast<uint8_t>(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+// BT.601 limited-range YUV to RGB, the usual output of camera ISPs.
+inline void YuvToRgb(int y, int u, int v, uint8_t * rgb)
+{
+    int c = 298 * (y - 16) + 128;
+    int d = u - 128;
+    int e = v - 128;
+    rgb[0] = Clamp255((c + 409 * e) >> 8);
+    rgb[1] = Clamp255((c - 100 * d - 208 * e) >> 8);
+    rgb[2] = Clamp255((c + 516 * d) >> 8);
+}
+
+inline int Lerp2D(int p00, int p01, int p10, int p11, int wx, int wy)
+{
+    int top = p00 * (kWeightOne - wx) + p01 * wx;
+    int bottom = p10 * (kWeightOne - wx) + p11 * wx;
+    return (top * (kWeightOne - wy) + bottom * wy + (1 << (2 * kWeightBits - 1))) >> (2 * kWeightBits);
+}
+
+// Maps one destination coordinate of the letterboxed content back to the source axis.
+void BuildAxis(int srcSize, int contentSize, bool bilinear, std::vector<int32_t> & index, std::vector<uint8_t> & weight)
+{
+    index.resize(contentSize);
+    weight.resize(contentSize);
+    const float ratio = static_cast<float>(srcSize) / static_cast<float>(contentSize);
+
+    for (int i = 0; i < contentSize; ++i) {
+        float f = (static_cast<float>(i) + 0.5f) * ratio;
+        if (!bilinear) {
+            index[i] = std::min(srcSize - 1, static_cast<int>(f));
+            weight[i] = 0;
+            continue;
+        }
+
+        f = std::max(0.0f, std::min(static_cast<float>(srcSize - 1), f - 0.5f));
+        int i0 = std::min(srcSize - 2, static_cast<int>(f));
+        index[i] = i0;
+        weight[i] = static_cast<uint8_t>(std::lround((f - static_cast<float>(i0)) * kWeightOne));
+    }
+}
+
+} // namespace
+
+RvcPreprocessor::RvcPreprocessor()
+    : mConfigured(false), mShiftOnly(false), mMode(ResizeMode::kNearest), mContentWidth(0), mContentHeight(0), mOffsetX(0), mOffsetY(0)
+{
+    std::memset(mLut, 0, sizeof(mLut));
+}
+
+bool RvcPreprocessor::Configure(const Config & config)
+{
+    if (config.srcWidth < 2 || config.srcHeight < 2 || config.dstWidth <= 0 || config.dstHeight <= 0 || config.inputScale <= 0.0f) {
+        std::cerr << "Error: Invalid preprocessor configuration." << std::endl;
+        return false;
+    }
+    if (config.srcFormat == RvcCameraFrame::PixelFormat::kNv12 && ((config.srcWidth | config.srcHeight) & 1)) {
+        std::cerr << "Error: NV12 frames must have even dimensions." << std::endl;
+        return false;
+    }
+
+    mConfig = config;
+
+    // pixel -> int8 input value, following the tensor's own quantization.
+    mShiftOnly = true;
+    for (int p = 0; p < 256; ++p) {
+        int q = static_cast<int>(std::lround((static_cast<float>(p) / 255.0f) / config.inputScale)) + config.inputZeroPoint;
+        mLut[p] = static_cast<int8_t>(std::max(-128, std::min(127, q)));
+        mShiftOnly = mShiftOnly && (mLut[p] == static_cast<int8_t>(p - 128));
+    }
+
+    BuildTables();
+    mConfigured = true;
+
+    std::cout << "Preprocessor: " << config.srcWidth << "x" << config.srcHeight << " -> " << mContentWidth << "x"
+              << mContentHeight << " letterboxed into " << config.dstWidth << "x" << config.dstHeight
+              << (mShiftOnly ? " (SIMD zero-point shift)" : " (lookup-table quantization)") << std::endl;
+    return true;
+}
+
+bool RvcPreprocessor::Matches(int srcWidth, int srcHeight, RvcCameraFrame::PixelFormat format) const
+{
+    return mConfigured && mConfig.srcWidth == srcWidth && mConfig.srcHeight == srcHeight && mConfig.srcFormat == format;
+}
+
+void RvcPreprocessor::BuildTables()
+{
+    float scale = std::min(static_cast<float>(mConfig.dstWidth) / mConfig.srcWidth,
+                           static_cast<float>(mConfig.dstHeight) / mConfig.srcHeight);
+    mContentWidth = std::max(1, std::min(mConfig.dstWidth, static_cast<int>(std::lround(mConfig.srcWidth * scale))));
+    mContentHeight = std::max(1, std::min(mConfig.dstHeight, static_cast<int>(std::lround(mConfig.srcHeight * scale))));
+    mOffsetX = (mConfig.dstWidth - mContentWidth) / 2;
+    mOffsetY = (mConfig.dstHeight - mContentHeight) / 2;
+
+    // A 1:1 mapping needs no interpolation, whatever mode was requested.
+    mMode = mConfig.resizeMode;
+    if (mContentWidth == mConfig.srcWidth && mContentHeight == mConfig.srcHeight) {
+        mMode = ResizeMode::kNearest;
+    }
+
+    bool bilinear = (mMode == ResizeMode::kBilinear);
+    BuildAxis(mConfig.srcWidth, mContentWidth, bilinear, mSrcX, mWeightX);
+    BuildAxis(mConfig.srcHeight, mContentHeight, bilinear, mSrcY, mWeightY);
+}
+
+void RvcPreprocessor::Run(const uint8_t * src, int8_t * dst) const
+{
+    if (!mConfigured || !src || !dst) {
+        return;
+    }
+
+    const size_t rowBytes = static_cast<size_t>(mConfig.dstWidth) * 3;
+    const int8_t pad = mLut[mConfig.padValue];
+
+    for (int y = 0; y < mConfig.dstHeight; ++y) {
+        int8_t * out = dst + static_cast<size_t>(y) * rowBytes;
+        int contentY = y - mOffsetY;
+        if (contentY < 0 || contentY >= mContentHeight) {
+            std::memset(out, static_cast<uint8_t>(pad), rowBytes);
+            continue;
+        }
+
+        // Gather into the tensor row as uint8, then quantize the row in place while it is hot.
+        uint8_t * row = reinterpret_cast<uint8_t *>(out);
+        std::memset(row, mConfig.padValue, static_cast<size_t>(mOffsetX) * 3);
+        FillRow(src, contentY, row + static_cast<size_t>(mOffsetX) * 3);
+        std::memset(row + static_cast<size_t>(mOffsetX + mContentWidth) * 3, mConfig.padValue,
+                    static_cast<size_t>(mConfig.dstWidth - mOffsetX - mContentWidth) * 3);
+        Quantize(row, rowBytes);
+    }
+}
+
+void RvcPreprocessor::ModelToSource(float & x, float & y) const
+{
+    if (!mConfigured) { return; }
+    // The content is scaled by exactly mContentWidth / srcWidth (and height alike), which can differ slightly
+    // between the axes after rounding.
+    x = (x * mConfig.dstWidth - mOffsetX) * mConfig.srcWidth / mContentWidth;
+    y = (y * mConfig.dstHeight - mOffsetY) * mConfig.srcHeight / mContentHeight;
+    x = std::max(0.0f, std::min(static_cast<float>(mConfig.srcWidth), x));
+    y = std::max(0.0f, std::min(static_cast<float>(mConfig.srcHeight), y));
+}
+
+void RvcPreprocessor::SourceToModel(float & x, float & y) const
+{
+    if (!mConfigured) { return; }
+    x = (x * mContentWidth / mConfig.srcWidth + mOffsetX) / mConfig.dstWidth;
+    y = (y * mContentHeight / mConfig.srcHeight + mOffsetY) / mConfig.dstHeight;
+}
+
+void RvcPreprocessor::FillRow(const uint8_t * src, int contentY, uint8_t * row) const
+{
+    if (mConfig.srcFormat == RvcCameraFrame::PixelFormat::kNv12) {
+        SampleNv12(src, contentY, row);
+        return;
+    }
+
+    const size_t srcStride = static_cast<size_t>(mConfig.srcWidth) * 3;
+    const uint8_t * srcRow0 = src + static_cast<size_t>(mSrcY[contentY]) * srcStride;
+    if (mMode == ResizeMode::kNearest) {
+        SampleRgbNearest(srcRow0, row);
+    }
+    else {
+        SampleRgbBilinear(srcRow0, srcRow0 + srcStride, mWeightY[contentY], row);
+    }
+}
+
+void RvcPreprocessor::SampleRgbNearest(const uint8_t * srcRow, uint8_t * out) const
+{
+    if (mContentWidth == mConfig.srcWidth) {
+        std::memcpy(out, srcRow, static_cast<size_t>(mContentWidth) * 3);
+        return;
+    }
+
+    for (int x = 0; x < mContentWidth; ++x) {
+        const uint8_t * p = srcRow + static_cast<size_t>(mSrcX[x]) * 3;
+        out[0] = p[0];
+        out[1] = p[1];
+        out[2] = p[2];
+        out += 3;
+    }
+}
+
+void RvcPreprocessor::SampleRgbBilinear(const uint8_t * srcRow0, const uint8_t * srcRow1, int wy, uint8_t * out) const
+{
+    for (int x = 0; x < mContentWidth; ++x) {
+        const size_t offset = static_cast<size_t>(mSrcX[x]) * 3;
+        const uint8_t * a = srcRow0 + offset;
+        const uint8_t * b = srcRow1 + offset;
+        const int wx = mWeightX[x];
+        for (int c = 0; c < 3; ++c) {
+            out[c] = static_cast<uint8_t>(Lerp2D(a[c], a[c + 3], b[c], b[c + 3], wx, wy));
+        }
+        out += 3;
+    }
+}
+
+void RvcPreprocessor::SampleNv12(const uint8_t * src, int contentY, uint8_t * out) const
+{
+    const size_t width = static_cast<size_t>(mConfig.srcWidth);
+    const bool bilinear = (mMode == ResizeMode::kBilinear);
+    const int sy = mSrcY[contentY];
+    const int wy = mWeightY[contentY];
+    const uint8_t * y0 = src + static_cast<size_t>(sy) * width;
+    const uint8_t * y1 = bilinear ? y0 + width : y0;
+
+    // Chroma is half resolution and sampled nearest; bilinear only applies to luma.
+    const int chromaRow = (sy + (wy >= kWeightOne / 2 ? 1 : 0)) / 2;
+    const uint8_t * uv = src + width * mConfig.srcHeight + static_cast<size_t>(chromaRow) * width;
+
+    for (int x = 0; x < mContentWidth; ++x) {
+        const int sx = mSrcX[x];
+        const int wx = mWeightX[x];
+        int luma = bilinear ? Lerp2D(y0[sx], y0[sx + 1], y1[sx], y1[sx + 1], wx, wy) : y0[sx];
+        const uint8_t * chroma = uv + ((sx + (wx >= kWeightOne / 2 ? 1 : 0)) & ~1);
+        YuvToRgb(luma, chroma[0], chroma[1], out);
+        out += 3;
+    }
+}
+
+void RvcPreprocessor::Quantize(uint8_t * row, size_t count) const
+{
+    if (!mShiftOnly) {
+        for (size_t i = 0; i < count; ++i) {
+            row[i] = static_cast<uint8_t>(mLut[row[i]]);
+        }
+        return;
+    }
+
+    // pixel - 128 as int8 is exactly the pixel with its top bit flipped.
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i bias = _mm_set1_epi8(static_cast<char>(0x80));
+    for (; i + 16 <= count; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(row + i), _mm_xor_si128(v, bias));
+    }
+#elif defined(__ARM_NEON)
+    const uint8x16_t bias = vdupq_n_u8(0x80);
+    for (; i + 16 <= count; i += 16) {
+        vst1q_u8(row + i, veorq_u8(vld1q_u8(row + i), bias));
+    }
+#endif
+    for (; i < count; ++i) {
+        row[i] ^= 0x80;
+    }
+}
@@ -0,0 +1,123 @@
+#include "RvcQuantizedWeights.h"
+#include "RvcTrainerKernels.h"
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+#include <iostream>
+
+namespace {
+constexpr size_t kMasterAlignment = 64;
+} // namespace
+
+RvcQuantizedWeights::RvcQuantizedWeights()
+    : mTensor(nullptr), mTensorIndex(-1), mCount(0), mChannelSize(0), mPerChannelOuter(true), mDirty(false)
+{
+}
+
+bool RvcQuantizedWeights::Bind(const tflite::Model * model, int tensorIndex, TfLiteEvalTensor * tensor)
+{
+    if (!model || !tensor || tensor->type != kTfLiteInt8) {
+        std::cerr << "Error: Tensor " << tensorIndex << " is not an int8 weight tensor." << std::endl;
+        return false;
+    }
+
+    const tflite::Tensor * fb_tensor = model->subgraphs()->Get(0)->tensors()->Get(tensorIndex);
+    const tflite::QuantizationParameters * quantization = fb_tensor->quantization();
+    if (!quantization || !quantization->scale() || quantization->scale()->size() == 0) {
+        std::cerr << "Error: Tensor " << tensorIndex << " has no quantization parameters." << std::endl;
+        return false;
+    }
+
+    size_t count = 1;
+    for (int i = 0; i < tensor->dims->size; ++i) {
+        count *= static_cast<size_t>(tensor->dims->data[i]);
+    }
+
+    const uint32_t channels = quantization->scale()->size();
+    const int dim = quantization->quantized_dimension();
+    if (channels > 1 && (dim < 0 || dim >= tensor->dims->size || static_cast<uint32_t>(tensor->dims->data[dim]) != channels ||
+                         (dim != 0 && dim != tensor->dims->size - 1))) {
+        std::cerr << "Error: Unsupported quantized dimension " << dim << " for tensor " << tensorIndex << std::endl;
+        return false;
+    }
+
+    mScales.resize(channels);
+    mZeroPoints.assign(channels, 0);
+    for (uint32_t c = 0; c < channels; ++c) {
+        mScales[c] = quantization->scale()->Get(c);
+        if (quantization->zero_point() && c < quantization->zero_point()->size()) {
+            mZeroPoints[c] = static_cast<int32_t>(quantization->zero_point()->Get(c));
+        }
+    }
+
+    mPerChannelOuter = (channels == 1 || dim == 0);
+    mChannelSize = count / channels;
+    mCount = count;
+    mTensor = tensor;
+    mTensorIndex = tensorIndex;
+
+    // aligned_alloc needs a size that is a multiple of the alignment.
+    size_t bytes = (count * sizeof(float) + kMasterAlignment - 1) & ~(kMasterAlignment - 1);
+    mMaster.reset(static_cast<float *>(std::aligned_alloc(kMasterAlignment, bytes)));
+    if (!mMaster) {
+        std::cerr << "Error: Failed to allocate the fp32 master weights." << std::endl;
+        mTensor = nullptr;
+        return false;
+    }
+
+    Dequantize();
+    return true;
+}
+
+int8_t * RvcQuantizedWeights::Int8Data() const
+{
+    return mTensor ? mTensor->data.int8 : nullptr;
+}
+
+void RvcQuantizedWeights::Dequantize()
+{
+    if (!mTensor) {
+        return;
+    }
+
+    const int8_t * q = mTensor->data.int8;
+    float * master = mMaster.get();
+    if (mPerChannelOuter) {
+        for (size_t c = 0; c < mScales.size(); ++c) {
+            RvcTrainerKernels::Dequantize(q + c * mChannelSize, master + c * mChannelSize, mChannelSize, mScales[c], mZeroPoints[c]);
+        }
+    }
+    else {
+        const size_t channels = mScales.size();
+        for (size_t i = 0; i < mCount; ++i) {
+            master[i] = static_cast<float>(q[i] - mZeroPoints[i % channels]) * mScales[i % channels];
+        }
+    }
+    mDirty = false;
+}
+
+void RvcQuantizedWeights::Commit()
+{
+    if (!mTensor || !mDirty) {
+        return;
+    }
+
+    // The scales are baked into the kernel's output multipliers at Prepare() time, so they
+    // stay fixed and master values outside the representable range are clamped.
+    int8_t * q = mTensor->data.int8;
+    const float * master = mMaster.get();
+    if (mPerChannelOuter) {
+        for (size_t c = 0; c < mScales.size(); ++c) {
+            RvcTrainerKernels::Requantize(master + c * mChannelSize, q + c * mChannelSize, mChannelSize, 1.0f / mScales[c],
+                                          mZeroPoints[c]);
+        }
+    }
+    else {
+        const size_t channels = mScales.size();
+        for (size_t i = 0; i < mCount; ++i) {
+            RvcTrainerKernels::Requantize(master + i, q + i, 1, 1.0f / mScales[i % channels], mZeroPoints[i % channels]);
+        }
+    }
+    mDirty = false;
+}
@@ -0,0 +1,233 @@
+#include "RvcReplayStore.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+constexpr uint32_t kMagic = 0x52565252; // "RRVR"
+constexpr uint32_t kVersion = 1;
+constexpr size_t kSlotAlignment = 64;
+constexpr uint32_t kFlagPseudoLabel = 1u << 0;
+constexpr uint32_t kFlagWriting = 1u << 1; // Set while a slot is rewritten; such a slot is never returned
+
+size_t AlignUp(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+} // namespace
+
+struct RvcReplayStore::FileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t inputBytes;
+    uint32_t maxBoxes;
+    uint32_t capacity;
+    uint32_t count; // Slots in use; grows to capacity, then stays there
+    uint64_t seen;  // Samples offered so far, for reservoir sampling
+    uint64_t rngState;
+};
+
+struct RvcReplayStore::SlotHeader {
+    uint32_t numBoxes;
+    uint32_t flags;
+};
+
+RvcReplayStore::RvcReplayStore()
+    : mFd(-1), mBase(nullptr), mMappedBytes(0), mInputBytes(0), mSlotBytes(0), mCapacity(0)
+{
+}
+
+RvcReplayStore::~RvcReplayStore()
+{
+    Close();
+}
+
+bool RvcReplayStore::Open(const std::string & path, size_t inputBytes, size_t byteBudget)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mBase) { std::cerr << "Error: Replay store already open." << std::endl; return false; }
+
+    const size_t header_bytes = AlignUp(sizeof(FileHeader), kSlotAlignment);
+    const size_t slot_bytes = AlignUp(sizeof(SlotHeader) + kMaxBoxes * sizeof(RvcTrainingBox) + inputBytes, kSlotAlignment);
+    if (inputBytes == 0 || byteBudget < header_bytes + slot_bytes) {
+        std::cerr << "Error: Replay store budget of " << byteBudget << " bytes is too small." << std::endl;
+        return false;
+    }
+    const size_t capacity = (byteBudget - header_bytes) / slot_bytes;
+    const size_t file_bytes = header_bytes + capacity * slot_bytes;
+
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd < 0) { std::cerr << "Error: Cannot open replay store " << path << std::endl; return false; }
+
+    struct stat st;
+    bool reuse = fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) == file_bytes;
+    if (!reuse && ftruncate(fd, static_cast<off_t>(file_bytes)) != 0) {
+        std::cerr << "Error: Cannot size replay store " << path << std::endl;
+        close(fd);
+        return false;
+    }
+
+    void * base = mmap(nullptr, file_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        std::cerr << "Error: Cannot map replay store " << path << std::endl;
+        close(fd);
+        return false;
+    }
+
+    mFd = fd;
+    mBase = static_cast<uint8_t *>(base);
+    mMappedBytes = file_bytes;
+    mInputBytes = inputBytes;
+    mSlotBytes = slot_bytes;
+    mCapacity = capacity;
+
+    FileHeader * header = Header();
+    reuse = reuse && header->magic == kMagic && header->version == kVersion && header->inputBytes == inputBytes &&
+        header->maxBoxes == kMaxBoxes && header->capacity == capacity && header->count <= capacity;
+    if (!reuse) {
+        std::memset(header, 0, sizeof(FileHeader));
+        header->magic = kMagic;
+        header->version = kVersion;
+        header->inputBytes = static_cast<uint32_t>(inputBytes);
+        header->maxBoxes = kMaxBoxes;
+        header->capacity = static_cast<uint32_t>(capacity);
+        header->rngState = 0x9E3779B97F4A7C15ull;
+    }
+
+    std::cout << "Replay store " << path << ": " << header->count << "/" << capacity << " samples ("
+              << (reuse ? "reused" : "new") << ", " << file_bytes / (1024 * 1024) << " MB)" << std::endl;
+    return true;
+}
+
+void RvcReplayStore::Close()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (!mBase) { return; }
+    msync(mBase, mMappedBytes, MS_SYNC);
+    munmap(mBase, mMappedBytes);
+    close(mFd);
+    mBase = nullptr;
+    mFd = -1;
+    mMappedBytes = 0;
+    mCapacity = 0;
+}
+
+bool RvcReplayStore::Add(const int8_t * input, size_t inputBytes, const RvcTrainingBox * boxes, size_t numBoxes,
+                         bool pseudoLabel, bool wait)
+{
+    std::unique_lock<std::mutex> lock(mMutex, std::defer_lock);
+    if (wait) {
+        lock.lock();
+    }
+    else if (!lock.try_lock()) {
+        return false;
+    }
+
+    if (!mBase || !input || inputBytes != mInputBytes || (numBoxes > 0 && !boxes)) { return false; }
+
+    // Reservoir sampling: the n-th sample is kept with probability capacity / n.
+    FileHeader * header = Header();
+    uint64_t seen = ++header->seen;
+    size_t index;
+    if (header->count < mCapacity) {
+        index = header->count;
+    }
+    else {
+        uint64_t pick = NextRandom() % seen;
+        if (pick >= mCapacity) { return false; }
+        index = static_cast<size_t>(pick);
+    }
+
+    uint8_t * slot = Slot(index);
+    SlotHeader * slot_header = reinterpret_cast<SlotHeader *>(slot);
+
+    // A replaced slot is already counted, so it is marked as being written first: a crash half-way leaves
+    // it unreadable rather than mixing two samples. The fences keep the compiler from merging or moving
+    // the flag stores across the copies.
+    slot_header->flags = kFlagWriting;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    slot_header->numBoxes = static_cast<uint32_t>(std::min(numBoxes, kMaxBoxes));
+    std::memcpy(slot + sizeof(SlotHeader), boxes, slot_header->numBoxes * sizeof(RvcTrainingBox));
+    std::memcpy(slot + sizeof(SlotHeader) + kMaxBoxes * sizeof(RvcTrainingBox), input, inputBytes);
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    slot_header->flags = pseudoLabel ? kFlagPseudoLabel : 0;
+
+    // A new slot is only counted once it is complete.
+    if (index == header->count) {
+        header->count++;
+    }
+    return true;
+}
+
+size_t RvcReplayStore::Size() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mBase ? Header()->count : 0;
+}
+
+bool RvcReplayStore::Get(size_t index, RvcReplaySample & sample) const
+{
+    if (!mBase || index >= Header()->count) { return false; }
+
+    const uint8_t * slot = Slot(index);
+    const SlotHeader * slot_header = reinterpret_cast<const SlotHeader *>(slot);
+    if (slot_header->flags & kFlagWriting) { return false; }
+    sample.boxes = reinterpret_cast<const RvcTrainingBox *>(slot + sizeof(SlotHeader));
+    sample.numBoxes = slot_header->numBoxes;
+    sample.pseudoLabel = (slot_header->flags & kFlagPseudoLabel) != 0;
+    sample.input = reinterpret_cast<const int8_t *>(slot + sizeof(SlotHeader) + kMaxBoxes * sizeof(RvcTrainingBox));
+    return true;
+}
+
+void RvcReplayStore::GetSplit(bool holdout, std::vector<uint32_t> & indices)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    indices.clear();
+    if (!mBase) { return; }
+
+    for (uint32_t i = 0; i < Header()->count; ++i) {
+        if (IsHoldout(i) == holdout) {
+            indices.push_back(i);
+        }
+    }
+    // Fisher-Yates with the store's own generator.
+    for (size_t i = indices.size(); i > 1; --i) {
+        std::swap(indices[i - 1], indices[NextRandom() % i]);
+    }
+}
+
+void RvcReplayStore::Flush()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mBase) {
+        msync(mBase, mMappedBytes, MS_ASYNC);
+    }
+}
+
+RvcReplayStore::FileHeader * RvcReplayStore::Header() const
+{
+    return reinterpret_cast<FileHeader *>(mBase);
+}
+
+uint8_t * RvcReplayStore::Slot(size_t index) const
+{
+    return mBase + AlignUp(sizeof(FileHeader), kSlotAlignment) + index * mSlotBytes;
+}
+
+uint64_t RvcReplayStore::NextRandom()
+{
+    // xorshift64*, with its state kept in the file so sampling continues across restarts.
+    uint64_t x = Header()->rngState;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    Header()->rngState = x;
+    return x * 0x2545F4914F6CDD1Dull;
+}
@@ -0,0 +1,279 @@
+#include "RvcTrainerKernels.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace {
+// Keeps the float -> int32 conversion in range; anything this large saturates anyway.
+constexpr float kMaxQuantizedMagnitude = 1024.0f;
+
+inline int8_t SaturateInt8(int value)
+{
+    return static_cast<int8_t>(std::max(-128, std::min(127, value)));
+}
+} // namespace
+
+void RvcTrainerKernels::AddSaturateInt8(int8_t * weights, const int8_t * deltas, size_t count)
+{
+    size_t i = 0;
+#if defined(__AVX2__)
+    for (; i + 32 <= count; i += 32) {
+        __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(weights + i));
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(deltas + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(weights + i), _mm256_adds_epi8(w, d));
+    }
+#elif defined(__SSE2__)
+    for (; i + 16 <= count; i += 16) {
+        __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i *>(weights + i));
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(deltas + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(weights + i), _mm_adds_epi8(w, d));
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    for (; i + 16 <= count; i += 16) {
+        vst1q_s8(weights + i, vqaddq_s8(vld1q_s8(weights + i), vld1q_s8(deltas + i)));
+    }
+#endif
+    for (; i < count; ++i) {
+        weights[i] = SaturateInt8(weights[i] + deltas[i]);
+    }
+}
+
+void RvcTrainerKernels::SubSaturateInt8(int8_t * weights, const int8_t * deltas, size_t count)
+{
+    size_t i = 0;
+#if defined(__AVX2__)
+    for (; i + 32 <= count; i += 32) {
+        __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(weights + i));
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(deltas + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(weights + i), _mm256_subs_epi8(w, d));
+    }
+#elif defined(__SSE2__)
+    for (; i + 16 <= count; i += 16) {
+        __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i *>(weights + i));
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(deltas + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(weights + i), _mm_subs_epi8(w, d));
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    for (; i + 16 <= count; i += 16) {
+        vst1q_s8(weights + i, vqsubq_s8(vld1q_s8(weights + i), vld1q_s8(deltas + i)));
+    }
+#endif
+    for (; i < count; ++i) {
+        weights[i] = SaturateInt8(weights[i] - deltas[i]);
+    }
+}
+
+void RvcTrainerKernels::Dequantize(const int8_t * src, float * dst, size_t count, float scale, int zeroPoint)
+{
+    size_t i = 0;
+#if defined(__AVX2__)
+    const __m256 scale_v = _mm256_set1_ps(scale);
+    const __m256i zp = _mm256_set1_epi32(zeroPoint);
+    for (; i + 8 <= count; i += 8) {
+        __m256i q = _mm256_cvtepi8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(src + i)));
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_sub_epi32(q, zp)), scale_v));
+    }
+#elif defined(__SSE2__)
+    const __m128 scale_v = _mm_set1_ps(scale);
+    const __m128i zp = _mm_set1_epi32(zeroPoint);
+    for (; i + 8 <= count; i += 8) {
+        // Sign-extend by placing each byte in the top of a wider lane and shifting it back down.
+        __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(src + i));
+        __m128i words = _mm_srai_epi16(_mm_unpacklo_epi8(bytes, bytes), 8);
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(words, words), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(words, words), 16);
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_sub_epi32(lo, zp)), scale_v));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_sub_epi32(hi, zp)), scale_v));
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    const int32x4_t zp = vdupq_n_s32(zeroPoint);
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t words = vmovl_s8(vld1_s8(src + i));
+        int32x4_t lo = vsubq_s32(vmovl_s16(vget_low_s16(words)), zp);
+        int32x4_t hi = vsubq_s32(vmovl_s16(vget_high_s16(words)), zp);
+        vst1q_f32(dst + i, vmulq_n_f32(vcvtq_f32_s32(lo), scale));
+        vst1q_f32(dst + i + 4, vmulq_n_f32(vcvtq_f32_s32(hi), scale));
+    }
+#endif
+    for (; i < count; ++i) {
+        dst[i] = static_cast<float>(src[i] - zeroPoint) * scale;
+    }
+}
+
+void RvcTrainerKernels::Requantize(const float * src, int8_t * dst, size_t count, float inverseScale, int zeroPoint)
+{
+    // Symmetric (per-channel) weights must stay within [-127, 127], as TFLite requires.
+    const int lo = (zeroPoint == 0) ? -127 : -128;
+    size_t i = 0;
+
+#if defined(__AVX2__)
+    const __m256 inv = _mm256_set1_ps(inverseScale);
+    const __m256 limit = _mm256_set1_ps(kMaxQuantizedMagnitude);
+    const __m256 neg_limit = _mm256_set1_ps(-kMaxQuantizedMagnitude);
+    const __m256i zp = _mm256_set1_epi32(zeroPoint);
+    const __m256i lo_v = _mm256_set1_epi8(static_cast<char>(lo));
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    auto convert = [&](const float * p) {
+        __m256 v = _mm256_mul_ps(_mm256_loadu_ps(p), inv);
+        v = _mm256_max_ps(neg_limit, _mm256_min_ps(limit, v));
+        return _mm256_add_epi32(_mm256_cvtps_epi32(v), zp); // Round to nearest even, like nearbyint()
+    };
+    for (; i + 32 <= count; i += 32) {
+        __m256i ab = _mm256_packs_epi32(convert(src + i), convert(src + i + 8));
+        __m256i cd = _mm256_packs_epi32(convert(src + i + 16), convert(src + i + 24));
+        __m256i packed = _mm256_permutevar8x32_epi32(_mm256_packs_epi16(ab, cd), order);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_max_epi8(packed, lo_v));
+    }
+#elif defined(__SSE2__)
+    const __m128 inv = _mm_set1_ps(inverseScale);
+    const __m128 limit = _mm_set1_ps(kMaxQuantizedMagnitude);
+    const __m128 neg_limit = _mm_set1_ps(-kMaxQuantizedMagnitude);
+    const __m128i zp = _mm_set1_epi32(zeroPoint);
+    const __m128i lo_v = _mm_set1_epi16(static_cast<short>(lo));
+    auto convert = [&](const float * p) {
+        __m128 v = _mm_mul_ps(_mm_loadu_ps(p), inv);
+        v = _mm_max_ps(neg_limit, _mm_min_ps(limit, v));
+        return _mm_add_epi32(_mm_cvtps_epi32(v), zp);
+    };
+    for (; i + 16 <= count; i += 16) {
+        __m128i ab = _mm_max_epi16(_mm_packs_epi32(convert(src + i), convert(src + i + 4)), lo_v);
+        __m128i cd = _mm_max_epi16(_mm_packs_epi32(convert(src + i + 8), convert(src + i + 12)), lo_v);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_packs_epi16(ab, cd));
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    const float32x4_t limit = vdupq_n_f32(kMaxQuantizedMagnitude);
+    const float32x4_t neg_limit = vdupq_n_f32(-kMaxQuantizedMagnitude);
+    const int32x4_t zp = vdupq_n_s32(zeroPoint);
+    const int8x16_t lo_v = vdupq_n_s8(static_cast<int8_t>(lo));
+    auto convert = [&](const float * p) {
+        float32x4_t v = vmulq_n_f32(vld1q_f32(p), inverseScale);
+        v = vmaxq_f32(neg_limit, vminq_f32(limit, v));
+        return vaddq_s32(vcvtnq_s32_f32(v), zp);
+    };
+    for (; i + 16 <= count; i += 16) {
+        int16x8_t ab = vcombine_s16(vqmovn_s32(convert(src + i)), vqmovn_s32(convert(src + i + 4)));
+        int16x8_t cd = vcombine_s16(vqmovn_s32(convert(src + i + 8)), vqmovn_s32(convert(src + i + 12)));
+        vst1q_s8(dst + i, vmaxq_s8(vcombine_s8(vqmovn_s16(ab), vqmovn_s16(cd)), lo_v));
+    }
+#endif
+
+    for (; i < count; ++i) {
+        float v = std::nearbyint(src[i] * inverseScale) + static_cast<float>(zeroPoint);
+        dst[i] = static_cast<int8_t>(std::max(static_cast<float>(lo), std::min(127.0f, v)));
+    }
+}
+
+void RvcTrainerKernels::Accumulate(float * dst, const float * src, size_t count)
+{
+    size_t i = 0;
+#if defined(__AVX2__)
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(dst + i, _mm256_add_ps(_mm256_loadu_ps(dst + i), _mm256_loadu_ps(src + i)));
+    }
+#elif defined(__SSE2__)
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_loadu_ps(src + i)));
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(dst + i, vaddq_f32(vld1q_f32(dst + i), vld1q_f32(src + i)));
+    }
+#endif
+    for (; i < count; ++i) {
+        dst[i] += src[i];
+    }
+}
+
+void RvcTrainerKernels::MultiplyAccumulate(float * dst, const float * src, float scale, size_t count)
+{
+    size_t i = 0;
+#if defined(__AVX2__)
+    const __m256 scale_v = _mm256_set1_ps(scale);
+    for (; i + 16 <= count; i += 16) {
+        __m256 a = _mm256_add_ps(_mm256_loadu_ps(dst + i), _mm256_mul_ps(scale_v, _mm256_loadu_ps(src + i)));
+        __m256 b = _mm256_add_ps(_mm256_loadu_ps(dst + i + 8), _mm256_mul_ps(scale_v, _mm256_loadu_ps(src + i + 8)));
+        _mm256_storeu_ps(dst + i, a);
+        _mm256_storeu_ps(dst + i + 8, b);
+    }
+#elif defined(__SSE2__)
+    const __m128 scale_v = _mm_set1_ps(scale);
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(scale_v, _mm_loadu_ps(src + i))));
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    for (; i + 8 <= count; i += 8) {
+        vst1q_f32(dst + i, vfmaq_n_f32(vld1q_f32(dst + i), vld1q_f32(src + i), scale));
+        vst1q_f32(dst + i + 4, vfmaq_n_f32(vld1q_f32(dst + i + 4), vld1q_f32(src + i + 4), scale));
+    }
+#endif
+    for (; i < count; ++i) {
+        dst[i] += scale * src[i];
+    }
+}
+
+void RvcTrainerKernels::MomentumStep(float * weights, float * velocity, const float * gradients, size_t count, float momentum,
+                                     float weightDecay, float learningRate, float gradientScale)
+{
+    size_t i = 0;
+#if defined(__AVX2__)
+    const __m256 m = _mm256_set1_ps(momentum);
+    const __m256 decay = _mm256_set1_ps(weightDecay);
+    const __m256 lr = _mm256_set1_ps(learningRate);
+    const __m256 gs = _mm256_set1_ps(gradientScale);
+    for (; i + 8 <= count; i += 8) {
+        __m256 w = _mm256_loadu_ps(weights + i);
+        __m256 v = _mm256_mul_ps(m, _mm256_loadu_ps(velocity + i));
+        v = _mm256_add_ps(v, _mm256_mul_ps(gs, _mm256_loadu_ps(gradients + i)));
+        v = _mm256_add_ps(v, _mm256_mul_ps(decay, w));
+        _mm256_storeu_ps(velocity + i, v);
+        _mm256_storeu_ps(weights + i, _mm256_sub_ps(w, _mm256_mul_ps(lr, v)));
+    }
+#elif defined(__SSE2__)
+    const __m128 m = _mm_set1_ps(momentum);
+    const __m128 decay = _mm_set1_ps(weightDecay);
+    const __m128 lr = _mm_set1_ps(learningRate);
+    const __m128 gs = _mm_set1_ps(gradientScale);
+    for (; i + 4 <= count; i += 4) {
+        __m128 w = _mm_loadu_ps(weights + i);
+        __m128 v = _mm_mul_ps(m, _mm_loadu_ps(velocity + i));
+        v = _mm_add_ps(v, _mm_mul_ps(gs, _mm_loadu_ps(gradients + i)));
+        v = _mm_add_ps(v, _mm_mul_ps(decay, w));
+        _mm_storeu_ps(velocity + i, v);
+        _mm_storeu_ps(weights + i, _mm_sub_ps(w, _mm_mul_ps(lr, v)));
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t w = vld1q_f32(weights + i);
+        float32x4_t v = vmulq_n_f32(vld1q_f32(velocity + i), momentum);
+        v = vfmaq_n_f32(v, vld1q_f32(gradients + i), gradientScale);
+        v = vfmaq_n_f32(v, w, weightDecay);
+        vst1q_f32(velocity + i, v);
+        vst1q_f32(weights + i, vfmsq_n_f32(w, v, learningRate));
+    }
+#endif
+    for (; i < count; ++i) {
+        velocity[i] = momentum * velocity[i] + gradientScale * gradients[i] + weightDecay * weights[i];
+        weights[i] -= learningRate * velocity[i];
+    }
+}
+
+const char * RvcTrainerKernels::SimdName()
+{
+#if defined(__AVX2__)
+    return "AVX2";
+#elif defined(__SSE2__)
+    return "SSE2";
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    return "NEON";
+#else
+    return "scalar";
+#endif
+}
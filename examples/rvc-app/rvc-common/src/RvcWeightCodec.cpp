@@ -0,0 +1,104 @@
+#include "RvcWeightCodec.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+// Starting a new run costs at least two varint bytes, so shorter gaps are sent inline.
+constexpr size_t kMaxInlineGap = 2;
+} // namespace
+
+void RvcWeightCodec::PutVarint(std::string & out, uint32_t value)
+{
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+bool RvcWeightCodec::GetVarint(const uint8_t *& p, const uint8_t * end, uint32_t & value)
+{
+    value = 0;
+    for (int shift = 0; shift < 35 && p < end; shift += 7) {
+        uint8_t byte = *p++;
+        value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t RvcWeightCodec::EncodeSparse(const int8_t * baseline, const int8_t * current, size_t count, size_t topK,
+                                    std::string & out, std::vector<uint32_t> & scratch)
+{
+    out.clear();
+    scratch.clear();
+    for (size_t i = 0; i < count; ++i) {
+        if (current[i] != baseline[i]) {
+            scratch.push_back(static_cast<uint32_t>(i));
+        }
+    }
+
+    if (topK > 0 && scratch.size() > topK) {
+        auto magnitude = [baseline, current](uint32_t i) { return std::abs(current[i] - baseline[i]); };
+        std::nth_element(scratch.begin(), scratch.begin() + topK, scratch.end(),
+                         [&magnitude](uint32_t a, uint32_t b) { return magnitude(a) > magnitude(b); });
+        scratch.resize(topK);
+        std::sort(scratch.begin(), scratch.end());
+    }
+
+    size_t position = 0; // First weight not yet covered by the output
+    size_t k = 0;
+    while (k < scratch.size()) {
+        // Extend the run over changed weights and short gaps.
+        size_t first = scratch[k];
+        size_t last = first;
+        size_t next = k + 1;
+        while (next < scratch.size() && scratch[next] - last <= kMaxInlineGap + 1) {
+            last = scratch[next++];
+        }
+
+        PutVarint(out, static_cast<uint32_t>(first - position));
+        PutVarint(out, static_cast<uint32_t>(last - first + 1));
+        // Inline gap bytes are sent as their baseline value, so they stay unchanged on the other side.
+        for (size_t i = first, s = k; i <= last; ++i) {
+            if (s < next && scratch[s] == i) {
+                out.push_back(static_cast<char>(current[i]));
+                ++s;
+            }
+            else {
+                out.push_back(static_cast<char>(baseline[i]));
+            }
+        }
+
+        position = last + 1;
+        k = next;
+    }
+
+    return scratch.size();
+}
+
+bool RvcWeightCodec::ApplySparse(const std::string & in, int8_t * weights, size_t count)
+{
+    const uint8_t * p = reinterpret_cast<const uint8_t *>(in.data());
+    const uint8_t * end = p + in.size();
+    size_t position = 0;
+
+    while (p < end) {
+        uint32_t skip = 0;
+        uint32_t run = 0;
+        if (!GetVarint(p, end, skip) || !GetVarint(p, end, run)) {
+            return false;
+        }
+        position += skip;
+        if (position + run > count || static_cast<size_t>(end - p) < run) {
+            return false;
+        }
+        std::copy(p, p + run, reinterpret_cast<uint8_t *>(weights) + position);
+        p += run;
+        position += run;
+    }
+    return true;
+}
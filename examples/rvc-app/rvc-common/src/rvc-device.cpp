@@ -1,5 +1,8 @@
 #include "rvc-device.h"
 
+#include <app/server/Server.h>
+#include <data-model-providers/codegen/CodegenDataModelProvider.h>
+
 #include <string>
 
 using namespace chip::app::Clusters;
@@ -7,9 +10,56 @@ using namespace chip::app::Clusters;
 void RvcDevice::Init()
 {
     mServiceAreaInstance.Init();
+    // Per-area estimates may be refreshed every second while cleaning; status changes are still reported right away.
+    mServiceAreaInstance.SetProgressEstimateReportInterval(System::Clock::Seconds32(10));
     mRunModeInstance.Init();
     mCleanModeInstance.Init();
     mOperationalStateInstance.Init();
+
+    // Restore the last imported floor plan, if any, in place of the default topology.
+    {
+        std::vector<ServiceArea::MapStructureWrapper> maps;
+        std::vector<ServiceArea::AreaStructureWrapper> areas;
+        CHIP_ERROR err = mStorageDelegate.LoadSupportedMaps(Server::GetInstance().GetPersistentStorage(), maps, areas);
+        if (err == CHIP_NO_ERROR)
+        {
+            HandleImportServiceAreaMaps(maps, areas);
+        }
+        else if (err != CHIP_ERROR_PERSISTED_STORAGE_VALUE_NOT_FOUND)
+        {
+            ChipLogError(NotSpecified, "RVC App: Failed to load the saved service area maps: %" CHIP_ERROR_FORMAT, err.Format());
+        }
+        // The default topology set up by Init() is not saved; only edits are.
+        mStorageDelegate.TakeSupportedMapsChanged();
+    }
+
+    CHIP_ERROR err = CodegenDataModelProvider::Instance().Registry().Register(mObstacleCluster.Registration());
+    if (err != CHIP_NO_ERROR)
+    {
+        ChipLogError(NotSpecified, "RVC App: Failed to register the obstacle detection cluster: %" CHIP_ERROR_FORMAT, err.Format());
+    }
+}
+
+RvcDevice::~RvcDevice()
+{
+    mServiceAreaInstance.Shutdown();
+    CodegenDataModelProvider::Instance().Registry().Unregister(&mObstacleCluster.Cluster());
+}
+
+void RvcDevice::SetOperationalStateChangedCallback(OperationalStateChangedCallback aCallback, void * aContext)
+{
+    mStateChangedCallback = aCallback;
+    mStateChangedContext  = aContext;
+}
+
+CHIP_ERROR RvcDevice::SetOperationalState(uint8_t aOpState)
+{
+    CHIP_ERROR err = mOperationalStateInstance.SetOperationalState(aOpState);
+    if (err == CHIP_NO_ERROR && mStateChangedCallback != nullptr)
+    {
+        mStateChangedCallback(aOpState, mStateChangedContext);
+    }
+    return err;
 }
 
 void RvcDevice::SetDeviceToIdleState()
@@ -17,15 +67,15 @@ void RvcDevice::SetDeviceToIdleState()
     if (mCharging)
     {
         mDocked = true;
-        mOperationalStateInstance.SetOperationalState(to_underlying(RvcOperationalState::OperationalStateEnum::kCharging));
+        SetOperationalState(to_underlying(RvcOperationalState::OperationalStateEnum::kCharging));
     }
     else if (mDocked)
     {
-        mOperationalStateInstance.SetOperationalState(to_underlying(RvcOperationalState::OperationalStateEnum::kDocked));
+        SetOperationalState(to_underlying(RvcOperationalState::OperationalStateEnum::kDocked));
     }
     else
     {
-        mOperationalStateInstance.SetOperationalState(to_underlying(OperationalState::OperationalStateEnum::kStopped));
+        SetOperationalState(to_underlying(OperationalState::OperationalStateEnum::kStopped));
     }
 }
 
@@ -50,7 +100,7 @@ void RvcDevice::HandleRvcRunChangeToMode(uint8_t newMode, ModeBase::Commands::Ch
         mCharging = false;
         mDocked   = false;
         mRunModeInstance.UpdateCurrentMode(newMode);
-        mOperationalStateInstance.SetOperationalState(to_underlying(OperationalState::OperationalStateEnum::kRunning));
+        SetOperationalState(to_underlying(OperationalState::OperationalStateEnum::kRunning));
         mServiceAreaDelegate.SetAttributesAtCleanStart();
         response.status = to_underlying(ModeBase::StatusCode::kSuccess);
         return;
@@ -65,7 +115,7 @@ void RvcDevice::HandleRvcRunChangeToMode(uint8_t newMode, ModeBase::Commands::Ch
         }
 
         mRunModeInstance.UpdateCurrentMode(newMode);
-        mOperationalStateInstance.SetOperationalState(to_underlying(RvcOperationalState::OperationalStateEnum::kSeekingCharger));
+        SetOperationalState(to_underlying(RvcOperationalState::OperationalStateEnum::kSeekingCharger));
         response.status = to_underlying(ModeBase::StatusCode::kSuccess);
 
         UpdateServiceAreaProgressOnExit();
@@ -97,7 +147,7 @@ void RvcDevice::HandleOpStatePauseCallback(Clusters::OperationalState::GenericOp
 {
     // This method is only called if the device is in a Pause-compatible state, i.e. `Running` or `SeekingCharger`.
     mStateBeforePause = mOperationalStateInstance.GetCurrentOperationalState();
-    auto error = mOperationalStateInstance.SetOperationalState(to_underlying(OperationalState::OperationalStateEnum::kPaused));
+    auto error = SetOperationalState(to_underlying(OperationalState::OperationalStateEnum::kPaused));
     err.Set((error == CHIP_NO_ERROR) ? to_underlying(OperationalState::ErrorStateEnum::kNoError)
                                      : to_underlying(OperationalState::ErrorStateEnum::kUnableToCompleteOperation));
 }
@@ -132,7 +182,7 @@ void RvcDevice::HandleOpStateResumeCallback(Clusters::OperationalState::GenericO
         return;
     }
 
-    auto error = mOperationalStateInstance.SetOperationalState(targetState);
+    auto error = SetOperationalState(targetState);
 
     err.Set((error == CHIP_NO_ERROR) ? to_underlying(OperationalState::ErrorStateEnum::kNoError)
                                      : to_underlying(OperationalState::ErrorStateEnum::kUnableToCompleteOperation));
@@ -157,8 +207,7 @@ void RvcDevice::HandleOpStateGoHomeCallback(Clusters::OperationalState::GenericO
         // but to avoid need for an additional state variable, set Idle now.
         mRunModeInstance.UpdateCurrentMode(RvcRunMode::ModeIdle);
 
-        auto error = mOperationalStateInstance.SetOperationalState(
-            to_underlying(RvcOperationalState::OperationalStateEnum::kSeekingCharger));
+        auto error = SetOperationalState(to_underlying(RvcOperationalState::OperationalStateEnum::kSeekingCharger));
 
         err.Set((error == CHIP_NO_ERROR) ? to_underlying(OperationalState::ErrorStateEnum::kNoError)
                                          : to_underlying(OperationalState::ErrorStateEnum::kUnableToCompleteOperation));
@@ -234,16 +283,16 @@ void RvcDevice::HandleChargedMessage()
     {
         if (mDocked) // assuming that we can't be charging the device while it is not docked.
         {
-            mOperationalStateInstance.SetOperationalState(to_underlying(RvcOperationalState::OperationalStateEnum::kDocked));
+            SetOperationalState(to_underlying(RvcOperationalState::OperationalStateEnum::kDocked));
         }
         else
         {
-            mOperationalStateInstance.SetOperationalState(to_underlying(OperationalState::OperationalStateEnum::kStopped));
+            SetOperationalState(to_underlying(OperationalState::OperationalStateEnum::kStopped));
         }
     }
     else
     {
-        mOperationalStateInstance.SetOperationalState(to_underlying(OperationalState::OperationalStateEnum::kRunning));
+        SetOperationalState(to_underlying(OperationalState::OperationalStateEnum::kRunning));
     }
 }
 
@@ -257,7 +306,7 @@ void RvcDevice::HandleChargingMessage()
 
     mCharging = true;
 
-    mOperationalStateInstance.SetOperationalState(to_underlying(RvcOperationalState::OperationalStateEnum::kCharging));
+    SetOperationalState(to_underlying(RvcOperationalState::OperationalStateEnum::kCharging));
 }
 
 void RvcDevice::HandleDockedMessage()
@@ -270,27 +319,27 @@ void RvcDevice::HandleDockedMessage()
 
     mDocked = true;
 
-    mOperationalStateInstance.SetOperationalState(to_underlying(RvcOperationalState::OperationalStateEnum::kDocked));
+    SetOperationalState(to_underlying(RvcOperationalState::OperationalStateEnum::kDocked));
 }
 
 void RvcDevice::HandleEmptyingDustBinMessage()
 {
-    mOperationalStateInstance.SetOperationalState(to_underlying(RvcOperationalState::OperationalStateEnum::kEmptyingDustBin));
+    SetOperationalState(to_underlying(RvcOperationalState::OperationalStateEnum::kEmptyingDustBin));
 }
 
 void RvcDevice::HandleCleaningMopMessage()
 {
-    mOperationalStateInstance.SetOperationalState(to_underlying(RvcOperationalState::OperationalStateEnum::kCleaningMop));
+    SetOperationalState(to_underlying(RvcOperationalState::OperationalStateEnum::kCleaningMop));
 }
 
 void RvcDevice::HandleFillingWaterTankMessage()
 {
-    mOperationalStateInstance.SetOperationalState(to_underlying(RvcOperationalState::OperationalStateEnum::kFillingWaterTank));
+    SetOperationalState(to_underlying(RvcOperationalState::OperationalStateEnum::kFillingWaterTank));
 }
 
 void RvcDevice::HandleUpdatingMapsMessage()
 {
-    mOperationalStateInstance.SetOperationalState(to_underlying(RvcOperationalState::OperationalStateEnum::kUpdatingMaps));
+    SetOperationalState(to_underlying(RvcOperationalState::OperationalStateEnum::kUpdatingMaps));
 }
 
 void RvcDevice::HandleChargerFoundMessage()
@@ -306,7 +355,7 @@ void RvcDevice::HandleChargerFoundMessage()
     mCharging = true;
     mDocked   = true;
 
-    mOperationalStateInstance.SetOperationalState(to_underlying(RvcOperationalState::OperationalStateEnum::kCharging));
+    SetOperationalState(to_underlying(RvcOperationalState::OperationalStateEnum::kCharging));
 }
 
 void RvcDevice::HandleLowChargeMessage()
@@ -317,7 +366,7 @@ void RvcDevice::HandleLowChargeMessage()
         return;
     }
 
-    mOperationalStateInstance.SetOperationalState(to_underlying(RvcOperationalState::OperationalStateEnum::kSeekingCharger));
+    SetOperationalState(to_underlying(RvcOperationalState::OperationalStateEnum::kSeekingCharger));
 }
 
 void RvcDevice::HandleActivityCompleteEvent()
@@ -335,7 +384,7 @@ void RvcDevice::HandleActivityCompleteEvent()
     Optional<DataModel::Nullable<uint32_t>> b(DataModel::Nullable<uint32_t>(10));
     mOperationalStateInstance.OnOperationCompletionDetected(0, a, b);
 
-    mOperationalStateInstance.SetOperationalState(to_underlying(RvcOperationalState::OperationalStateEnum::kSeekingCharger));
+    SetOperationalState(to_underlying(RvcOperationalState::OperationalStateEnum::kSeekingCharger));
 
     mServiceAreaInstance.SetCurrentArea(DataModel::NullNullable);
     mServiceAreaInstance.SetEstimatedEndTime(DataModel::NullNullable);
@@ -353,24 +402,110 @@ void RvcDevice::HandleAreaCompletedEvent()
     }
 }
 
+void RvcDevice::HandleProgressStatusMessage(uint32_t areaId, ServiceArea::OperationalStatusEnum status)
+{
+    if (!mServiceAreaInstance.HasFeature(ServiceArea::Feature::kProgressReporting))
+    {
+        return;
+    }
+
+    mServiceAreaInstance.SetProgressStatus(areaId, status);
+}
+
+void RvcDevice::HandleProgressEstimateMessage(uint32_t areaId, const DataModel::Nullable<uint32_t> & estimatedTime)
+{
+    if (!mServiceAreaInstance.HasFeature(ServiceArea::Feature::kProgressReporting))
+    {
+        return;
+    }
+
+    mServiceAreaInstance.SetProgressEstimatedTime(areaId, estimatedTime);
+}
+
+void RvcDevice::BeginMessageBatch()
+{
+    mServiceAreaInstance.BeginTransaction();
+    mInMessageBatch = true;
+}
+
+void RvcDevice::EndMessageBatch()
+{
+    mServiceAreaInstance.EndTransaction();
+    mInMessageBatch = false;
+    SaveServiceAreaMapsIfChanged();
+}
+
 void RvcDevice::HandleAddServiceAreaMap(uint32_t mapId, const CharSpan & mapName)
 {
     mServiceAreaInstance.AddSupportedMap(mapId, mapName);
+    SaveServiceAreaMapsIfChanged();
 }
 
 void RvcDevice::HandleAddServiceAreaArea(ServiceArea::AreaStructureWrapper & area)
 {
     mServiceAreaInstance.AddSupportedArea(area);
+    SaveServiceAreaMapsIfChanged();
 }
 
 void RvcDevice::HandleRemoveServiceAreaMap(uint32_t mapId)
 {
+    // Also removes the map's areas.
     mServiceAreaInstance.RemoveSupportedMap(mapId);
+    SaveServiceAreaMapsIfChanged();
 }
 
 void RvcDevice::HandleRemoveServiceAreaArea(uint32_t areaId)
 {
     mServiceAreaInstance.RemoveSupportedArea(areaId);
+    SaveServiceAreaMapsIfChanged();
+}
+
+void RvcDevice::HandleImportServiceAreaMaps(const std::vector<ServiceArea::MapStructureWrapper> & maps,
+                                            std::vector<ServiceArea::AreaStructureWrapper> & areas)
+{
+    if (!SaIsSupportedMapChangeAllowed() || !SaIsSupportedAreasChangeAllowed())
+    {
+        ChipLogError(NotSpecified, "RVC App: Maps cannot be imported while the device is running.");
+        return;
+    }
+
+    size_t mapsAdded  = 0;
+    size_t areasAdded = 0;
+
+    mServiceAreaInstance.BeginTransaction();
+
+    mServiceAreaInstance.ClearSupportedMaps();
+    mServiceAreaInstance.ClearSupportedAreas();
+
+    for (const auto & map : maps)
+    {
+        mapsAdded += mServiceAreaInstance.AddSupportedMap(map.mapID, map.name) ? 1 : 0;
+    }
+    for (auto & area : areas)
+    {
+        areasAdded += mServiceAreaInstance.AddSupportedArea(area) ? 1 : 0;
+    }
+
+    mServiceAreaInstance.EndTransaction();
+
+    ChipLogProgress(NotSpecified, "RVC App: Imported %u of %u maps and %u of %u areas", static_cast<unsigned>(mapsAdded),
+                    static_cast<unsigned>(maps.size()), static_cast<unsigned>(areasAdded), static_cast<unsigned>(areas.size()));
+
+    SaveServiceAreaMapsIfChanged();
+}
+
+void RvcDevice::SaveServiceAreaMapsIfChanged()
+{
+    if (mInMessageBatch || !mStorageDelegate.TakeSupportedMapsChanged())
+    {
+        return;
+    }
+
+    CHIP_ERROR err = mStorageDelegate.SaveSupportedMaps(Server::GetInstance().GetPersistentStorage());
+    if (err != CHIP_NO_ERROR)
+    {
+        ChipLogError(NotSpecified, "RVC App: Failed to save the service area maps: %" CHIP_ERROR_FORMAT, err.Format());
+    }
 }
 
 void RvcDevice::HandleErrorEvent(const std::string & error)
@@ -473,7 +608,7 @@ void RvcDevice::HandleClearErrorMessage()
 void RvcDevice::HandleResetMessage()
 {
     mRunModeInstance.UpdateCurrentMode(RvcRunMode::ModeIdle);
-    mOperationalStateInstance.SetOperationalState(to_underlying(OperationalState::OperationalStateEnum::kStopped));
+    SetOperationalState(to_underlying(OperationalState::OperationalStateEnum::kStopped));
     mCleanModeInstance.UpdateCurrentMode(RvcCleanMode::ModeQuick);
 
     mServiceAreaInstance.ClearSelectedAreas();
@@ -482,6 +617,14 @@ void RvcDevice::HandleResetMessage()
     mServiceAreaInstance.SetEstimatedEndTime(DataModel::NullNullable);
 
     mServiceAreaDelegate.SetMapTopology();
+
+    // Back to the default topology, also after a restart: it is not saved, the saved maps are dropped instead.
+    mStorageDelegate.TakeSupportedMapsChanged();
+    CHIP_ERROR err = mStorageDelegate.DeleteSavedSupportedMaps(Server::GetInstance().GetPersistentStorage());
+    if (err != CHIP_NO_ERROR)
+    {
+        ChipLogError(NotSpecified, "RVC App: Failed to delete the saved service area maps: %" CHIP_ERROR_FORMAT, err.Format());
+    }
 }
 
 void RvcDevice::UpdateServiceAreaProgressOnExit()
@@ -491,6 +634,9 @@ void RvcDevice::UpdateServiceAreaProgressOnExit()
         return;
     }
 
+    // One Progress report for all the areas.
+    ServiceArea::ScopedTransaction transaction(mServiceAreaInstance);
+
     uint32_t i = 0;
     ServiceArea::Structs::ProgressStruct::Type progressElement;
     while (mServiceAreaInstance.GetProgressElementByIndex(i, progressElement))
@@ -503,3 +649,17 @@ void RvcDevice::UpdateServiceAreaProgressOnExit()
         i++;
     }
 }
+
+void RvcDevice::HandleDetectionResult(const RvcDetectionResult & result)
+{
+    RvcObstacleChanges changes;
+    mObstacleTracker.Update(result, changes);
+    mObstacleCluster.Cluster().Publish(mObstacleTracker, changes, mServiceAreaInstance.GetCurrentArea());
+}
+
+void RvcDevice::ClearObstacles()
+{
+    RvcObstacleChanges changes;
+    mObstacleTracker.Clear(changes);
+    mObstacleCluster.Cluster().Publish(mObstacleTracker, changes, mServiceAreaInstance.GetCurrentArea());
+}
@@ -0,0 +1,255 @@
+/*
+ *
+ *    Copyright (c) 2025 Project CHIP Authors
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "rvc-obstacle-detection-cluster.h"
+
+#include <app/AttributeValueEncoder.h>
+#include <app/data-model/Encode.h>
+#include <app/server-cluster/AttributeListBuilder.h>
+#include <clusters/shared/GlobalIds.h>
+#include <lib/support/logging/CHIPLogging.h>
+#include <platform/CHIPDeviceLayer.h>
+#include <protocols/interaction_model/StatusCode.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace chip {
+namespace app {
+namespace Clusters {
+namespace RvcObstacleDetection {
+
+using namespace RvcObstacleDetection::Attributes;
+
+namespace {
+
+constexpr DataModel::AttributeEntry kObstaclesEntry(Obstacles::Id,
+                                                    BitFlags<DataModel::AttributeQualityFlags>(
+                                                        DataModel::AttributeQualityFlags::kListAttribute),
+                                                    Access::Privilege::kView, std::nullopt);
+constexpr DataModel::AttributeEntry kSuppressedEventCountEntry(SuppressedEventCount::Id,
+                                                               BitFlags<DataModel::AttributeQualityFlags>(),
+                                                               Access::Privilege::kView, std::nullopt);
+constexpr DataModel::AttributeEntry kMandatoryAttributes[] = { kObstaclesEntry, kSuppressedEventCountEntry };
+
+Percent ToPercent(float confidence)
+{
+    return static_cast<Percent>(std::lround(std::clamp(confidence, 0.0f, 1.0f) * 100.0f));
+}
+
+} // namespace
+
+CHIP_ERROR Structs::ObstacleStruct::Type::Encode(TLV::TLVWriter & aWriter, TLV::Tag aTag) const
+{
+    TLV::TLVType outer;
+    ReturnErrorOnFailure(aWriter.StartContainer(aTag, TLV::kTLVType_Structure, outer));
+    ReturnErrorOnFailure(DataModel::Encode(aWriter, TLV::ContextTag(Fields::kTrackID), trackID));
+    ReturnErrorOnFailure(DataModel::Encode(aWriter, TLV::ContextTag(Fields::kClassID), classID));
+    ReturnErrorOnFailure(DataModel::Encode(aWriter, TLV::ContextTag(Fields::kConfidence), confidence));
+    ReturnErrorOnFailure(DataModel::Encode(aWriter, TLV::ContextTag(Fields::kAreaID), areaID));
+    return aWriter.EndContainer(outer);
+}
+
+Cluster::Cluster(EndpointId endpointId) : DefaultServerCluster({ endpointId, RvcObstacleDetection::Id }) {}
+
+DataModel::ActionReturnStatus Cluster::ReadAttribute(const DataModel::ReadAttributeRequest & request,
+                                                     AttributeValueEncoder & encoder)
+{
+    switch (request.path.mAttributeId)
+    {
+    case Obstacles::Id:
+        return encoder.EncodeList([this](const auto & listEncoder) -> CHIP_ERROR {
+            for (size_t i = 0; i < mObstacleCount; i++)
+            {
+                ReturnErrorOnFailure(listEncoder.Encode(mObstacles[i]));
+            }
+            return CHIP_NO_ERROR;
+        });
+    case SuppressedEventCount::Id:
+        return encoder.Encode(mSuppressedEventCount);
+    case Globals::Attributes::ClusterRevision::Id:
+        return encoder.Encode(kRevision);
+    case Globals::Attributes::FeatureMap::Id:
+        return encoder.Encode<uint32_t>(0);
+    default:
+        return Protocols::InteractionModel::Status::UnsupportedAttribute;
+    }
+}
+
+CHIP_ERROR Cluster::Attributes(const ConcreteClusterPath & path, ReadOnlyBufferBuilder<DataModel::AttributeEntry> & builder)
+{
+    AttributeListBuilder listBuilder(builder);
+    return listBuilder.Append(Span(kMandatoryAttributes), {});
+}
+
+void Cluster::Shutdown()
+{
+    DeviceLayer::SystemLayer().CancelTimer(HandleConfidenceReportTimer, this);
+    mConfidencePending = false;
+    DefaultServerCluster::Shutdown();
+}
+
+void Cluster::HandleConfidenceReportTimer(System::Layer * layer, void * context)
+{
+    auto * cluster = static_cast<Cluster *>(context);
+    VerifyOrReturn(cluster->mTracker != nullptr && cluster->mConfidencePending);
+
+    // Nothing appeared since the last Publish(), so no obstacle needs the current area.
+    cluster->Publish(*cluster->mTracker, RvcObstacleChanges(), DataModel::NullNullable);
+}
+
+bool Cluster::TakeEventToken(System::Clock::Timestamp now)
+{
+    uint32_t refills = static_cast<uint32_t>((now - mLastRefill).count() / kEventRefillInterval.count());
+    if (refills > 0)
+    {
+        mEventTokens = std::min(kEventBurst, mEventTokens + refills);
+        mLastRefill  = mLastRefill + System::Clock::Milliseconds64(static_cast<uint64_t>(refills) * kEventRefillInterval.count());
+    }
+    VerifyOrReturnValue(mEventTokens > 0, false);
+    mEventTokens--;
+    return true;
+}
+
+const Structs::ObstacleStruct::Type * Cluster::FindObstacle(uint32_t trackId) const
+{
+    for (size_t i = 0; i < mObstacleCount; i++)
+    {
+        if (mObstacles[i].trackID == trackId)
+        {
+            return &mObstacles[i];
+        }
+    }
+    return nullptr;
+}
+
+template <typename EventType>
+void Cluster::GenerateObstacleEvent(const Structs::ObstacleStruct::Type & obstacle, System::Clock::Timestamp now)
+{
+    VerifyOrReturn(mContext != nullptr);
+    if (!TakeEventToken(now))
+    {
+        mSuppressedEventCount++;
+        mSuppressedEventCountDirty = true;
+        return;
+    }
+
+    EventType event;
+    event.obstacle = obstacle;
+    mContext->interactionContext.eventsGenerator.GenerateEvent(event, mPath.mEndpointId);
+}
+
+void Cluster::RebuildObstacles(const RvcObstacleTracker & tracker, const DataModel::Nullable<uint32_t> & areaId)
+{
+    // Obstacles keep the area they were first seen in.
+    std::array<Structs::ObstacleStruct::Type, RvcObstacleTracker::kMaxTracks> previous = mObstacles;
+    size_t previousCount                                                              = mObstacleCount;
+
+    mObstacleCount = 0;
+    for (size_t i = 0; i < tracker.GetTrackCount(); i++)
+    {
+        const RvcTrackedObstacle & track = tracker.GetTrack(i);
+        if (!track.confirmed)
+        {
+            continue;
+        }
+
+        Structs::ObstacleStruct::Type & obstacle = mObstacles[mObstacleCount++];
+        obstacle.trackID                         = track.trackId;
+        obstacle.classID                         = static_cast<uint16_t>(track.classId);
+        obstacle.confidence                      = ToPercent(track.confidence);
+        obstacle.areaID                          = areaId;
+        for (size_t j = 0; j < previousCount; j++)
+        {
+            if (previous[j].trackID == track.trackId)
+            {
+                obstacle.areaID = previous[j].areaID;
+                break;
+            }
+        }
+    }
+}
+
+void Cluster::Publish(const RvcObstacleTracker & tracker, const RvcObstacleChanges & changes,
+                      const DataModel::Nullable<uint32_t> & areaId)
+{
+    System::Clock::Timestamp now = System::SystemClock().GetMonotonicTimestamp();
+    mTracker                     = &tracker;
+
+    // Cleared obstacles are looked up in the list before it is rebuilt, for their area.
+    for (size_t i = 0; i < changes.clearedCount; i++)
+    {
+        const RvcTrackedObstacle & track          = changes.cleared[i];
+        const Structs::ObstacleStruct::Type * old = FindObstacle(track.trackId);
+
+        Structs::ObstacleStruct::Type obstacle;
+        obstacle.trackID    = track.trackId;
+        obstacle.classID    = static_cast<uint16_t>(track.classId);
+        obstacle.confidence = ToPercent(track.confidence);
+        obstacle.areaID     = old != nullptr ? old->areaID : areaId;
+        GenerateObstacleEvent<Events::ObstacleCleared::Type>(obstacle, now);
+    }
+
+    bool membershipChanged = changes.appearedCount > 0 || changes.clearedCount > 0;
+    mConfidencePending     = mConfidencePending || changes.confidenceChanged;
+    if (membershipChanged || (mConfidencePending && now - mLastListReport >= kMinConfidenceReportInterval))
+    {
+        RebuildObstacles(tracker, areaId);
+        NotifyAttributeChanged(Obstacles::Id);
+        mLastListReport    = now;
+        mConfidencePending = false;
+    }
+
+    // Flush a held-back confidence update even if this was the last frame for a while.
+    if (mConfidencePending)
+    {
+        System::Clock::Timeout delay =
+            std::chrono::duration_cast<System::Clock::Timeout>(kMinConfidenceReportInterval - (now - mLastListReport));
+        if (DeviceLayer::SystemLayer().StartTimer(delay, HandleConfidenceReportTimer, this) != CHIP_NO_ERROR)
+        {
+            ChipLogError(Zcl, "RVC obstacles: Failed to schedule the confidence report");
+        }
+    }
+    else
+    {
+        DeviceLayer::SystemLayer().CancelTimer(HandleConfidenceReportTimer, this);
+    }
+
+    for (size_t i = 0; i < changes.appearedCount; i++)
+    {
+        const Structs::ObstacleStruct::Type * obstacle = FindObstacle(changes.appeared[i]);
+        if (obstacle != nullptr)
+        {
+            GenerateObstacleEvent<Events::ObstacleDetected::Type>(*obstacle, now);
+        }
+    }
+
+    // Bounded by the list reports: the count is only published alongside them.
+    if (mSuppressedEventCountDirty && mLastListReport == now)
+    {
+        ChipLogProgress(Zcl, "RVC obstacles: %u events suppressed by the rate limit so far",
+                        static_cast<unsigned>(mSuppressedEventCount));
+        NotifyAttributeChanged(SuppressedEventCount::Id);
+        mSuppressedEventCountDirty = false;
+    }
+}
+
+} // namespace RvcObstacleDetection
+} // namespace Clusters
+} // namespace app
+} // namespace chip
@@ -183,6 +183,9 @@ void RvcServiceAreaDelegate::SetAttributesAtCleanStart()
         return;
     }
 
+    // Report the current area and the whole progress list once, rather than once per area.
+    ScopedTransaction transaction(*GetInstance());
+
     if (GetInstance()->GetNumberOfSelectedAreas() == 0)
     {
         AreaStructureWrapper firstArea;
@@ -235,6 +238,9 @@ void RvcServiceAreaDelegate::GoToNextArea(OperationalStatusEnum currentAreaOpSta
         return;
     }
 
+    // The completed area and the next one are reported together.
+    ScopedTransaction transaction(*GetInstance());
+
     auto currentAreaId = currentAreaIdN.Value();
     uint32_t currentAreaIndex;
     GetInstance()->GetSupportedAreaById(currentAreaId, currentAreaIndex, currentArea);
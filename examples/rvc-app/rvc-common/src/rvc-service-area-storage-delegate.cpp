@@ -16,6 +16,9 @@
  *    limitations under the License.
  */
 #include <app-common/zap-generated/attributes/Accessors.h>
+#include <lib/core/TLV.h>
+#include <lib/support/DefaultStorageKeyAllocator.h>
+#include <lib/support/ScopedBuffer.h>
 #include <rvc-service-area-storage-delegate.h>
 #include <vector>
 
@@ -23,6 +26,24 @@ using namespace chip;
 using namespace chip::app::Clusters;
 using namespace chip::app::Clusters::ServiceArea;
 
+namespace {
+
+// Blob layout: a structure holding a list of MapStruct and a list of AreaStruct.
+constexpr uint8_t kSupportedMapsTag  = 1;
+constexpr uint8_t kSupportedAreasTag = 2;
+
+// Room for full lists with maximum-size names, with per-entry TLV overhead.
+constexpr size_t kSupportedMapsBlobMaxSize =
+    kMaxNumSupportedMaps * (kMapNameMaxSize + 16) + kMaxNumSupportedAreas * (kAreaNameMaxSize + 48) + 16;
+static_assert(kSupportedMapsBlobMaxSize <= UINT16_MAX, "The supported maps blob must fit in a single KVS value");
+
+StorageKeyName SupportedMapsKey()
+{
+    return StorageKeyName::FromConst("g/rvc/sa/maps");
+}
+
+} // namespace
+
 //*************************************************************************
 // Supported Areas accessors
 
@@ -45,25 +66,24 @@ bool RvcServiceAreaStorageDelegate::GetSupportedAreaByIndex(uint32_t listIndex,
 bool RvcServiceAreaStorageDelegate::GetSupportedAreaById(uint32_t aAreaID, uint32_t & listIndex,
                                                          AreaStructureWrapper & supportedArea)
 {
-    // We do not need to reimplement this method as it's already done by the SDK.
-    // We are reimplementing this method, still using linear search, but with some optimization on the SDK implementation
-    // since we have direct access to the list.
-    listIndex = 0;
-
-    while (listIndex < mSupportedAreas.size())
+    // The SDK implementation scans the list; the index makes this a constant time lookup, which matters for the server's
+    // per-entry validation when a whole floor plan is imported.
+    auto it = mSupportedAreaIndex.find(aAreaID);
+    if (it == mSupportedAreaIndex.end())
     {
-        if (mSupportedAreas[listIndex].areaID == aAreaID)
-        {
-            supportedArea = mSupportedAreas[listIndex];
-            return true;
-        }
-
-        ++listIndex;
+        return false;
     }
 
-    return false;
+    listIndex     = it->second;
+    supportedArea = mSupportedAreas[listIndex];
+    return true;
 };
 
+bool RvcServiceAreaStorageDelegate::IsSupportedArea(uint32_t aAreaId)
+{
+    return mSupportedAreaIndex.find(aAreaId) != mSupportedAreaIndex.end();
+}
+
 bool RvcServiceAreaStorageDelegate::AddSupportedAreaRaw(const AreaStructureWrapper & newArea, uint32_t & listIndex)
 {
     // The server instance (caller) is responsible for ensuring that there are no duplicate area IDs, list size not exceeded,
@@ -74,7 +94,9 @@ bool RvcServiceAreaStorageDelegate::AddSupportedAreaRaw(const AreaStructureWrapp
     {
         // not sorting list, number of areas normally expected to be small, max 255
         mSupportedAreas.push_back(newArea);
-        listIndex = static_cast<uint32_t>(mSupportedMaps.size()) - 1; // new element is last in list
+        listIndex                           = static_cast<uint32_t>(mSupportedAreas.size()) - 1; // new element is last in list
+        mSupportedAreaIndex[newArea.areaID] = listIndex;
+        mSupportedMapsChanged               = true;
         return true;
     }
 
@@ -99,6 +121,7 @@ bool RvcServiceAreaStorageDelegate::ModifySupportedAreaRaw(uint32_t listIndex, c
 
     // checks passed, update the attribute
     mSupportedAreas[listIndex] = modifiedArea;
+    mSupportedMapsChanged      = true;
     return true;
 }
 
@@ -107,6 +130,8 @@ bool RvcServiceAreaStorageDelegate::ClearSupportedAreasRaw()
     if (!mSupportedAreas.empty())
     {
         mSupportedAreas.clear();
+        mSupportedAreaIndex.clear();
+        mSupportedMapsChanged = true;
         return true;
     }
 
@@ -115,16 +140,24 @@ bool RvcServiceAreaStorageDelegate::ClearSupportedAreasRaw()
 
 bool RvcServiceAreaStorageDelegate::RemoveSupportedAreaRaw(uint32_t areaId)
 {
-    for (auto it = mSupportedAreas.begin(); it != mSupportedAreas.end(); ++it)
+    auto it = mSupportedAreaIndex.find(areaId);
+    if (it == mSupportedAreaIndex.end())
     {
-        if (it->areaID == areaId)
-        {
-            mSupportedAreas.erase(it);
-            return true;
-        }
+        return false;
     }
 
-    return false;
+    uint32_t listIndex = it->second;
+    mSupportedAreaIndex.erase(it);
+    mSupportedAreas.erase(mSupportedAreas.begin() + listIndex);
+
+    // The following entries moved down by one.
+    for (uint32_t i = listIndex; i < mSupportedAreas.size(); ++i)
+    {
+        mSupportedAreaIndex[mSupportedAreas[i].areaID] = i;
+    }
+
+    mSupportedMapsChanged = true;
+    return true;
 }
 
 //*************************************************************************
@@ -148,23 +181,15 @@ bool RvcServiceAreaStorageDelegate::GetSupportedMapByIndex(uint32_t listIndex, M
 
 bool RvcServiceAreaStorageDelegate::GetSupportedMapById(uint32_t aMapId, uint32_t & listIndex, MapStructureWrapper & aSupportedMap)
 {
-    // We do not need to reimplement this method as it's already done by the SDK.
-    // We are reimplementing this method, still using linear search, but with some optimization on the SDK implementation
-    // since we have direct access to the list.
-    listIndex = 0;
-
-    while (listIndex < mSupportedMaps.size())
+    auto it = mSupportedMapIndex.find(aMapId);
+    if (it == mSupportedMapIndex.end())
     {
-        if (mSupportedMaps[listIndex].mapID == aMapId)
-        {
-            aSupportedMap = mSupportedMaps[listIndex];
-            return true;
-        }
-
-        ++listIndex;
+        return false;
     }
 
-    return false;
+    listIndex     = it->second;
+    aSupportedMap = mSupportedMaps[listIndex];
+    return true;
 };
 
 bool RvcServiceAreaStorageDelegate::AddSupportedMapRaw(const MapStructureWrapper & newMap, uint32_t & listIndex)
@@ -177,7 +202,9 @@ bool RvcServiceAreaStorageDelegate::AddSupportedMapRaw(const MapStructureWrapper
     {
         // not sorting list, number of areas normally expected to be small, max 255
         mSupportedMaps.push_back(newMap);
-        listIndex = static_cast<uint32_t>(mSupportedMaps.size()) - 1; // new element is last in list
+        listIndex                        = static_cast<uint32_t>(mSupportedMaps.size()) - 1; // new element is last in list
+        mSupportedMapIndex[newMap.mapID] = listIndex;
+        mSupportedMapsChanged            = true;
         return true;
     }
     ChipLogError(Zcl, "AddSupportedMapRaw %u - supported maps list is already at maximum size %u", newMap.mapID,
@@ -201,6 +228,7 @@ bool RvcServiceAreaStorageDelegate::ModifySupportedMapRaw(uint32_t listIndex, co
 
     // save modified map
     mSupportedMaps[listIndex] = modifiedMap;
+    mSupportedMapsChanged     = true;
     return true;
 }
 
@@ -209,6 +237,8 @@ bool RvcServiceAreaStorageDelegate::ClearSupportedMapsRaw()
     if (!mSupportedMaps.empty())
     {
         mSupportedMaps.clear();
+        mSupportedMapIndex.clear();
+        mSupportedMapsChanged = true;
         return true;
     }
 
@@ -217,16 +247,24 @@ bool RvcServiceAreaStorageDelegate::ClearSupportedMapsRaw()
 
 bool RvcServiceAreaStorageDelegate::RemoveSupportedMapRaw(uint32_t mapId)
 {
-    for (auto it = mSupportedMaps.begin(); it != mSupportedMaps.end(); ++it)
+    auto it = mSupportedMapIndex.find(mapId);
+    if (it == mSupportedMapIndex.end())
     {
-        if (it->mapID == mapId)
-        {
-            mSupportedMaps.erase(it);
-            return true;
-        }
+        return false;
     }
 
-    return false;
+    uint32_t listIndex = it->second;
+    mSupportedMapIndex.erase(it);
+    mSupportedMaps.erase(mSupportedMaps.begin() + listIndex);
+
+    // The following entries moved down by one.
+    for (uint32_t i = listIndex; i < mSupportedMaps.size(); ++i)
+    {
+        mSupportedMapIndex[mSupportedMaps[i].mapID] = i;
+    }
+
+    mSupportedMapsChanged = true;
+    return true;
 }
 
 //*************************************************************************
@@ -391,3 +429,102 @@ bool RvcServiceAreaStorageDelegate::RemoveProgressElementRaw(uint32_t areaId)
 
     return false;
 }
+
+//*************************************************************************
+// Persistence
+
+CHIP_ERROR RvcServiceAreaStorageDelegate::SaveSupportedMaps(PersistentStorageDelegate & aStorage)
+{
+    Platform::ScopedMemoryBuffer<uint8_t> buffer;
+    VerifyOrReturnError(buffer.Alloc(kSupportedMapsBlobMaxSize), CHIP_ERROR_NO_MEMORY);
+
+    TLV::TLVWriter writer;
+    writer.Init(buffer.Get(), kSupportedMapsBlobMaxSize);
+
+    TLV::TLVType outerType;
+    TLV::TLVType listType;
+    ReturnErrorOnFailure(writer.StartContainer(TLV::AnonymousTag(), TLV::kTLVType_Structure, outerType));
+
+    ReturnErrorOnFailure(writer.StartContainer(TLV::ContextTag(kSupportedMapsTag), TLV::kTLVType_Array, listType));
+    for (const auto & map : mSupportedMaps)
+    {
+        ReturnErrorOnFailure(map.Encode(writer, TLV::AnonymousTag()));
+    }
+    ReturnErrorOnFailure(writer.EndContainer(listType));
+
+    ReturnErrorOnFailure(writer.StartContainer(TLV::ContextTag(kSupportedAreasTag), TLV::kTLVType_Array, listType));
+    for (const auto & area : mSupportedAreas)
+    {
+        ReturnErrorOnFailure(area.Encode(writer, TLV::AnonymousTag()));
+    }
+    ReturnErrorOnFailure(writer.EndContainer(listType));
+
+    ReturnErrorOnFailure(writer.EndContainer(outerType));
+    ReturnErrorOnFailure(writer.Finalize());
+
+    return aStorage.SyncSetKeyValue(SupportedMapsKey().KeyName(), buffer.Get(), static_cast<uint16_t>(writer.GetLengthWritten()));
+}
+
+CHIP_ERROR RvcServiceAreaStorageDelegate::LoadSupportedMaps(PersistentStorageDelegate & aStorage,
+                                                            std::vector<MapStructureWrapper> & aMaps,
+                                                            std::vector<AreaStructureWrapper> & aAreas)
+{
+    Platform::ScopedMemoryBuffer<uint8_t> buffer;
+    VerifyOrReturnError(buffer.Alloc(kSupportedMapsBlobMaxSize), CHIP_ERROR_NO_MEMORY);
+
+    uint16_t size = static_cast<uint16_t>(kSupportedMapsBlobMaxSize);
+    ReturnErrorOnFailure(aStorage.SyncGetKeyValue(SupportedMapsKey().KeyName(), buffer.Get(), size));
+
+    TLV::TLVReader reader;
+    reader.Init(buffer.Get(), size);
+
+    TLV::TLVType outerType;
+    TLV::TLVType listType;
+    CHIP_ERROR err;
+    ReturnErrorOnFailure(reader.Next(TLV::kTLVType_Structure, TLV::AnonymousTag()));
+    ReturnErrorOnFailure(reader.EnterContainer(outerType));
+
+    ReturnErrorOnFailure(reader.Next(TLV::kTLVType_Array, TLV::ContextTag(kSupportedMapsTag)));
+    ReturnErrorOnFailure(reader.EnterContainer(listType));
+    while ((err = reader.Next()) == CHIP_NO_ERROR)
+    {
+        Structs::MapStruct::DecodableType map;
+        ReturnErrorOnFailure(map.Decode(reader));
+        // The wrapper copies the name out of the blob.
+        aMaps.emplace_back(map.mapID, map.name);
+    }
+    VerifyOrReturnError(err == CHIP_END_OF_TLV, err);
+    ReturnErrorOnFailure(reader.ExitContainer(listType));
+
+    ReturnErrorOnFailure(reader.Next(TLV::kTLVType_Array, TLV::ContextTag(kSupportedAreasTag)));
+    ReturnErrorOnFailure(reader.EnterContainer(listType));
+    while ((err = reader.Next()) == CHIP_NO_ERROR)
+    {
+        Structs::AreaStruct::DecodableType decoded;
+        ReturnErrorOnFailure(decoded.Decode(reader));
+
+        AreaStructureWrapper area;
+        area.SetAreaId(decoded.areaID)
+            .SetMapId(decoded.mapID)
+            .SetLocationInfo(decoded.areaInfo.locationInfo)
+            .SetLandmarkInfo(decoded.areaInfo.landmarkInfo);
+        aAreas.push_back(area);
+    }
+    VerifyOrReturnError(err == CHIP_END_OF_TLV, err);
+    ReturnErrorOnFailure(reader.ExitContainer(listType));
+
+    return reader.ExitContainer(outerType);
+}
+
+CHIP_ERROR RvcServiceAreaStorageDelegate::DeleteSavedSupportedMaps(PersistentStorageDelegate & aStorage)
+{
+    CHIP_ERROR err = aStorage.SyncDeleteKeyValue(SupportedMapsKey().KeyName());
+    return err == CHIP_ERROR_PERSISTED_STORAGE_VALUE_NOT_FOUND ? CHIP_NO_ERROR : err;
+}
+
+bool RvcServiceAreaStorageDelegate::TakeSupportedMapsChanged()
+{
+    bool changed          = mSupportedMapsChanged;
+    mSupportedMapsChanged = false;
+    return changed;
+}
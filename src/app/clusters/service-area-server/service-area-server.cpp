@@ -34,6 +34,7 @@
 #include <app/util/util.h>
 #include <lib/support/CodeUtils.h>
 #include <lib/support/logging/CHIPLogging.h>
+#include <platform/CHIPDeviceLayer.h>
 #include <protocols/interaction_model/StatusCode.h>
 
 using Status = chip::Protocols::InteractionModel::Status;
@@ -56,6 +57,17 @@ Instance::Instance(StorageDelegate * storageDelegate, Delegate * aDelegate, Endp
 
 Instance::~Instance()
 {
+    Shutdown();
+}
+
+void Instance::Shutdown()
+{
+    // The timer only exists while a report is held back; otherwise the system layer may already be gone.
+    if (mProgressEstimatePending)
+    {
+        mProgressEstimatePending = false;
+        DeviceLayer::SystemLayer().CancelTimer(OnProgressEstimateReportTimer, this);
+    }
     CommandHandlerInterfaceRegistry::Instance().UnregisterCommandHandler(this);
     AttributeAccessInterfaceRegistry::Instance().Unregister(this);
 }
@@ -415,32 +427,143 @@ void Instance::HandleSkipAreaCmd(HandlerContext & ctx, const Commands::SkipArea:
 
 void Instance::NotifySupportedAreasChanged()
 {
-    MatterReportingAttributeChangeCallback(mEndpointId, mClusterId, Attributes::SupportedAreas::Id);
+    NotifyAttributeChanged(Attributes::SupportedAreas::Id, PendingChange::kSupportedAreas);
 }
 
 void Instance::NotifySupportedMapsChanged()
 {
-    MatterReportingAttributeChangeCallback(mEndpointId, mClusterId, Attributes::SupportedMaps::Id);
+    NotifyAttributeChanged(Attributes::SupportedMaps::Id, PendingChange::kSupportedMaps);
 }
 
 void Instance::NotifySelectedAreasChanged()
 {
-    MatterReportingAttributeChangeCallback(mEndpointId, mClusterId, Attributes::SelectedAreas::Id);
+    NotifyAttributeChanged(Attributes::SelectedAreas::Id, PendingChange::kSelectedAreas);
 }
 
 void Instance::NotifyCurrentAreaChanged()
 {
-    MatterReportingAttributeChangeCallback(mEndpointId, mClusterId, Attributes::CurrentArea::Id);
+    NotifyAttributeChanged(Attributes::CurrentArea::Id, PendingChange::kCurrentArea);
 }
 
 void Instance::NotifyEstimatedEndTimeChanged()
 {
-    MatterReportingAttributeChangeCallback(mEndpointId, mClusterId, Attributes::EstimatedEndTime::Id);
+    NotifyAttributeChanged(Attributes::EstimatedEndTime::Id, PendingChange::kEstimatedEndTime);
 }
 
 void Instance::NotifyProgressChanged()
 {
-    MatterReportingAttributeChangeCallback(mEndpointId, mClusterId, Attributes::Progress::Id);
+    // The list is reported as a whole, so this report also carries any estimate changes held back so far.
+    if (mProgressEstimatePending)
+    {
+        mProgressEstimatePending = false;
+        DeviceLayer::SystemLayer().CancelTimer(OnProgressEstimateReportTimer, this);
+    }
+
+    if (mTransactionDepth == 0)
+    {
+        mLastProgressReport = System::SystemClock().GetMonotonicTimestamp();
+    }
+
+    NotifyAttributeChanged(Attributes::Progress::Id, PendingChange::kProgress);
+}
+
+void Instance::NotifyProgressEstimateChanged()
+{
+    if (mProgressEstimatePending)
+    {
+        return; // already scheduled
+    }
+
+    System::Clock::Timestamp now = System::SystemClock().GetMonotonicTimestamp();
+    if (mProgressEstimateReportInterval == System::Clock::kZero || now - mLastProgressReport >= mProgressEstimateReportInterval)
+    {
+        NotifyProgressChanged();
+        return;
+    }
+
+    System::Clock::Timeout delay =
+        std::chrono::duration_cast<System::Clock::Timeout>(mProgressEstimateReportInterval - (now - mLastProgressReport));
+
+    CHIP_ERROR err = DeviceLayer::SystemLayer().StartTimer(delay, OnProgressEstimateReportTimer, this);
+    if (err != CHIP_NO_ERROR)
+    {
+        ChipLogError(Zcl, "Service Area: Failed to delay the progress report: %" CHIP_ERROR_FORMAT, err.Format());
+        NotifyProgressChanged();
+        return;
+    }
+
+    mProgressEstimatePending = true;
+}
+
+void Instance::OnProgressEstimateReportTimer(System::Layer * aLayer, void * aInstance)
+{
+    auto * instance                    = static_cast<Instance *>(aInstance);
+    instance->mProgressEstimatePending = false;
+    instance->NotifyProgressChanged();
+}
+
+void Instance::NotifyAttributeChanged(AttributeId aAttributeId, PendingChange aChange)
+{
+    if (mTransactionDepth > 0)
+    {
+        mPendingChanges.Set(aChange);
+        return;
+    }
+
+    MatterReportingAttributeChangeCallback(mEndpointId, mClusterId, aAttributeId);
+}
+
+//*************************************************************************
+// transactions
+
+void Instance::BeginTransaction()
+{
+    VerifyOrDie(mTransactionDepth < UINT8_MAX);
+    ++mTransactionDepth;
+}
+
+void Instance::EndTransaction()
+{
+    VerifyOrReturn(mTransactionDepth > 0, ChipLogError(Zcl, "Service Area: EndTransaction without a matching BeginTransaction"));
+
+    if (--mTransactionDepth > 0)
+    {
+        return;
+    }
+
+    BitFlags<PendingChange> pending = mPendingChanges;
+    mPendingChanges.ClearAll();
+
+    // This may change, and report, the SelectedAreas, CurrentArea and Progress attributes.
+    if (pending.Has(PendingChange::kSupportedAreasUpdated))
+    {
+        HandleSupportedAreasUpdated();
+    }
+
+    if (pending.Has(PendingChange::kSupportedMaps))
+    {
+        NotifySupportedMapsChanged();
+    }
+    if (pending.Has(PendingChange::kSupportedAreas))
+    {
+        NotifySupportedAreasChanged();
+    }
+    if (pending.Has(PendingChange::kSelectedAreas))
+    {
+        NotifySelectedAreasChanged();
+    }
+    if (pending.Has(PendingChange::kCurrentArea))
+    {
+        NotifyCurrentAreaChanged();
+    }
+    if (pending.Has(PendingChange::kEstimatedEndTime))
+    {
+        NotifyEstimatedEndTimeChanged();
+    }
+    if (pending.Has(PendingChange::kProgress))
+    {
+        NotifyProgressChanged();
+    }
 }
 
 // ****************************************************************************
@@ -570,6 +693,13 @@ bool Instance::ReportEstimatedEndTimeChange(const DataModel::Nullable<uint32_t>
 
 void Instance::HandleSupportedAreasUpdated()
 {
+    // The supported areas may still change before the transaction ends.
+    if (mTransactionDepth > 0)
+    {
+        mPendingChanges.Set(PendingChange::kSupportedAreasUpdated);
+        return;
+    }
+
     // If there are no more Supported Areas, clear all selected areas, current area, and progress.
     if (GetNumberOfSupportedAreas() == 0)
     {
@@ -1278,10 +1408,21 @@ bool Instance::SetProgressEstimatedTime(uint32_t aAreaId, const DataModel::Nulla
         return false;
     }
 
-    NotifyProgressChanged();
+    NotifyProgressEstimateChanged();
     return true;
 }
 
+void Instance::SetProgressEstimateReportInterval(System::Clock::Milliseconds32 aInterval)
+{
+    mProgressEstimateReportInterval = aInterval;
+
+    // A report held back under the previous interval goes out now rather than being delayed further.
+    if (mProgressEstimatePending)
+    {
+        NotifyProgressChanged();
+    }
+}
+
 bool Instance::ClearProgress()
 {
     if (mStorageDelegate->ClearProgressRaw())
@@ -30,8 +30,11 @@
 
 #include <app/util/basic-types.h>
 #include <app/util/config.h>
+#include <lib/support/BitFlags.h>
 #include <lib/support/Span.h>
 #include <platform/CHIPDeviceConfig.h>
+#include <system/SystemClock.h>
+#include <system/SystemLayer.h>
 
 namespace chip {
 namespace app {
@@ -77,7 +80,40 @@ public:
      */
     CHIP_ERROR Init();
 
+    /**
+     * @brief Cancel any held-back Progress report and unregister this instance. Call this before the system layer shuts down;
+     * the destructor calls it too.
+     */
+    void Shutdown();
+
+    /**
+     * @brief Start a transaction. Until the matching EndTransaction() call, attribute changes are not reported and the
+     * SelectedAreas, CurrentArea and Progress attributes are not checked against the SupportedAreas attribute.
+     * This allows applying a batch of changes, e.g. a whole floor plan, with a single report per changed attribute.
+     *
+     * @note Transactions can be nested; only the outermost EndTransaction() call has an effect.
+     */
+    void BeginTransaction();
+
+    /**
+     * @brief End a transaction started with BeginTransaction(). When the outermost transaction ends, HandleSupportedAreasUpdated
+     * is called once if the supported areas changed, and each attribute that changed during the transaction is reported once.
+     */
+    void EndTransaction();
+
 private:
+    // Changes deferred while a transaction is open.
+    enum class PendingChange : uint8_t
+    {
+        kSupportedAreas        = 0x01,
+        kSupportedMaps         = 0x02,
+        kSelectedAreas         = 0x04,
+        kCurrentArea           = 0x08,
+        kEstimatedEndTime      = 0x10,
+        kProgress              = 0x20,
+        kSupportedAreasUpdated = 0x40, // HandleSupportedAreasUpdated needs to run
+    };
+
     StorageDelegate * mStorageDelegate;
     Delegate * mDelegate;
     EndpointId mEndpointId;
@@ -88,6 +124,14 @@ private:
     DataModel::Nullable<uint32_t> mEstimatedEndTime;
     BitMask<ServiceArea::Feature> mFeature;
 
+    uint8_t mTransactionDepth = 0;
+    BitFlags<PendingChange> mPendingChanges;
+
+    // Rate limit for Progress reports that only carry new estimates.
+    System::Clock::Milliseconds32 mProgressEstimateReportInterval{ 0 };
+    System::Clock::Timestamp mLastProgressReport{ 0 };
+    bool mProgressEstimatePending = false;
+
     //*************************************************************************
     // core functions
 
@@ -141,6 +185,20 @@ private:
     void NotifyEstimatedEndTimeChanged();
     void NotifyProgressChanged();
 
+    /**
+     * @brief Report a Progress change that only updates estimated times. Reports are spaced by at least
+     * mProgressEstimateReportInterval; a change arriving sooner is reported when the interval has passed, or along with the next
+     * Progress report, whichever comes first.
+     */
+    void NotifyProgressEstimateChanged();
+
+    static void OnProgressEstimateReportTimer(System::Layer * aLayer, void * aInstance);
+
+    /**
+     * @brief Report a change of aAttributeId, or record it as aChange if a transaction is open.
+     */
+    void NotifyAttributeChanged(AttributeId aAttributeId, PendingChange aChange);
+
     //*************************************************************************
     // Supported Areas helpers
 
@@ -173,6 +231,8 @@ private:
      * Any invalid area IDs in the Selected Areas attribute will be removed.
      * If the Current Area is not in the Selected Areas attribute, it will be set to null.
      * Any progres elements with area IDs not in the Selected Areas attribute will be removed.
+     *
+     * @note While a transaction is open, this is deferred to the end of the transaction.
      */
     virtual void HandleSupportedAreasUpdated();
 
@@ -406,6 +466,15 @@ public:
      */
     bool SetProgressEstimatedTime(uint32_t aAreaId, const DataModel::Nullable<uint32_t> & aEstimatedTime);
 
+    /**
+     * @brief Set the minimum interval between Progress reports caused only by SetProgressEstimatedTime. Status and operational
+     * time changes are always reported right away, and carry any estimate changes made so far.
+     * @param[in] aInterval The minimum interval. Zero, the default, reports every change.
+     *
+     * @note Combine with BeginTransaction()/EndTransaction(), or ScopedTransaction, to report updates to several areas at once.
+     */
+    void SetProgressEstimateReportInterval(System::Clock::Milliseconds32 aInterval);
+
     /**
      * @return true if the progress list was not already null, false otherwise.
      */
@@ -430,6 +499,23 @@ public:
     bool HasFeature(ServiceArea::Feature feature) const;
 };
 
+/**
+ * Holds a transaction open on a Service Area instance for the lifetime of the object, e.g. while the progress of several areas
+ * is updated. See Instance::BeginTransaction().
+ */
+class ScopedTransaction
+{
+public:
+    explicit ScopedTransaction(Instance & aInstance) : mInstance(aInstance) { mInstance.BeginTransaction(); }
+    ~ScopedTransaction() { mInstance.EndTransaction(); }
+
+    ScopedTransaction(const ScopedTransaction &)             = delete;
+    ScopedTransaction & operator=(const ScopedTransaction &) = delete;
+
+private:
+    Instance & mInstance;
+};
+
 } // namespace ServiceArea
 } // namespace Clusters
 } // namespace app
@@ -272,6 +272,41 @@
 #endif
 #endif // INET_CONFIG_UDP_SOCKET_PKTINFO
 
+/**
+ *  @def INET_CONFIG_UDP_SOCKET_RECV_BATCH_SIZE
+ *
+ *  @brief
+ *    The maximum number of datagrams the socket-based implementation of UDP
+ *    endpoints reads with one recvmmsg() call when its socket is readable.
+ *
+ *  @details
+ *    When this is greater than one, the platform must provide recvmmsg(), and
+ *    each read allocates up to this many packet buffers of the largest size.
+ *    With the default of one, datagrams are read one at a time with recvmsg().
+ */
+#ifndef INET_CONFIG_UDP_SOCKET_RECV_BATCH_SIZE
+#define INET_CONFIG_UDP_SOCKET_RECV_BATCH_SIZE 1
+#endif // INET_CONFIG_UDP_SOCKET_RECV_BATCH_SIZE
+
+/**
+ *  @def INET_CONFIG_UDP_SOCKET_SEND_BATCH_SIZE
+ *
+ *  @brief
+ *    The maximum number of datagrams the socket-based implementation of UDP
+ *    endpoints queues and hands to the kernel with one sendmmsg() call.
+ *
+ *  @details
+ *    When this is greater than one, the platform must provide sendmmsg().
+ *    SendMsg() queues the datagram and returns; the queue is sent once the
+ *    current System::Layer callbacks have run, when it fills up, or when the
+ *    endpoint is closed. Errors the kernel reports for a queued datagram are
+ *    then logged rather than returned by SendMsg(). With the default of one,
+ *    each datagram is sent with sendmsg() before SendMsg() returns.
+ */
+#ifndef INET_CONFIG_UDP_SOCKET_SEND_BATCH_SIZE
+#define INET_CONFIG_UDP_SOCKET_SEND_BATCH_SIZE 1
+#endif // INET_CONFIG_UDP_SOCKET_SEND_BATCH_SIZE
+
 /**
  *  @def HAVE_SO_BINDTODEVICE
  *
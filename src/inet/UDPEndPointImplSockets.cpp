@@ -26,6 +26,7 @@
 #define __APPLE_USE_RFC_3542
 #include <inet/UDPEndPointImplSockets.h>
 
+#include <lib/support/CHIPMem.h>
 #include <lib/support/CodeUtils.h>
 #include <lib/support/SafeInt.h>
 #include <lib/support/logging/CHIPLogging.h>
@@ -173,6 +174,25 @@ CHIP_ERROR IPv4Bind(int socket, const IPAddress & address, uint16_t port)
 UDPEndPointImplSockets::MulticastGroupHandler UDPEndPointImplSockets::sMulticastGroupHandler;
 #endif // CHIP_SYSTEM_CONFIG_USE_PLATFORM_MULTICAST_API
 
+struct UDPEndPointImplSockets::MessageHeader
+{
+    struct msghdr msgHeader;
+    struct iovec msgIOV;
+    SockAddr peerSockAddr;
+    uint8_t controlData[256];
+};
+
+#if INET_CONFIG_UDP_SOCKET_SEND_BATCH_SIZE > 1
+struct UDPEndPointImplSockets::SendBatch
+{
+    static constexpr unsigned kSize = INET_CONFIG_UDP_SOCKET_SEND_BATCH_SIZE;
+
+    MessageHeader headers[kSize];
+    System::PacketBufferHandle messages[kSize];
+    unsigned count = 0;
+};
+#endif // INET_CONFIG_UDP_SOCKET_SEND_BATCH_SIZE > 1
+
 CHIP_ERROR UDPEndPointImplSockets::BindImpl(IPAddressType addressType, const IPAddress & addr, uint16_t port, InterfaceId interface)
 {
     // Make sure we have the appropriate type of socket.
@@ -292,22 +312,48 @@ CHIP_ERROR UDPEndPointImplSockets::SendMsgImpl(const IPPacketInfo * aPktInfo, Sy
     // For now the entire message must fit within a single buffer.
     VerifyOrReturnError(!msg->HasChainedBuffer(), CHIP_ERROR_MESSAGE_TOO_LONG);
 
-    struct iovec msgIOV;
-    msgIOV.iov_base = msg->Start();
-    msgIOV.iov_len  = msg->DataLength();
+#if INET_CONFIG_UDP_SOCKET_SEND_BATCH_SIZE > 1
+    return QueueMessage(aPktInfo, std::move(msg));
+#else
+    MessageHeader header;
+    ReturnErrorOnFailure(PrepareSendHeader(aPktInfo, msg, header));
+
+    // Send IP packet.
+    // NOLINTNEXTLINE(clang-analyzer-unix.StdCLibraryFunctions): GetSocket calls ensure mSocket is valid
+    const ssize_t lenSent = sendmsg(mSocket, &header.msgHeader, 0);
+    if (lenSent == -1)
+    {
+        return CHIP_ERROR_POSIX(errno);
+    }
+
+    size_t len = static_cast<size_t>(lenSent);
+
+    if (len != msg->DataLength())
+    {
+        return CHIP_ERROR_OUTBOUND_MESSAGE_TOO_BIG;
+    }
+    return CHIP_NO_ERROR;
+#endif // INET_CONFIG_UDP_SOCKET_SEND_BATCH_SIZE > 1
+}
+
+CHIP_ERROR UDPEndPointImplSockets::PrepareSendHeader(const IPPacketInfo * aPktInfo, const System::PacketBufferHandle & msg,
+                                                     MessageHeader & header)
+{
+    struct iovec & msgIOV = header.msgIOV;
+    msgIOV.iov_base       = msg->Start();
+    msgIOV.iov_len        = msg->DataLength();
 
 #if defined(IP_PKTINFO) || defined(IPV6_PKTINFO)
-    uint8_t controlData[256];
-    memset(controlData, 0, sizeof(controlData));
+    memset(header.controlData, 0, sizeof(header.controlData));
 #endif // defined(IP_PKTINFO) || defined(IPV6_PKTINFO)
 
-    struct msghdr msgHeader;
+    struct msghdr & msgHeader = header.msgHeader;
     memset(&msgHeader, 0, sizeof(msgHeader));
     msgHeader.msg_iov    = &msgIOV;
     msgHeader.msg_iovlen = 1;
 
     // Construct a sockaddr_in/sockaddr_in6 structure containing the destination information.
-    SockAddr peerSockAddr;
+    SockAddr & peerSockAddr = header.peerSockAddr;
     memset(&peerSockAddr, 0, sizeof(peerSockAddr));
     msgHeader.msg_name = &peerSockAddr;
     if (mAddrType == IPAddressType::kIPv6)
@@ -350,8 +396,8 @@ CHIP_ERROR UDPEndPointImplSockets::SendMsgImpl(const IPPacketInfo * aPktInfo, Sy
     if (intf.IsPresent() || aPktInfo->SrcAddress.Type() != IPAddressType::kAny)
     {
 #if defined(IP_PKTINFO) || defined(IPV6_PKTINFO)
-        msgHeader.msg_control    = controlData;
-        msgHeader.msg_controllen = sizeof(controlData);
+        msgHeader.msg_control    = header.controlData;
+        msgHeader.msg_controllen = sizeof(header.controlData);
 
         struct cmsghdr * controlHdr      = CMSG_FIRSTHDR(&msgHeader);
         InterfaceId::PlatformType intfId = intf.GetPlatformInterface();
@@ -409,25 +455,97 @@ CHIP_ERROR UDPEndPointImplSockets::SendMsgImpl(const IPPacketInfo * aPktInfo, Sy
     }
 #endif // INET_CONFIG_UDP_SOCKET_PKTINFO
 
-    // Send IP packet.
-    // NOLINTNEXTLINE(clang-analyzer-unix.StdCLibraryFunctions): GetSocket calls ensure mSocket is valid
-    const ssize_t lenSent = sendmsg(mSocket, &msgHeader, 0);
-    if (lenSent == -1)
+    return CHIP_NO_ERROR;
+}
+
+#if INET_CONFIG_UDP_SOCKET_SEND_BATCH_SIZE > 1
+CHIP_ERROR UDPEndPointImplSockets::QueueMessage(const IPPacketInfo * aPktInfo, System::PacketBufferHandle && msg)
+{
+    if (mSendBatch == nullptr)
     {
-        return CHIP_ERROR_POSIX(errno);
+        mSendBatch = Platform::New<SendBatch>();
+        VerifyOrReturnError(mSendBatch != nullptr, CHIP_ERROR_NO_MEMORY);
+    }
+    if (mSendBatch->count == SendBatch::kSize)
+    {
+        FlushSendBatch();
     }
 
-    size_t len = static_cast<size_t>(lenSent);
+    const unsigned slot = mSendBatch->count;
+    ReturnErrorOnFailure(PrepareSendHeader(aPktInfo, msg, mSendBatch->headers[slot]));
+    mSendBatch->messages[slot] = std::move(msg);
+    mSendBatch->count++;
 
-    if (len != msg->DataLength())
+    // The first queued datagram schedules the flush. It runs once the event loop is done with the callbacks that are
+    // running now, so all the datagrams they send go out with a single sendmmsg().
+    if (slot == 0 && GetSystemLayer().StartTimer(System::Clock::kZero, FlushSendBatch, this) != CHIP_NO_ERROR)
     {
-        return CHIP_ERROR_OUTBOUND_MESSAGE_TOO_BIG;
+        FlushSendBatch();
     }
     return CHIP_NO_ERROR;
 }
 
+// static
+void UDPEndPointImplSockets::FlushSendBatch(System::Layer * aLayer, void * aAppState)
+{
+    static_cast<UDPEndPointImplSockets *>(aAppState)->FlushSendBatch();
+}
+
+void UDPEndPointImplSockets::FlushSendBatch()
+{
+    VerifyOrReturn(mSendBatch != nullptr && mSendBatch->count > 0);
+
+    const unsigned count = mSendBatch->count;
+    struct mmsghdr messages[SendBatch::kSize];
+    for (unsigned i = 0; i < count; i++)
+    {
+        messages[i].msg_hdr = mSendBatch->headers[i].msgHeader;
+        messages[i].msg_len = 0;
+    }
+
+    unsigned sent = 0;
+    while (sent < count)
+    {
+        // NOLINTNEXTLINE(clang-analyzer-unix.StdCLibraryFunctions): datagrams are only queued on a valid socket
+        const int result = sendmmsg(mSocket, &messages[sent], count - sent, 0);
+        if (result <= 0)
+        {
+            // sendmmsg() fails when the first datagram fails; drop that one, as a failed sendmsg() would, and carry on.
+            ChipLogError(Inet, "UDP send failed: %" CHIP_ERROR_FORMAT, CHIP_ERROR_POSIX(errno).Format());
+            sent++;
+            continue;
+        }
+        for (unsigned i = sent; i < sent + static_cast<unsigned>(result); i++)
+        {
+            if (messages[i].msg_len != mSendBatch->messages[i]->DataLength())
+            {
+                ChipLogError(Inet, "UDP send failed: %" CHIP_ERROR_FORMAT, CHIP_ERROR_OUTBOUND_MESSAGE_TOO_BIG.Format());
+            }
+        }
+        sent += static_cast<unsigned>(result);
+    }
+
+    for (unsigned i = 0; i < count; i++)
+    {
+        mSendBatch->messages[i] = nullptr;
+    }
+    mSendBatch->count = 0;
+}
+#endif // INET_CONFIG_UDP_SOCKET_SEND_BATCH_SIZE > 1
+
 void UDPEndPointImplSockets::CloseImpl()
 {
+#if INET_CONFIG_UDP_SOCKET_SEND_BATCH_SIZE > 1
+    if (mSendBatch != nullptr)
+    {
+        // Datagrams accepted by SendMsg() still go out.
+        GetSystemLayer().CancelTimer(FlushSendBatch, this);
+        FlushSendBatch();
+        Platform::Delete(mSendBatch);
+        mSendBatch = nullptr;
+    }
+#endif // INET_CONFIG_UDP_SOCKET_SEND_BATCH_SIZE > 1
+
     if (mSocket != kInvalidSocketFd)
     {
         static_cast<System::LayerSockets *>(&GetSystemLayer())->StopWatchingSocket(&mWatch);
@@ -578,113 +696,178 @@ void UDPEndPointImplSockets::HandlePendingIO(System::SocketEvents events)
         return;
     }
 
+#if INET_CONFIG_UDP_SOCKET_RECV_BATCH_SIZE > 1
+    ReceiveBatch();
+#else
     CHIP_ERROR lStatus = CHIP_NO_ERROR;
     IPPacketInfo lPacketInfo;
-    System::PacketBufferHandle lBuffer;
-
-    lPacketInfo.Clear();
-    lPacketInfo.DestPort  = mBoundPort;
-    lPacketInfo.Interface = mBoundIntfId;
-
-    lBuffer = System::PacketBufferHandle::New(System::PacketBuffer::kMaxSizeWithoutReserve, 0);
+    System::PacketBufferHandle lBuffer = System::PacketBufferHandle::New(System::PacketBuffer::kMaxSizeWithoutReserve, 0);
 
     if (!lBuffer.IsNull())
     {
-        struct iovec msgIOV;
-        SockAddr lPeerSockAddr;
-        uint8_t controlData[256];
-        struct msghdr msgHeader;
-
-        msgIOV.iov_base = lBuffer->Start();
-        msgIOV.iov_len  = lBuffer->AvailableDataLength();
-
-        memset(&lPeerSockAddr, 0, sizeof(lPeerSockAddr));
+        MessageHeader header;
+        PrepareReceiveHeader(lBuffer, header);
 
-        memset(&msgHeader, 0, sizeof(msgHeader));
-
-        msgHeader.msg_name       = &lPeerSockAddr;
-        msgHeader.msg_namelen    = sizeof(lPeerSockAddr);
-        msgHeader.msg_iov        = &msgIOV;
-        msgHeader.msg_iovlen     = 1;
-        msgHeader.msg_control    = controlData;
-        msgHeader.msg_controllen = sizeof(controlData);
-
-        ssize_t rcvLen = recvmsg(mSocket, &msgHeader, MSG_DONTWAIT);
+        ssize_t rcvLen = recvmsg(mSocket, &header.msgHeader, MSG_DONTWAIT);
 
         if (rcvLen == -1)
         {
             lStatus = CHIP_ERROR_POSIX(errno);
         }
-        else if (lBuffer->AvailableDataLength() < static_cast<size_t>(rcvLen))
+        else
         {
-            lStatus = CHIP_ERROR_INBOUND_MESSAGE_TOO_BIG;
+            lStatus = ParseReceivedMessage(header, static_cast<size_t>(rcvLen), lBuffer, lPacketInfo);
         }
-        else
+    }
+    else
+    {
+        lStatus = CHIP_ERROR_NO_MEMORY;
+    }
+
+    DeliverReceivedMessage(lStatus, std::move(lBuffer), lPacketInfo);
+#endif // INET_CONFIG_UDP_SOCKET_RECV_BATCH_SIZE > 1
+}
+
+#if INET_CONFIG_UDP_SOCKET_RECV_BATCH_SIZE > 1
+void UDPEndPointImplSockets::ReceiveBatch()
+{
+    constexpr unsigned kBatchSize = INET_CONFIG_UDP_SOCKET_RECV_BATCH_SIZE;
+
+    MessageHeader headers[kBatchSize];
+    struct mmsghdr messages[kBatchSize];
+    System::PacketBufferHandle buffers[kBatchSize];
+
+    unsigned count = 0;
+    for (; count < kBatchSize; count++)
+    {
+        buffers[count] = System::PacketBufferHandle::New(System::PacketBuffer::kMaxSizeWithoutReserve, 0);
+        if (buffers[count].IsNull())
         {
-            lBuffer->SetDataLength(static_cast<uint16_t>(rcvLen));
+            break;
+        }
+        PrepareReceiveHeader(buffers[count], headers[count]);
+        messages[count].msg_hdr = headers[count].msgHeader;
+        messages[count].msg_len = 0;
+    }
 
-            if (lPeerSockAddr.any.sa_family == AF_INET6)
-            {
-                lPacketInfo.SrcAddress = IPAddress(lPeerSockAddr.in6.sin6_addr);
-                lPacketInfo.SrcPort    = ntohs(lPeerSockAddr.in6.sin6_port);
-            }
+    if (count == 0)
+    {
+        DeliverReceivedMessage(CHIP_ERROR_NO_MEMORY, System::PacketBufferHandle(), IPPacketInfo());
+        return;
+    }
+
+    const int received = recvmmsg(mSocket, messages, count, MSG_DONTWAIT, nullptr);
+    if (received == -1)
+    {
+        DeliverReceivedMessage(CHIP_ERROR_POSIX(errno), System::PacketBufferHandle(), IPPacketInfo());
+        return;
+    }
+
+    // A callback may close or free this endpoint. Hold a reference until the loop is done, and drop the remaining
+    // datagrams once the endpoint is no longer listening.
+    Retain();
+    for (int i = 0; i < received && mState == State::kListening && OnMessageReceived != nullptr; i++)
+    {
+        IPPacketInfo packetInfo;
+        headers[i].msgHeader = messages[i].msg_hdr; // recvmmsg() updated the lengths and flags of its copy.
+        CHIP_ERROR status    = ParseReceivedMessage(headers[i], messages[i].msg_len, buffers[i], packetInfo);
+        DeliverReceivedMessage(status, std::move(buffers[i]), packetInfo);
+    }
+    Release();
+}
+#endif // INET_CONFIG_UDP_SOCKET_RECV_BATCH_SIZE > 1
+
+void UDPEndPointImplSockets::PrepareReceiveHeader(System::PacketBufferHandle & buffer, MessageHeader & header)
+{
+    header.msgIOV.iov_base = buffer->Start();
+    header.msgIOV.iov_len  = buffer->AvailableDataLength();
+
+    memset(&header.peerSockAddr, 0, sizeof(header.peerSockAddr));
+
+    memset(&header.msgHeader, 0, sizeof(header.msgHeader));
+
+    header.msgHeader.msg_name       = &header.peerSockAddr;
+    header.msgHeader.msg_namelen    = sizeof(header.peerSockAddr);
+    header.msgHeader.msg_iov        = &header.msgIOV;
+    header.msgHeader.msg_iovlen     = 1;
+    header.msgHeader.msg_control    = header.controlData;
+    header.msgHeader.msg_controllen = sizeof(header.controlData);
+}
+
+CHIP_ERROR UDPEndPointImplSockets::ParseReceivedMessage(MessageHeader & header, size_t rcvLen, System::PacketBufferHandle & lBuffer,
+                                                        IPPacketInfo & lPacketInfo)
+{
+    struct msghdr & msgHeader      = header.msgHeader;
+    const SockAddr & lPeerSockAddr = header.peerSockAddr;
+
+    lPacketInfo.Clear();
+    lPacketInfo.DestPort  = mBoundPort;
+    lPacketInfo.Interface = mBoundIntfId;
+
+    if (lBuffer->AvailableDataLength() < rcvLen)
+    {
+        return CHIP_ERROR_INBOUND_MESSAGE_TOO_BIG;
+    }
+
+    lBuffer->SetDataLength(static_cast<uint16_t>(rcvLen));
+
+    if (lPeerSockAddr.any.sa_family == AF_INET6)
+    {
+        lPacketInfo.SrcAddress = IPAddress(lPeerSockAddr.in6.sin6_addr);
+        lPacketInfo.SrcPort    = ntohs(lPeerSockAddr.in6.sin6_port);
+    }
 #if INET_CONFIG_ENABLE_IPV4
-            else if (lPeerSockAddr.any.sa_family == AF_INET)
-            {
-                lPacketInfo.SrcAddress = IPAddress(lPeerSockAddr.in.sin_addr);
-                lPacketInfo.SrcPort    = ntohs(lPeerSockAddr.in.sin_port);
-            }
+    else if (lPeerSockAddr.any.sa_family == AF_INET)
+    {
+        lPacketInfo.SrcAddress = IPAddress(lPeerSockAddr.in.sin_addr);
+        lPacketInfo.SrcPort    = ntohs(lPeerSockAddr.in.sin_port);
+    }
 #endif // INET_CONFIG_ENABLE_IPV4
-            else
-            {
-                lStatus = CHIP_ERROR_INCORRECT_STATE;
-            }
-        }
+    else
+    {
+        return CHIP_ERROR_INCORRECT_STATE;
+    }
 
-        if (lStatus == CHIP_NO_ERROR)
-        {
-            for (struct cmsghdr * controlHdr = CMSG_FIRSTHDR(&msgHeader); controlHdr != nullptr;
-                 controlHdr                  = CMSG_NXTHDR(&msgHeader, controlHdr))
-            {
+    for (struct cmsghdr * controlHdr = CMSG_FIRSTHDR(&msgHeader); controlHdr != nullptr;
+         controlHdr                  = CMSG_NXTHDR(&msgHeader, controlHdr))
+    {
 #if INET_CONFIG_ENABLE_IPV4
 #ifdef IP_PKTINFO
-                if (controlHdr->cmsg_level == IPPROTO_IP && controlHdr->cmsg_type == IP_PKTINFO)
-                {
-                    auto * inPktInfo = reinterpret_cast<struct in_pktinfo *> CMSG_DATA(controlHdr);
-                    if (!CanCastTo<InterfaceId::PlatformType>(inPktInfo->ipi_ifindex))
-                    {
-                        lStatus = CHIP_ERROR_INCORRECT_STATE;
-                        break;
-                    }
-                    lPacketInfo.Interface   = InterfaceId(static_cast<InterfaceId::PlatformType>(inPktInfo->ipi_ifindex));
-                    lPacketInfo.DestAddress = IPAddress(inPktInfo->ipi_addr);
-                    continue;
-                }
+        if (controlHdr->cmsg_level == IPPROTO_IP && controlHdr->cmsg_type == IP_PKTINFO)
+        {
+            auto * inPktInfo = reinterpret_cast<struct in_pktinfo *> CMSG_DATA(controlHdr);
+            if (!CanCastTo<InterfaceId::PlatformType>(inPktInfo->ipi_ifindex))
+            {
+                return CHIP_ERROR_INCORRECT_STATE;
+            }
+            lPacketInfo.Interface   = InterfaceId(static_cast<InterfaceId::PlatformType>(inPktInfo->ipi_ifindex));
+            lPacketInfo.DestAddress = IPAddress(inPktInfo->ipi_addr);
+            continue;
+        }
 #endif // defined(IP_PKTINFO)
 #endif // INET_CONFIG_ENABLE_IPV4
 
 #ifdef IPV6_PKTINFO
-                if (controlHdr->cmsg_level == IPPROTO_IPV6 && controlHdr->cmsg_type == IPV6_PKTINFO)
-                {
-                    auto * in6PktInfo = reinterpret_cast<struct in6_pktinfo *> CMSG_DATA(controlHdr);
-                    if (!CanCastTo<InterfaceId::PlatformType>(in6PktInfo->ipi6_ifindex))
-                    {
-                        lStatus = CHIP_ERROR_INCORRECT_STATE;
-                        break;
-                    }
-                    lPacketInfo.Interface   = InterfaceId(static_cast<InterfaceId::PlatformType>(in6PktInfo->ipi6_ifindex));
-                    lPacketInfo.DestAddress = IPAddress(in6PktInfo->ipi6_addr);
-                    continue;
-                }
-#endif // defined(IPV6_PKTINFO)
+        if (controlHdr->cmsg_level == IPPROTO_IPV6 && controlHdr->cmsg_type == IPV6_PKTINFO)
+        {
+            auto * in6PktInfo = reinterpret_cast<struct in6_pktinfo *> CMSG_DATA(controlHdr);
+            if (!CanCastTo<InterfaceId::PlatformType>(in6PktInfo->ipi6_ifindex))
+            {
+                return CHIP_ERROR_INCORRECT_STATE;
             }
+            lPacketInfo.Interface   = InterfaceId(static_cast<InterfaceId::PlatformType>(in6PktInfo->ipi6_ifindex));
+            lPacketInfo.DestAddress = IPAddress(in6PktInfo->ipi6_addr);
+            continue;
         }
-    }
-    else
-    {
-        lStatus = CHIP_ERROR_NO_MEMORY;
+#endif // defined(IPV6_PKTINFO)
     }
 
+    return CHIP_NO_ERROR;
+}
+
+void UDPEndPointImplSockets::DeliverReceivedMessage(CHIP_ERROR lStatus, System::PacketBufferHandle && lBuffer,
+                                                    const IPPacketInfo & lPacketInfo)
+{
     if (lStatus == CHIP_NO_ERROR)
     {
         lBuffer.RightSize();
@@ -58,6 +58,27 @@ private:
     void HandlePendingIO(System::SocketEvents events);
     static void HandlePendingIO(System::SocketEvents events, intptr_t data);
 
+    // A msghdr with the storage it points to, for one datagram sent or received.
+    struct MessageHeader;
+    CHIP_ERROR PrepareSendHeader(const IPPacketInfo * pktInfo, const System::PacketBufferHandle & msg, MessageHeader & header);
+    void PrepareReceiveHeader(System::PacketBufferHandle & buffer, MessageHeader & header);
+    CHIP_ERROR ParseReceivedMessage(MessageHeader & header, size_t rcvLen, System::PacketBufferHandle & buffer,
+                                    IPPacketInfo & pktInfo);
+    void DeliverReceivedMessage(CHIP_ERROR status, System::PacketBufferHandle && buffer, const IPPacketInfo & pktInfo);
+#if INET_CONFIG_UDP_SOCKET_RECV_BATCH_SIZE > 1
+    void ReceiveBatch();
+#endif // INET_CONFIG_UDP_SOCKET_RECV_BATCH_SIZE > 1
+
+#if INET_CONFIG_UDP_SOCKET_SEND_BATCH_SIZE > 1
+    // Datagrams accepted by SendMsg() and not yet handed to sendmmsg().
+    struct SendBatch;
+    CHIP_ERROR QueueMessage(const IPPacketInfo * pktInfo, System::PacketBufferHandle && msg);
+    void FlushSendBatch();
+    static void FlushSendBatch(System::Layer * aLayer, void * aAppState);
+
+    SendBatch * mSendBatch = nullptr;
+#endif // INET_CONFIG_UDP_SOCKET_SEND_BATCH_SIZE > 1
+
     InterfaceId mBoundIntfId;
     uint16_t mBoundPort;
 
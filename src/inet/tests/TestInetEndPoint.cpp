@@ -377,6 +377,56 @@ TEST_F(TestInetEndPoint, TestInetEndPointInternal)
 #endif // INET_CONFIG_ENABLE_TCP_ENDPOINT
 }
 
+#if INET_CONFIG_ENABLE_UDP_ENDPOINT
+// Test that datagrams that arrive together are each delivered once, in order.
+TEST_F(TestInetEndPoint, TestInetEndPointUDPLoopback)
+{
+    constexpr uint8_t kMessageCount = 3 * INET_CONFIG_UDP_SOCKET_RECV_BATCH_SIZE + 1;
+
+    struct ReceiveState
+    {
+        uint8_t received = 0;
+        bool inOrder     = true;
+    } state;
+
+    UDPEndPoint::OnMessageReceivedFunct onMessage = [](UDPEndPoint * ep, PacketBufferHandle && msg, const IPPacketInfo * pktInfo) {
+        auto * receiveState = static_cast<ReceiveState *>(ep->mAppState);
+        if (msg->DataLength() != 1 || msg->Start()[0] != receiveState->received || pktInfo->SrcPort != ep->GetBoundPort())
+        {
+            receiveState->inOrder = false;
+        }
+        receiveState->received++;
+    };
+    UDPEndPoint::OnReceiveErrorFunct onError = [](UDPEndPoint * ep, CHIP_ERROR err, const IPPacketInfo * pktInfo) {
+        static_cast<ReceiveState *>(ep->mAppState)->inOrder = false;
+    };
+
+    UDPEndPoint * testUDPEP = nullptr;
+    ASSERT_EQ(gUDP.NewEndPoint(&testUDPEP), CHIP_NO_ERROR);
+    ASSERT_EQ(testUDPEP->Bind(IPAddressType::kIPv6, IPAddress::Any, 0), CHIP_NO_ERROR);
+    ASSERT_EQ(testUDPEP->Listen(onMessage, onError, &state), CHIP_NO_ERROR);
+
+    // Send everything before servicing any events, so the socket has several datagrams queued per read.
+    const IPAddress loopback = IPAddress::Loopback(IPAddressType::kIPv6);
+    for (uint8_t i = 0; i < kMessageCount; i++)
+    {
+        PacketBufferHandle buf = PacketBufferHandle::NewWithData(&i, 1);
+        ASSERT_FALSE(buf.IsNull());
+        EXPECT_EQ(testUDPEP->SendTo(loopback, testUDPEP->GetBoundPort(), std::move(buf)), CHIP_NO_ERROR);
+    }
+
+    for (int i = 0; i < 100 && state.received < kMessageCount; i++)
+    {
+        ServiceEvents(10);
+    }
+
+    EXPECT_EQ(state.received, kMessageCount);
+    EXPECT_TRUE(state.inOrder);
+
+    testUDPEP->Free();
+}
+#endif // INET_CONFIG_ENABLE_UDP_ENDPOINT
+
 #if !CHIP_SYSTEM_CONFIG_POOL_USE_HEAP
 // Test the Inet resource limitations.
 TEST_F(TestInetEndPoint, TestInetEndPointLimit)
@@ -51,6 +51,33 @@ void HeapObjectPoolExitHandling::ExitHandler()
 
 namespace internal {
 
+namespace {
+
+// Index of the lowest set bit of a non-zero usage word.
+inline size_t LowestSetBit(unsigned long value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<size_t>(__builtin_ctzl(value));
+#else
+    size_t bit = 0;
+    while ((value & 1) == 0)
+    {
+        value >>= 1;
+        ++bit;
+    }
+    return bit;
+#endif
+}
+
+} // namespace
+
+void Statistics::DumpStatisticsToLog(const char * poolName) const
+{
+    ChipLogError(Support, "%s: %lu allocated, %lu high water mark, %lu failed allocations", poolName,
+                 static_cast<unsigned long>(mAllocated), static_cast<unsigned long>(mHighWaterMark),
+                 static_cast<unsigned long>(mAllocationFailures));
+}
+
 StaticAllocatorBitmap::StaticAllocatorBitmap(void * storage, std::atomic<tBitChunkType> * usage, size_t capacity,
                                              size_t elementSize) :
     StaticAllocatorBase(capacity),
@@ -62,23 +89,27 @@ StaticAllocatorBitmap::StaticAllocatorBitmap(void * storage, std::atomic<tBitChu
     }
 }
 
+StaticAllocatorBitmap::tBitChunkType StaticAllocatorBitmap::UsableBits(size_t word) const
+{
+    size_t remaining = Capacity() - word * kBitChunkSize;
+    return (remaining >= kBitChunkSize) ? ~tBitChunkType(0) : ((kBit1 << remaining) - 1);
+}
+
 void * StaticAllocatorBitmap::Allocate()
 {
     for (size_t word = 0; word * kBitChunkSize < Capacity(); ++word)
     {
-        auto & usage = mUsage[word];
-        auto value   = usage.load(std::memory_order_relaxed);
-        for (size_t offset = 0; offset < kBitChunkSize && offset + word * kBitChunkSize < Capacity(); ++offset)
+        auto & usage      = mUsage[word];
+        auto value        = usage.load(std::memory_order_relaxed);
+        const auto usable = UsableBits(word);
+        while ((~value & usable) != 0)
         {
-            if ((value & (kBit1 << offset)) == 0)
+            size_t offset = LowestSetBit(~value & usable);
+            // On a race, compare_exchange_strong() reloads value with the new usage.
+            if (usage.compare_exchange_strong(value, value | (kBit1 << offset)))
             {
-                if (usage.compare_exchange_strong(value, value | (kBit1 << offset)))
-                {
-                    IncreaseUsage();
-                    return At(word * kBitChunkSize + offset);
-                }
-
-                value = usage.load(std::memory_order_relaxed); // if there is a race, update new usage
+                IncreaseUsage();
+                return At(word * kBitChunkSize + offset);
             }
         }
     }
@@ -113,15 +144,13 @@ Loop StaticAllocatorBitmap::ForEachActiveObjectInner(void * context, Lambda lamb
 {
     for (size_t word = 0; word * kBitChunkSize < Capacity(); ++word)
     {
-        auto & usage = mUsage[word];
-        auto value   = usage.load(std::memory_order_relaxed);
-        for (size_t offset = 0; offset < kBitChunkSize && offset + word * kBitChunkSize < Capacity(); ++offset)
+        auto value = mUsage[word].load(std::memory_order_relaxed);
+        while (value != 0)
         {
-            if ((value & (kBit1 << offset)) != 0)
-            {
-                if (lambda(context, At(word * kBitChunkSize + offset)) == Loop::Break)
-                    return Loop::Break;
-            }
+            size_t offset = LowestSetBit(value);
+            value &= value - 1;
+            if (lambda(context, At(word * kBitChunkSize + offset)) == Loop::Break)
+                return Loop::Break;
         }
     }
     return Loop::Finish;
@@ -129,58 +158,40 @@ Loop StaticAllocatorBitmap::ForEachActiveObjectInner(void * context, Lambda lamb
 
 size_t StaticAllocatorBitmap::FirstActiveIndex()
 {
-    size_t idx = 0;
-    for (size_t word = 0; word * kBitChunkSize < Capacity(); ++word)
-    {
-        auto & usage = mUsage[word];
-        auto value   = usage.load(std::memory_order_relaxed);
-        for (size_t offset = 0; offset < kBitChunkSize && offset + word * kBitChunkSize < Capacity(); ++offset)
-        {
-            if ((value & (kBit1 << offset)) != 0)
-            {
-                return idx;
-            }
-            idx++;
-        }
-    }
-    VerifyOrDie(idx == mCapacity);
-    return mCapacity;
+    return NextActiveIndexFrom(0);
 }
 
 size_t StaticAllocatorBitmap::NextActiveIndexAfter(size_t start)
 {
-    size_t idx = 0;
-    for (size_t word = 0; word * kBitChunkSize < Capacity(); ++word)
+    if (start >= mCapacity)
     {
-        auto & usage = mUsage[word];
-        auto value   = usage.load(std::memory_order_relaxed);
-        for (size_t offset = 0; offset < kBitChunkSize && offset + word * kBitChunkSize < Capacity(); ++offset)
-        {
-            if (((value & (kBit1 << offset)) != 0) && (start < idx))
-            {
-                return idx;
-            }
-            idx++;
-        }
+        return mCapacity;
     }
-    VerifyOrDie(idx == mCapacity);
-    return mCapacity;
+    return NextActiveIndexFrom(start + 1);
 }
 
-#if CHIP_SYSTEM_CONFIG_POOL_USE_HEAP
-
-HeapObjectListNode * HeapObjectList::FindNode(void * object) const
+size_t StaticAllocatorBitmap::NextActiveIndexFrom(size_t index)
 {
-    for (HeapObjectListNode * p = mNext; p != this; p = p->mNext)
+    if (index >= mCapacity)
     {
-        if (p->mObject == object)
+        return mCapacity;
+    }
+
+    size_t word = index / kBitChunkSize;
+    auto value  = mUsage[word].load(std::memory_order_relaxed) & (~tBitChunkType(0) << (index % kBitChunkSize));
+    while (value == 0)
+    {
+        if (++word * kBitChunkSize >= mCapacity)
         {
-            return p;
+            return mCapacity;
         }
+        value = mUsage[word].load(std::memory_order_relaxed);
     }
-    return nullptr;
+    return word * kBitChunkSize + LowestSetBit(value);
 }
 
+#if CHIP_SYSTEM_CONFIG_POOL_USE_HEAP
+
 Loop HeapObjectList::ForEachNode(void * context, Lambda lambda)
 {
     ++mIterationDepth;
@@ -217,7 +228,7 @@ void HeapObjectList::CleanupDeferredReleases()
         if (p->mObject == nullptr)
         {
             p->Remove();
-            Platform::Delete(p);
+            Platform::MemoryFree(p);
         }
         p = next;
     }
@@ -225,6 +236,18 @@ void HeapObjectList::CleanupDeferredReleases()
     mHaveDeferredNodeRemovals = false;
 }
 
+bool HeapObjectList::Contains(const void * object) const
+{
+    for (const HeapObjectListNode * p = mNext; p != this; p = p->mNext)
+    {
+        if (p->mObject == object)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
 #endif // CHIP_SYSTEM_CONFIG_POOL_USE_HEAP
 
 } // namespace internal
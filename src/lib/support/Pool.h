@@ -30,6 +30,7 @@
 #include <lib/support/Iterators.h>
 
 #include <atomic>
+#include <cstddef>
 #include <limits>
 #include <new>
 #include <stddef.h>
@@ -45,10 +46,14 @@ namespace internal {
 class Statistics
 {
 public:
-    Statistics() : mAllocated(0), mHighWaterMark(0) {}
+    Statistics() : mAllocated(0), mHighWaterMark(0), mAllocationFailures(0) {}
 
     size_t Allocated() const { return mAllocated; }
     size_t HighWaterMark() const { return mHighWaterMark; }
+    /// Number of CreateObject() calls that returned nullptr.
+    size_t AllocationFailures() const { return mAllocationFailures; }
+    /// Restarts the high water mark from the current usage, e.g. at the start of a measurement window.
+    void ResetHighWaterMark() { mHighWaterMark = mAllocated; }
     void IncreaseUsage()
     {
         if (++mAllocated > mHighWaterMark)
@@ -57,10 +62,14 @@ public:
         }
     }
     void DecreaseUsage() { --mAllocated; }
+    void RecordAllocationFailure() { ++mAllocationFailures; }
 
 protected:
+    void DumpStatisticsToLog(const char * poolName) const;
+
     size_t mAllocated;
     size_t mHighWaterMark;
+    size_t mAllocationFailures;
 };
 
 class StaticAllocatorBase : public Statistics
@@ -95,6 +104,9 @@ protected:
     void * At(size_t index) { return static_cast<uint8_t *>(mElements) + mElementSize * index; }
     size_t IndexOf(void * element);
 
+    /// Mask of the bits of usage word `word` that map to elements of the pool.
+    tBitChunkType UsableBits(size_t word) const;
+
     /// Returns the first index that is active (i.e. allocated data).
     ///
     /// If nothing is active, this will return mCapacity
@@ -105,6 +117,11 @@ protected:
     /// If nothing else active/allocated, returns mCapacity
     size_t NextActiveIndexAfter(size_t start);
 
+    /// Returns the first active index that is not before `index`, skipping empty usage words whole.
+    ///
+    /// If nothing active/allocated from there on, returns mCapacity
+    size_t NextActiveIndexFrom(size_t index);
+
     using Lambda = Loop (*)(void * context, void * object);
     Loop ForEachActiveObjectInner(void * context, Lambda lambda);
     Loop ForEachActiveObjectInner(void * context, Loop lambda(void * context, const void * object)) const
@@ -142,17 +159,25 @@ private:
 
 #if CHIP_SYSTEM_CONFIG_POOL_USE_HEAP
 
+/**
+ * List node of a HeapObjectPool object. HeapObjectPool allocates each node as the header of the same block as its
+ * object, so a node is freed with Platform::MemoryFree().
+ */
+struct HeapObjectList;
+
 struct HeapObjectListNode
 {
     void Remove()
     {
         mNext->mPrev = mPrev;
         mPrev->mNext = mNext;
+        mOwner       = nullptr;
     }
 
-    void * mObject             = nullptr;
-    HeapObjectListNode * mNext = nullptr;
-    HeapObjectListNode * mPrev = nullptr;
+    void * mObject                = nullptr;
+    HeapObjectListNode * mNext    = nullptr;
+    HeapObjectListNode * mPrev    = nullptr;
+    const HeapObjectList * mOwner = nullptr; // The list this node is on; a best-effort check for releases into the wrong pool.
 };
 
 struct HeapObjectList : HeapObjectListNode
@@ -163,12 +188,11 @@ struct HeapObjectList : HeapObjectListNode
     {
         node->mNext  = this;
         node->mPrev  = mPrev;
+        node->mOwner = this;
         mPrev->mNext = node;
         mPrev        = node;
     }
 
-    HeapObjectListNode * FindNode(void * object) const;
-
     using Lambda = Loop (*)(void *, void *);
     Loop ForEachNode(void * context, Lambda lambda);
     Loop ForEachNode(void * context, Loop lambda(void * context, const void * object)) const
@@ -179,6 +203,9 @@ struct HeapObjectList : HeapObjectListNode
     /// Cleans up any deferred releases IFF iteration depth is 0
     void CleanupDeferredReleases();
 
+    /// Whether a live object on this list is at `object`. Walks the whole list, so it is only used in debug builds.
+    bool Contains(const void * object) const;
+
     size_t mIterationDepth         = 0;
     bool mHaveDeferredNodeRemovals = false;
 };
@@ -275,6 +302,7 @@ public:
         T * element = static_cast<T *>(Allocate());
         if (element != nullptr)
             return new (element) T(std::forward<Args>(args)...);
+        RecordAllocationFailure();
         return nullptr;
     }
 
@@ -326,7 +354,7 @@ public:
 
     void DumpToLog() const
     {
-        ChipLogError(Support, "BitMapObjectPool: %lu allocated", static_cast<unsigned long>(Allocated()));
+        DumpStatisticsToLog("BitMapObjectPool");
         if constexpr (IsDumpable<T>::value)
         {
             ForEachActiveObject([](const T * object) {
@@ -495,19 +523,19 @@ public:
     template <typename... Args>
     T * CreateObject(Args &&... args)
     {
-        T * object = Platform::New<T>(std::forward<Args>(args)...);
-        if (object != nullptr)
+        void * block = Platform::MemoryAlloc(kNodeSize + sizeof(T));
+        if (block == nullptr)
         {
-            auto node = Platform::New<internal::HeapObjectListNode>();
-            if (node != nullptr)
-            {
-                node->mObject = object;
-                mObjects.Append(node);
-                IncreaseUsage();
-                return object;
-            }
+            RecordAllocationFailure();
+            return nullptr;
         }
-        return nullptr;
+
+        auto * node   = new (block) internal::HeapObjectListNode();
+        T * object    = new (static_cast<uint8_t *>(block) + kNodeSize) T(std::forward<Args>(args)...);
+        node->mObject = object;
+        mObjects.Append(node);
+        IncreaseUsage();
+        return object;
     }
 
     /*
@@ -526,20 +554,29 @@ public:
     {
         if (object != nullptr)
         {
-            internal::HeapObjectListNode * node = mObjects.FindNode(object);
-            // Releasing an object that is not allocated indicates likely memory
+            // Releasing an object that is not allocated by this pool (or already released) indicates likely memory
             // corruption; better to safe-crash than proceed at this point.
-            VerifyOrDie(node != nullptr);
+#ifndef NDEBUG
+            // Only a walk of the list is sure not to read outside a pointer that no pool allocated.
+            VerifyOrDie(mObjects.Contains(object));
+#endif
+            // In O(1), only the header in front of the object can be checked. That is a best-effort check: it catches
+            // releases into the wrong pool and most double releases, but for a pointer that no heap pool allocated, the
+            // header read itself is out of bounds.
+            internal::HeapObjectListNode * node = NodeOf(object);
+            VerifyOrDie(node->mOwner == &mObjects);
+            VerifyOrDie(node->mObject == object);
 
             node->mObject = nullptr;
-            Platform::Delete(object);
+            object->~T();
 
-            // The node needs to be released immediately if we are not in the middle of iteration.
-            // Otherwise cleanup is deferred until all iteration on this pool completes and it's safe to release nodes.
+            // The node, and with it the object's storage, needs to be released immediately if we are not in the middle
+            // of iteration. Otherwise cleanup is deferred until all iteration on this pool completes and it's safe to
+            // release nodes.
             if (mObjects.mIterationDepth == 0)
             {
                 node->Remove();
-                Platform::Delete(node);
+                Platform::MemoryFree(node);
             }
             else
             {
@@ -585,7 +622,7 @@ public:
 
     void DumpToLog() const
     {
-        ChipLogError(Support, "HeapObjectPool: %lu allocated", static_cast<unsigned long>(Allocated()));
+        DumpStatisticsToLog("HeapObjectPool");
         if constexpr (IsDumpable<T>::value)
         {
             ForEachActiveObject([](const T * object) {
@@ -596,6 +633,17 @@ public:
     }
 
 private:
+    static_assert(alignof(T) <= alignof(std::max_align_t), "HeapObjectPool does not support over-aligned types");
+
+    // Each object lives in one block right after its list node, so ReleaseObject() finds the node without
+    // walking the list. kNodeSize pads the node so that the object stays aligned.
+    static constexpr size_t kNodeSize = (sizeof(internal::HeapObjectListNode) + alignof(T) - 1) / alignof(T) * alignof(T);
+
+    static internal::HeapObjectListNode * NodeOf(T * object)
+    {
+        return reinterpret_cast<internal::HeapObjectListNode *>(reinterpret_cast<uint8_t *>(object) - kNodeSize);
+    }
+
     static Loop ReleaseObject(void * context, void * object)
     {
         static_cast<HeapObjectPool *>(context)->ReleaseObject(static_cast<T *>(object));
@@ -23,7 +23,9 @@
  *
  */
 
+#include <cstddef>
 #include <set>
+#include <vector>
 
 #include <pw_unit_test/framework.h>
 
@@ -546,6 +548,146 @@ TEST_F(TestPool, TestPoolInterfaceDynamic)
 }
 #endif // CHIP_SYSTEM_CONFIG_POOL_USE_HEAP
 
+TEST_F(TestPool, TestSparseIterationStatic)
+{
+    // Spans several usage words, with a partial last word.
+    constexpr size_t kSize = 200;
+    ObjectPool<size_t, kSize, ObjectPoolMem::kInline> pool;
+    size_t * objs[kSize];
+
+    for (size_t i = 0; i < kSize; ++i)
+    {
+        objs[i] = pool.CreateObject(i);
+        ASSERT_NE(objs[i], nullptr);
+    }
+
+    const std::set<size_t> kept = { 0, 63, 64, 65, 130, 199 };
+    for (size_t i = 0; i < kSize; ++i)
+    {
+        if (kept.count(i) == 0)
+        {
+            pool.ReleaseObject(objs[i]);
+        }
+    }
+
+    // Both ways of iterating visit exactly the live objects, in slot order.
+    std::vector<size_t> visited;
+    pool.ForEachActiveObject([&](size_t * object) {
+        visited.push_back(*object);
+        return Loop::Continue;
+    });
+    EXPECT_TRUE(visited == std::vector<size_t>(kept.begin(), kept.end()));
+
+    visited.clear();
+    for (auto object : pool)
+    {
+        visited.push_back(*object);
+    }
+    EXPECT_TRUE(visited == std::vector<size_t>(kept.begin(), kept.end()));
+
+    // Freed slots are reused lowest first.
+    size_t * reused = pool.CreateObject(kSize);
+    EXPECT_EQ(reused, objs[1]);
+
+    pool.ReleaseAll();
+    EXPECT_EQ(pool.begin(), pool.end());
+}
+
+template <ObjectPoolMem P>
+void TestPoolStatistics()
+{
+    constexpr size_t kSize = 10;
+    ObjectPool<uint32_t, kSize, P> pool;
+    uint32_t * objs[kSize];
+
+    for (auto & obj : objs)
+    {
+        obj = pool.CreateObject();
+        ASSERT_NE(obj, nullptr);
+    }
+    EXPECT_EQ(pool.HighWaterMark(), kSize);
+    EXPECT_EQ(pool.AllocationFailures(), 0u);
+
+    for (size_t i = 0; i < kSize / 2; ++i)
+    {
+        pool.ReleaseObject(objs[i]);
+    }
+    EXPECT_EQ(pool.Allocated(), kSize / 2);
+    EXPECT_EQ(pool.HighWaterMark(), kSize);
+
+    pool.ResetHighWaterMark();
+    EXPECT_EQ(pool.HighWaterMark(), kSize / 2);
+    objs[0] = pool.CreateObject();
+    ASSERT_NE(objs[0], nullptr);
+    EXPECT_EQ(pool.HighWaterMark(), kSize / 2 + 1);
+
+    pool.ReleaseAll();
+}
+
+TEST_F(TestPool, TestPoolStatisticsStatic)
+{
+    TestPoolStatistics<ObjectPoolMem::kInline>();
+
+    ObjectPool<uint32_t, 2, ObjectPoolMem::kInline> pool;
+    ASSERT_NE(pool.CreateObject(), nullptr);
+    ASSERT_NE(pool.CreateObject(), nullptr);
+    EXPECT_EQ(pool.CreateObject(), nullptr);
+    EXPECT_EQ(pool.CreateObject(), nullptr);
+    EXPECT_EQ(pool.AllocationFailures(), 2u);
+    pool.ReleaseAll();
+}
+
+#if CHIP_SYSTEM_CONFIG_POOL_USE_HEAP
+TEST_F(TestPool, TestPoolStatisticsDynamic)
+{
+    TestPoolStatistics<ObjectPoolMem::kHeap>();
+}
+
+TEST_F(TestPool, TestMassReleaseDynamic)
+{
+    struct alignas(alignof(std::max_align_t)) S
+    {
+        S(size_t id) : mId(id) {}
+        size_t mId;
+    };
+
+    // Release from the middle, the back and the front of the list; each release only touches its own node.
+    constexpr size_t kSize = 2000;
+    ObjectPool<S, kSize, ObjectPoolMem::kHeap> pool;
+    std::vector<S *> objs;
+    for (size_t i = 0; i < kSize; ++i)
+    {
+        objs.push_back(pool.CreateObject(i));
+        ASSERT_NE(objs.back(), nullptr);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(objs.back()) % alignof(S), 0u);
+    }
+
+    for (size_t i = kSize / 4; i < kSize / 2; ++i)
+    {
+        pool.ReleaseObject(objs[i]);
+    }
+    for (size_t i = kSize; i > kSize / 2; --i)
+    {
+        pool.ReleaseObject(objs[i - 1]);
+    }
+    EXPECT_EQ(pool.Allocated(), kSize / 4);
+
+    size_t expected = 0;
+    for (auto object : pool)
+    {
+        EXPECT_EQ(object->mId, expected++);
+    }
+    EXPECT_EQ(expected, kSize / 4);
+
+    for (size_t i = 0; i < kSize / 4; ++i)
+    {
+        pool.ReleaseObject(objs[i]);
+    }
+    EXPECT_EQ(pool.Allocated(), 0u);
+    EXPECT_EQ(pool.begin(), pool.end());
+}
+#endif // CHIP_SYSTEM_CONFIG_POOL_USE_HEAP
+
 template <typename T, size_t N, ObjectPoolMem P>
 void TestPoolAutoRelease()
 {
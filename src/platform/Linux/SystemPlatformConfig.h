@@ -39,6 +39,14 @@ struct ChipDeviceEvent;
 #define CHIP_SYSTEM_CONFIG_NO_LOCKING 0
 #define CHIP_SYSTEM_CONFIG_PLATFORM_PROVIDES_TIME 1
 #define CHIP_SYSTEM_CONFIG_POOL_USE_HEAP 1
+// Timers are heap allocated and a controller can hold many; keep timer lookups short.
+#define CHIP_SYSTEM_CONFIG_TIMER_LIST_HASH_BUCKETS 256
+// Packet buffers come from the heap; reuse freed blocks instead of going to malloc for every message.
+// Large (TCP) buffers get geometric classes so that no allocation is rounded up by more than 4x.
+#define CHIP_SYSTEM_CONFIG_PACKETBUFFER_SIZE_CLASS_CACHE 1
+#define CHIP_SYSTEM_CONFIG_PACKETBUFFER_SIZE_CLASSES                                                                               \
+    { 256, 16 }, { CHIP_SYSTEM_CONFIG_PACKETBUFFER_CAPACITY_MAX, 8 }, { 4096, 4 }, { 16384, 2 },                                   \
+        { CHIP_SYSTEM_CONFIG_MAX_LARGE_BUFFER_SIZE_BYTES, 2 }
 
 // ========== Platform-specific Configuration Overrides =========
 #define CHIP_CONFIG_MDNS_RESOLVE_LOOKUP_RESULTS 5
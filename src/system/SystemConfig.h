@@ -381,6 +381,39 @@
 #define CHIP_SYSTEM_CONFIG_PACKETBUFFER_POOL_SIZE 15
 #endif /* CHIP_SYSTEM_CONFIG_PACKETBUFFER_POOL_SIZE */
 
+/**
+ *  @def CHIP_SYSTEM_CONFIG_PACKETBUFFER_SIZE_CLASS_CACHE
+ *
+ *  @brief
+ *      When packet buffers come from the heap (#CHIP_SYSTEM_CONFIG_PACKETBUFFER_POOL_SIZE is zero), this enables (1) a
+ *      per-thread cache of freed packet buffer blocks in front of Platform::MemoryAlloc(), so that most allocations of
+ *      common sizes reuse a block instead of going to malloc. Allocations are rounded up to the size classes of
+ *      #CHIP_SYSTEM_CONFIG_PACKETBUFFER_SIZE_CLASSES.
+ *
+ *      This requires `thread_local` support.
+ */
+#ifndef CHIP_SYSTEM_CONFIG_PACKETBUFFER_SIZE_CLASS_CACHE
+#define CHIP_SYSTEM_CONFIG_PACKETBUFFER_SIZE_CLASS_CACHE 0
+#endif /* CHIP_SYSTEM_CONFIG_PACKETBUFFER_SIZE_CLASS_CACHE */
+
+/**
+ *  @def CHIP_SYSTEM_CONFIG_PACKETBUFFER_SIZE_CLASSES
+ *
+ *  @brief
+ *      Size classes of the packet buffer cache, as a list of `{ capacity, cache depth }` pairs in increasing order of
+ *      capacity. The capacity is the largest reserve plus data size (\c PacketBuffer::AllocSize()) the class serves, and
+ *      the cache depth is the number of free blocks of the class each thread keeps. Larger allocations bypass the cache.
+ *
+ *      The default classes are one for small messages such as MRP acknowledgements and status responses, and one for
+ *      full-size messages up to the IPv6 MTU. A platform with TCP can add classes up to
+ *      #CHIP_SYSTEM_CONFIG_MAX_LARGE_BUFFER_SIZE_BYTES for large payloads. Space them geometrically (e.g. 4 KB, 16 KB,
+ *      then the maximum) rather than adding a single large class, since an allocation is rounded up to the capacity of
+ *      its class, and keep their depth small, as every cached block holds that much memory.
+ */
+#ifndef CHIP_SYSTEM_CONFIG_PACKETBUFFER_SIZE_CLASSES
+#define CHIP_SYSTEM_CONFIG_PACKETBUFFER_SIZE_CLASSES { 256, 16 }, { CHIP_SYSTEM_CONFIG_PACKETBUFFER_CAPACITY_MAX, 8 }
+#endif /* CHIP_SYSTEM_CONFIG_PACKETBUFFER_SIZE_CLASSES */
+
 /**
  *  @def CHIP_SYSTEM_CONFIG_PACKETBUFFER_LWIP_PBUF_RAM
  *
@@ -518,6 +551,17 @@ struct LwIPEvent;
 #define CHIP_SYSTEM_CONFIG_NUM_TIMERS 32
 #endif /* CHIP_SYSTEM_CONFIG_NUM_TIMERS */
 
+/**
+ *  @def CHIP_SYSTEM_CONFIG_TIMER_LIST_HASH_BUCKETS
+ *
+ *  @brief
+ *      Number of hash buckets, a power of two, that System::TimerList uses to find timers by callback and
+ *      app state. Each TimerList holds one pointer per bucket; a lookup visits about (timers / buckets) timers.
+ */
+#ifndef CHIP_SYSTEM_CONFIG_TIMER_LIST_HASH_BUCKETS
+#define CHIP_SYSTEM_CONFIG_TIMER_LIST_HASH_BUCKETS 16
+#endif /* CHIP_SYSTEM_CONFIG_TIMER_LIST_HASH_BUCKETS */
+
 /**
  *  @def CHIP_SYSTEM_CONFIG_THREAD_LOCAL_STORAGE
  *
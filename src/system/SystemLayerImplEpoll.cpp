@@ -0,0 +1,584 @@
+/*
+ *
+ *    Copyright (c) 2025 Project CHIP Authors
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      This file implements Layer using Linux epoll, eventfd and timerfd.
+ */
+
+#include <lib/support/CodeUtils.h>
+#include <lib/support/TimeUtils.h>
+#include <platform/LockTracker.h>
+#include <system/SystemFaultInjection.h>
+#include <system/SystemLayer.h>
+#include <system/SystemLayerImplEpoll.h>
+
+#include <algorithm>
+#include <errno.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+// Choose an approximation of PTHREAD_NULL if pthread.h doesn't define one.
+#if CHIP_SYSTEM_CONFIG_POSIX_LOCKING && !defined(PTHREAD_NULL)
+#define PTHREAD_NULL 0
+#endif // CHIP_SYSTEM_CONFIG_POSIX_LOCKING && !defined(PTHREAD_NULL)
+
+namespace chip {
+namespace System {
+
+constexpr Clock::Seconds64 kDefaultMinSleepPeriod = Clock::Seconds64(60 * 60 * 24 * 30); // Month [sec]
+
+CHIP_ERROR LayerImplEpoll::Init()
+{
+    VerifyOrReturnError(mLayerState.SetInitializing(), CHIP_ERROR_INCORRECT_STATE);
+
+    RegisterPOSIXErrorFormatter();
+
+    for (auto & w : mSocketWatchPool)
+    {
+        w.Clear();
+    }
+
+#if CHIP_SYSTEM_CONFIG_POSIX_LOCKING
+    mHandleEventsThread = PTHREAD_NULL;
+#endif // CHIP_SYSTEM_CONFIG_POSIX_LOCKING
+
+    mWaitResult = 0;
+    mEventCount = 0;
+    mNextEvent  = 0;
+    mTimerArmed = false;
+
+    mEpollFD = epoll_create1(EPOLL_CLOEXEC);
+    // The eventfd lets an arbitrary thread wake the thread in epoll_wait().
+    mWakeFD  = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    mTimerFD = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+
+    CHIP_ERROR err = (mEpollFD < 0 || mWakeFD < 0 || mTimerFD < 0) ? CHIP_ERROR_POSIX(errno) : CHIP_NO_ERROR;
+    for (int * fd : { &mWakeFD, &mTimerFD })
+    {
+        if (err == CHIP_NO_ERROR)
+        {
+            // The internal descriptors are told apart from sockets by the address of the member holding them.
+            epoll_event event = {};
+            event.events      = EPOLLIN;
+            event.data.ptr    = fd;
+            if (epoll_ctl(mEpollFD, EPOLL_CTL_ADD, *fd, &event) != 0)
+            {
+                err = CHIP_ERROR_POSIX(errno);
+            }
+        }
+    }
+    if (err != CHIP_NO_ERROR)
+    {
+        CloseDescriptors();
+        return err;
+    }
+
+    VerifyOrReturnError(mLayerState.SetInitialized(), CHIP_ERROR_INCORRECT_STATE);
+    return CHIP_NO_ERROR;
+}
+
+void LayerImplEpoll::Shutdown()
+{
+    VerifyOrReturn(mLayerState.SetShuttingDown());
+
+    mTimerList.Clear();
+    mTimerPool.ReleaseAll();
+
+    CloseDescriptors();
+
+    mLayerState.ResetFromShuttingDown(); // Return to uninitialized state to permit re-initialization.
+}
+
+void LayerImplEpoll::CloseDescriptors()
+{
+    for (int * fd : { &mTimerFD, &mWakeFD, &mEpollFD })
+    {
+        if (*fd != kInvalidFd)
+        {
+            VerifyOrDie(::close(*fd) == 0);
+            *fd = kInvalidFd;
+        }
+    }
+}
+
+void LayerImplEpoll::Signal()
+{
+    /*
+     * Wake up the I/O thread by adding to the eventfd counter.
+     *
+     * If this is being called from within an I/O event callback, then the write can be skipped,
+     * since the I/O thread is already awake and will recompute its wake time in PrepareEvents().
+     *
+     * EAGAIN only means the counter is saturated, in which case the eventfd is readable anyway.
+     */
+#if CHIP_SYSTEM_CONFIG_POSIX_LOCKING
+    if (pthread_equal(mHandleEventsThread, pthread_self()))
+    {
+        return;
+    }
+#endif // CHIP_SYSTEM_CONFIG_POSIX_LOCKING
+
+    uint64_t value = 1;
+    if (::write(mWakeFD, &value, sizeof(value)) < 0 && errno != EAGAIN)
+    {
+        ChipLogError(chipSystemLayer, "System wake event notify failed: %" CHIP_ERROR_FORMAT, CHIP_ERROR_POSIX(errno).Format());
+    }
+}
+
+CHIP_ERROR LayerImplEpoll::StartTimer(Clock::Timeout delay, TimerCompleteCallback onComplete, void * appState)
+{
+    assertChipStackLockedByCurrentThread();
+
+    VerifyOrReturnError(mLayerState.IsInitialized(), CHIP_ERROR_INCORRECT_STATE);
+
+    CHIP_SYSTEM_FAULT_INJECT(FaultInjection::kFault_TimeoutImmediate, delay = System::Clock::kZero);
+
+    CancelTimer(onComplete, appState);
+
+    TimerList::Node * timer = mTimerPool.Create(*this, SystemClock().GetMonotonicTimestamp() + delay, onComplete, appState);
+    VerifyOrReturnError(timer != nullptr, CHIP_ERROR_NO_MEMORY);
+
+    if (mTimerList.Add(timer) == timer)
+    {
+        // The new timer is the earliest, so the timerfd has to be re-armed.
+        Signal();
+    }
+
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR LayerImplEpoll::ExtendTimerTo(Clock::Timeout delay, TimerCompleteCallback onComplete, void * appState)
+{
+    VerifyOrReturnError(delay.count() > 0, CHIP_ERROR_INVALID_ARGUMENT);
+
+    assertChipStackLockedByCurrentThread();
+
+    Clock::Timeout remainingTime = mTimerList.GetRemainingTime(onComplete, appState);
+    if (remainingTime.count() < delay.count())
+    {
+        // Just call StartTimer; it will invoke CancelTimer(), then start a new timer.  That handles
+        // all the various "timer was about to fire" edge cases correctly too.
+        return StartTimer(delay, onComplete, appState);
+    }
+
+    return CHIP_NO_ERROR;
+}
+
+bool LayerImplEpoll::IsTimerActive(TimerCompleteCallback onComplete, void * appState)
+{
+    bool timerIsActive = (mTimerList.GetRemainingTime(onComplete, appState) > Clock::kZero);
+
+    if (!timerIsActive)
+    {
+        // check if the timer is in the mExpiredTimers list about to be fired.
+        timerIsActive = (mExpiredTimers.Find(onComplete, appState) != nullptr);
+    }
+
+    return timerIsActive;
+}
+
+Clock::Timeout LayerImplEpoll::GetRemainingTime(TimerCompleteCallback onComplete, void * appState)
+{
+    return mTimerList.GetRemainingTime(onComplete, appState);
+}
+
+void LayerImplEpoll::CancelTimer(TimerCompleteCallback onComplete, void * appState)
+{
+    assertChipStackLockedByCurrentThread();
+
+    VerifyOrReturn(mLayerState.IsInitialized());
+
+    TimerList::Node * timer = mTimerList.Remove(onComplete, appState);
+    if (timer == nullptr)
+    {
+        // The timer was not in our "will fire in the future" list, but it might
+        // be in the "we're about to fire these" chunk we already grabbed from
+        // that list.  Check for it there too, and if found there we still want
+        // to cancel it.
+        timer = mExpiredTimers.Remove(onComplete, appState);
+    }
+    VerifyOrReturn(timer != nullptr);
+
+    mTimerPool.Release(timer);
+    Signal();
+}
+
+CHIP_ERROR LayerImplEpoll::ScheduleWork(TimerCompleteCallback onComplete, void * appState)
+{
+    assertChipStackLockedByCurrentThread();
+
+    VerifyOrReturnError(mLayerState.IsInitialized(), CHIP_ERROR_INCORRECT_STATE);
+
+    // Same as LayerImplSelect: an expires-ASAP timer serves as the closure, and existing timers
+    // with the same callback and appState are not cancelled.
+    TimerList::Node * timer = mTimerPool.Create(*this, SystemClock().GetMonotonicTimestamp(), onComplete, appState);
+    VerifyOrReturnError(timer != nullptr, CHIP_ERROR_NO_MEMORY);
+
+    if (mTimerList.Add(timer) == timer)
+    {
+        // The new timer is the earliest, so the timerfd has to be re-armed.
+        Signal();
+    }
+
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR LayerImplEpoll::StartWatchingSocket(int fd, SocketWatchToken * tokenOut)
+{
+    // Find a free slot.
+    SocketWatch * watch = nullptr;
+    for (auto & w : mSocketWatchPool)
+    {
+        if (w.mFD == fd)
+        {
+            // Already registered, return the existing token
+            *tokenOut = reinterpret_cast<SocketWatchToken>(&w);
+            return CHIP_NO_ERROR;
+        }
+        if ((w.mFD == kInvalidFd) && (watch == nullptr))
+        {
+            watch = &w;
+        }
+    }
+    VerifyOrReturnError(watch != nullptr, CHIP_ERROR_ENDPOINT_POOL_FULL);
+
+    // The descriptor only joins the epoll set once a callback is requested: epoll always reports
+    // EPOLLERR and EPOLLHUP, which select() would not for a socket nobody is waiting on.
+    watch->mFD = fd;
+
+    *tokenOut = reinterpret_cast<SocketWatchToken>(watch);
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR LayerImplEpoll::SetCallback(SocketWatchToken token, SocketWatchCallback callback, intptr_t data)
+{
+    SocketWatch * watch = reinterpret_cast<SocketWatch *>(token);
+    VerifyOrReturnError(watch != nullptr, CHIP_ERROR_INVALID_ARGUMENT);
+
+    watch->mCallback     = callback;
+    watch->mCallbackData = data;
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR LayerImplEpoll::RequestCallbackOnPendingRead(SocketWatchToken token)
+{
+    SocketWatch * watch = reinterpret_cast<SocketWatch *>(token);
+    VerifyOrReturnError(watch != nullptr, CHIP_ERROR_INVALID_ARGUMENT);
+    VerifyOrReturnError(!watch->mPendingIO.Has(SocketEventFlags::kRead), CHIP_NO_ERROR);
+
+    watch->mPendingIO.Set(SocketEventFlags::kRead);
+    return UpdateInterest(*watch);
+}
+
+CHIP_ERROR LayerImplEpoll::RequestCallbackOnPendingWrite(SocketWatchToken token)
+{
+    SocketWatch * watch = reinterpret_cast<SocketWatch *>(token);
+    VerifyOrReturnError(watch != nullptr, CHIP_ERROR_INVALID_ARGUMENT);
+    VerifyOrReturnError(!watch->mPendingIO.Has(SocketEventFlags::kWrite), CHIP_NO_ERROR);
+
+    watch->mPendingIO.Set(SocketEventFlags::kWrite);
+    return UpdateInterest(*watch);
+}
+
+CHIP_ERROR LayerImplEpoll::ClearCallbackOnPendingRead(SocketWatchToken token)
+{
+    SocketWatch * watch = reinterpret_cast<SocketWatch *>(token);
+    VerifyOrReturnError(watch != nullptr, CHIP_ERROR_INVALID_ARGUMENT);
+    VerifyOrReturnError(watch->mPendingIO.Has(SocketEventFlags::kRead), CHIP_NO_ERROR);
+
+    watch->mPendingIO.Clear(SocketEventFlags::kRead);
+    return UpdateInterest(*watch);
+}
+
+CHIP_ERROR LayerImplEpoll::ClearCallbackOnPendingWrite(SocketWatchToken token)
+{
+    SocketWatch * watch = reinterpret_cast<SocketWatch *>(token);
+    VerifyOrReturnError(watch != nullptr, CHIP_ERROR_INVALID_ARGUMENT);
+    VerifyOrReturnError(watch->mPendingIO.Has(SocketEventFlags::kWrite), CHIP_NO_ERROR);
+
+    watch->mPendingIO.Clear(SocketEventFlags::kWrite);
+    return UpdateInterest(*watch);
+}
+
+CHIP_ERROR LayerImplEpoll::StopWatchingSocket(SocketWatchToken * tokenInOut)
+{
+    SocketWatch * watch = reinterpret_cast<SocketWatch *>(*tokenInOut);
+    *tokenInOut         = InvalidSocketWatchToken();
+
+    VerifyOrReturnError(watch != nullptr, CHIP_ERROR_INVALID_ARGUMENT);
+    VerifyOrReturnError(watch->mFD >= 0, CHIP_ERROR_INCORRECT_STATE);
+
+    if (watch->mInEpoll)
+    {
+        // Fails with EBADF if the socket was closed first, in which case the kernel already dropped it.
+        (void) epoll_ctl(mEpollFD, EPOLL_CTL_DEL, watch->mFD, nullptr);
+    }
+    ForgetPendingEvents(*watch);
+    watch->Clear();
+
+    return CHIP_NO_ERROR;
+}
+
+CHIP_ERROR LayerImplEpoll::UpdateInterest(SocketWatch & watch)
+{
+    epoll_event event = {};
+    event.events      = (watch.mPendingIO.Has(SocketEventFlags::kRead) ? EPOLLIN : 0u) |
+        (watch.mPendingIO.Has(SocketEventFlags::kWrite) ? EPOLLOUT : 0u);
+    event.data.ptr = &watch;
+
+    int op;
+    if (event.events == 0)
+    {
+        VerifyOrReturnError(watch.mInEpoll, CHIP_NO_ERROR);
+        op = EPOLL_CTL_DEL;
+        // A readiness already returned by epoll_wait() must not be reported after the callback was cleared.
+        ForgetPendingEvents(watch);
+    }
+    else
+    {
+        op = watch.mInEpoll ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+    }
+
+    // Unlike select(), the interest set lives in the kernel, so no Signal() is needed: a thread blocked
+    // in epoll_wait() sees the change immediately.
+    if (epoll_ctl(mEpollFD, op, watch.mFD, &event) != 0)
+    {
+        return CHIP_ERROR_POSIX(errno);
+    }
+    watch.mInEpoll = (op != EPOLL_CTL_DEL);
+    return CHIP_NO_ERROR;
+}
+
+void LayerImplEpoll::ForgetPendingEvents(const SocketWatch & watch)
+{
+    for (int i = mNextEvent; i < mEventCount; ++i)
+    {
+        if (mEvents[i].data.ptr == &watch)
+        {
+            mEvents[i].data.ptr = nullptr;
+        }
+    }
+}
+
+/**
+ *  Translate the events reported by epoll_wait() for a socket into SocketEvents.
+ *
+ *  EPOLLHUP is reported as readable, matching select(), so that the endpoint reads and sees the end of stream.
+ *
+ *  @param[in]    events    The epoll_event::events bits.
+ */
+SocketEvents LayerImplEpoll::SocketEventsFromEpoll(uint32_t events)
+{
+    SocketEvents res;
+
+    if (events & (EPOLLIN | EPOLLHUP))
+        res.Set(SocketEventFlags::kRead);
+    if (events & EPOLLOUT)
+        res.Set(SocketEventFlags::kWrite);
+    if (events & (EPOLLERR | EPOLLPRI))
+        res.Set(SocketEventFlags::kExcept);
+
+    return res;
+}
+
+enum : intptr_t
+{
+    kLoopHandlerInactive = 0, // default value for EventLoopHandler::mState
+    kLoopHandlerPending,
+    kLoopHandlerActive,
+};
+
+void LayerImplEpoll::AddLoopHandler(EventLoopHandler & handler)
+{
+    // Add the handler as pending because this method can be called at any point
+    // in a PrepareEvents() / WaitForEvents() / HandleEvents() sequence.
+    // It will be marked active when we call PrepareEvents() on it for the first time.
+    auto & state = LoopHandlerState(handler);
+    VerifyOrDie(state == kLoopHandlerInactive);
+    state = kLoopHandlerPending;
+    mLoopHandlers.PushBack(&handler);
+}
+
+void LayerImplEpoll::RemoveLoopHandler(EventLoopHandler & handler)
+{
+    mLoopHandlers.Remove(&handler);
+    LoopHandlerState(handler) = kLoopHandlerInactive;
+}
+
+void LayerImplEpoll::PrepareEvents()
+{
+    assertChipStackLockedByCurrentThread();
+
+    const Clock::Timestamp currentTime = SystemClock().GetMonotonicTimestamp();
+    Clock::Timestamp awakenTime        = currentTime + kDefaultMinSleepPeriod;
+
+    TimerList::Node * timer = mTimerList.Earliest();
+    if (timer)
+    {
+        awakenTime = std::min(awakenTime, timer->AwakenTime());
+    }
+
+    // Activate added EventLoopHandlers and call PrepareEvents on active handlers.
+    auto loopIter = mLoopHandlers.begin();
+    while (loopIter != mLoopHandlers.end())
+    {
+        auto & loop = *loopIter++; // advance before calling out, in case a list modification clobbers the `next` pointer
+        switch (auto & state = LoopHandlerState(loop))
+        {
+        case kLoopHandlerPending:
+            state = kLoopHandlerActive;
+            [[fallthrough]];
+        case kLoopHandlerActive:
+            awakenTime = std::min(awakenTime, loop.PrepareEvents(currentTime));
+            break;
+        }
+    }
+
+    const Clock::Timestamp sleepTime = (awakenTime > currentTime) ? (awakenTime - currentTime) : Clock::kZero;
+    ArmTimer(awakenTime, sleepTime);
+}
+
+void LayerImplEpoll::ArmTimer(Clock::Timestamp awakenTime, Clock::Timeout sleepTime)
+{
+    // Most loop iterations keep the same earliest timer; skip the syscall then. A due wake time is always
+    // re-armed, in case a mock clock moved past it faster than the timerfd.
+    VerifyOrReturn(!mTimerArmed || awakenTime != mArmedAwakenTime || sleepTime == Clock::kZero);
+
+    // The timer is relative, like the select() timeout, so it follows SystemClock() even when that is mocked.
+    // A zero it_value would disarm the timerfd, so an overdue wake time fires after 1 ns instead.
+    const Clock::Microseconds64 sleepMicros = sleepTime;
+    itimerspec spec                         = {};
+    spec.it_value.tv_sec                    = static_cast<time_t>(sleepMicros.count() / kMicrosecondsPerSecond);
+    spec.it_value.tv_nsec = static_cast<long>((sleepMicros.count() % kMicrosecondsPerSecond) * kNanosecondsPerMicrosecond);
+    if (spec.it_value.tv_sec == 0 && spec.it_value.tv_nsec == 0)
+    {
+        spec.it_value.tv_nsec = 1;
+    }
+
+    if (timerfd_settime(mTimerFD, 0, &spec, nullptr) != 0)
+    {
+        ChipLogError(chipSystemLayer, "timerfd_settime failed: %" CHIP_ERROR_FORMAT, CHIP_ERROR_POSIX(errno).Format());
+        mTimerArmed = false;
+        return;
+    }
+    mTimerArmed      = true;
+    mArmedAwakenTime = awakenTime;
+}
+
+void LayerImplEpoll::WaitForEvents()
+{
+    // Timers are delivered through the timerfd, so there is no timeout.
+    mWaitResult    = epoll_wait(mEpollFD, mEvents, kMaxEvents, -1);
+    mWaitErrorCode = (mWaitResult < 0) ? errno : 0;
+}
+
+void LayerImplEpoll::HandleEvents()
+{
+    assertChipStackLockedByCurrentThread();
+
+    if (!IsSelectResultValid())
+    {
+        // A signal interrupting the wait is not an error; the next iteration waits again.
+        if (mWaitErrorCode != EINTR)
+        {
+            ChipLogError(DeviceLayer, "epoll_wait failed: %" CHIP_ERROR_FORMAT, CHIP_ERROR_POSIX(mWaitErrorCode).Format());
+        }
+        return;
+    }
+
+#if CHIP_SYSTEM_CONFIG_POSIX_LOCKING
+    mHandleEventsThread = pthread_self();
+#endif // CHIP_SYSTEM_CONFIG_POSIX_LOCKING
+
+    mEventCount = mWaitResult;
+    mNextEvent  = 0;
+
+    // Consume the internal descriptors first, so that a Signal() or timer expiry from here on wakes
+    // the next epoll_wait().
+    for (int i = 0; i < mEventCount; ++i)
+    {
+        uint64_t value;
+        if (mEvents[i].data.ptr == &mWakeFD)
+        {
+            (void) ::read(mWakeFD, &value, sizeof(value));
+            mEvents[i].data.ptr = nullptr;
+        }
+        else if (mEvents[i].data.ptr == &mTimerFD)
+        {
+            (void) ::read(mTimerFD, &value, sizeof(value));
+            mEvents[i].data.ptr = nullptr;
+            mTimerArmed         = false;
+        }
+    }
+
+    // Obtain the list of currently expired timers. Any new timers added by timer callback are NOT handled on this pass,
+    // since that could result in infinite handling of new timers blocking any other progress.
+    VerifyOrDieWithMsg(mExpiredTimers.Empty(), DeviceLayer, "Re-entry into HandleEvents from a timer callback?");
+    mExpiredTimers          = mTimerList.ExtractEarlier(Clock::Timeout(1) + SystemClock().GetMonotonicTimestamp());
+    TimerList::Node * timer = nullptr;
+    while ((timer = mExpiredTimers.PopEarliest()) != nullptr)
+    {
+        mTimerPool.Invoke(timer);
+    }
+
+    // Process socket events. Only the ready sockets are visited; callbacks that stop or clear a watch
+    // remove its remaining events through ForgetPendingEvents().
+    while (mNextEvent < mEventCount)
+    {
+        const epoll_event & event = mEvents[mNextEvent++];
+        SocketWatch * watch       = static_cast<SocketWatch *>(event.data.ptr);
+        if (watch != nullptr && watch->mFD != kInvalidFd && watch->mCallback != nullptr)
+        {
+            SocketEvents events = SocketEventsFromEpoll(event.events);
+            if (events.HasAny())
+            {
+                watch->mCallback(events, watch->mCallbackData);
+            }
+        }
+    }
+    mEventCount = 0;
+    mNextEvent  = 0;
+
+    // Call HandleEvents for active loop handlers
+    auto loopIter = mLoopHandlers.begin();
+    while (loopIter != mLoopHandlers.end())
+    {
+        auto & loop = *loopIter++; // advance before calling out, in case a list modification clobbers the `next` pointer
+        if (LoopHandlerState(loop) == kLoopHandlerActive)
+        {
+            loop.HandleEvents();
+        }
+    }
+
+#if CHIP_SYSTEM_CONFIG_POSIX_LOCKING
+    mHandleEventsThread = PTHREAD_NULL;
+#endif // CHIP_SYSTEM_CONFIG_POSIX_LOCKING
+}
+
+void LayerImplEpoll::SocketWatch::Clear()
+{
+    mFD = kInvalidFd;
+    mPendingIO.ClearAll();
+    mCallback     = nullptr;
+    mCallbackData = 0;
+    mInEpoll      = false;
+}
+
+} // namespace System
+} // namespace chip
@@ -0,0 +1,160 @@
+/*
+ *
+ *    Copyright (c) 2025 Project CHIP Authors
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      This file declares an implementation of System::Layer using Linux epoll.
+ */
+
+#pragma once
+
+#include "system/SystemConfig.h"
+
+#if CHIP_SYSTEM_CONFIG_USE_LIBEV
+#error "LayerImplEpoll does not support CHIP_SYSTEM_CONFIG_USE_LIBEV; use LayerImplSelect"
+#endif // CHIP_SYSTEM_CONFIG_USE_LIBEV
+
+#include <sys/epoll.h>
+
+#if CHIP_SYSTEM_CONFIG_POSIX_LOCKING
+#include <atomic>
+#include <pthread.h>
+#endif // CHIP_SYSTEM_CONFIG_POSIX_LOCKING
+
+#include <lib/support/ObjectLifeCycle.h>
+#include <system/SystemLayer.h>
+#include <system/SystemTimer.h>
+
+namespace chip {
+namespace System {
+
+/**
+ * System::Layer for Linux built on epoll.
+ *
+ * Unlike LayerImplSelect, the kernel keeps the interest set: it only changes when a watch requests or clears
+ * read/write callbacks, and the loop only visits the sockets that are ready. The epoll_data of each registration
+ * points straight at its SocketWatch. Signal() writes an eventfd and the earliest timer (or loop handler wake)
+ * is armed on a timerfd, so epoll_wait() itself never needs a timeout.
+ *
+ * Sockets are level-triggered, like select(): endpoints read one datagram or chunk per callback and rely on
+ * being called again while data is pending.
+ */
+class LayerImplEpoll : public LayerSocketsLoop
+{
+public:
+    LayerImplEpoll() = default;
+    ~LayerImplEpoll() override { VerifyOrDie(mLayerState.Destroy()); }
+
+    // Layer overrides.
+    CHIP_ERROR Init() override;
+    void Shutdown() override;
+    bool IsInitialized() const override { return mLayerState.IsInitialized(); }
+    CHIP_ERROR StartTimer(Clock::Timeout delay, TimerCompleteCallback onComplete, void * appState) override;
+    CHIP_ERROR ExtendTimerTo(Clock::Timeout delay, TimerCompleteCallback onComplete, void * appState) override;
+    bool IsTimerActive(TimerCompleteCallback onComplete, void * appState) override;
+    Clock::Timeout GetRemainingTime(TimerCompleteCallback onComplete, void * appState) override;
+    void CancelTimer(TimerCompleteCallback onComplete, void * appState) override;
+    CHIP_ERROR ScheduleWork(TimerCompleteCallback onComplete, void * appState) override;
+
+    // LayerSocket overrides.
+    CHIP_ERROR StartWatchingSocket(int fd, SocketWatchToken * tokenOut) override;
+    CHIP_ERROR SetCallback(SocketWatchToken token, SocketWatchCallback callback, intptr_t data) override;
+    CHIP_ERROR RequestCallbackOnPendingRead(SocketWatchToken token) override;
+    CHIP_ERROR RequestCallbackOnPendingWrite(SocketWatchToken token) override;
+    CHIP_ERROR ClearCallbackOnPendingRead(SocketWatchToken token) override;
+    CHIP_ERROR ClearCallbackOnPendingWrite(SocketWatchToken token) override;
+    CHIP_ERROR StopWatchingSocket(SocketWatchToken * tokenInOut) override;
+    SocketWatchToken InvalidSocketWatchToken() override { return reinterpret_cast<SocketWatchToken>(nullptr); }
+
+    // LayerSocketLoop overrides.
+    void Signal() override;
+    void EventLoopBegins() override {}
+    void PrepareEvents() override;
+    void WaitForEvents() override;
+    void HandleEvents() override;
+    void EventLoopEnds() override {}
+
+    void AddLoopHandler(EventLoopHandler & handler) override;
+    void RemoveLoopHandler(EventLoopHandler & handler) override;
+
+    // Expose the result of WaitForEvents() for non-blocking socket implementations.
+    bool IsSelectResultValid() const { return mWaitResult >= 0; }
+
+protected:
+    static SocketEvents SocketEventsFromEpoll(uint32_t events);
+
+    static constexpr int kSocketWatchMax = (INET_CONFIG_ENABLE_TCP_ENDPOINT ? INET_CONFIG_NUM_TCP_ENDPOINTS : 0) +
+        (INET_CONFIG_ENABLE_UDP_ENDPOINT ? INET_CONFIG_NUM_UDP_ENDPOINTS : 0);
+
+    // Every watch, plus the wake eventfd and the timerfd.
+    static constexpr int kMaxEvents = kSocketWatchMax + 2;
+
+    struct SocketWatch
+    {
+        void Clear();
+        int mFD;
+        SocketEvents mPendingIO;
+        SocketWatchCallback mCallback;
+        intptr_t mCallbackData;
+        bool mInEpoll; // Whether mFD is in the epoll interest set; only while mPendingIO is non-empty.
+    };
+    SocketWatch mSocketWatchPool[kSocketWatchMax];
+
+    // Adds, modifies or removes the watch in the epoll interest set to match its mPendingIO.
+    CHIP_ERROR UpdateInterest(SocketWatch & watch);
+    // Drops events for the watch that WaitForEvents() returned but HandleEvents() has not dispatched yet.
+    void ForgetPendingEvents(const SocketWatch & watch);
+    void ArmTimer(Clock::Timestamp awakenTime, Clock::Timeout sleepTime);
+    void CloseDescriptors();
+
+    TimerPool<TimerList::Node> mTimerPool;
+    TimerList mTimerList;
+    // List of expired timers being processed right now.  Stored in a member so
+    // we can cancel them.
+    TimerList mExpiredTimers;
+
+    IntrusiveList<EventLoopHandler> mLoopHandlers;
+
+    int mEpollFD = kInvalidFd;
+    int mWakeFD  = kInvalidFd; // eventfd written by Signal()
+    int mTimerFD = kInvalidFd; // timerfd armed for the next wake time
+
+    // The wake time the timerfd is armed for, so PrepareEvents() only re-arms it when it changes.
+    Clock::Timestamp mArmedAwakenTime;
+    bool mTimerArmed = false;
+
+    // Result of epoll_wait(), carried between WaitForEvents() and HandleEvents().
+    epoll_event mEvents[kMaxEvents];
+    int mWaitResult    = 0;
+    int mWaitErrorCode = 0;
+
+    // The events HandleEvents() is dispatching. Only touched with the stack lock held, unlike the
+    // above, which WaitForEvents() writes without it.
+    int mEventCount = 0;
+    int mNextEvent  = 0;
+
+    ObjectLifeCycle mLayerState;
+
+#if CHIP_SYSTEM_CONFIG_POSIX_LOCKING
+    std::atomic<pthread_t> mHandleEventsThread;
+#endif // CHIP_SYSTEM_CONFIG_POSIX_LOCKING
+};
+
+using LayerImpl = LayerImplEpoll;
+
+} // namespace System
+} // namespace chip
@@ -109,6 +109,144 @@ PacketBuffer * PacketBuffer::BuildFreeList()
 // Heap allocation for PacketBuffer objects.
 //
 
+#if CHIP_SYSTEM_CONFIG_PACKETBUFFER_SIZE_CLASS_CACHE
+
+namespace {
+
+struct PacketBufferSizeClass
+{
+    size_t capacity;   // Largest alloc_size served by the class; every block of the class has room for this much.
+    size_t cacheDepth; // Free blocks of the class that each thread keeps for reuse.
+};
+
+constexpr PacketBufferSizeClass kSizeClasses[] = { CHIP_SYSTEM_CONFIG_PACKETBUFFER_SIZE_CLASSES };
+constexpr size_t kSizeClassCount               = sizeof(kSizeClasses) / sizeof(kSizeClasses[0]);
+
+constexpr bool SizeClassesAscend(size_t index = 1)
+{
+    return (index >= kSizeClassCount) ||
+        ((kSizeClasses[index - 1].capacity < kSizeClasses[index].capacity) && SizeClassesAscend(index + 1));
+}
+static_assert(SizeClassesAscend(), "CHIP_SYSTEM_CONFIG_PACKETBUFFER_SIZE_CLASSES must be in increasing order of capacity");
+
+// Returns the smallest size class that holds allocSize bytes, or kSizeClassCount if none does.
+size_t SizeClassOf(size_t allocSize)
+{
+    size_t sizeClass = 0;
+    while ((sizeClass < kSizeClassCount) && (kSizeClasses[sizeClass].capacity < allocSize))
+    {
+        ++sizeClass;
+    }
+    return sizeClass;
+}
+
+// Free blocks of each size class. Every thread has its own cache, so neither allocation nor release takes a lock;
+// a buffer freed on another thread than the one that allocated it joins the cache of the freeing thread.
+class PacketBufferBlockCache
+{
+public:
+    ~PacketBufferBlockCache()
+    {
+        // The thread is exiting. Give the blocks back, and let later releases on this thread go to the heap.
+        mThreadExited = true;
+        for (size_t sizeClass = 0; sizeClass < kSizeClassCount; ++sizeClass)
+        {
+            while (void * block = Take(sizeClass))
+            {
+                chip::Platform::MemoryFree(block);
+            }
+        }
+    }
+
+    void * Take(size_t sizeClass)
+    {
+        FreeBlock * block = mFreeBlocks[sizeClass];
+        if (block != nullptr)
+        {
+            mFreeBlocks[sizeClass] = block->mNext;
+            --mCount[sizeClass];
+            SYSTEM_STATS_DECREMENT(chip::System::Stats::kSystemLayer_NumCachedPacketBufs);
+        }
+        return block;
+    }
+
+    bool Put(size_t sizeClass, void * block)
+    {
+        VerifyOrReturnValue(!mThreadExited && (mCount[sizeClass] < kSizeClasses[sizeClass].cacheDepth), false);
+
+        auto * freeBlock       = new (block) FreeBlock;
+        freeBlock->mNext       = mFreeBlocks[sizeClass];
+        mFreeBlocks[sizeClass] = freeBlock;
+        ++mCount[sizeClass];
+        SYSTEM_STATS_INCREMENT(chip::System::Stats::kSystemLayer_NumCachedPacketBufs);
+        return true;
+    }
+
+private:
+    struct FreeBlock
+    {
+        FreeBlock * mNext;
+    };
+
+    FreeBlock * mFreeBlocks[kSizeClassCount] = {};
+    size_t mCount[kSizeClassCount]           = {};
+    bool mThreadExited                       = false;
+};
+
+thread_local PacketBufferBlockCache sBlockCache;
+
+} // namespace
+
+PacketBuffer * PacketBuffer::AllocateBlock(size_t allocSize)
+{
+    const size_t sizeClass = SizeClassOf(allocSize);
+    if (sizeClass == kSizeClassCount)
+    {
+        return reinterpret_cast<PacketBuffer *>(chip::Platform::MemoryAlloc(kStructureSize + allocSize));
+    }
+
+    void * block = sBlockCache.Take(sizeClass);
+    if (block == nullptr)
+    {
+        block = chip::Platform::MemoryAlloc(kStructureSize + kSizeClasses[sizeClass].capacity);
+    }
+    return reinterpret_cast<PacketBuffer *>(block);
+}
+
+void PacketBuffer::FreeBlock(PacketBuffer * block, size_t allocSize)
+{
+    const size_t sizeClass = SizeClassOf(allocSize);
+    if ((sizeClass == kSizeClassCount) || !sBlockCache.Put(sizeClass, block))
+    {
+        chip::Platform::MemoryFree(block);
+    }
+}
+
+size_t PacketBuffer::BlockCapacity(size_t allocSize)
+{
+    const size_t sizeClass = SizeClassOf(allocSize);
+    return (sizeClass == kSizeClassCount) ? allocSize : kSizeClasses[sizeClass].capacity;
+}
+
+#else // CHIP_SYSTEM_CONFIG_PACKETBUFFER_SIZE_CLASS_CACHE
+
+PacketBuffer * PacketBuffer::AllocateBlock(size_t allocSize)
+{
+    return reinterpret_cast<PacketBuffer *>(chip::Platform::MemoryAlloc(kStructureSize + allocSize));
+}
+
+void PacketBuffer::FreeBlock(PacketBuffer * block, size_t /* allocSize */)
+{
+    chip::Platform::MemoryFree(block);
+}
+
+size_t PacketBuffer::BlockCapacity(size_t allocSize)
+{
+    return allocSize;
+}
+
+#endif // CHIP_SYSTEM_CONFIG_PACKETBUFFER_SIZE_CLASS_CACHE
+
 #if CHIP_SYSTEM_PACKETBUFFER_HAS_CHECK
 void PacketBuffer::InternalCheck(const PacketBuffer * buffer)
 {
@@ -138,13 +276,12 @@ void PacketBufferHandle::InternalRightSize()
     const uint8_t * const start   = mBuffer->ReserveStart();
     const uint8_t * const payload = mBuffer->Start();
     const size_t usedSize         = static_cast<size_t>(payload - start + static_cast<ptrdiff_t>(mBuffer->len));
-    if (usedSize + kRightSizingThreshold > mBuffer->alloc_size)
+    if (PacketBuffer::BlockCapacity(usedSize) + kRightSizingThreshold > PacketBuffer::BlockCapacity(mBuffer->alloc_size))
     {
         return;
     }
 
-    const size_t blockSize   = usedSize + PacketBuffer::kStructureSize;
-    PacketBuffer * newBuffer = reinterpret_cast<PacketBuffer *>(chip::Platform::MemoryAlloc(blockSize));
+    PacketBuffer * newBuffer = PacketBuffer::AllocateBlock(usedSize);
     if (newBuffer == nullptr)
     {
         ChipLogError(chipSystemLayer, "PacketBuffer: pool EMPTY.");
@@ -616,10 +753,9 @@ PacketBufferHandle PacketBufferHandle::New(size_t aAvailableSize, uint16_t aRese
     UNLOCK_BUF_POOL();
 
 #elif CHIP_SYSTEM_PACKETBUFFER_FROM_CHIP_HEAP
-    // sumOfSizes is essentially (kStructureSize + lAllocSize) which we already
-    // checked to fit in a size_t.
-    const size_t lBlockSize = static_cast<size_t>(sumOfSizes);
-    lPacket                 = reinterpret_cast<PacketBuffer *>(chip::Platform::MemoryAlloc(lBlockSize));
+    // The block is (kStructureSize + lAllocSize), i.e. sumOfSizes, which we already
+    // checked to fit in a size_t; a size class can only round it up to a configured size.
+    lPacket = PacketBuffer::AllocateBlock(lAllocSize);
 
 #else
 #error "Unimplemented PacketBuffer storage case"
@@ -700,13 +836,14 @@ void PacketBuffer::Free(PacketBuffer * aPacket)
             SYSTEM_STATS_DECREMENT(chip::System::Stats::kSystemLayer_NumPacketBufs);
 #if CHIP_SYSTEM_PACKETBUFFER_FROM_CHIP_HEAP
             ::chip::Platform::MemoryDebugCheckPointer(aPacket, aPacket->alloc_size + kStructureSize);
+            const size_t lAllocSize = aPacket->alloc_size;
 #endif
             aPacket->Clear();
 #if CHIP_SYSTEM_PACKETBUFFER_FROM_CHIP_POOL
             aPacket->next = sFreeList;
             sFreeList     = aPacket;
 #elif CHIP_SYSTEM_PACKETBUFFER_FROM_CHIP_HEAP
-            chip::Platform::MemoryFree(aPacket);
+            FreeBlock(aPacket, lAllocSize);
 #endif
             aPacket       = lNextPacket;
         }
@@ -387,6 +387,14 @@ private:
     static PacketBuffer * BuildFreeList();
 #endif // CHIP_SYSTEM_PACKETBUFFER_FROM_CHIP_POOL || defined(DOXYGEN)
 
+#if CHIP_SYSTEM_PACKETBUFFER_FROM_CHIP_HEAP
+    // Heap blocks for buffers with `allocSize` bytes of reserve and data. The block may be larger than requested when
+    // CHIP_SYSTEM_CONFIG_PACKETBUFFER_SIZE_CLASS_CACHE rounds it up to a size class; BlockCapacity() says how large.
+    static PacketBuffer * AllocateBlock(size_t allocSize);
+    static void FreeBlock(PacketBuffer * block, size_t allocSize);
+    static size_t BlockCapacity(size_t allocSize);
+#endif // CHIP_SYSTEM_PACKETBUFFER_FROM_CHIP_HEAP
+
 #if CHIP_SYSTEM_PACKETBUFFER_HAS_CHECK
     static void InternalCheck(const PacketBuffer * buffer);
 #endif
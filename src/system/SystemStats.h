@@ -54,6 +54,9 @@ enum
 #undef LWIP_PBUF_MEMPOOL
 #else
     kSystemLayer_NumPacketBufs,
+#endif
+#if CHIP_SYSTEM_CONFIG_PACKETBUFFER_SIZE_CLASS_CACHE
+    kSystemLayer_NumCachedPacketBufs,
 #endif
     kSystemLayer_NumTimers,
 #if INET_CONFIG_NUM_TCP_ENDPOINTS
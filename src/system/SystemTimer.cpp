@@ -38,83 +38,197 @@
 namespace chip {
 namespace System {
 
-TimerList::Node * TimerList::Add(TimerList::Node * add)
+void TimerList::ClearBuckets()
 {
-    VerifyOrDie(add != mEarliestTimer);
-    if (mEarliestTimer == nullptr || (add->AwakenTime() < mEarliestTimer->AwakenTime()))
+    for (auto & bucket : mBuckets)
     {
-        add->mNextTimer = mEarliestTimer;
-        mEarliestTimer  = add;
+        bucket = nullptr;
     }
-    else
+}
+
+size_t TimerList::Bucket(TimerCompleteCallback aOnComplete, void * aAppState)
+{
+    // Callbacks are few and app states are objects, so mix both and keep the high bits of a Fibonacci hash.
+    uint64_t key = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(aOnComplete)) ^
+        (static_cast<uint64_t>(reinterpret_cast<uintptr_t>(aAppState)) * 31u);
+    key *= 0x9E3779B97F4A7C15ull;
+    return static_cast<size_t>(key >> 32) & (kBucketCount - 1);
+}
+
+bool TimerList::IsEarlier(const Node * a, const Node * b)
+{
+    if (a->AwakenTime() != b->AwakenTime())
+    {
+        return a->AwakenTime() < b->AwakenTime();
+    }
+    // Same expiration time: the one added first, allowing for the sequence wrapping around.
+    return static_cast<int32_t>(a->mSequence - b->mSequence) < 0;
+}
+
+TimerList::Node * TimerList::Meld(Node * a, Node * b)
+{
+    if (a == nullptr)
+    {
+        return b;
+    }
+    if (b == nullptr)
+    {
+        return a;
+    }
+    if (IsEarlier(b, a))
     {
-        TimerList::Node * lTimer = mEarliestTimer;
-        while (lTimer->mNextTimer)
+        Node * swap = a;
+        a           = b;
+        b           = swap;
+    }
+
+    // b becomes the first child of a.
+    b->mPrev    = a;
+    b->mSibling = a->mChild;
+    if (a->mChild != nullptr)
+    {
+        a->mChild->mPrev = b;
+    }
+    a->mChild = b;
+    return a;
+}
+
+TimerList::Node * TimerList::MergePairs(Node * first)
+{
+    // First pass: meld the siblings in pairs from left to right, stacking the results through mSibling.
+    Node * pairs = nullptr;
+    while (first != nullptr)
+    {
+        Node * a = first;
+        Node * b = a->mSibling;
+        first    = (b != nullptr) ? b->mSibling : nullptr;
+
+        a->mSibling = a->mPrev = nullptr;
+        if (b != nullptr)
         {
-            VerifyOrDie(lTimer->mNextTimer != add);
-            if (add->AwakenTime() < lTimer->mNextTimer->AwakenTime())
-            {
-                // found the insert location.
-                break;
-            }
-            lTimer = lTimer->mNextTimer;
+            b->mSibling = b->mPrev = nullptr;
         }
-        add->mNextTimer    = lTimer->mNextTimer;
-        lTimer->mNextTimer = add;
+        Node * pair    = Meld(a, b);
+        pair->mSibling = pairs;
+        pairs          = pair;
     }
-    return mEarliestTimer;
+
+    // Second pass: meld the pairs from right to left.
+    Node * root = nullptr;
+    while (pairs != nullptr)
+    {
+        Node * next     = pairs->mSibling;
+        pairs->mSibling = nullptr;
+        root            = Meld(root, pairs);
+        pairs           = next;
+    }
+    return root;
 }
 
-TimerList::Node * TimerList::Remove(TimerList::Node * remove)
+bool TimerList::Contains(const Node * node) const
 {
-    if (mEarliestTimer != nullptr && remove != nullptr)
+    const Node * entry = mBuckets[Bucket(node->GetCallback().GetOnComplete(), node->GetCallback().GetAppState())];
+    while (entry != nullptr && entry != node)
+    {
+        entry = entry->mHashNext;
+    }
+    return entry != nullptr;
+}
+
+void TimerList::Unlink(Node * node)
+{
+    // Take the node out of the heap; its children are merged back in.
+    if (node == mEarliestTimer)
+    {
+        mEarliestTimer = MergePairs(node->mChild);
+    }
+    else
     {
-        if (remove == mEarliestTimer)
+        if (node->mPrev->mChild == node)
         {
-            mEarliestTimer = remove->mNextTimer;
+            node->mPrev->mChild = node->mSibling;
         }
         else
         {
-            TimerList::Node * lTimer = mEarliestTimer;
-
-            while (lTimer->mNextTimer)
-            {
-                if (remove == lTimer->mNextTimer)
-                {
-                    lTimer->mNextTimer = remove->mNextTimer;
-                    break;
-                }
-
-                lTimer = lTimer->mNextTimer;
-            }
+            node->mPrev->mSibling = node->mSibling;
+        }
+        if (node->mSibling != nullptr)
+        {
+            node->mSibling->mPrev = node->mPrev;
         }
+        mEarliestTimer = Meld(mEarliestTimer, MergePairs(node->mChild));
+    }
+
+    // And out of its hash chain.
+    if (node->mHashPrev != nullptr)
+    {
+        node->mHashPrev->mHashNext = node->mHashNext;
+    }
+    else
+    {
+        mBuckets[Bucket(node->GetCallback().GetOnComplete(), node->GetCallback().GetAppState())] = node->mHashNext;
+    }
+    if (node->mHashNext != nullptr)
+    {
+        node->mHashNext->mHashPrev = node->mHashPrev;
+    }
+
+    node->mChild = node->mSibling = node->mPrev = nullptr;
+    node->mHashNext = node->mHashPrev = nullptr;
+}
+
+TimerList::Node * TimerList::Add(TimerList::Node * add)
+{
+    VerifyOrDie(add != mEarliestTimer);
 
-        remove->mNextTimer = nullptr;
+    add->mChild = add->mSibling = add->mPrev = nullptr;
+    add->mSequence                           = mNextSequence++;
+
+    Node *& bucket = mBuckets[Bucket(add->GetCallback().GetOnComplete(), add->GetCallback().GetAppState())];
+    add->mHashPrev = nullptr;
+    add->mHashNext = bucket;
+    if (bucket != nullptr)
+    {
+        bucket->mHashPrev = add;
+    }
+    bucket = add;
+
+    mEarliestTimer = Meld(mEarliestTimer, add);
+    return mEarliestTimer;
+}
+
+TimerList::Node * TimerList::Remove(TimerList::Node * remove)
+{
+    if (remove != nullptr && Contains(remove))
+    {
+        Unlink(remove);
     }
     return mEarliestTimer;
 }
 
 TimerList::Node * TimerList::Remove(TimerCompleteCallback aOnComplete, void * aAppState)
 {
-    TimerList::Node * previous = nullptr;
-    for (TimerList::Node * timer = mEarliestTimer; timer != nullptr; timer = timer->mNextTimer)
+    TimerList::Node * timer = Find(aOnComplete, aAppState);
+    if (timer != nullptr)
     {
-        if (timer->GetCallback().GetOnComplete() == aOnComplete && timer->GetCallback().GetAppState() == aAppState)
+        Unlink(timer);
+    }
+    return timer;
+}
+
+TimerList::Node * TimerList::Find(TimerCompleteCallback aOnComplete, void * aAppState) const
+{
+    // Several timers may match (ScheduleWork() does not cancel); the first is the one that would fire first.
+    TimerList::Node * found = nullptr;
+    for (TimerList::Node * timer = mBuckets[Bucket(aOnComplete, aAppState)]; timer != nullptr; timer = timer->mHashNext)
+    {
+        if (timer->GetCallback().GetOnComplete() == aOnComplete && timer->GetCallback().GetAppState() == aAppState &&
+            (found == nullptr || IsEarlier(timer, found)))
         {
-            if (previous == nullptr)
-            {
-                mEarliestTimer = timer->mNextTimer;
-            }
-            else
-            {
-                previous->mNextTimer = timer->mNextTimer;
-            }
-            timer->mNextTimer = nullptr;
-            return timer;
+            found = timer;
         }
-        previous = timer;
     }
-    return nullptr;
+    return found;
 }
 
 TimerList::Node * TimerList::PopEarliest()
@@ -124,8 +238,7 @@ TimerList::Node * TimerList::PopEarliest()
         return nullptr;
     }
     TimerList::Node * earliest = mEarliestTimer;
-    mEarliestTimer             = mEarliestTimer->mNextTimer;
-    earliest->mNextTimer       = nullptr;
+    Unlink(earliest);
     return earliest;
 }
 
@@ -135,26 +248,18 @@ TimerList::Node * TimerList::PopIfEarlier(Clock::Timestamp t)
     {
         return nullptr;
     }
-    TimerList::Node * earliest = mEarliestTimer;
-    mEarliestTimer             = mEarliestTimer->mNextTimer;
-    earliest->mNextTimer       = nullptr;
-    return earliest;
+    return PopEarliest();
 }
 
 TimerList TimerList::ExtractEarlier(Clock::Timestamp t)
 {
     TimerList out;
 
-    if ((mEarliestTimer != nullptr) && (mEarliestTimer->AwakenTime() < t))
+    // Popped in order, so each one becomes a child of the first and the result is cheap to pop from.
+    TimerList::Node * timer;
+    while ((timer = PopIfEarlier(t)) != nullptr)
     {
-        out.mEarliestTimer    = mEarliestTimer;
-        TimerList::Node * end = mEarliestTimer;
-        while ((end->mNextTimer != nullptr) && (end->mNextTimer->AwakenTime() < t))
-        {
-            end = end->mNextTimer;
-        }
-        mEarliestTimer  = end->mNextTimer;
-        end->mNextTimer = nullptr;
+        out.Add(timer);
     }
 
     return out;
@@ -162,18 +267,16 @@ TimerList TimerList::ExtractEarlier(Clock::Timestamp t)
 
 Clock::Timeout TimerList::GetRemainingTime(TimerCompleteCallback aOnComplete, void * aAppState)
 {
-    for (TimerList::Node * timer = mEarliestTimer; timer != nullptr; timer = timer->mNextTimer)
+    TimerList::Node * timer = Find(aOnComplete, aAppState);
+    if (timer != nullptr)
     {
-        if (timer->GetCallback().GetOnComplete() == aOnComplete && timer->GetCallback().GetAppState() == aAppState)
-        {
-            Clock::Timestamp currentTime = SystemClock().GetMonotonicTimestamp();
+        Clock::Timestamp currentTime = SystemClock().GetMonotonicTimestamp();
 
-            if (currentTime < timer->AwakenTime())
-            {
-                return Clock::Timeout(timer->AwakenTime() - currentTime);
-            }
-            return Clock::kZero;
+        if (currentTime < timer->AwakenTime())
+        {
+            return Clock::Timeout(timer->AwakenTime() - currentTime);
         }
+        return Clock::kZero;
     }
     return Clock::kZero;
 }
@@ -104,7 +104,14 @@ private:
 };
 
 /**
- * List of `Timer`s ordered by expiration time.
+ * List of `Timer`s ordered by expiration time, indexed by callback and app state.
+ *
+ * The order is kept in an intrusive pairing heap: Add() is O(1), and removing the earliest or a given timer is
+ * O(log n) amortized. Each timer is also chained into a hash table keyed by (onComplete, appState), so
+ * Remove(onComplete, appState), Find() and GetRemainingTime() only visit the timers that share a bucket. All links
+ * live in the Node; nothing is allocated.
+ *
+ * Timers with the same expiration time come out in the order they were added.
  */
 class TimerList
 {
@@ -113,12 +120,24 @@ public:
     {
     public:
         Node(Layer & systemLayer, System::Clock::Timestamp awakenTime, TimerCompleteCallback onComplete, void * appState) :
-            TimerData(systemLayer, awakenTime, onComplete, appState), mNextTimer(nullptr)
+            TimerData(systemLayer, awakenTime, onComplete, appState)
         {}
-        Node * mNextTimer;
+
+    private:
+        friend class TimerList;
+
+        // Pairing heap links. mPrev is the parent for a first child, and the previous sibling otherwise.
+        Node * mChild   = nullptr;
+        Node * mSibling = nullptr;
+        Node * mPrev    = nullptr;
+        // Hash chain links.
+        Node * mHashNext = nullptr;
+        Node * mHashPrev = nullptr;
+        // Order of insertion, to break ties between equal expiration times.
+        uint32_t mSequence = 0;
     };
 
-    TimerList() : mEarliestTimer(nullptr) {}
+    TimerList() : mEarliestTimer(nullptr) { ClearBuckets(); }
 
     /**
      * Add a timer to the list
@@ -176,7 +195,18 @@ public:
     /**
      * Remove all timers.
      */
-    void Clear() { mEarliestTimer = nullptr; }
+    void Clear()
+    {
+        mEarliestTimer = nullptr;
+        ClearBuckets();
+    }
+
+    /**
+     * Find the first timer with the given properties, if present.
+     *
+     * @return  The timer, or nullptr if the list contains no matching timer.
+     */
+    Node * Find(TimerCompleteCallback aOnComplete, void * aAppState) const;
 
     /**
      * Find the timer with the given properties, if present, and return its remaining time
@@ -186,7 +216,22 @@ public:
     Clock::Timeout GetRemainingTime(TimerCompleteCallback aOnComplete, void * aAppState);
 
 private:
-    Node * mEarliestTimer;
+    static constexpr size_t kBucketCount = CHIP_SYSTEM_CONFIG_TIMER_LIST_HASH_BUCKETS;
+    static_assert(kBucketCount > 0 && (kBucketCount & (kBucketCount - 1)) == 0,
+                  "CHIP_SYSTEM_CONFIG_TIMER_LIST_HASH_BUCKETS must be a power of two");
+
+    static size_t Bucket(TimerCompleteCallback aOnComplete, void * aAppState);
+    static bool IsEarlier(const Node * a, const Node * b);
+    static Node * Meld(Node * a, Node * b);
+    static Node * MergePairs(Node * first);
+
+    void ClearBuckets();
+    bool Contains(const Node * node) const;
+    void Unlink(Node * node);
+
+    Node * mEarliestTimer; // Root of the heap
+    Node * mBuckets[kBucketCount];
+    uint32_t mNextSequence = 0;
 };
 
 /**
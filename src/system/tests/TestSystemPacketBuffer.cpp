@@ -128,6 +128,10 @@ public:
     }
     static void PrintHandle(const char * tag, const PacketBufferHandle & handle) { PrintHandle(tag, handle.mBuffer); }
 
+#if CHIP_SYSTEM_PACKETBUFFER_FROM_CHIP_HEAP
+    static size_t BlockCapacity(size_t allocSize) { return PacketBuffer::BlockCapacity(allocSize); }
+#endif // CHIP_SYSTEM_PACKETBUFFER_FROM_CHIP_HEAP
+
     struct BufferConfiguration
     {
         BufferConfiguration(uint16_t aReservedSize = 0) :
@@ -1719,6 +1723,48 @@ TEST_F_FROM_FIXTURE(TestSystemPacketBuffer, CheckHandleCloneData)
 #endif // CHIP_SYSTEM_PACKETBUFFER_FROM_CHIP_HEAP
 }
 
+#if CHIP_SYSTEM_PACKETBUFFER_FROM_CHIP_HEAP && CHIP_SYSTEM_CONFIG_PACKETBUFFER_SIZE_CLASS_CACHE
+TEST_F(TestSystemPacketBuffer, CheckSizeClassCache)
+{
+    // A freed block is reused for the next allocation of the same size class, whatever its exact size.
+    PacketBufferHandle handle = PacketBufferHandle::New(10, 0);
+    ASSERT_FALSE(handle.IsNull());
+    const uint8_t * const firstBlock = handle->Start();
+    handle                           = nullptr;
+
+    handle = PacketBufferHandle::New(20, 0);
+    ASSERT_FALSE(handle.IsNull());
+    EXPECT_EQ(handle->Start(), firstBlock);
+    EXPECT_EQ(handle->AllocSize(), 20u);
+    EXPECT_EQ(handle->AvailableDataLength(), 20u);
+    handle = nullptr;
+
+    // A buffer of a larger class does not take it.
+    PacketBufferHandle large = PacketBufferHandle::New(PacketBuffer::kMaxSizeWithoutReserve, 0);
+    ASSERT_FALSE(large.IsNull());
+    EXPECT_NE(large->Start(), firstBlock);
+
+    // Right-sizing into the same class is not worth a copy; into a smaller one it is.
+    large->SetDataLength(PacketBuffer::kMaxSizeWithoutReserve - 10);
+    const uint8_t * const largeBlock = large->Start();
+    large.RightSize();
+    EXPECT_EQ(large->Start(), largeBlock);
+
+    large->SetDataLength(4);
+    large.RightSize();
+    EXPECT_NE(large->Start(), largeBlock);
+    EXPECT_EQ(large->DataLength(), 4u);
+
+    // Large buffers are rounded up to a nearby class, not all the way to the largest one.
+    for (size_t allocSize = PacketBuffer::kMaxSizeWithoutReserve + 1; allocSize <= PacketBuffer::kLargeBufMaxSizeWithoutReserve;
+         allocSize *= 2)
+    {
+        EXPECT_GE(BlockCapacity(allocSize), allocSize);
+        EXPECT_LE(BlockCapacity(allocSize), 4 * allocSize);
+    }
+}
+#endif // CHIP_SYSTEM_PACKETBUFFER_FROM_CHIP_HEAP && CHIP_SYSTEM_CONFIG_PACKETBUFFER_SIZE_CLASS_CACHE
+
 TEST_F(TestSystemPacketBuffer, CheckPacketBufferWriter)
 {
     static const char kPayload[] = "Hello, world!";
@@ -0,0 +1,164 @@
+/*
+ *    Copyright (c) 2025 Project CHIP Authors
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      This file tests the socket watches of the sockets-based System::Layer
+ *      implementations (select and epoll).
+ */
+
+#include <pw_unit_test/framework.h>
+#include <system/SystemConfig.h>
+
+#if CHIP_SYSTEM_CONFIG_USE_SOCKETS && !CHIP_SYSTEM_CONFIG_USE_DISPATCH && CHIP_SYSTEM_CONFIG_USE_POSIX_SOCKETS
+// The fake PlatformManagerImpl does not drive the system layer event loop
+#if !CHIP_DEVICE_LAYER_TARGET_FAKE
+
+#include <unistd.h>
+
+#include <lib/support/CodeUtils.h>
+#include <platform/CHIPDeviceLayer.h>
+
+using namespace chip;
+using namespace chip::System::Clock::Literals;
+
+namespace {
+
+struct WatchedPipe
+{
+    int fds[2]                     = { -1, -1 };
+    System::SocketWatchToken token = 0;
+    int callbacks                  = 0;
+};
+
+class TestSystemSocketWatch : public ::testing::Test
+{
+public:
+    static void SetUpTestSuite()
+    {
+        ASSERT_EQ(Platform::MemoryInit(), CHIP_NO_ERROR);
+        ASSERT_EQ(DeviceLayer::PlatformMgr().InitChipStack(), CHIP_NO_ERROR);
+    }
+
+    static void TearDownTestSuite()
+    {
+        DeviceLayer::PlatformMgr().Shutdown();
+        Platform::MemoryShutdown();
+    }
+
+    static System::LayerSockets & SystemLayer() { return static_cast<System::LayerSockets &>(DeviceLayer::SystemLayer()); }
+
+    static void Open(WatchedPipe & pipe, System::SocketWatchCallback callback)
+    {
+        ASSERT_EQ(::pipe(pipe.fds), 0);
+        ASSERT_EQ(SystemLayer().StartWatchingSocket(pipe.fds[0], &pipe.token), CHIP_NO_ERROR);
+        ASSERT_EQ(SystemLayer().SetCallback(pipe.token, callback, reinterpret_cast<intptr_t>(&pipe)), CHIP_NO_ERROR);
+    }
+
+    static void Close(WatchedPipe & pipe)
+    {
+        if (pipe.token != SystemLayer().InvalidSocketWatchToken())
+        {
+            SystemLayer().StopWatchingSocket(&pipe.token);
+        }
+        ::close(pipe.fds[0]);
+        ::close(pipe.fds[1]);
+    }
+
+    static void MakeReadable(WatchedPipe & pipe) { ASSERT_EQ(::write(pipe.fds[1], "x", 1), 1); }
+
+    // Runs the event loop until a callback stops it, or for at most `limit`.
+    static void RunEventLoop(System::Clock::Timeout limit)
+    {
+        System::TimerCompleteCallback stop = [](System::Layer *, void *) { DeviceLayer::PlatformMgr().StopEventLoopTask(); };
+        DeviceLayer::SystemLayer().StartTimer(limit, stop, nullptr);
+        DeviceLayer::PlatformMgr().RunEventLoop();
+        DeviceLayer::SystemLayer().CancelTimer(stop, nullptr);
+    }
+};
+
+void ReadAndStop(System::SocketEvents events, intptr_t data)
+{
+    auto * pipe = reinterpret_cast<WatchedPipe *>(data);
+    char byte;
+    EXPECT_TRUE(events.Has(System::SocketEventFlags::kRead));
+    EXPECT_EQ(::read(pipe->fds[0], &byte, 1), 1);
+    pipe->callbacks++;
+    DeviceLayer::PlatformMgr().StopEventLoopTask();
+}
+
+} // namespace
+
+TEST_F(TestSystemSocketWatch, ReadCallback)
+{
+    WatchedPipe pipe;
+    Open(pipe, ReadAndStop);
+    EXPECT_EQ(SystemLayer().RequestCallbackOnPendingRead(pipe.token), CHIP_NO_ERROR);
+    MakeReadable(pipe);
+
+    RunEventLoop(1000_ms);
+    EXPECT_EQ(pipe.callbacks, 1);
+
+    Close(pipe);
+}
+
+TEST_F(TestSystemSocketWatch, ClearedReadIsNotReported)
+{
+    WatchedPipe pipe;
+    Open(pipe, ReadAndStop);
+    EXPECT_EQ(SystemLayer().RequestCallbackOnPendingRead(pipe.token), CHIP_NO_ERROR);
+    EXPECT_EQ(SystemLayer().ClearCallbackOnPendingRead(pipe.token), CHIP_NO_ERROR);
+    MakeReadable(pipe);
+
+    RunEventLoop(100_ms);
+    EXPECT_EQ(pipe.callbacks, 0);
+
+    Close(pipe);
+}
+
+TEST_F(TestSystemSocketWatch, StopWatchingFromCallback)
+{
+    // Both pipes are ready in the same loop iteration; whichever callback runs first stops watching
+    // the other one, which must then not be called with the readiness already collected.
+    static WatchedPipe pipes[2];
+    System::SocketWatchCallback callback = [](System::SocketEvents events, intptr_t data) {
+        auto * pipe  = reinterpret_cast<WatchedPipe *>(data);
+        auto & other = pipes[(pipe == &pipes[0]) ? 1 : 0];
+        if (other.token != SystemLayer().InvalidSocketWatchToken())
+        {
+            EXPECT_EQ(SystemLayer().StopWatchingSocket(&other.token), CHIP_NO_ERROR);
+        }
+        ReadAndStop(events, data);
+    };
+
+    for (auto & pipe : pipes)
+    {
+        Open(pipe, callback);
+        EXPECT_EQ(SystemLayer().RequestCallbackOnPendingRead(pipe.token), CHIP_NO_ERROR);
+        MakeReadable(pipe);
+    }
+
+    RunEventLoop(1000_ms);
+    EXPECT_EQ(pipes[0].callbacks + pipes[1].callbacks, 1);
+
+    for (auto & pipe : pipes)
+    {
+        Close(pipe);
+    }
+}
+
+#endif // !CHIP_DEVICE_LAYER_TARGET_FAKE
+#endif // CHIP_SYSTEM_CONFIG_USE_SOCKETS && !CHIP_SYSTEM_CONFIG_USE_DISPATCH && CHIP_SYSTEM_CONFIG_USE_POSIX_SOCKETS
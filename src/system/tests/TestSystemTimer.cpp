@@ -24,8 +24,10 @@
  */
 
 #include <errno.h>
+#include <memory>
 #include <stdint.h>
 #include <string.h>
+#include <vector>
 
 #include <pw_unit_test/framework.h>
 
@@ -564,6 +566,100 @@ TEST_F(TestSystemTimer, CheckTimerPool)
     EXPECT_TRUE(SYSTEM_STATS_TEST_HIGH_WATER_MARK(Stats::kSystemLayer_NumTimers, 4));
 }
 
+TEST_F(TestSystemTimer, CheckTimerListTies)
+{
+    using Timer = TimerList::Node;
+    struct TestState
+    {
+        static void A(Layer * layer, void * state) {}
+        static void B(Layer * layer, void * state) {}
+    };
+    int stateA, stateB;
+
+    using namespace Clock::Literals;
+    Timer first(mLayer, 100_ms, TestState::A, &stateA);
+    Timer second(mLayer, 100_ms, TestState::B, &stateB);
+    Timer third(mLayer, 100_ms, TestState::A, &stateA); // Same callback and state as `first`, like repeated ScheduleWork()
+    Timer later(mLayer, 200_ms, TestState::A, &stateB);
+    Timer stray(mLayer, 50_ms, TestState::B, &stateA);
+
+    TimerList list;
+    list.Add(&later);
+    list.Add(&first);
+    list.Add(&second);
+    list.Add(&third);
+
+    // Lookups return the matching timer that fires first; removing a timer that is not in the list does nothing.
+    EXPECT_EQ(list.Find(TestState::A, &stateA), &first);
+    EXPECT_EQ(list.Find(TestState::B, &stateA), nullptr);
+    EXPECT_EQ(list.Remove(&stray), &first);
+
+    // Equal expiration times come out in the order they were added.
+    EXPECT_EQ(list.PopEarliest(), &first);
+    EXPECT_EQ(list.Find(TestState::A, &stateA), &third);
+    EXPECT_EQ(list.PopEarliest(), &second);
+    EXPECT_EQ(list.PopEarliest(), &third);
+    EXPECT_EQ(list.PopEarliest(), &later);
+    EXPECT_TRUE(list.Empty());
+}
+
+// Arms, re-arms (cancelling by callback and state, like StartTimer() on a running timer), looks up and expires a few
+// timers, and checks they come out in order. timer-list-benchmark runs the same sequence at scale and times it.
+TEST_F(TestSystemTimer, CheckTimerListRearm)
+{
+    using Timer                  = TimerList::Node;
+    constexpr size_t kTimerCount = 16;
+    constexpr int kRearmRounds   = 3;
+    struct TestState
+    {
+        static void Fire(Layer * layer, void * state) {}
+        static void Other(Layer * layer, void * state) {}
+    };
+
+    uint32_t seed   = 1;
+    auto randomTime = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return Clock::Timestamp((seed >> 8) % 600000u);
+    };
+
+    uint8_t appStates[kTimerCount];
+    std::vector<std::unique_ptr<Timer>> timers(kTimerCount);
+    TimerList list;
+
+    for (size_t i = 0; i < kTimerCount; ++i)
+    {
+        timers[i] = std::make_unique<Timer>(mLayer, randomTime(), TestState::Fire, &appStates[i]);
+        list.Add(timers[i].get());
+    }
+    for (int round = 0; round < kRearmRounds; ++round)
+    {
+        for (size_t i = 0; i < kTimerCount; ++i)
+        {
+            // A different callback with the same state is a different timer.
+            EXPECT_EQ(list.Remove(TestState::Other, &appStates[i]), nullptr);
+            ASSERT_EQ(list.Remove(TestState::Fire, &appStates[i]), timers[i].get());
+            EXPECT_EQ(list.Find(TestState::Fire, &appStates[i]), nullptr);
+            timers[i] = std::make_unique<Timer>(mLayer, randomTime(), TestState::Fire, &appStates[i]);
+            list.Add(timers[i].get());
+        }
+    }
+    for (size_t i = 0; i < kTimerCount; ++i)
+    {
+        EXPECT_EQ(list.Find(TestState::Fire, &appStates[i]), timers[i].get());
+    }
+
+    size_t expired = 0;
+    Clock::Timestamp previous(0);
+    for (Timer * timer = list.PopEarliest(); timer != nullptr; timer = list.PopEarliest())
+    {
+        EXPECT_GE(timer->AwakenTime(), previous);
+        previous = timer->AwakenTime();
+        ++expired;
+    }
+    EXPECT_EQ(expired, kTimerCount);
+    EXPECT_TRUE(list.Empty());
+}
+
 TEST_F(TestSystemTimer, ExtendTimerToTest)
 {
     if (!LayerEvents<LayerImpl>::HasServiceEvents())
@@ -0,0 +1,148 @@
+/*
+ *
+ *    Copyright (c) 2025 Project CHIP Authors
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      Microbenchmark for System::TimerList: arms, re-arms, looks up and
+ *      expires timers the way StartTimer()/CancelTimer() and the event loop
+ *      do, and prints the time taken. The correctness of the same operations
+ *      is covered by TestSystemTimer.
+ *
+ *      Usage: timer-list-benchmark [timer count] [re-arm rounds]
+ */
+
+#include <chrono>
+#include <inttypes.h>
+#include <memory>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include <lib/support/CHIPMem.h>
+#include <system/SystemLayerImpl.h>
+#include <system/SystemTimer.h>
+
+using namespace chip;
+using namespace chip::System;
+
+namespace {
+
+constexpr size_t kDefaultTimerCount = 10000;
+constexpr int kDefaultRearmRounds   = 4;
+
+void Fire(Layer * layer, void * state) {}
+
+uint32_t sSeed = 1;
+
+Clock::Timestamp RandomTime()
+{
+    sSeed = sSeed * 1664525u + 1013904223u;
+    return Clock::Timestamp((sSeed >> 8) % 600000u);
+}
+
+// Returns the time taken in microseconds, or -1 if the list misbehaved.
+int64_t RunChurn(Layer & layer, size_t timerCount, int rearmRounds)
+{
+    using Timer = TimerList::Node;
+
+    std::vector<uint8_t> appStates(timerCount);
+    std::vector<std::unique_ptr<Timer>> timers(timerCount);
+    TimerList list;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < timerCount; ++i)
+    {
+        timers[i] = std::make_unique<Timer>(layer, RandomTime(), Fire, &appStates[i]);
+        list.Add(timers[i].get());
+    }
+    for (int round = 0; round < rearmRounds; ++round)
+    {
+        for (size_t i = 0; i < timerCount; ++i)
+        {
+            if (list.Remove(Fire, &appStates[i]) != timers[i].get())
+            {
+                fprintf(stderr, "Remove() returned the wrong timer\n");
+                return -1;
+            }
+            timers[i] = std::make_unique<Timer>(layer, RandomTime(), Fire, &appStates[i]);
+            list.Add(timers[i].get());
+        }
+    }
+    for (size_t i = 0; i < timerCount; ++i)
+    {
+        if (list.Find(Fire, &appStates[i]) != timers[i].get())
+        {
+            fprintf(stderr, "Find() returned the wrong timer\n");
+            return -1;
+        }
+    }
+
+    size_t expired = 0;
+    Clock::Timestamp previous(0);
+    for (Timer * timer = list.PopEarliest(); timer != nullptr; timer = list.PopEarliest())
+    {
+        if (timer->AwakenTime() < previous)
+        {
+            fprintf(stderr, "Timers expired out of order\n");
+            return -1;
+        }
+        previous = timer->AwakenTime();
+        ++expired;
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+    if (expired != timerCount)
+    {
+        fprintf(stderr, "%zu of %zu timers expired\n", expired, timerCount);
+        return -1;
+    }
+    return static_cast<int64_t>(elapsed.count());
+}
+
+} // namespace
+
+int main(int argc, char * argv[])
+{
+    size_t timerCount = (argc > 1) ? strtoul(argv[1], nullptr, 10) : kDefaultTimerCount;
+    int rearmRounds   = (argc > 2) ? atoi(argv[2]) : kDefaultRearmRounds;
+    if (timerCount == 0 || rearmRounds < 0)
+    {
+        fprintf(stderr, "Usage: %s [timer count] [re-arm rounds]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (Platform::MemoryInit() != CHIP_NO_ERROR)
+    {
+        return EXIT_FAILURE;
+    }
+    LayerImpl layer;
+    if (layer.Init() != CHIP_NO_ERROR)
+    {
+        return EXIT_FAILURE;
+    }
+
+    int64_t elapsedUs = RunChurn(layer, timerCount, rearmRounds);
+    if (elapsedUs >= 0)
+    {
+        printf("TimerList churn: %zu timers, %d re-arm rounds: %" PRId64 " us\n", timerCount, rearmRounds, elapsedUs);
+    }
+
+    layer.Shutdown();
+    Platform::MemoryShutdown();
+    return elapsedUs >= 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
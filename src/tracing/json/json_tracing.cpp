@@ -280,18 +280,15 @@ void JsonBackend::TraceInstant(const char * label, const char * group)
 void JsonBackend::TraceCounter(const char * label)
 {
     std::string counterId = std::string(label);
-    if (mCounters.find(counterId) == mCounters.end())
+    int count;
     {
-        mCounters[counterId] = 1;
-    }
-    else
-    {
-        mCounters[counterId]++;
+        std::lock_guard<std::mutex> lock(mMutex);
+        count = ++mCounters[counterId];
     }
     ::Json::Value value;
     value["event"] = "TraceCounter";
     value["label"] = label;
-    value["count"] = mCounters[counterId];
+    value["count"] = count;
 
     // Output the counter event
     OutputValue(value);
@@ -451,6 +448,7 @@ void JsonBackend::LogNodeDiscoveryFailed(NodeDiscoveryFailedInfo & info)
 
 void JsonBackend::CloseFile()
 {
+    std::lock_guard<std::mutex> lock(mMutex);
     if (!mOutputFile.is_open())
     {
         return;
@@ -465,6 +463,7 @@ CHIP_ERROR JsonBackend::OpenFile(const char * path)
 {
     CloseFile();
 
+    std::lock_guard<std::mutex> lock(mMutex);
     std::error_code ec;
     std::filesystem::path filePath(path);
     // Create directories if they don't exist
@@ -490,6 +489,7 @@ void JsonBackend::OutputValue(::Json::Value & value)
     ::Json::StreamWriterBuilder builder;
     std::unique_ptr<::Json::StreamWriter> writer(builder.newStreamWriter());
 
+    std::lock_guard<std::mutex> lock(mMutex);
     if (mOutputFile.is_open())
     {
         if (!mFirstRecord)
@@ -18,6 +18,7 @@
 #pragma once
 
 #include <fstream>
+#include <mutex>
 #include <string>
 #include <tracing/backend.h>
 #include <unordered_map>
@@ -37,6 +38,8 @@ namespace Json {
 /// THREAD SAFETY:
 ///    class assumes that ChipLog* is thread_safe (generally
 ///    we ChipLog* everywhere, so that condition seems to be met).
+///    File output and counters are serialized internally, as
+///    applications may trace from their own worker threads.
 class JsonBackend : public ::chip::Tracing::Backend
 {
 public:
@@ -65,6 +68,7 @@ private:
     /// Does the actual write of the value
     void OutputValue(::Json::Value & value);
 
+    std::mutex mMutex; // Guards mCounters, mOutputFile and mFirstRecord
     std::unordered_map<std::string, int> mCounters;
 
     // Output file if writing to a file. If closed, writing
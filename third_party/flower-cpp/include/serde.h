@@ -20,12 +20,12 @@
 /**
  * Serialize client parameters to protobuf parameters message
  */
-flwr::proto::Parameters parameters_to_proto(flwr_local::Parameters parameters);
+flwr::proto::Parameters parameters_to_proto(const flwr_local::Parameters &parameters);
 
 /**
  * Deserialize client protobuf parameters message to client parameters
  */
-flwr_local::Parameters parameters_from_proto(flwr::proto::Parameters msg);
+flwr_local::Parameters parameters_from_proto(const flwr::proto::Parameters &msg);
 
 /**
  * Serialize client scalar type to protobuf scalar type
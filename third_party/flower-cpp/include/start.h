@@ -21,6 +21,7 @@
 #include "flwr/proto/transport.grpc.pb.h"
 #include "grpc_rere.h"
 #include "message_handler.h"
+#include <functional>
 #include <grpcpp/grpcpp.h>
 #include <thread>
 
@@ -53,5 +54,15 @@ public:
   static void
   start_client(std::string server_address, flwr_local::Client *client,
                int grpc_max_message_length = GRPC_MAX_MESSAGE_LENGTH);
+
+  /**
+   * @brief Same as above, but returns once `keep_running` becomes false. It is
+   * polled between tasks and while waiting for the server, so a task that is
+   * already running completes (or is aborted by the client itself) first.
+   */
+  static void
+  start_client(std::string server_address, flwr_local::Client *client,
+               const std::function<bool()> &keep_running,
+               int grpc_max_message_length = GRPC_MAX_MESSAGE_LENGTH);
 };
 #endif
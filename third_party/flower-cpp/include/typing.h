@@ -17,6 +17,7 @@
 #include <map>
 #include <optional>
 #include <string>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -66,9 +67,11 @@ public:
   Parameters(const std::list<std::string> &tensors,
              const std::string &tensor_type)
       : tensors(tensors), tensor_type(tensor_type) {}
+  Parameters(std::list<std::string> &&tensors, const std::string &tensor_type)
+      : tensors(std::move(tensors)), tensor_type(tensor_type) {}
 
   // Getters
-  const std::list<std::string> getTensors() const { return tensors; }
+  const std::list<std::string> &getTensors() const { return tensors; }
   const std::string getTensor_type() const { return tensor_type; }
 
   // Setters
@@ -91,6 +94,8 @@ class ParametersRes {
 public:
   explicit ParametersRes(const Parameters &parameters)
       : parameters(parameters) {}
+  explicit ParametersRes(Parameters &&parameters)
+      : parameters(std::move(parameters)) {}
 
   const Parameters getParameters() const { return parameters; }
   void setParameters(const Parameters &p) { parameters = p; }
@@ -109,7 +114,7 @@ public:
       : parameters(parameters), config(config) {}
 
   // Getters
-  Parameters getParameters() { return parameters; }
+  const Parameters &getParameters() const { return parameters; }
   std::map<std::string, Scalar> getConfig() { return config; }
 
   // Setters
@@ -135,13 +140,14 @@ public:
         _fit_duration(fit_duration), _metrics(metrics) {}
 
   // Getters
-  const Parameters getParameters() const { return _parameters; }
+  const Parameters &getParameters() const { return _parameters; }
   const int getNum_example() const { return _num_examples; }
   const std::optional<float> getFit_duration() const { return _fit_duration; }
   const std::optional<Metrics> getMetrics() const { return _metrics; }
 
   // Setters
   void setParameters(const Parameters &p) { _parameters = p; }
+  void setParameters(Parameters &&p) { _parameters = std::move(p); }
   void setNum_example(int n) { _num_examples = n; }
   void setFit_duration(float f) { _fit_duration = f; }
   void setMetrics(const flwr_local::Metrics &m) { _metrics = m; }
@@ -163,7 +169,7 @@ public:
       : parameters(parameters), config(config) {}
 
   // Getters
-  Parameters getParameters() { return parameters; }
+  const Parameters &getParameters() const { return parameters; }
   std::map<std::string, Scalar> getConfig() { return config; }
 
   // Setters
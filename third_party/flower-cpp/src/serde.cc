@@ -5,11 +5,11 @@
 /**
  * Serialize client parameters to protobuf parameters message
  */
-flwr::proto::Parameters parameters_to_proto(flwr_local::Parameters parameters) {
+flwr::proto::Parameters parameters_to_proto(const flwr_local::Parameters &parameters) {
   flwr::proto::Parameters mp;
   mp.set_tensor_type(parameters.getTensor_type());
 
-  for (auto &i : parameters.getTensors()) {
+  for (const auto &i : parameters.getTensors()) {
     mp.add_tensors(i);
   }
   return mp;
@@ -18,13 +18,13 @@ flwr::proto::Parameters parameters_to_proto(flwr_local::Parameters parameters) {
 /**
  * Deserialize client protobuf parameters message to client parameters
  */
-flwr_local::Parameters parameters_from_proto(flwr::proto::Parameters msg) {
+flwr_local::Parameters parameters_from_proto(const flwr::proto::Parameters &msg) {
   std::list<std::string> tensors;
   for (int i = 0; i < msg.tensors_size(); i++) {
     tensors.push_back(msg.tensors(i));
   }
 
-  return flwr_local::Parameters(tensors, msg.tensor_type());
+  return flwr_local::Parameters(std::move(tensors), msg.tensor_type());
 }
 
 /**
@@ -393,7 +393,7 @@ parametersrecord_to_parameters(const flwr_local::ParametersRecord &record,
     }
   }
 
-  return flwr_local::Parameters(tensors, tensor_type);
+  return flwr_local::Parameters(std::move(tensors), tensor_type);
 }
 
 flwr_local::EvaluateIns
@@ -500,7 +500,7 @@ flwr_local::FitIns recordset_to_fit_ins(const flwr_local::RecordSet &recordset,
 flwr_local::ParametersRecord
 parameters_to_parametersrecord(const flwr_local::Parameters &parameters) {
   flwr_local::ParametersRecord record;
-  const std::list<std::string> tensors = parameters.getTensors();
+  const std::list<std::string> &tensors = parameters.getTensors();
   const std::string tensor_type = parameters.getTensor_type();
 
   int idx = 0;
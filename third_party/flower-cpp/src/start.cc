@@ -3,15 +3,23 @@
 // cppcheck-suppress unusedFunction
 void start::start_client(std::string server_address, flwr_local::Client *client,
                          int grpc_max_message_length) {
+  start_client(std::move(server_address), client, [] { return true; },
+               grpc_max_message_length);
+}
+
+// cppcheck-suppress unusedFunction
+void start::start_client(std::string server_address, flwr_local::Client *client,
+                         const std::function<bool()> &keep_running,
+                         int grpc_max_message_length) {
 
   gRPCRereCommunicator communicator(server_address, grpc_max_message_length);
 
-  while (true) {
+  while (keep_running()) {
     int sleep_duration = 0;
 
     create_node(&communicator);
 
-    while (true) {
+    while (keep_running()) {
       auto task_ins = receive(&communicator);
       if (!task_ins) {
         std::this_thread::sleep_for(std::chrono::seconds(3));
@@ -28,6 +36,10 @@ void start::start_client(std::string server_address, flwr_local::Client *client,
     }
 
     delete_node(&communicator);
+    if (!keep_running()) {
+      std::cout << "Stopped by the caller, disconnected." << std::endl;
+      break;
+    }
     if (sleep_duration == 0) {
       std::cout << "Disconnect and shut down." << std::endl;
       break;